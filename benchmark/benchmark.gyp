@@ -0,0 +1,57 @@
+{
+  'includes': [
+    '../common.gypi',
+    '../config.gypi'
+  ],
+  'targets': [
+    {
+        "target_name": "benchmark",
+        "product_name": "bench_tile_pipeline",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./pbf.cpp",
+            "./buckets.cpp",
+            "./collision.cpp",
+            "./clip_ids.cpp",
+            "./functions.cpp",
+            "./binpack.cpp",
+            "./font_stack.cpp",
+            "./label_placement.cpp",
+            "./utf.cpp",
+            "./fixtures/fixture_tile.hpp",
+            "./fixtures/fixture_tile.cpp",
+        ],
+        "dependencies": [
+            "../mapboxgl.gyp:mapboxgl",
+        ],
+        'conditions': [
+            ['OS == "mac"', {
+                'xcode_settings': {
+                    'OTHER_CPLUSPLUSFLAGS': [
+                        '<@(benchmark_cflags)',
+                    ],
+                    'OTHER_LDFLAGS': [
+                        '<@(benchmark_libraries)',
+                        # Buckets reference the painter, even though nothing is rendered.
+                        '-framework OpenGL',
+                    ],
+                },
+            }, {
+                'cflags': [
+                    '<@(benchmark_cflags)',
+                ],
+                'link_settings': {
+                    'libraries': [
+                        '<@(benchmark_libraries)',
+                        # Buckets reference the painter, even though nothing is rendered.
+                        '<@(glfw3_libraries)',
+                        '-lboost_regex',
+                        '-lpthread',
+                    ],
+                },
+            }],
+        ],
+    },
+  ]
+}
@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/geometry/binpack.hpp>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace mbgl;
+
+// Adds glyph-sized rects for a stream of tiles and releases the rects of the oldest tile once the
+// given number of tiles is live, like the glyph atlas while the map is panned.
+static void BinPack_GlyphChurn(benchmark::State &state) {
+    const size_t liveTiles = state.range(0);
+    size_t failed = 0;
+
+    while (state.KeepRunning()) {
+        BinPack<uint16_t> bin(1024, 1024);
+        std::mt19937 generator(20141016);
+        std::deque<std::vector<Rect<uint16_t>>> tiles;
+        for (int tile = 0; tile < 200; tile++) {
+            std::vector<Rect<uint16_t>> glyphs;
+            for (int glyph = 0; glyph < 150; glyph++) {
+                const Rect<uint16_t> rect = bin.allocate(12 + 4 * (generator() % 8), 16 + 4 * (generator() % 6));
+                if (rect) {
+                    glyphs.push_back(rect);
+                } else {
+                    failed++;
+                }
+            }
+            tiles.push_back(std::move(glyphs));
+            if (tiles.size() > liveTiles) {
+                for (const Rect<uint16_t> &rect : tiles.front()) {
+                    bin.release(rect);
+                }
+                tiles.pop_front();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 200 * 150);
+    state.SetLabel(std::to_string(failed / state.iterations()) + " overflows");
+}
+BENCHMARK(BinPack_GlyphChurn)->Arg(4)->Arg(8);
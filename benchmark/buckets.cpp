@@ -0,0 +1,188 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/geometry/sprite_atlas.hpp>
+#include <mbgl/map/sprite.hpp>
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/renderer/fill_bucket.hpp>
+#include <mbgl/renderer/line_bucket.hpp>
+#include <mbgl/renderer/symbol_bucket.hpp>
+#include <mbgl/text/collision.hpp>
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/util/filesource.hpp>
+
+#include "fixtures/fixture_tile.hpp"
+
+#include <future>
+#include <string>
+
+using namespace mbgl;
+
+namespace {
+
+const FixtureTile &fixture() {
+    static const FixtureTile fixture;
+    return fixture;
+}
+
+}
+
+// Triangulates all polygons of a layer. Most buildings are simple polygons and take the ear
+// clipping path; the water layer has holes that cross their outer rings.
+static void FillBucket_AddGeometry(benchmark::State &state, const std::string &layerName) {
+    const VectorTileLayer &layer = fixture().layer(layerName);
+    const StyleBucketFill properties;
+
+    while (state.KeepRunning()) {
+        FillVertexBuffer vertexBuffer;
+        TriangleElementsBuffer triangleElementsBuffer;
+        LineElementsBuffer lineElementsBuffer;
+        util::Arena arena;
+        FillBucket bucket(vertexBuffer, triangleElementsBuffer, lineElementsBuffer, properties, arena);
+
+        for (const VectorTileFeature &feature : layer.features) {
+            pbf geometry = feature.geometry;
+            bucket.addGeometry(geometry);
+        }
+        benchmark::DoNotOptimize(bucket.hasData());
+    }
+    state.SetItemsProcessed(state.iterations() * layer.features.size());
+}
+
+static void FillBucket_AddGeometry_Water(benchmark::State &state) {
+    FillBucket_AddGeometry(state, "water");
+}
+BENCHMARK(FillBucket_AddGeometry_Water);
+
+static void FillBucket_AddGeometry_Building(benchmark::State &state) {
+    FillBucket_AddGeometry(state, "building");
+}
+BENCHMARK(FillBucket_AddGeometry_Building);
+
+static void LineBucket_AddGeometry(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+
+    StyleBucketLine properties;
+    properties.join = state.range(0) ? JoinType::Round : JoinType::Miter;
+
+    while (state.KeepRunning()) {
+        LineVertexBuffer vertexBuffer;
+        TriangleElementsBuffer triangleElementsBuffer;
+        PointElementsBuffer pointElementsBuffer;
+        util::Arena arena;
+        LineBucket bucket(vertexBuffer, triangleElementsBuffer, pointElementsBuffer, properties, arena);
+
+        for (const VectorTileFeature &feature : road.features) {
+            pbf geometry = feature.geometry;
+            bucket.addGeometry(geometry);
+        }
+        benchmark::DoNotOptimize(bucket.hasData());
+    }
+    state.SetItemsProcessed(state.iterations() * road.features.size());
+}
+BENCHMARK(LineBucket_AddGeometry)->Arg(0)->Arg(1);
+
+// Expands the text and icon tokens of every feature and collects the glyph ranges of the labels.
+static void SymbolBucket_ProcessFeatures(benchmark::State &state) {
+    const FixtureTile &tile = fixture();
+    const VectorTileLayer &layer = tile.layer("poi_label");
+    const FilterExpression filter;
+
+    StyleBucketSymbol properties;
+    properties.text.field = "{name}";
+    properties.icon.image = "{maki}-12";
+
+    while (state.KeepRunning()) {
+        Collision collision(tile.id.z, 4096, 512);
+        util::Arena arena;
+        SymbolBucket bucket(properties, collision, arena);
+        std::set<GlyphRange> ranges;
+        benchmark::DoNotOptimize(bucket.processFeatures(layer, filter, ranges).size());
+    }
+    state.SetItemsProcessed(state.iterations() * layer.features.size());
+}
+BENCHMARK(SymbolBucket_ProcessFeatures);
+
+// Shapes and places the labels of a layer. Glyphs are loaded from the fixtures before the timed
+// loop, so only shaping, placement and buffer writes are measured. Unless the shaping cache is
+// cleared, labels are shaped once, like the street names that recur in neighbouring tiles.
+static void SymbolBucket_AddFeatures(benchmark::State &state, const std::string &layerName, PlacementType placement,
+                                     PlacementIndexType indexType = PlacementIndexType::Grid,
+                                     bool clearShapingCache = false) {
+    const FixtureTile &tile = fixture();
+    const VectorTileLayer &layer = tile.layer(layerName);
+    const FilterExpression filter;
+
+    StyleBucketSymbol properties;
+    properties.placement = placement;
+    properties.text.field = "{name}";
+    properties.text.font = "Open Sans Regular";
+
+    const std::shared_ptr<FileSource> fileSource = std::make_shared<FileSource>();
+    GlyphStore glyphStore(fileSource);
+    glyphStore.setURL(FixtureTile::glyphURL());
+    GlyphAtlas glyphAtlas(1024, 1024);
+    SpriteAtlas spriteAtlas(512, 512);
+    std::shared_ptr<Sprite> sprite = Sprite::Create("", 1, fileSource);
+
+    {
+        Collision collision(tile.id.z, 4096, 512);
+        util::Arena arena;
+        SymbolBucket bucket(properties, collision, arena);
+        std::set<GlyphRange> ranges;
+        bucket.processFeatures(layer, filter, ranges);
+
+        std::promise<void> loaded;
+        if (!glyphStore.requestGlyphRanges(properties.text.font, ranges, [&loaded]() { loaded.set_value(); })) {
+            loaded.get_future().wait();
+        }
+    }
+
+    while (state.KeepRunning()) {
+        if (clearShapingCache) {
+            glyphStore.getShapingCache().clear();
+        }
+        Collision collision(tile.id.z, 4096, 512, 1, indexType);
+        util::Arena arena;
+        SymbolBucket bucket(properties, collision, arena);
+        std::set<GlyphRange> ranges;
+        bucket.addFeatures(bucket.processFeatures(layer, filter, ranges), tile.id, spriteAtlas, *sprite, glyphAtlas, glyphStore);
+        benchmark::DoNotOptimize(bucket.hasData());
+    }
+    state.SetItemsProcessed(state.iterations() * layer.features.size());
+
+    const ShapingCache::Stats stats = glyphStore.getShapingCache().getStats();
+    state.SetLabel("shaping cache hit rate " + std::to_string(int(stats.hitRate() * 100)) + "%");
+}
+
+static void SymbolBucket_AddFeatures_Point(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "poi_label", PlacementType::Point);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Point);
+
+static void SymbolBucket_AddFeatures_Line(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "road", PlacementType::Line);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Line);
+
+// The same with every label shaped again, like tiles with labels that haven't been seen before.
+static void SymbolBucket_AddFeatures_Point_Unshaped(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "poi_label", PlacementType::Point, PlacementIndexType::Grid, true);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Point_Unshaped);
+
+static void SymbolBucket_AddFeatures_Line_Unshaped(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "road", PlacementType::Line, PlacementIndexType::Grid, true);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Line_Unshaped);
+
+// The same on the R*-tree that the collision index used to be, for comparison.
+static void SymbolBucket_AddFeatures_Point_RTree(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "poi_label", PlacementType::Point, PlacementIndexType::RTree);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Point_RTree);
+
+static void SymbolBucket_AddFeatures_Line_RTree(benchmark::State &state) {
+    SymbolBucket_AddFeatures(state, "road", PlacementType::Line, PlacementIndexType::RTree);
+}
+BENCHMARK(SymbolBucket_AddFeatures_Line_RTree);
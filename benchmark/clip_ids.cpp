@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/clip_ids.hpp>
+
+using namespace mbgl;
+
+// Covers the viewport with tiles at two zoom levels, like a map that is zooming in and still shows
+// the parents of the tiles that haven't loaded yet.
+static void ClipIDs_Compute(benchmark::State &state) {
+    const int32_t size = state.range(0);
+
+    std::forward_list<Tile::ID> ids;
+    for (int32_t x = 0; x < size; x++) {
+        for (int32_t y = 0; y < size; y++) {
+            ids.emplace_front(15, 17600 + x, 10740 + y);
+            if (x % 2 == 0 && y % 2 == 0) {
+                ids.emplace_front(14, (17600 + x) / 2, (10740 + y) / 2);
+            }
+        }
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(computeClipIDs(ids).size());
+    }
+    state.SetItemsProcessed(state.iterations() * std::distance(ids.begin(), ids.end()));
+}
+BENCHMARK(ClipIDs_Compute)->Arg(4)->Arg(8);
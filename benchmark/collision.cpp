@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/text/collision.hpp>
+
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+// Label-sized boxes at random positions in the tile. The seed is fixed so that every run places
+// the same boxes.
+std::vector<std::pair<CollisionAnchor, GlyphBoxes>> labels(size_t count) {
+    std::mt19937 generator(20141016);
+    std::uniform_real_distribution<float> position(0, 4096);
+    std::uniform_real_distribution<float> size(40, 400);
+
+    std::vector<std::pair<CollisionAnchor, GlyphBoxes>> result;
+    for (size_t i = 0; i < count; i++) {
+        const CollisionAnchor anchor { position(generator), position(generator) };
+        const float width = size(generator);
+        const float height = width / 5;
+        GlyphBoxes boxes;
+        boxes.emplace_back(CollisionRect{ -width / 2, -height / 2, width / 2, height / 2 }, anchor, 0.5f, std::numeric_limits<float>::infinity(), 2.0f);
+        result.emplace_back(anchor, std::move(boxes));
+    }
+    return result;
+}
+
+}
+
+// Places every label at the scale where it doesn't collide with the labels placed before it, like
+// SymbolBucket does.
+static void Collision_Place(benchmark::State &state, PlacementIndexType indexType) {
+    const auto boxes = labels(state.range(0));
+
+    while (state.KeepRunning()) {
+        Collision collision(14, 4096, 512, 1, indexType);
+        for (const auto &label : boxes) {
+            const float scale = collision.getPlacementScale(label.second, 0.5f, false);
+            if (scale) {
+                const PlacementRange range = collision.getPlacementRange(label.second, scale, true);
+                collision.insert(label.second, label.first, scale, range, true);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boxes.size());
+}
+
+static void Collision_Place_Grid(benchmark::State &state) {
+    Collision_Place(state, PlacementIndexType::Grid);
+}
+BENCHMARK(Collision_Place_Grid)->Arg(100)->Arg(1000)->Arg(5000);
+
+static void Collision_Place_RTree(benchmark::State &state) {
+    Collision_Place(state, PlacementIndexType::RTree);
+}
+BENCHMARK(Collision_Place_RTree)->Arg(100)->Arg(1000)->Arg(5000);
@@ -0,0 +1,36 @@
+#include "fixture_tile.hpp"
+
+#include <mbgl/util/io.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+const std::string base_directory = []{
+    std::string fn = __FILE__;
+    fn.erase(fn.find_last_of("/"));
+    return fn;
+}();
+
+}
+
+namespace mbgl {
+
+FixtureTile::FixtureTile()
+    : data(util::read_file(base_directory + "/14-8802-5374.vector.pbf")),
+      tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size())) {
+}
+
+const VectorTileLayer &FixtureTile::layer(const std::string &name) const {
+    auto it = tile.layers.find(name);
+    if (it == tile.layers.end()) {
+        throw std::runtime_error("fixture tile has no layer " + name);
+    }
+    return it->second;
+}
+
+std::string FixtureTile::glyphURL() {
+    return "file://" + base_directory + "/glyphs/{range}.pbf";
+}
+
+}
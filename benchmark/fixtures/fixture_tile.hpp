@@ -0,0 +1,28 @@
+#ifndef MBGL_BENCHMARK_FIXTURE_TILE
+#define MBGL_BENCHMARK_FIXTURE_TILE
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/map/tile.hpp>
+
+#include <string>
+
+namespace mbgl {
+
+// A checked-in vector tile with water polygons, roads, POI labels and buildings. See generate.py.
+class FixtureTile {
+public:
+    FixtureTile();
+
+    const VectorTileLayer &layer(const std::string &name) const;
+
+    // URL template for the glyphs of the fixture tile.
+    static std::string glyphURL();
+
+    const Tile::ID id { 14, 8802, 5374 };
+    const std::string data;
+    const VectorTile tile;
+};
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+#!/usr/bin/env python
+# Generates the fixture tile and glyphs used by the benchmarks. The output is deterministic, so the
+# checked-in files only need to be regenerated when this script changes.
+
+import math
+import os
+import random
+
+root = os.path.dirname(os.path.abspath(__file__))
+random.seed(20141016)
+
+
+def varint(value):
+    result = bytearray()
+    while value >= 0x80:
+        result.append((value & 0x7F) | 0x80)
+        value >>= 7
+    result.append(value)
+    return bytes(result)
+
+
+def zigzag(value):
+    return (value << 1) ^ (value >> 31)
+
+
+def field(tag, value):
+    if isinstance(value, bytes):
+        return varint((tag << 3) | 2) + varint(len(value)) + value
+    return varint(tag << 3) + varint(value)
+
+
+def packed(values):
+    return b''.join(varint(value) for value in values)
+
+
+def command(id, count):
+    return (id & 0x7) | (count << 3)
+
+
+def geometry(rings, close):
+    values = []
+    x, y = 0, 0
+    for ring in rings:
+        for i, (px, py) in enumerate(ring):
+            if i == 0:
+                values.append(command(1, 1))
+            elif i == 1:
+                values.append(command(2, len(ring) - 1))
+            values.append(zigzag(px - x))
+            values.append(zigzag(py - y))
+            x, y = px, py
+        if close:
+            values.append(command(7, 1))
+    return packed(values)
+
+
+class Layer(object):
+    def __init__(self, name):
+        self.name = name
+        self.keys = []
+        self.values = []
+        self.features = []
+
+    def index(self, table, item):
+        if item not in table:
+            table.append(item)
+        return table.index(item)
+
+    def add(self, id, type, tags, geom):
+        indices = []
+        for key, value in sorted(tags.items()):
+            indices.append(self.index(self.keys, key))
+            indices.append(self.index(self.values, value))
+        self.features.append(field(1, id) + field(2, packed(indices)) + field(3, type) + field(4, geom))
+
+    def encode(self):
+        data = field(15, 1) + field(1, self.name.encode('utf-8'))
+        for feature in self.features:
+            data += field(2, feature)
+        for key in self.keys:
+            data += field(3, key.encode('utf-8'))
+        for value in self.values:
+            if isinstance(value, str):
+                data += field(4, field(1, value.encode('utf-8')))
+            else:
+                data += field(4, field(4, value))
+        return data + field(5, 4096)
+
+
+def clamp(value):
+    return max(-64, min(4160, int(value)))
+
+
+def blob(cx, cy, radius, count, rng=random):
+    ring = []
+    for i in range(count):
+        angle = 2 * math.pi * i / count
+        r = radius * rng.uniform(0.6, 1.0)
+        ring.append((clamp(cx + r * math.cos(angle)), clamp(cy + r * math.sin(angle))))
+    return ring
+
+
+def walk(count):
+    x, y = random.uniform(0, 4096), random.uniform(0, 4096)
+    heading = random.uniform(0, 2 * math.pi)
+    line = []
+    for i in range(count):
+        line.append((clamp(x), clamp(y)))
+        heading += random.uniform(-0.4, 0.4)
+        step = random.uniform(20, 80)
+        x += step * math.cos(heading)
+        y += step * math.sin(heading)
+    return line
+
+
+def orient(ring, outer):
+    area = sum(ring[i - 1][0] * ring[i][1] - ring[i][0] * ring[i - 1][1] for i in range(len(ring)))
+    return ring if (area > 0) == outer else list(reversed(ring))
+
+
+def footprint(rng, cx, cy, shape):
+    # Rectangles, L and U shapes, rotated by a random angle.
+    w, h = rng.uniform(8, 40), rng.uniform(8, 40)
+    if shape == 'rect':
+        corners = [(0, 0), (w, 0), (w, h), (0, h)]
+    elif shape == 'l':
+        corners = [(0, 0), (w, 0), (w, h / 2), (w / 2, h / 2), (w / 2, h), (0, h)]
+    else:
+        corners = [(0, 0), (w, 0), (w, h), (w * 2 / 3, h), (w * 2 / 3, h / 3),
+                   (w / 3, h / 3), (w / 3, h), (0, h)]
+    angle = rng.uniform(0, math.pi)
+    ring = []
+    for x, y in corners:
+        x, y = x - w / 2, y - h / 2
+        ring.append((clamp(cx + x * math.cos(angle) - y * math.sin(angle)),
+                     clamp(cy + x * math.sin(angle) + y * math.cos(angle))))
+    return orient(ring, True), w, h
+
+
+def word():
+    syllables = ['ber', 'lin', 'to', 'ka', 'ma', 'ri', 'son', 'del', 'vo', 'sta', 'ne', 'gar']
+    return ''.join(random.choice(syllables) for i in range(random.randint(2, 4))).capitalize()
+
+
+def tile():
+    water = Layer('water')
+    for i in range(300):
+        cx, cy = random.uniform(0, 4096), random.uniform(0, 4096)
+        rings = [blob(cx, cy, random.uniform(40, 400), random.randint(8, 48))]
+        if i % 5 == 0:
+            hole = blob(cx, cy, random.uniform(10, 30), 8)
+            rings.append(list(reversed(hole)))
+        water.add(i + 1, 3, {'class': random.choice(['lake', 'river', 'ocean'])}, geometry(rings, True))
+
+    road = Layer('road')
+    for i in range(800):
+        tags = {
+            'class': random.choice(['motorway', 'main', 'street', 'street', 'path']),
+            'oneway': random.randint(0, 1),
+        }
+        if i % 4 == 0:
+            tags['name'] = word() + ' Street'
+        road.add(i + 1, 2, tags, geometry([walk(random.randint(10, 60))], False))
+
+    poi_label = Layer('poi_label')
+    for i in range(400):
+        point = (clamp(random.uniform(0, 4096)), clamp(random.uniform(0, 4096)))
+        tags = {
+            'name': word() if i % 3 else word() + ' ' + word(),
+            'type': random.choice(['park', 'school', 'cafe', 'museum']),
+            'scalerank': random.randint(1, 4),
+        }
+        poi_label.add(i + 1, 1, tags, geometry([[point]], False))
+
+    # Buildings use their own generator, so the other layers and the glyphs stay the same.
+    rng = random.Random(20150401)
+    building = Layer('building')
+    for i in range(3000):
+        cx, cy = rng.uniform(0, 4096), rng.uniform(0, 4096)
+        courtyard = i % 10 == 0
+        ring, w, h = footprint(rng, cx, cy, 'rect' if courtyard else rng.choice(['rect', 'rect', 'l', 'u']))
+        rings = [ring]
+        if courtyard:
+            r = min(w, h) / 6
+            rings.append(orient([(clamp(cx - r), clamp(cy - r)), (clamp(cx + r), clamp(cy - r)),
+                                 (clamp(cx + r), clamp(cy + r)), (clamp(cx - r), clamp(cy + r))], False))
+        elif i % 25 == 1:
+            # Large building with many vertices
+            rings = [orient(blob(cx, cy, rng.uniform(60, 120), rng.randint(100, 200), rng), True)]
+        elif i % 100 == 2:
+            # Self-intersecting footprint
+            ring = ring[:4]
+            rings = [[ring[0], ring[2], ring[1], ring[3]]]
+        building.add(i + 1, 3, {'type': rng.choice(['house', 'apartments', 'industrial'])}, geometry(rings, True))
+
+    return b''.join(field(3, layer.encode()) for layer in [water, road, poi_label, building])
+
+
+def glyphs():
+    # Glyph metrics are synthetic; the bitmaps have the size the glyph atlas expects.
+    stack = field(1, b'Open Sans Regular') + field(2, b'0-255')
+    for id in range(32, 127):
+        width = 0 if id == 32 else random.randint(6, 12)
+        height = 0 if id == 32 else random.randint(10, 16)
+        glyph = field(1, id)
+        if width:
+            glyph += field(2, bytes(bytearray(random.randint(0, 255) for i in range((width + 6) * (height + 6)))))
+        glyph += field(3, width) + field(4, height) + field(5, zigzag(1)) + field(6, zigzag(-18)) + field(7, width + 2)
+        stack += field(3, glyph)
+    return field(1, stack)
+
+
+def write(path, data):
+    with open(os.path.join(root, path), 'wb') as f:
+        f.write(data)
+
+
+write('14-8802-5374.vector.pbf', tile())
+write('glyphs/0-255.pbf', glyphs())
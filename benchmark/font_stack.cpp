@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/text/shaping_cache.hpp>
+#include <mbgl/util/std.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+const FontStack &fontStack() {
+    static FontStack stack;
+    static bool loaded = [] {
+        std::unique_ptr<GlyphSet> glyphs = std::make_unique<GlyphSet>();
+        for (uint32_t id = 32; id < 127; id++) {
+            SDFGlyph glyph;
+            glyph.id = id;
+            glyph.metrics.width = 12;
+            glyph.metrics.height = 18;
+            glyph.metrics.advance = 10 + id % 5;
+            glyph.bitmap = std::string(18 * 24, '\0');
+            glyphs->insert(glyph);
+        }
+        stack.insert(0, std::move(glyphs));
+        return true;
+    }();
+    (void)loaded;
+    return stack;
+}
+
+const std::vector<std::u32string> labels = {
+    U"Main Street", U"Rue de la Paix", U"Central Park", U"Alexanderplatz",
+    U"Golden Gate Bridge", U"St. Mary's Hospital", U"Washington Avenue", U"Lake Merritt",
+};
+
+}
+
+// Shapes street labels with word wrapping, like the symbol buckets of several tiles that are
+// parsed at the same time. The font stack is shared by all threads.
+static void FontStack_Shaping(benchmark::State &state) {
+    const FontStack &stack = fontStack();
+    size_t glyphs = 0;
+
+    while (state.KeepRunning()) {
+        for (const std::u32string &label : labels) {
+            const Shaping shaping = stack.getShaping(label, 8 * 24, 1.2 * 24, 0.5, 0.5, 0.5, 0, { 0, 0 });
+            benchmark::DoNotOptimize(shaping.data());
+            glyphs += shaping.size();
+        }
+    }
+    state.SetItemsProcessed(glyphs);
+}
+BENCHMARK(FontStack_Shaping)->ThreadRange(1, 8);
+
+// The same labels from the shaping cache, which all threads share.
+static void ShapingCache_Shaping(benchmark::State &state) {
+    static ShapingCache cache(1024 * 1024);
+    const FontStack &stack = fontStack();
+    const std::string fontStackName = "Open Sans Regular";
+    size_t glyphs = 0;
+
+    while (state.KeepRunning()) {
+        for (const std::u32string &label : labels) {
+            const std::shared_ptr<const Shaping> shaping = cache.getShaping(
+                fontStackName, stack, label, 8 * 24, 1.2 * 24, 0.5, 0.5, 0.5, 0, { 0, 0 });
+            benchmark::DoNotOptimize(shaping->data());
+            glyphs += shaping->size();
+        }
+    }
+    state.SetItemsProcessed(glyphs);
+}
+BENCHMARK(ShapingCache_Shaping)->ThreadRange(1, 8);
+
+// Looks up the glyphs of the labels, like adding them to the glyph atlas does.
+static void FontStack_GetGlyph(benchmark::State &state) {
+    const FontStack &stack = fontStack();
+    size_t glyphs = 0;
+
+    while (state.KeepRunning()) {
+        for (const std::u32string &label : labels) {
+            for (char32_t chr : label) {
+                benchmark::DoNotOptimize(stack.getGlyph(chr));
+            }
+            glyphs += label.size();
+        }
+    }
+    state.SetItemsProcessed(glyphs);
+}
+BENCHMARK(FontStack_GetGlyph)->ThreadRange(1, 8);
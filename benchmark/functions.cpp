@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/style/function_properties.hpp>
+#include <mbgl/style/types.hpp>
+
+using namespace mbgl;
+
+// Evaluates a stops function at zoom levels spread over its whole range.
+template <typename T>
+static void evaluate(benchmark::State &state, const StopsFunction<T> &function) {
+    float z = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(function.evaluate(z));
+        z += 0.01f;
+        if (z > 22) z = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void StopsFunction_Float(benchmark::State &state) {
+    const StopsFunction<float> function({ { 5, 0.5 }, { 10, 1 }, { 14, 4 }, { 16, 12 }, { 18, 30 } }, 1.5);
+    evaluate(state, function);
+}
+BENCHMARK(StopsFunction_Float);
+
+static void StopsFunction_Color(benchmark::State &state) {
+    const StopsFunction<Color> function({ { 8, {{ 0.9, 0.9, 0.8, 1 }} }, { 14, {{ 1, 1, 1, 1 }} } }, 1);
+    evaluate(state, function);
+}
+BENCHMARK(StopsFunction_Color);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/text/label_placement.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// A dense city view: 4x4 tiles of 256 pixels, with 2000 labels of street and POI size each.
+struct CityView {
+    CityView() {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> position(0, 4096);
+        std::uniform_real_distribution<float> width(30, 120);
+        std::uniform_int_distribution<uint32_t> name(1, 500);
+
+        instances.resize(16);
+        for (std::vector<SymbolInstance> &tile : instances) {
+            for (size_t i = 0; i < 2000; i++) {
+                SymbolInstance instance;
+                instance.key = name(random);
+                instance.anchor = CollisionAnchor{position(random), position(random)};
+                const float w = width(random);
+                instance.box = CollisionRect{-w / 2, -10, w / 2, 10};
+                instance.repeatDistance = i % 2 ? 250 : 0;
+                instance.rotateWithMap = i % 2;
+                tile.push_back(instance);
+            }
+        }
+
+        view.width = 1024;
+        view.height = 1024;
+        view.zoom = 16;
+    }
+
+    std::vector<LabelPlacement::Bucket> buckets() const {
+        std::vector<LabelPlacement::Bucket> result;
+        for (size_t i = 0; i < instances.size(); i++) {
+            LabelPlacement::Bucket bucket;
+            bucket.instances = &instances[i];
+            matrix::identity(bucket.matrix);
+            matrix::translate(bucket.matrix, bucket.matrix, i % 4 * 256.0f, i / 4 * 256.0f, 0);
+            matrix::scale(bucket.matrix, bucket.matrix, 256.0f / 4096, 256.0f / 4096, 1);
+            result.push_back(std::move(bucket));
+        }
+        return result;
+    }
+
+    std::vector<std::vector<SymbolInstance>> instances;
+    LabelPlacement::View view;
+};
+
+}
+
+// Places all labels of the view against each other, as happens after every camera change.
+static void LabelPlacement_CityView(benchmark::State &state) {
+    const CityView city;
+    std::vector<LabelPlacement::Bucket> buckets = city.buckets();
+
+    while (state.KeepRunning()) {
+        LabelPlacement::place(buckets, city.view);
+        benchmark::DoNotOptimize(buckets.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 16 * 2000);
+}
+BENCHMARK(LabelPlacement_CityView);
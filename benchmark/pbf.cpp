@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/geometry/geometry.hpp>
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+#include <mbgl/style/filter_comparison_private.hpp>
+#include <mbgl/util/vec.hpp>
+
+#include "fixtures/fixture_tile.hpp"
+
+using namespace mbgl;
+
+namespace {
+
+const FixtureTile &fixture() {
+    static const FixtureTile fixture;
+    return fixture;
+}
+
+}
+
+// Decodes every varint in the geometries of the fixture tile.
+static void PBF_Varint(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+
+    size_t count = 0;
+    while (state.KeepRunning()) {
+        for (const VectorTileFeature &feature : road.features) {
+            pbf geometry = feature.geometry;
+            while (geometry) {
+                benchmark::DoNotOptimize(geometry.varint());
+                count++;
+            }
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(PBF_Varint);
+
+static void PBF_Svarint(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+
+    size_t count = 0;
+    while (state.KeepRunning()) {
+        for (const VectorTileFeature &feature : road.features) {
+            pbf geometry = feature.geometry;
+            while (geometry) {
+                benchmark::DoNotOptimize(geometry.svarint<int32_t>());
+                count++;
+            }
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(PBF_Svarint);
+
+// Decodes every line of the road geometries into a reused vertex buffer.
+static void Geometry_NextRing(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+
+    std::vector<Coordinate> line;
+    size_t count = 0;
+    while (state.KeepRunning()) {
+        for (const VectorTileFeature &feature : road.features) {
+            pbf geometry_pbf = feature.geometry;
+            Geometry geometry(geometry_pbf);
+            while (geometry.nextRing(line)) {
+                count += line.size();
+            }
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(Geometry_NextRing);
+
+// Decodes all layers of the fixture tile into their feature indices.
+static void VectorTileLayer_Construct(benchmark::State &state) {
+    const std::string &data = fixture().data;
+
+    while (state.KeepRunning()) {
+        VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+        benchmark::DoNotOptimize(tile.layers.size());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(VectorTileLayer_Construct);
+
+static void FilteredVectorTileLayer_All(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+    const FilterExpression all;
+
+    size_t count = 0;
+    while (state.KeepRunning()) {
+        for (const VectorTileFeature &feature : FilteredVectorTileLayer(road, all)) {
+            benchmark::DoNotOptimize(feature.id);
+            count++;
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(FilteredVectorTileLayer_All);
+
+// A filter like the ones of typical road styles: one class out of a list, on one-way roads only.
+static void FilteredVectorTileLayer_Comparison(benchmark::State &state) {
+    const VectorTileLayer &road = fixture().layer("road");
+
+    FilterComparison classes("class");
+    classes.add(FilterComparison::Operator::In, std::vector<Value> { std::string("main"), std::string("street") });
+    FilterComparison oneway("oneway");
+    oneway.add(FilterComparison::Operator::Equal, std::vector<Value> { int64_t(1) });
+
+    FilterExpression expression;
+    expression.setGeometryType(FilterExpression::GeometryType::LineString);
+    expression.add(classes);
+    expression.add(oneway);
+
+    size_t count = 0;
+    while (state.KeepRunning()) {
+        for (const VectorTileFeature &feature : FilteredVectorTileLayer(road, expression)) {
+            benchmark::DoNotOptimize(feature.id);
+        }
+        count += road.features.size();
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(FilteredVectorTileLayer_Comparison);
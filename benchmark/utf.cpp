@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/utf.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+const std::vector<std::string> ascii = {
+    "Main Street", "Rue de la Paix", "Central Park", "Alexanderplatz",
+    "Golden Gate Bridge", "St. Mary's Hospital", "Washington Avenue", "Lake Merritt",
+};
+
+const std::vector<std::string> latin = {
+    "Stra\xc3\x9f" "e des 17. Juni", "Champs-\xc3\x89lys\xc3\xa9" "es", "Plac Zamkowy",
+    "\xc3\x81" "vila", "Z\xc3\xbcrich Hauptbahnhof", "Praha hlavn\xc3\xad n\xc3\xa1" "dra\xc5\xbe\xc3\xad",
+};
+
+const std::vector<std::string> cjk = {
+    "\xe6\x9d\xb1\xe4\xba\xac\xe9\x83\xbd", "\xe6\x96\xb0\xe5\xae\xbf\xe9\xa7\x85",
+    "\xe5\x8c\x97\xe4\xba\xac\xe5\xb8\x82", "\xec\x84\x9c\xec\x9a\xb8\xed\x8a\xb9\xeb\xb3\x84\xec\x8b\x9c",
+};
+
+}
+
+// Decodes labels into a buffer that is reused, like the symbol buckets do for every feature.
+static void UTF_Decode(benchmark::State &state, const std::vector<std::string> &labels) {
+    std::u32string label;
+    size_t bytes = 0;
+
+    while (state.KeepRunning()) {
+        for (const std::string &utf8 : labels) {
+            label.clear();
+            util::utf8ToUtf32(utf8, label);
+            benchmark::DoNotOptimize(label.data());
+            bytes += utf8.size();
+        }
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+static void UTF_Decode_ASCII(benchmark::State &state) {
+    UTF_Decode(state, ascii);
+}
+BENCHMARK(UTF_Decode_ASCII);
+
+static void UTF_Decode_Latin(benchmark::State &state) {
+    UTF_Decode(state, latin);
+}
+BENCHMARK(UTF_Decode_Latin);
+
+static void UTF_Decode_CJK(benchmark::State &state) {
+    UTF_Decode(state, cjk);
+}
+BENCHMARK(UTF_Decode_CJK);
+
+// Uppercases decoded labels, like text-transform does.
+static void UTF_ToUpper(benchmark::State &state) {
+    std::vector<std::u32string> labels;
+    for (const std::string &utf8 : latin) {
+        labels.emplace_back();
+        util::utf8ToUtf32(utf8, labels.back());
+    }
+    size_t characters = 0;
+
+    while (state.KeepRunning()) {
+        for (const std::u32string &label : labels) {
+            std::u32string upper = label;
+            util::toUpper(upper);
+            benchmark::DoNotOptimize(upper.data());
+            characters += upper.size();
+        }
+    }
+    state.SetItemsProcessed(characters);
+}
+BENCHMARK(UTF_ToUpper);
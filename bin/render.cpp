@@ -0,0 +1,242 @@
+#include <mbgl/map/map.hpp>
+#include <mbgl/geometry/bufferpool.hpp>
+#include <mbgl/platform/log.hpp>
+#include <mbgl/util/filesource.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/time.hpp>
+#include <mbgl/util/uv.hpp>
+
+#include "../common/headless_view.hpp"
+#include "../common/stderr_log.hpp"
+
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+// Renders a batch of static map images with a single Map and GL context, so that tiles, glyphs
+// and sprites loaded for one job are reused by all later jobs.
+//
+// Each line of the job list describes one image:
+//
+//     lon lat zoom [bearing [width [height [ratio [output]]]]]
+//
+// Missing values default to a bearing of 0, a 512x512 image, a pixel ratio of 1 and an output
+// file named after the line number. Empty lines and lines starting with # are skipped.
+//
+// The renderer needs a GLX display. On machines without a GPU, run it under Xvfb with Mesa's
+// software rasterizer:
+//
+//     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./mbgl-render -s style.json -j jobs.txt -o out
+
+namespace {
+
+struct Job {
+    double longitude = 0;
+    double latitude = 0;
+    double zoom = 0;
+    double bearing = 0;
+    unsigned int width = 512;
+    unsigned int height = 512;
+    float ratio = 1;
+    std::string output;
+};
+
+bool parseJob(const std::string &line, size_t number, Job &job) {
+    std::istringstream stream(line);
+    if (!(stream >> job.longitude >> job.latitude >> job.zoom)) {
+        return false;
+    }
+
+    // All remaining fields are optional, but must be valid when present.
+    if (!(stream >> job.bearing) && !stream.eof()) return false;
+    if (!(stream >> job.width) && !stream.eof()) return false;
+    if (!(stream >> job.height) && !stream.eof()) return false;
+    if (!(stream >> job.ratio) && !stream.eof()) return false;
+    if (!(stream >> job.output)) {
+        char name[32];
+        snprintf(name, sizeof(name), "%06zu.png", number);
+        job.output = name;
+    }
+
+    return job.width > 0 && job.height > 0 && job.ratio > 0 &&
+           job.width * job.ratio <= UINT16_MAX && job.height * job.ratio <= UINT16_MAX;
+}
+
+double milliseconds(mbgl::timestamp duration) {
+    return double(duration) / 1e6;
+}
+
+void usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s -s STYLE [-j JOBS] [-o DIRECTORY] [-c CACHE] [-t TOKEN]\n"
+            "\n"
+            "  -s, --style     style JSON file or URL\n"
+            "  -j, --jobs      job list, one 'lon lat zoom [bearing [width [height [ratio [output]]]]]'\n"
+            "                  per line (default: stdin)\n"
+            "  -o, --output    directory for the rendered PNG files (default: .)\n"
+            "  -c, --cache     SQLite cache database shared between runs\n"
+            "  -t, --token     Mapbox access token (default: $MAPBOX_ACCESS_TOKEN)\n",
+            name);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    using namespace mbgl;
+
+    Log::Set<StderrLogBackend>();
+
+    std::string style_path;
+    std::string jobs_path = "-";
+    std::string output_dir = ".";
+    std::string cache_path;
+    std::string token = getenv("MAPBOX_ACCESS_TOKEN") ? getenv("MAPBOX_ACCESS_TOKEN") : "";
+
+    const struct option long_options[] = {
+        {"style", required_argument, 0, 's'},
+        {"jobs", required_argument, 0, 'j'},
+        {"output", required_argument, 0, 'o'},
+        {"cache", required_argument, 0, 'c'},
+        {"token", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while (true) {
+        int option_index = 0;
+        int c = getopt_long(argc, argv, "s:j:o:c:t:h", long_options, &option_index);
+        if (c == -1) break;
+        switch (c) {
+            case 's': style_path = optarg; break;
+            case 'j': jobs_path = optarg; break;
+            case 'o': output_dir = optarg; break;
+            case 'c': cache_path = optarg; break;
+            case 't': token = optarg; break;
+            default: usage(argv[0]); return c == 'h' ? 0 : 1;
+        }
+    }
+
+    if (style_path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream jobs_file;
+    if (jobs_path != "-") {
+        jobs_file.open(jobs_path);
+        if (!jobs_file) {
+            fprintf(stderr, "Cannot open job list %s\n", jobs_path.c_str());
+            return 1;
+        }
+    }
+    std::istream &jobs = jobs_path == "-" ? std::cin : jobs_file;
+
+    HeadlessView view;
+    Map map(view);
+
+    if (!token.empty()) {
+        map.setAccessToken(token);
+    }
+
+    if (!cache_path.empty()) {
+        map.getFileSource()->setCacheDatabase(cache_path);
+    }
+
+    if (style_path.find("://") == std::string::npos) {
+        // Local styles are loaded synchronously so that the first job already requests its tiles.
+        if (style_path[0] != '/') {
+            style_path = uv::cwd() + "/" + style_path;
+        }
+        std::string style;
+        try {
+            style = util::read_file(style_path);
+        } catch (const std::exception &ex) {
+            fprintf(stderr, "%s\n", ex.what());
+            return 1;
+        }
+        map.setStyleJSON(style, "file://" + style_path.substr(0, style_path.rfind('/') + 1));
+    } else {
+        // Remote styles arrive asynchronously; fetch them before the first job starts.
+        map.setStyleURL(style_path);
+        map.run();
+    }
+
+    uint16_t fb_width = 0, fb_height = 0;
+    std::unique_ptr<uint32_t[]> pixels;
+
+    size_t succeeded = 0, failed = 0, number = 0;
+    const timestamp batch_start = util::now();
+
+    std::string line;
+    while (std::getline(jobs, line)) {
+        number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') {
+            continue;
+        }
+
+        Job job;
+        if (!parseJob(line, number, job)) {
+            fprintf(stderr, "Line %zu: invalid job '%s'\n", number, line.c_str());
+            failed++;
+            continue;
+        }
+
+        const timestamp job_start = util::now();
+        const size_t uploaded_start = map.getBufferpool()->getStats().totalUploaded;
+
+        // Recreating the GL surface is expensive, so it is only done when the image size changes.
+        const uint16_t width = job.width * job.ratio;
+        const uint16_t height = job.height * job.ratio;
+        if (width != fb_width || height != fb_height) {
+            view.resize(width, height);
+            pixels.reset(new uint32_t[width * height]);
+            fb_width = width;
+            fb_height = height;
+        }
+
+        map.resize(job.width, job.height, job.ratio);
+        map.setLonLatZoom(job.longitude, job.latitude, job.zoom);
+        map.setBearing(job.bearing);
+
+        // Runs the loop until all resources of this view are loaded, then renders once.
+        map.run();
+
+        const timestamp render_end = util::now();
+
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.get());
+        const std::string image = util::compress_png(width, height, pixels.get(), true);
+        const std::string path = job.output[0] == '/' ? job.output : output_dir + "/" + job.output;
+
+        try {
+            util::write_file(path, image);
+        } catch (const std::exception &ex) {
+            fprintf(stderr, "Line %zu: %s\n", number, ex.what());
+            failed++;
+            continue;
+        }
+
+        const timestamp job_end = util::now();
+        succeeded++;
+
+        const size_t uploaded = map.getBufferpool()->getStats().totalUploaded - uploaded_start;
+        printf("%s\t%.2f ms\t(render %.2f ms, encode %.2f ms, %zu kB uploaded)\n", path.c_str(),
+               milliseconds(job_end - job_start), milliseconds(render_end - job_start),
+               milliseconds(job_end - render_end), uploaded / 1024);
+        fflush(stdout);
+    }
+
+    const double seconds = milliseconds(util::now() - batch_start) / 1e3;
+    fprintf(stderr, "%zu jobs in %.2f s: %.2f jobs/s (%zu failed)\n", succeeded, seconds,
+            seconds > 0 ? succeeded / seconds : 0.0, failed);
+
+    const Bufferpool::Stats stats = map.getBufferpool()->getStats();
+    fprintf(stderr, "buffer pool: %zu kB of %zu kB used in %zu buffers, %zu kB uploaded\n",
+            stats.used / 1024, stats.capacity / 1024, stats.buffers, stats.totalUploaded / 1024);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+{
+  'includes': [
+    '../common.gypi',
+    '../config.gypi',
+  ],
+  'targets': [
+    {
+      'target_name': 'mbgl-render',
+      'product_name': 'mbgl-render',
+      'type': 'executable',
+      'sources': [
+        './render.cpp',
+        '../common/headless_view.hpp',
+        '../common/headless_view.cpp',
+        '../common/curl_request.cpp',
+        '../common/stderr_log.hpp',
+        '../common/stderr_log.cpp',
+      ],
+
+      'conditions': [
+        ['OS == "mac"',
+
+        # Mac OS X
+        {
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS':[
+              '<@(curl_cflags)',
+            ],
+            'OTHER_LDFLAGS': [
+              '-framework OpenGL',
+              '<@(curl_libraries)',
+            ],
+          }
+        },
+
+        # Non-Mac OS X
+        {
+          'cflags': [
+            '<@(curl_cflags)',
+          ],
+          'link_settings': {
+            'libraries': [
+              '<@(glfw3_libraries)', # This is a hack since we're not actually using GLFW
+              '<@(curl_libraries)',
+              '-lboost_regex',
+              '-lpthread',
+              '-lz',
+            ],
+          },
+        }],
+      ],
+      'dependencies': [
+        '../mapboxgl.gyp:mapboxgl',
+        '../mapboxgl.gyp:copy_certificate_bundle',
+      ],
+    },
+  ],
+}
@@ -3,8 +3,14 @@
 #include <mbgl/platform/request.hpp>
 #include <mbgl/util/uv_detail.hpp>
 #include <mbgl/util/std.hpp>
+#include <mbgl/platform/log.hpp>
 
+#include <algorithm>
 #include <queue>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <strings.h>
 #include <boost/lockfree/queue.hpp>
 
 #include <curl/curl.h>
@@ -89,10 +95,21 @@ class CURLRequest : public mbgl::platform::Request {
 public:
     CURLRequest(const std::string &url,
                 std::function<void(mbgl::platform::Response *)> callback,
-                std::shared_ptr<uv::loop> loop)
-        : Request(url, callback, loop) {}
+                std::shared_ptr<uv::loop> loop,
+                const std::string &etag_,
+                int64_t modified_)
+        : Request(url, callback, loop), etag(etag_), modified(modified_) {}
+
+    ~CURLRequest() {
+        curl_slist_free_all(headers);
+    }
 
     CURL *curl = nullptr;
+
+    // Validators of a cached copy of the resource for conditional requests.
+    const std::string etag;
+    const int64_t modified;
+    curl_slist *headers = nullptr;
 };
 
 
@@ -133,24 +150,31 @@ void remove_curl_handle(CURL *handle) {
     curl_handle_cache.push(handle);
 }
 
-void curl_perform(uv_poll_t *req, int /*status*/, int events) {
-    int running_handles;
-    int flags = 0;
-    curl_context *context;
+// Requests that take longer than this are reported even if debug logging is disabled.
+const double slow_request_time = 1.0;
+
+// Reports how long the phases of a request took. All times are relative to the start of the
+// request; reused connections report zero for name lookup, connect and TLS handshake. Only slow
+// requests are logged as info, since the others would flood the log while panning.
+void log_timing(CURL *handle, const Request &req) {
+    double dns = 0, connect = 0, tls = 0, ttfb = 0, total = 0;
+    curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME, &dns);
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME, &connect);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME, &tls);
+    curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &ttfb);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &total);
+
+    Log::Record(total >= slow_request_time ? EventSeverity::Info : EventSeverity::Debug, Event::HttpRequest,
+                "%s: %d (dns %.1fms, connect %.1fms, tls %.1fms, ttfb %.1fms, transfer %.1fms, %lu bytes)",
+                req.url.c_str(), int(req.res->code), dns * 1e3, connect * 1e3, tls * 1e3, ttfb * 1e3,
+                (total - ttfb) * 1e3, (unsigned long)req.res->body.size());
+}
+
+// Completes all requests that CURL has finished.
+void check_multi_info() {
     CURLMsg *message;
     int pending;
 
-    uv_timer_stop(&timeout);
-
-    if (events & UV_READABLE)
-        flags |= CURL_CSELECT_IN;
-    if (events & UV_WRITABLE)
-        flags |= CURL_CSELECT_OUT;
-
-    context = (curl_context *)req;
-
-    curl_multi_socket_action(curl_multi, context->sockfd, flags, &running_handles);
-
     while ((message = curl_multi_info_read(curl_multi, &pending))) {
         switch (message->msg) {
         case CURLMSG_DONE: {
@@ -162,7 +186,10 @@ void curl_perform(uv_poll_t *req, int /*status*/, int events) {
                 (*req)->res->error_message = curl_easy_strerror(message->data.result);
                 (*req)->res->code = -1;
             } else {
-                curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &(*req)->res->code);
+                long code = 0;
+                curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+                (*req)->res->code = code;
+                log_timing(message->easy_handle, **req);
             }
 
             // We're currently in the CURL request thread. We're going to schedule a uv_work request
@@ -189,6 +216,24 @@ void curl_perform(uv_poll_t *req, int /*status*/, int events) {
     }
 }
 
+void curl_perform(uv_poll_t *req, int /*status*/, int events) {
+    int running_handles;
+    int flags = 0;
+    curl_context *context;
+
+    uv_timer_stop(&timeout);
+
+    if (events & UV_READABLE)
+        flags |= CURL_CSELECT_IN;
+    if (events & UV_WRITABLE)
+        flags |= CURL_CSELECT_OUT;
+
+    context = (curl_context *)req;
+
+    curl_multi_socket_action(curl_multi, context->sockfd, flags, &running_handles);
+    check_multi_info();
+}
+
 int handle_socket(CURL * /*easy*/, curl_socket_t s, int action, void * /*userp*/, void *socketp) {
     curl_context *context = nullptr;
 
@@ -223,14 +268,20 @@ void on_timeout(uv_timer_t * /*req*/) {
     if (error != CURLM_OK) {
         throw std::runtime_error(std::string("CURL multi error: ") + curl_multi_strerror(error));
     }
+
+    // Requests on a reused connection may complete without any socket activity.
+    check_multi_info();
 }
 
-void start_timeout(CURLM * /*multi*/, long timeout_ms, void * /*userp*/) {
-    if (timeout_ms <= 0) {
-        on_timeout(&timeout);
+int start_timeout(CURLM * /*multi*/, long timeout_ms, void * /*userp*/) {
+    if (timeout_ms < 0) {
+        uv_timer_stop(&timeout);
     } else {
+        // Newer versions of CURL don't allow calling into the multi handle from this callback, so
+        // we're always deferring to the next loop iteration, even for a zero timeout.
         uv_timer_start(&timeout, on_timeout, timeout_ms, 0);
     }
+    return 0;
 }
 
 // This function is the first function called in the request thread. It sets up the CURL share/multi
@@ -251,6 +302,15 @@ void thread_init(void * /*ptr*/) {
         throw std::runtime_error(std::string("CURL share error: ") + curl_share_strerror(share_error));
     }
 
+    // Share resolved host names and TLS sessions so that new connections to the same host skip
+    // the DNS lookup and can resume the TLS session.
+    for (curl_lock_data data : { CURL_LOCK_DATA_DNS, CURL_LOCK_DATA_SSL_SESSION }) {
+        share_error = curl_share_setopt(curl_share, CURLSHOPT_SHARE, data);
+        if (share_error != CURLSHE_OK) {
+            throw std::runtime_error(std::string("CURL share error: ") + curl_share_strerror(share_error));
+        }
+    }
+
     CURLMcode multi_error;
     curl_multi = curl_multi_init();
 
@@ -264,6 +324,16 @@ void thread_init(void * /*ptr*/) {
 
     }
 
+#if LIBCURL_VERSION_NUM >= 0x072B00 // 7.43.0
+    // Multiplex requests to the same host over a single HTTP/2 connection. Servers that only speak
+    // HTTP/1.1 get a few persistent connections instead; the RequestScheduler limits the number of
+    // concurrent requests per host anyway.
+    multi_error = curl_multi_setopt(curl_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    if (multi_error != CURLM_OK) {
+        throw std::runtime_error(std::string("CURL multi error: ") + curl_multi_strerror(multi_error));
+    }
+#endif
+
     // Main event loop. This will not return until the request loop is terminated.
     uv_run(loop, UV_RUN_DEFAULT);
 
@@ -286,6 +356,69 @@ size_t curl_write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
     return size * nmemb;
 }
 
+// Checks whether a header line has the given (case-insensitive) name and extracts its value.
+bool curl_header_matches(const std::string &line, const char *name, std::string &value) {
+    const size_t length = std::strlen(name);
+    if (line.size() <= length || line[length] != ':' || strncasecmp(line.c_str(), name, length) != 0) {
+        return false;
+    }
+
+    const size_t begin = line.find_first_not_of(" \t", length + 1);
+    const size_t end = line.find_last_not_of(" \t\r\n");
+    value = begin == std::string::npos || end < begin ? "" : line.substr(begin, end - begin + 1);
+    return true;
+}
+
+// Checks whether a Cache-Control header value contains the given (case-insensitive) directive.
+bool curl_has_directive(const std::string &value, const char *directive) {
+    const size_t length = std::strlen(directive);
+    size_t begin = 0;
+    while ((begin = value.find_first_not_of(" \t,", begin)) != std::string::npos) {
+        const size_t end = std::min(value.find(',', begin), value.size());
+        if (strncasecmp(value.c_str() + begin, directive, length) == 0 &&
+            (begin + length == end || std::strchr(" \t=", value[begin + length]))) {
+            return true;
+        }
+        begin = end;
+    }
+    return false;
+}
+
+// This function is called for every header line of the response. We extract the values that the
+// FileSource needs for caching the response.
+size_t curl_header_cb(char *buffer, size_t size, size_t nmemb, void *userp) {
+    Response *res = (Response *)userp;
+    const std::string line(buffer, size * nmemb);
+    std::string value;
+
+    if (curl_header_matches(line, "Cache-Control", value)) {
+        res->noStore = res->noStore || curl_has_directive(value, "no-store");
+        if (curl_has_directive(value, "no-cache")) {
+            // The response is stored as expired, so that it is revalidated before it's used again.
+            res->noCache = true;
+            res->expires = 0;
+        }
+
+        const size_t pos = value.find("max-age=");
+        if (pos != std::string::npos && !res->noCache) {
+            // max-age takes precedence over the Expires header.
+            res->expires = std::time(nullptr) + std::atol(value.c_str() + pos + 8);
+        }
+    } else if (curl_header_matches(line, "Expires", value)) {
+        if (!res->expires && !res->noCache) {
+            const time_t time = curl_getdate(value.c_str(), nullptr);
+            res->expires = time > 0 ? time : 0;
+        }
+    } else if (curl_header_matches(line, "Last-Modified", value)) {
+        const time_t time = curl_getdate(value.c_str(), nullptr);
+        res->modified = time > 0 ? time : 0;
+    } else if (curl_header_matches(line, "ETag", value)) {
+        res->etag = value;
+    }
+
+    return size * nmemb;
+}
+
 // This callback is called in the request event loop (on the request thread).
 // It initializes newly queued up download requests and adds them to the CURL
 // multi handle.
@@ -315,8 +448,37 @@ void async_add_cb(uv_async_t * /*async*/) {
         curl_easy_setopt(handle, CURLOPT_URL, (*req)->url.c_str());
         curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
         curl_easy_setopt(handle, CURLOPT_WRITEDATA, &(*req)->res->body);
-        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "deflate");
+        curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, curl_header_cb);
+        curl_easy_setopt(handle, CURLOPT_HEADERDATA, (*req)->res.get());
+        // An empty string accepts all encodings that CURL can decode, so compressed responses are
+        // decompressed on the request thread.
+        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
         curl_easy_setopt(handle, CURLOPT_SHARE, curl_share);
+
+        // Keep idle connections alive so that the next tile requests don't have to reconnect.
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1l);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 60l);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 30l);
+
+#if LIBCURL_VERSION_NUM >= 0x072F00 // 7.47.0
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072B00 // 7.43.0
+        // Wait for an existing connection that supports multiplexing instead of opening a new one.
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1l);
+#endif
+
+        // Revalidate cached resources. The server answers with 304 Not Modified and an empty body
+        // if our copy is still current.
+        CURLRequest *request = (CURLRequest *)req->get();
+        if (!request->etag.empty()) {
+            request->headers = curl_slist_append(request->headers, ("If-None-Match: " + request->etag).c_str());
+            curl_easy_setopt(handle, CURLOPT_HTTPHEADER, request->headers);
+        }
+        if (request->modified) {
+            curl_easy_setopt(handle, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE);
+            curl_easy_setopt(handle, CURLOPT_TIMEVALUE, long(request->modified));
+        }
         curl_multi_add_handle(curl_multi, handle);
     }
 }
@@ -354,10 +516,12 @@ void thread_init_cb() {
 std::shared_ptr<platform::Request>
 platform::request_http(const std::string &url,
                        std::function<void(Response *)> callback,
-                       std::shared_ptr<uv::loop> loop) {
+                       std::shared_ptr<uv::loop> loop,
+                       const std::string &etag,
+                       int64_t modified) {
     using namespace request;
     init_thread_once(thread_init_cb);
-    std::shared_ptr<CURLRequest> req = std::make_shared<CURLRequest>(url, callback, loop);
+    std::shared_ptr<CURLRequest> req = std::make_shared<CURLRequest>(url, callback, loop, etag, modified);
 
     // Note that we are creating a new shared_ptr pointer(!) because the lockless queue can't store
     // objects with nontrivial destructors. We have to make absolutely sure that we manually delete
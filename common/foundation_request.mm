@@ -55,7 +55,9 @@ public:
 std::shared_ptr<mbgl::platform::Request>
 mbgl::platform::request_http(const std::string &url,
                              std::function<void(Response *)> callback,
-                             std::shared_ptr<uv::loop> loop) {
+                             std::shared_ptr<uv::loop> loop,
+                             const std::string &etag,
+                             int64_t modified) {
     dispatch_once(&request_initialize, ^{
         NSURLSessionConfiguration *sessionConfig =
             [NSURLSessionConfiguration defaultSessionConfiguration];
@@ -78,8 +80,21 @@ mbgl::platform::request_http(const std::string &url,
     // callback that this pointer gets destroyed again.
     std::shared_ptr<Request> *req_ptr = new std::shared_ptr<Request>(req);
 
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@(url.c_str())]];
+    if (!etag.empty()) {
+        [request setValue:@(etag.c_str()) forHTTPHeaderField:@"If-None-Match"];
+    }
+    if (modified) {
+        NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss 'GMT'";
+        [request setValue:[formatter stringFromDate:[NSDate dateWithTimeIntervalSince1970:modified]]
+            forHTTPHeaderField:@"If-Modified-Since"];
+    }
+
     NSURLSessionDataTask *task = [session
-                                  dataTaskWithURL:[NSURL URLWithString:@(url.c_str())]
+                                  dataTaskWithRequest:request
                                   completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
         if ([error code] == NSURLErrorCancelled) {
             // We intentionally cancelled this request. Make sure we clear the shared_ptr to resolve
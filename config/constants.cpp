@@ -1,6 +1,9 @@
 #include <mbgl/util/constants.hpp>
 
 const float mbgl::util::tileSize = 512.0f;
+const size_t mbgl::util::defaultTileCacheSize = 16 * 1024 * 1024;
+const size_t mbgl::util::minimumShapingCacheSize = 1024 * 1024;
+const size_t mbgl::util::defaultUploadBudget = 2 * 1024 * 1024;
 
 #if defined(DEBUG)
 const bool mbgl::debug::tileParseWarnings = false;
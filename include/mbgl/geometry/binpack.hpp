@@ -3,96 +3,215 @@
 
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/rect.hpp>
+
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <list>
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace mbgl {
 
+// Packs rectangles into an area that can grow. The area is divided into shelves: rows that are
+// filled from left to right and form a skyline of horizontal levels. Released rects become free
+// bins that are reused by rects of the same or a smaller size. Shelves that become empty are merged
+// with their empty neighbors, so that their space can be reused for rects of any height.
+//
+// Allocated rects never move, since their position is baked into vertex buffers.
 template <typename T>
 class BinPack : private util::noncopyable {
 public:
-    BinPack(T width, T height)
-        : free(1, Rect<uint16_t>{ 0, 0, width, height }) {}
+    BinPack(T width, T height) : width(width), height(height) {}
+
 public:
-    Rect<T> allocate(T width, T height) {
-        // Find the smallest free rect angle
-        auto smallest = free.end();
-        for (auto it = free.begin(); it != free.end(); ++it) {
-            const Rect<T>& ref = *it;
-            const Rect<T>& rect = *smallest;
-            if (width <= ref.w && height <= ref.h) {
-                if (smallest == free.end() || (ref.y <= rect.y && ref.x <= rect.x)) {
-                    smallest = it;
-                }
-            }
+    // Returns an empty rect if there's no space left.
+    Rect<T> allocate(T w, T h) {
+        if (w == 0 || h == 0 || w > width) {
+            return Rect<T>{ 0, 0, 0, 0 };
         }
 
-        if (smallest == free.end()) {
-            // There's no space left for this char.
-            return Rect<uint16_t>{ 0, 0, 0, 0 };
-        } else {
-            Rect<T> rect = *smallest;
-            free.erase(smallest);
-
-            // Shorter/Longer Axis Split Rule (SAS)
-            // http://clb.demon.fi/files/RectangleBinPack.pdf p. 15
-            // Ignore the dimension of R and just split long the shorter dimension
-            // See Also: http://www.cs.princeton.edu/~chazelle/pubs/blbinpacking.pdf
-            if (rect.w < rect.h) {
-                // split horizontally
-                // +--+---+
-                // |__|___|  <-- b1
-                // +------+  <-- b2
-                if (rect.w > width) free.emplace_back(rect.x + width, rect.y, rect.w - width, height);
-                if (rect.h > height) free.emplace_back(rect.x, rect.y + height, rect.w, rect.h - height);
-            } else {
-                // split vertically
-                // +--+---+
-                // |__|   | <-- b1
-                // +--|---+ <-- b2
-                if (rect.w > width) free.emplace_back(rect.x + width, rect.y, rect.w - width, rect.h);
-                if (rect.h > height) free.emplace_back(rect.x, rect.y + height, width, rect.h - height);
-            }
+        Rect<T> rect = allocateBin(w, h);
+        if (!rect) {
+            rect = allocateShelf(w, h);
+        }
+        if (rect) {
+            usedArea += area(rect);
+        }
+        return rect;
+    }
 
-            return Rect<uint16_t>{ rect.x, rect.y, width, height };
+    void release(Rect<T> rect) {
+        auto bin = bins.find(Position { rect.y, rect.x });
+        if (bin == bins.end() || bin->second.free) {
+            return;
+        }
+
+        usedArea -= area(rect);
+        bin->second.free = true;
+        bin->second.index = freeBins.emplace(Size { bin->second.h, bin->second.w }, bin->first);
+        freeArea += size_t(bin->second.w) * bin->second.h;
+
+        auto shelf = findShelf(rect.y);
+        if (--shelf->live == 0) {
+            clearShelf(shelf);
         }
     }
 
+    // Enlarges the area. Existing rects keep their position.
+    void resize(T newWidth, T newHeight) {
+        width = std::max(width, newWidth);
+        height = std::max(height, newHeight);
+    }
 
-    void release(Rect<T> rect) {
-        // Simple algorithm to recursively merge the newly released cell with its
-        // neighbor. This doesn't merge more than two cells at a time, and fails
-        // for complicated merges.
-        for (auto it = free.begin(); it != free.end(); ++it) {
-            Rect<T> ref = *it;
-            if (ref.y == rect.y && ref.h == rect.h && ref.x + ref.w == rect.x) {
-                ref.w += rect.w;
-            }
-            else if (ref.x == rect.x && ref.w == rect.w && ref.y + ref.h == rect.y) {
-                ref.h += rect.h;
-            }
-            else if (rect.y == ref.y && rect.h == ref.h && rect.x + rect.w == ref.x) {
-                ref.x = rect.x;
-                ref.w += rect.w;
-            }
-            else if (rect.x == ref.x && rect.w == ref.w && rect.y + rect.h == ref.y) {
-                ref.y = rect.y;
-                ref.h += rect.h;
-            } else {
+    inline T getWidth() const { return width; }
+    inline T getHeight() const { return height; }
+
+    // Area of the allocated rects.
+    inline size_t used() const { return usedArea; }
+
+    // Share of the total area that is allocated.
+    float occupancy() const {
+        return float(usedArea) / (size_t(width) * height);
+    }
+
+    // Share of the unallocated area that is only available as free bins in shelves that are still
+    // in use, rather than in empty shelves or below the last shelf.
+    float fragmentation() const {
+        const size_t unused = size_t(width) * height - usedArea;
+        return unused ? float(freeArea) / unused : 0;
+    }
+
+private:
+    struct Shelf {
+        T y, h;
+
+        // Start of the unused space at the end of the shelf.
+        T x;
+
+        // Number of allocated rects in the shelf.
+        size_t live;
+    };
+
+    // Positions are (y, x) so that the bins of a shelf are adjacent. Sizes are (h, w).
+    typedef std::pair<T, T> Position;
+    typedef std::pair<T, T> Size;
+    typedef std::multimap<Size, Position> FreeBins;
+
+    struct Bin {
+        T w, h;
+        bool free;
+        typename FreeBins::iterator index;
+    };
+
+    typedef typename std::vector<Shelf>::iterator ShelfIterator;
+
+    // Limits the number of free bins that are examined for one allocation.
+    static const size_t MaxFreeScan = 128;
+
+    static size_t area(const Rect<T> &rect) {
+        return size_t(rect.w) * rect.h;
+    }
+
+    Rect<T> allocateBin(T w, T h) {
+        // Free bins are sorted by height, then width, so the first candidates are the ones with
+        // the smallest height that fits. Bins that are much taller are left for taller rects.
+        size_t scanned = 0;
+        for (auto it = freeBins.lower_bound(Size { h, w });
+             it != freeBins.end() && it->first.first <= h + h / 4 && scanned < MaxFreeScan;
+             ++it, ++scanned) {
+            if (it->first.second < w) {
                 continue;
             }
 
-            free.erase(it);
-            release(ref);
-            return;
+            const Position position = it->second;
+            Bin &bin = bins[position];
+            bin.free = false;
+            freeArea -= size_t(bin.w) * bin.h;
+            freeBins.erase(it);
+            findShelf(position.first)->live++;
+            return Rect<T>{ position.second, position.first, w, h };
+        }
+        return Rect<T>{ 0, 0, 0, 0 };
+    }
 
+    Rect<T> allocateShelf(T w, T h) {
+        // Use the shelf with the least wasted height, unless a new shelf fits better.
+        ShelfIterator best = shelves.end();
+        for (ShelfIterator it = shelves.begin(); it != shelves.end(); ++it) {
+            if (it->h >= h && size_t(it->x) + w <= width && (best == shelves.end() || it->h < best->h)) {
+                best = it;
+            }
         }
 
-        free.emplace_back(rect);
-    };
+        const size_t bottom = shelves.empty() ? 0 : size_t(shelves.back().y) + shelves.back().h;
+        if ((best == shelves.end() || best->h > h + h / 4) && bottom + h <= height) {
+            shelves.push_back(Shelf { T(bottom), h, 0, 0 });
+            best = shelves.end() - 1;
+        }
+
+        if (best == shelves.end()) {
+            return Rect<T>{ 0, 0, 0, 0 };
+        }
+
+        if (best->live == 0 && best->h > h) {
+            // Split empty shelves, so that the rest stays available for other heights.
+            const Shelf rest { T(best->y + h), T(best->h - h), 0, 0 };
+            best->h = h;
+            best = shelves.insert(best + 1, rest) - 1;
+        }
+
+        const Rect<T> rect { best->x, best->y, w, h };
+        bins.emplace(Position { rect.y, rect.x }, Bin { w, best->h, false, freeBins.end() });
+        best->x += w;
+        best->live++;
+        return rect;
+    }
+
+    ShelfIterator findShelf(T y) {
+        return std::lower_bound(shelves.begin(), shelves.end(), y, [](const Shelf &shelf, T value) {
+            return shelf.y < value;
+        });
+    }
+
+    // Discards the bins of an empty shelf and merges it with its empty neighbors.
+    void clearShelf(ShelfIterator shelf) {
+        auto begin = bins.lower_bound(Position { shelf->y, 0 });
+        auto end = begin;
+        for (; end != bins.end() && end->first.first == shelf->y; ++end) {
+            freeArea -= size_t(end->second.w) * end->second.h;
+            freeBins.erase(end->second.index);
+        }
+        bins.erase(begin, end);
+        shelf->x = 0;
+
+        if (shelf + 1 != shelves.end() && (shelf + 1)->live == 0) {
+            shelf->h += (shelf + 1)->h;
+            shelf = shelves.erase(shelf + 1) - 1;
+        }
+        if (shelf != shelves.begin() && (shelf - 1)->live == 0) {
+            (shelf - 1)->h += shelf->h;
+            shelf = shelves.erase(shelf) - 1;
+        }
+        if (shelf + 1 == shelves.end()) {
+            // The space below the last shelf is available anyway.
+            shelves.pop_back();
+        }
+    }
 
 private:
-    std::list<Rect<T>> free;
+    T width;
+    T height;
+
+    // Shelves sorted by y, without gaps between them.
+    std::vector<Shelf> shelves;
+
+    // Allocated and free bins by position, and free bins by size.
+    std::map<Position, Bin> bins;
+    FreeBins freeBins;
+
+    size_t usedArea = 0;
+    size_t freeArea = 0;
 };
 
 }
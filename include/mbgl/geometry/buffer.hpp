@@ -1,11 +1,15 @@
 #ifndef MBGL_GEOMETRY_BUFFER
 #define MBGL_GEOMETRY_BUFFER
 
+#include <mbgl/geometry/bufferpool.hpp>
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/util/noncopyable.hpp>
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <cassert>
+#include <memory>
 #include <stdexcept>
 
 namespace mbgl {
@@ -20,10 +24,7 @@ class Buffer : private util::noncopyable {
 public:
     ~Buffer() {
         cleanup();
-        if (buffer != 0) {
-            glDeleteBuffers(1, &buffer);
-            buffer = 0;
-        }
+        releaseBuffer();
     }
 
     // Returns the number of elements in this buffer. This is not the number of
@@ -38,23 +39,98 @@ public:
 
     // Transfers this buffer to the GPU and binds the buffer to the GL context.
     void bind(bool force = false) {
-        if (buffer == 0) {
-            glGenBuffers(1, &buffer);
-            force = true;
+        const bool created = buffer == 0;
+        if ((created || force) && array == nullptr) {
+            throw std::runtime_error("Buffer was already deleted or doesn't contain elements");
         }
-        glBindBuffer(bufferType, buffer);
-        if (force) {
-            if (array == nullptr) {
-                throw std::runtime_error("Buffer was already deleted or doesn't contain elements");
+
+        if (created) {
+            if (pool) {
+                allocation = pool->allocate(bufferType, pos);
+                buffer = allocation.buffer;
+            } else {
+                glGenBuffers(1, &buffer);
             }
+        }
+        glBindBuffer(bufferType, buffer);
 
-            glBufferData(bufferType, pos, array, GL_STATIC_DRAW);
-            if (!retainAfterUpload) {
+        if (created || force) {
+            if (pool) {
+                pool->upload(bufferType, allocation, array, pos);
+            } else if (created) {
+                glBufferData(bufferType, pos, array, GL_STATIC_DRAW);
+            } else {
+                // Orphans the previous storage, so that the driver doesn't have to wait for draw
+                // calls that still read from it.
+                glBufferData(bufferType, pos, nullptr, GL_STREAM_DRAW);
+                glBufferSubData(bufferType, 0, pos, array);
+            }
+            if (!retain) {
                 cleanup();
             }
         }
     }
 
+    // Sub-allocates the GL buffer from a pool instead of creating a buffer object for it. This
+    // must be set before the buffer is bound the first time.
+    inline void setPool(const std::shared_ptr<Bufferpool> &pool_) {
+        assert(buffer == 0);
+        pool = pool_;
+    }
+
+    // Returns the byte offset of this buffer's data in the GL buffer. This is only valid after
+    // the buffer was bound.
+    inline size_t getOffset() const {
+        return allocation.offset;
+    }
+
+    // Keeps the CPU copy of the buffer after it was transferred to the GPU. This is required for
+    // buffers that should survive releaseGPU().
+    inline void setRetainAfterUpload(bool value) {
+        retain = value;
+    }
+
+    // Deletes the GL buffer if we still have a CPU copy of it. The next bind() transfers the data
+    // to the GPU again.
+    void releaseGPU() {
+        if (buffer != 0 && array != nullptr) {
+            releaseBuffer();
+        }
+    }
+
+    // Returns the number of bytes of the data stored in this buffer.
+    inline size_t bytes() const {
+        return pos;
+    }
+
+    // Makes room for a total of at least count elements, so that adding them doesn't reallocate
+    // the CPU buffer. Like adding elements, this grows the buffer geometrically, so it can be
+    // called for every feature.
+    void reserve(size_t count) {
+        if (buffer != 0) {
+            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
+        }
+        if (length < count * itemSize) {
+            grow(count * itemSize);
+        }
+    }
+
+    // Appends the elements of another buffer and returns the index of the first appended element.
+    size_t append(const Buffer &other) {
+        if (buffer != 0) {
+            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
+        }
+        const size_t start = index();
+        if (other.pos) {
+            if (length < pos + other.pos) {
+                grow(pos + other.pos);
+            }
+            memcpy(static_cast<char *>(array) + pos, other.array, other.pos);
+            pos += other.pos;
+        }
+        return start;
+    }
+
     void cleanup() {
         if (array) {
             free(array);
@@ -73,11 +149,7 @@ protected:
             throw std::runtime_error("Can't add elements after buffer was bound to GPU");
         }
         if (length < pos + itemSize) {
-            while (length < pos + itemSize) length += defaultLength;
-            array = realloc(array, length);
-            if (array == nullptr) {
-                throw std::runtime_error("Buffer reallocation failed");
-            }
+            grow(pos + itemSize);
         }
         pos += itemSize;
         return static_cast<char *>(array) + (pos - itemSize);
@@ -100,6 +172,34 @@ public:
     static const size_t itemSize = item_size;
 
 private:
+    // Grows the CPU buffer geometrically, so that adding n elements one by one takes amortized
+    // linear time. Growing by half instead of doubling leaves less of the buffer unused.
+    void grow(size_t required) {
+        resize(std::max(required, std::max(length + length / 2, defaultLength)));
+    }
+
+    void resize(size_t bytes) {
+        void *resized = realloc(array, bytes);
+        if (resized == nullptr) {
+            throw std::runtime_error("Buffer reallocation failed");
+        }
+        array = resized;
+        length = bytes;
+    }
+
+    void releaseBuffer() {
+        if (buffer == 0) {
+            return;
+        }
+        if (pool) {
+            pool->release(allocation);
+            allocation = Bufferpool::Allocation();
+        } else {
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+    }
+
     // CPU buffer
     void *array = nullptr;
 
@@ -111,6 +211,13 @@ private:
 
     // GL buffer ID
     GLuint buffer = 0;
+
+    // The range of the GL buffer that holds this buffer's data if it comes from a pool.
+    std::shared_ptr<Bufferpool> pool;
+    Bufferpool::Allocation allocation;
+
+    // Whether to keep the CPU buffer after uploading it.
+    bool retain = retainAfterUpload;
 };
 
 }
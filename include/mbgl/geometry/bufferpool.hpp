@@ -0,0 +1,78 @@
+#ifndef MBGL_GEOMETRY_BUFFERPOOL
+#define MBGL_GEOMETRY_BUFFERPOOL
+
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/platform/gl.hpp>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace mbgl {
+
+// Sub-allocates tile geometry from a few large GL buffers, so that buffer objects are recycled
+// instead of being created and deleted as tiles come and go.
+class Bufferpool : private util::noncopyable {
+public:
+    struct Allocation {
+        GLuint buffer = 0;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    struct Stats {
+        // GL buffers owned by the pool and their total size in bytes.
+        size_t buffers = 0;
+        size_t capacity = 0;
+
+        // Bytes that are allocated to tiles.
+        size_t used = 0;
+
+        // Bytes uploaded since the current frame started, and in total.
+        size_t uploaded = 0;
+        size_t totalUploaded = 0;
+    };
+
+    explicit Bufferpool(size_t pageSize = 1024 * 1024);
+    ~Bufferpool();
+
+    // Reserves length bytes in a buffer that can be bound to target. Allocations that are larger
+    // than the page size get a buffer of their own. Must be called on the GL thread.
+    Allocation allocate(GLenum target, size_t length);
+
+    // Returns the memory of an allocation to the pool. This doesn't call GL, so buffers can be
+    // destroyed on any thread.
+    void release(const Allocation &allocation);
+
+    // Copies data into an allocation. Its buffer must be bound to target.
+    void upload(GLenum target, const Allocation &allocation, const void *data, size_t length);
+
+    // Resets the per-frame upload counter and deletes empty buffers in excess of what the pool
+    // keeps around for new tiles. Must be called on the GL thread.
+    void beginFrame();
+
+    Stats getStats() const;
+
+private:
+    struct Page {
+        GLenum target;
+        GLuint buffer;
+        size_t capacity;
+        size_t used;
+
+        // Free ranges by offset, which are coalesced with their neighbors when memory is released.
+        std::map<size_t, size_t> free;
+    };
+
+    const size_t pageSize;
+
+    mutable std::mutex mtx;
+    std::vector<Page> pages;
+    size_t uploaded = 0;
+    size_t totalUploaded = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef MBGL_GEOMETRY_EARCUT
+#define MBGL_GEOMETRY_EARCUT
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <clipper/clipper.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+
+// Triangulates polygons with holes by ear clipping. Holes are first joined to the outer ring with
+// bridge edges, so the polygon becomes a single ring. This is much faster than a sweep-line
+// tessellator, but it only produces correct results for rings that don't intersect each other,
+// which is what isSimple() checks.
+class Earcut : private util::noncopyable {
+public:
+    typedef std::vector<ClipperLib::IntPoint> Ring;
+
+    // Returns whether the first count rings can be triangulated without clipping them first.
+    // Outer rings must have a positive and holes a negative area, like ClipperLib::pftPositive
+    // expects, and every hole must follow its outer ring. No two edges may cross or touch, holes
+    // must lie inside their outer ring, and outer rings may only lie inside another outer ring if
+    // they are islands in one of its holes.
+    bool isSimple(const std::vector<Ring> &rings, size_t count);
+
+    // Triangulates the outer ring rings[begin] with the holes up to rings[end - 1]. Vertices are
+    // numbered in ring order, starting with 0 for the first vertex of the outer ring. Appends
+    // three indices per triangle. Returns false if parts of the polygon couldn't be triangulated.
+    bool triangulate(const std::vector<Ring> &rings, size_t begin, size_t end, std::vector<uint32_t> &indices);
+
+private:
+    struct Node {
+        Node(uint32_t i_, double x_, double y_) : i(i_), x(x_), y(y_) {}
+
+        // Index of the vertex in the input rings.
+        const uint32_t i;
+        const double x;
+        const double y;
+
+        // Neighbours in the polygon ring.
+        Node *prev = nullptr;
+        Node *next = nullptr;
+
+        // Z-order curve value and neighbours in z-order.
+        int32_t z = 0;
+        Node *prevZ = nullptr;
+        Node *nextZ = nullptr;
+    };
+
+    struct Segment {
+        const ClipperLib::IntPoint *a;
+        const ClipperLib::IntPoint *b;
+        ClipperLib::cInt minX, maxX;
+        uint32_t ring;
+        uint32_t index;
+    };
+
+    struct Bounds {
+        ClipperLib::cInt minX, minY, maxX, maxY;
+    };
+
+    Node *createNode(uint32_t i, double x, double y, Node *last);
+    Node *linkedList(const Ring &ring, uint32_t offset, bool clockwise);
+    Node *filterPoints(Node *start, Node *end = nullptr);
+    void earcutLinked(Node *ear, int pass = 0);
+    bool isEar(Node *ear);
+    bool isEarHashed(Node *ear);
+    Node *cureLocalIntersections(Node *start);
+    void splitEarcut(Node *start);
+    Node *eliminateHoles(const std::vector<Ring> &rings, size_t begin, size_t end, Node *outerNode, uint32_t offset);
+    Node *eliminateHole(Node *hole, Node *outerNode);
+    Node *findHoleBridge(Node *hole, Node *outerNode);
+    void indexCurve(Node *start);
+    Node *sortLinked(Node *list);
+    int32_t zOrder(double x, double y) const;
+    Node *splitPolygon(Node *a, Node *b);
+    void addTriangle(const Node *a, const Node *b, const Node *c);
+
+    static void removeNode(Node *p);
+    static Node *getLeftmost(Node *start);
+    static bool isValidDiagonal(Node *a, Node *b);
+    static bool intersectsPolygon(Node *a, Node *b);
+    static bool locallyInside(const Node *a, const Node *b);
+    static bool middleInside(Node *a, Node *b);
+    static bool sectorContainsSector(const Node *m, const Node *p);
+
+    // Nodes of the current polygon. The capacity is reserved up front, so the nodes never move.
+    std::vector<Node> nodes;
+    std::vector<Node *> queue;
+    std::vector<uint32_t> *output = nullptr;
+    bool failed = false;
+
+    // Parameters of the z-order curve, which speeds up ear checks for large polygons.
+    bool hashed = false;
+    double minX = 0, minY = 0, invSize = 0;
+
+    // Scratch space for isSimple().
+    std::vector<Segment> segments;
+    std::vector<Bounds> bounds;
+    std::vector<bool> outer;
+};
+
+}
+
+#endif
@@ -19,6 +19,12 @@ struct ElementGroup {
         : vertex_length(vertex_length),
           elements_length(elements_length) {
     }
+
+    void releaseGPU() {
+        for (VertexArrayObject &vao : array) {
+            vao.releaseGPU();
+        }
+    }
 };
 
 class TriangleElementsBuffer : public Buffer<
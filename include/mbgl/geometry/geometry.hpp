@@ -4,7 +4,9 @@
 #include <mbgl/util/pbf.hpp>
 #include <mbgl/util/noncopyable.hpp>
 
+#include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 namespace mbgl {
 
@@ -20,14 +22,22 @@ public:
         close = 7
     };
 
-    inline command next(int32_t &rx, int32_t &ry);
+    // Decodes the next line or ring into the buffer, replacing its contents. Closed rings end
+    // with their first vertex. Returns false when the geometry has no more lines. Callers should
+    // reuse the buffer across calls to avoid allocations.
+    template <typename Point>
+    inline bool nextRing(std::vector<Point> &ring);
 
 private:
+    // Number of coordinate pairs that are decoded at once.
+    static const uint32_t batch = 64;
+
     pbf& data;
     uint8_t cmd;
     uint32_t length;
     int32_t x, y;
     int32_t ox, oy;
+    int32_t deltas[batch * 2];
 };
 
 Geometry::Geometry(pbf& data)
@@ -37,39 +47,62 @@ Geometry::Geometry(pbf& data)
       x(0), y(0),
       ox(0), oy(0) {}
 
-Geometry::command Geometry::next(int32_t &rx, int32_t &ry) {
-    if (data.data < data.end) {
+template <typename Point>
+bool Geometry::nextRing(std::vector<Point> &ring) {
+    ring.clear();
+
+    while (data.data < data.end || length) {
         if (length == 0) {
             uint32_t cmd_length = static_cast<uint32_t>(data.varint());
             cmd = cmd_length & 0x7;
             length = cmd_length >> 3;
+            if (cmd == move_to || cmd == line_to) {
+                // Every point takes at least two bytes, so a count that exceeds the remaining data
+                // comes from a malformed tile and mustn't be trusted for allocations.
+                const uint32_t remaining = static_cast<uint32_t>((data.end - data.data) / 2);
+                if (length > remaining) {
+                    length = remaining;
+                }
+            }
+            continue;
         }
 
-        --length;
-
-        if (cmd == move_to || cmd == line_to) {
-            rx = (x += data.svarint());
-            ry = (y += data.svarint());
-
-            if (cmd == move_to) {
-                ox = x;
-                oy = y;
-                return move_to;
-            } else {
-                return line_to;
+        if (cmd == move_to) {
+            // A move_to starts a new line; the remaining points of the command are decoded by
+            // the next call.
+            if (!ring.empty()) {
+                return true;
+            }
+            data.svarints(deltas, 2);
+            ox = (x += deltas[0]);
+            oy = (y += deltas[1]);
+            ring.emplace_back(x, y);
+            --length;
+        } else if (cmd == line_to) {
+            ring.reserve(ring.size() + length);
+            while (length) {
+                const uint32_t count = length < batch ? length : batch;
+                data.svarints(deltas, count * 2);
+                for (uint32_t i = 0; i < count; i++) {
+                    x += deltas[i * 2];
+                    y += deltas[i * 2 + 1];
+                    ring.emplace_back(x, y);
+                }
+                length -= count;
             }
         } else if (cmd == close) {
-            rx = ox;
-            ry = oy;
-            return close;
+            // Like other commands, a close stops at the end of the data after its first point.
+            ring.emplace_back(ox, oy);
+            length = data.data < data.end ? length - 1 : 0;
         } else {
             fprintf(stderr, "unknown command: %d\n", cmd);
             // TODO: gracefully handle geometry parse failures
-            return end;
+            data.data = data.end;
+            length = 0;
         }
-    } else {
-        return end;
     }
+
+    return !ring.empty();
 }
 
 }
@@ -5,8 +5,9 @@
 #include <mbgl/text/glyph_store.hpp>
 
 #include <string>
-#include <set>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <mutex>
 #include <atomic>
 
@@ -17,13 +18,39 @@ public:
 
 private:
     struct GlyphValue {
-        GlyphValue(const Rect<uint16_t>& rect, uint64_t id)
-            : rect(rect), ids({ id }) {}
+        GlyphValue(const Rect<uint16_t>& rect, uint64_t tile_id)
+            : rect(rect), lastTile(tile_id) {}
         Rect<uint16_t> rect;
-        std::set<uint64_t> ids;
+
+        // Number of references from the tile table below.
+        uint32_t refs = 1;
+
+        // The tile that referenced this glyph most recently. Tiles add the same glyph many times
+        // in a row, so this avoids most duplicate references.
+        uint64_t lastTile;
+    };
+
+    typedef std::map<uint32_t, GlyphValue> Face;
+
+    struct GlyphRef {
+        Face *face;
+        Face::iterator it;
+    };
+
+public:
+    struct Stats {
+        uint16_t width;
+        uint16_t height;
+
+        // Share of the atlas that holds glyphs, and share of the free space that is scattered
+        // between them.
+        float occupancy;
+        float fragmentation;
     };
 
 public:
+    // Creates an atlas of the given size, which doubles when it runs out of space until it
+    // reaches the largest size that glyph texture coordinates can address.
     GlyphAtlas(uint16_t width, uint16_t height);
     ~GlyphAtlas();
 
@@ -32,18 +59,41 @@ public:
                             const SDFGlyph& glyph);
     void removeGlyphs(uint64_t tile_id);
     void bind();
-    void upload();
 
-public:
-    const uint16_t width = 0;
-    const uint16_t height = 0;
+    // Uploads the parts of the atlas that changed and returns the number of bytes that were
+    // uploaded.
+    size_t upload();
+
+    // Dimensions of the uploaded texture. Only valid on the render thread.
+    inline uint16_t getTextureWidth() const { return textureWidth; }
+    inline uint16_t getTextureHeight() const { return textureHeight; }
+
+    Stats getStats();
+
+private:
+    void markDirty(const Rect<uint16_t>& rect);
+    bool grow();
 
 private:
     std::mutex mtx;
+    uint16_t width;
+    uint16_t height;
     BinPack<uint16_t> bin;
-    std::map<std::string, std::map<uint32_t, GlyphValue>> index;
-    char *const data = nullptr;
+    std::map<std::string, Face> index;
+
+    // The glyphs referenced by each tile. A glyph is removed when its last reference is released.
+    std::unordered_map<uint64_t, std::vector<GlyphRef>> tiles;
+
+    char *data = nullptr;
     std::atomic<bool> dirty;
+
+    // Regions that changed since the last upload, and the scratch buffer for uploading them.
+    std::vector<Rect<uint16_t>> dirtyRects;
+    std::vector<char> staging;
+    bool textured = false;
+
+    uint16_t textureWidth = 0;
+    uint16_t textureHeight = 0;
     uint32_t texture = 0;
 };
 
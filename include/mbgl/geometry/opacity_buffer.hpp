@@ -0,0 +1,34 @@
+#ifndef MBGL_GEOMETRY_OPACITY_BUFFER
+#define MBGL_GEOMETRY_OPACITY_BUFFER
+
+#include "buffer.hpp"
+
+namespace mbgl {
+
+// Opacity of the vertices of symbols. Unlike the other buffers, it changes after it was uploaded:
+// the viewport-wide label placement decides which labels are shown. The buffer keeps its CPU copy
+// and is uploaded again when it has changed.
+class OpacityVertexBuffer : public Buffer<
+    4,
+    GL_ARRAY_BUFFER,
+    8192,
+    true
+> {
+public:
+    // Appends vertices of labels that are hidden until they are placed.
+    void add(size_t count);
+
+    // Sets the opacity that the vertices in [start, end) had at the last placement, and whether
+    // they are fading in or out since then.
+    void set(size_t start, size_t end, float opacity, bool visible);
+
+    // Binds the buffer, uploading it first if it has changed.
+    void bind();
+
+private:
+    bool changed = false;
+};
+
+}
+
+#endif
@@ -35,17 +35,12 @@ public:
     // Otherwise, it returns a 0/0/0/0 rect.
     Rect<dimension> getImage(const std::string &name, const Sprite &sprite);
 
-    // Returns the coordinates of an image that is sourced from the sprite image.
-    // This getter waits until the sprite image was loaded, copies it into the sprite
-    // image and returns the dimensions.
-    // NEVER CALL THIS FUNCTION FROM THE RENDER THREAD! it is blocking.
-    Rect<dimension> waitForImage(const std::string &name, const Sprite &sprite);
-
     // Binds the image buffer of this sprite atlas to the GPU.
     void bind(bool linear = false);
 
-    // Uploads the image buffer to the GPU if it is out of date.
-    void upload();
+    // Uploads the image buffer to the GPU if it is out of date and returns the number of bytes
+    // that were uploaded. Only the rows that changed are uploaded unless the texture size changed.
+    size_t upload();
 
     inline float getWidth() const { return width; }
     inline float getHeight() const { return height; }
@@ -57,6 +52,7 @@ private:
     void allocate();
     Rect<SpriteAtlas::dimension> allocateImage(size_t width, size_t height);
     void copy(const Rect<dimension> &dst, const SpritePosition &src, const Sprite &sprite);
+    void markDirty(uint32_t top, uint32_t bottom);
 
 public:
     const dimension width = 0;
@@ -70,6 +66,14 @@ private:
     std::set<std::string> uninitialized;
     uint32_t *data = nullptr;
     std::atomic<bool> dirty;
+
+    // Texture rows that changed since the last upload.
+    uint32_t dirtyTop = 0;
+    uint32_t dirtyBottom = 0;
+
+    // Pixel ratio of the uploaded texture, or 0 if it wasn't uploaded yet.
+    float textureRatio = 0;
+
     uint32_t texture = 0;
     uint32_t filter = 0;
     static const int buffer = 1;
@@ -11,15 +11,17 @@ namespace mbgl {
 #if GL_ARB_vertex_array_object
 class VertexArrayObject {
 public:
+    // The offset is relative to the vertex buffer, which may start anywhere in a pooled GL buffer.
     template <typename Shader, typename VertexBuffer>
     inline void bind(Shader& shader, VertexBuffer &vertexBuffer, char *offset) {
         bindVertexArrayObject();
         if (bound_shader == 0) {
             vertexBuffer.bind();
+            offset += vertexBuffer.getOffset();
             shader.bind(offset);
             storeBinding(shader, vertexBuffer.getID(), 0, offset);
         } else {
-            verifyBinding(shader, vertexBuffer.getID(), 0, offset);
+            verifyBinding(shader, vertexBuffer.getID(), 0, offset + vertexBuffer.getOffset());
         }
     }
 
@@ -29,15 +31,19 @@ public:
         if (bound_shader == 0) {
             vertexBuffer.bind();
             elementsBuffer.bind();
+            offset += vertexBuffer.getOffset();
             shader.bind(offset);
             storeBinding(shader, vertexBuffer.getID(), elementsBuffer.getID(), offset);
         } else {
-            verifyBinding(shader, vertexBuffer.getID(), elementsBuffer.getID(), offset);
+            verifyBinding(shader, vertexBuffer.getID(), elementsBuffer.getID(), offset + vertexBuffer.getOffset());
         }
     }
 
     ~VertexArrayObject();
 
+    // Deletes the GL object. It is recreated with the next bind().
+    void releaseGPU();
+
 private:
     void bindVertexArrayObject();
     void storeBinding(Shader &shader, GLuint vertexBuffer, GLuint elementsBuffer, char *offset);
@@ -65,6 +71,8 @@ public:
         }
         shader.bind(offset);
     }
+
+    inline void releaseGPU() {}
 };
 
 #endif
@@ -3,6 +3,7 @@
 
 #include <mbgl/map/transform.hpp>
 #include <mbgl/renderer/painter.hpp>
+#include <mbgl/text/label_placement.hpp>
 
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/time.hpp>
@@ -27,6 +28,8 @@ class StyleLayer;
 class StyleLayerGroup;
 class StyleSource;
 class Texturepool;
+class Bufferpool;
+class UploadScheduler;
 class FileSource;
 class View;
 
@@ -113,6 +116,13 @@ public:
     void toggleDebug();
     bool getDebug() const;
 
+    // Memory
+    // Sets the number of bytes of parsed tiles that each source keeps around after they left the
+    // viewport. A size of 0 disables the tile cache. The shapings of labels are cached along
+    // with it.
+    void setTileCacheSize(size_t bytes);
+    size_t getTileCacheSize() const;
+
 public:
     inline const TransformState &getState() const { return state; }
     inline std::shared_ptr<FileSource> getFileSource() const { return fileSource; }
@@ -122,6 +132,8 @@ public:
     inline std::shared_ptr<SpriteAtlas> getSpriteAtlas() { return spriteAtlas; }
     std::shared_ptr<Sprite> getSprite();
     inline std::shared_ptr<Texturepool> getTexturepool() { return texturepool; }
+    inline std::shared_ptr<Bufferpool> getBufferpool() { return bufferpool; }
+    inline std::shared_ptr<UploadScheduler> getUploadScheduler() { return uploadScheduler; }
     inline std::shared_ptr<uv::loop> getLoop() { return loop; }
     inline timestamp getAnimationTime() const { return animationTime; }
     inline timestamp getTime() const { return animationTime; }
@@ -142,6 +154,10 @@ private:
 
     void updateRenderState();
 
+    // Places the labels of all symbol layers in the view, across tile boundaries.
+    void placeLabels();
+    void collectLabels(const std::shared_ptr<StyleLayerGroup> &group, std::vector<LabelPlacement::Bucket> &buckets);
+
     size_t countLayers(const std::vector<LayerDescription>& layers);
 
     // Prepares a map render by updating the tiles we need for the current view, as well as updating
@@ -189,6 +205,9 @@ private:
     std::shared_ptr<SpriteAtlas> spriteAtlas;
     std::shared_ptr<Sprite> sprite;
     std::shared_ptr<Texturepool> texturepool;
+    std::shared_ptr<Bufferpool> bufferpool;
+    std::shared_ptr<UploadScheduler> uploadScheduler;
+    std::unique_ptr<LabelPlacement> labelPlacement;
 
     Painter painter;
 
@@ -196,6 +215,7 @@ private:
     std::string accessToken = "";
 
     bool debug = false;
+    std::atomic<size_t> tileCacheSize;
     timestamp animationTime = 0;
 
     int indent = 0;
@@ -24,6 +24,10 @@ public:
     virtual void parse();
     virtual void render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const mat4 &matrix);
     virtual bool hasData(std::shared_ptr<StyleLayer> layer_desc) const;
+    virtual void releaseGPU();
+    virtual bool upload(UploadScheduler &scheduler);
+    virtual bool isUploaded() const;
+    virtual size_t bytes() const;
 
 protected:
     StyleBucketRaster properties;
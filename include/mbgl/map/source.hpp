@@ -3,7 +3,9 @@
 
 #include <mbgl/map/tile.hpp>
 #include <mbgl/map/tile_data.hpp>
+#include <mbgl/map/tile_cache.hpp>
 #include <mbgl/style/style_source.hpp>
+#include <mbgl/text/label_placement.hpp>
 
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/time.hpp>
@@ -35,6 +37,11 @@ public:
     void render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID &id, const mat4 &matrix);
     void finishRender(Painter &painter);
 
+    // Adds the labels of the layer in the rendered tiles. Tiles at the ideal zoom level come
+    // first, so that their labels take precedence over those of tiles that fill in for them.
+    void collectLabels(std::shared_ptr<StyleLayer> layer_desc, const TransformState &state,
+                       std::vector<LabelPlacement::Bucket> &buckets);
+
     std::forward_list<Tile::ID> getIDs() const;
     void updateClipIDs(const std::map<Tile::ID, ClipID> &mapping);
 
@@ -53,14 +60,25 @@ private:
     TileData::State addTile(Map &map, const Tile::ID& id);
     TileData::State hasTile(const Tile::ID& id);
 
+    // Whether the tile is parsed and its textures are uploaded. Doesn't upload anything; the
+    // textures of required tiles are uploaded once per frame by updateTiles().
+    bool isReady(const Tile::ID& id);
+
     double getZoom(const TransformState &state) const;
 
+    // Returns the distance of the tile's center to the viewport center in screen pixels. The
+    // points are the viewport corners in tile coordinates of the clamped zoom level.
+    util::Executor::Priority getPriority(const TransformState &state, int32_t clamped_zoom, const box& points, const Tile::ID& id) const;
+
 private:
     // Stores the time when this source was most recently updated.
     timestamp updated = 0;
 
     std::map<Tile::ID, std::unique_ptr<Tile>> tiles;
     std::map<Tile::ID, std::weak_ptr<TileData>> tile_data;
+
+    // Parsed tiles that are no longer retained, but that we may need again soon.
+    TileCache cache;
 };
 
 }
@@ -10,7 +10,9 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
-#include <future>
+#include <functional>
+#include <mutex>
+#include <vector>
 
 namespace mbgl {
 
@@ -41,7 +43,9 @@ public:
 
     const SpritePosition &getSpritePosition(const std::string& name) const;
 
-    void waitUntilLoaded() const;
+    // Returns whether the sprite has been loaded or failed to load. Otherwise, the callback is
+    // invoked once that has happened, on the thread that finished loading the sprite.
+    bool requestLoaded(std::function<void()> callback);
     bool isLoaded() const;
 
     operator bool() const;
@@ -53,6 +57,8 @@ public:
     const float pixelRatio;
     const std::string spriteURL;
     const std::string jsonURL;
+
+    // The image is decoded on the executor.
     std::unique_ptr<util::Image> raster;
 
 private:
@@ -65,12 +71,14 @@ private:
     std::string image;
     std::atomic<bool> loadedImage;
     std::atomic<bool> loadedJSON;
+    std::atomic<bool> failed;
     std::unordered_map<std::string, SpritePosition> pos;
     const SpritePosition empty;
 
-    std::promise<void> promise;
-    std::future<void> future;
-
+    // Callbacks waiting for the sprite, and whether they have been invoked.
+    std::mutex mtx;
+    std::vector<std::function<void()>> callbacks;
+    bool completed = false;
 };
 
 }
@@ -0,0 +1,58 @@
+#ifndef MBGL_MAP_TILE_CACHE
+#define MBGL_MAP_TILE_CACHE
+
+#include <mbgl/map/tile.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <list>
+#include <map>
+#include <memory>
+
+namespace mbgl {
+
+class TileData;
+
+// Keeps parsed tiles that dropped out of the viewport around so that they can be reused without
+// loading and parsing them again. The cache is bounded by the number of bytes the tiles hold and
+// evicts the least recently added tiles first.
+class TileCache : private util::noncopyable {
+public:
+    TileCache(size_t maximumSize = 0);
+
+    void setMaximumSize(size_t size);
+    size_t getMaximumSize() const;
+
+    // Adds a tile that is no longer needed for rendering. Its GL objects are released. Tiles that
+    // don't retain their buffers after upload are ignored.
+    void add(const Tile::ID &id, const std::shared_ptr<TileData> &data);
+
+    // Removes a tile from the cache and returns it, or returns an empty pointer.
+    std::shared_ptr<TileData> get(const Tile::ID &id);
+
+    bool has(const Tile::ID &id) const;
+    void clear();
+
+    size_t getSize() const;
+    size_t getTileCount() const;
+
+private:
+    struct Entry {
+        Tile::ID id;
+        std::shared_ptr<TileData> data;
+        size_t size;
+    };
+
+    void prune();
+
+private:
+    size_t maximumSize;
+    size_t size = 0;
+
+    // Most recently added tiles come first.
+    std::list<Entry> entries;
+    std::map<Tile::ID, std::list<Entry>::iterator> index;
+};
+
+}
+
+#endif
@@ -6,21 +6,24 @@
 #include <mbgl/geometry/debug_font_buffer.hpp>
 
 #include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/request_scheduler.hpp>
 
 #include <atomic>
 #include <exception>
+#include <functional>
 #include <iosfwd>
 #include <memory>
 #include <string>
 
 namespace mbgl {
 
+class Bucket;
 class Map;
 class Painter;
 class SourceInfo;
 class StyleLayer;
-
-namespace platform { class Request; }
+class UploadScheduler;
 
 class TileData : public std::enable_shared_from_this<TileData>,
              private util::noncopyable {
@@ -46,7 +49,13 @@ public:
 
     void request();
     void cancel();
+
+    // Parses the tile on the executor. Must be called on the map thread.
     void reparse();
+
+    // Updates the priority of parsing the tile and, if it is still waiting for a connection, of
+    // downloading it.
+    void setPriority(util::Executor::Priority value);
     const std::string toString() const;
 
     // Override this in the child class.
@@ -56,11 +65,36 @@ public:
     virtual void render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const mat4 &matrix) = 0;
     virtual bool hasData(std::shared_ptr<StyleLayer> layer_desc) const = 0;
 
+    // Returns the bucket of the layer once the tile has been parsed.
+    virtual Bucket *getBucket(std::shared_ptr<StyleLayer> layer_desc);
+
+    // Releases the GL objects of this tile when it is moved into the tile cache. They are
+    // recreated from the retained CPU data once the tile is rendered again.
+    virtual void releaseGPU();
+
+    // Uploads the textures of a parsed tile as far as the scheduler's budget allows. Returns
+    // whether the tile can be rendered; tiles that can't are covered by their parents or children.
+    virtual bool upload(UploadScheduler &scheduler);
+
+    // Returns whether the textures of the tile are uploaded, without uploading them.
+    virtual bool isUploaded() const;
+
+    // Returns the approximate number of bytes of tile data held by this object.
+    virtual size_t bytes() const;
+
 
 public:
     const Tile::ID id;
     std::atomic<State> state;
 
+    // Determines the order in which tiles are parsed. It's the tile's distance to the viewport
+    // center in screen pixels.
+    std::atomic<util::Executor::Priority> priority;
+
+    // Whether buffers keep their CPU copy after upload so that the tile can be cached. It is
+    // decided when the tile is created; tiles without it can't be cached.
+    const bool retainAfterUpload;
+
 protected:
     Map &map;
 
@@ -71,7 +105,11 @@ public:
     const std::string url;
 
 protected:
-    std::weak_ptr<platform::Request> req;
+    // Returns a callback that reparses the tile on the map thread if it is still loaded. It may be
+    // invoked from any thread. Must be called on the map thread.
+    std::function<void()> reparseOnMapThread();
+
+    std::shared_ptr<util::RequestScheduler::Ticket> req;
     std::string data;
 
     // Contains the tile ID string for painting debug information.
@@ -79,6 +117,12 @@ protected:
 
 public:
     DebugBucket debugBucket;
+
+private:
+    // The reparse that the tile waits for. Its handle is closed when the tile is cancelled, so
+    // that a dependency which never calls back doesn't keep the map loop alive.
+    class Reparse;
+    std::shared_ptr<Reparse> pendingReparse;
 };
 
 }
@@ -4,11 +4,17 @@
 #include <mbgl/map/vector_tile.hpp>
 #include <mbgl/style/filter_expression.hpp>
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/util/arena.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <iosfwd>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace mbgl {
 
@@ -25,6 +31,8 @@ class StyleBucketFill;
 class StyleBucketRaster;
 class StyleBucketLine;
 class StyleBucketSymbol;
+class SymbolBucket;
+class SymbolFeature;
 class StyleLayerGroup;
 class VectorTileData;
 class Collision;
@@ -40,22 +48,47 @@ public:
     ~TileParser();
 
 public:
-    void parse();
+    // Returns false if the symbols of the tile are waiting for glyphs or the sprite. Missing
+    // resources are requested, and parsing continues where it left off when it is called again.
+    bool parse();
+
+    // Calls back once after the glyphs and the sprite that the parser waits for are loaded, or
+    // right away if it isn't waiting anymore. The callback may be invoked on any thread.
+    void notifyWhenLoaded(std::function<void()> callback);
+
+    // Returns whether parsing has completed or was cancelled, so that the parser can be deleted.
+    bool done();
 
 private:
+    // Vertex and element buffers that a single bucket is written to while parsing in parallel.
+    struct BufferSegment;
+
+    // The features of a symbol bucket, which are placed once its glyphs and the sprite are loaded.
+    struct PendingSymbols {
+        SymbolBucket *bucket;
+        util::ArenaVector<SymbolFeature> features;
+    };
+
     bool obsolete() const;
-    void parseStyleLayers(std::shared_ptr<StyleLayerGroup> group);
-    std::unique_ptr<Bucket> createBucket(std::shared_ptr<StyleBucket> bucket_desc);
+    void parseBuckets();
+    bool requestDependencies(const std::function<void()> &callback);
+    void moveBuckets();
+    void collectBuckets(std::shared_ptr<StyleLayerGroup> group, std::vector<std::shared_ptr<StyleBucket>> &bucket_descs);
+    std::unique_ptr<Bucket> createBucket(std::shared_ptr<StyleBucket> bucket_desc, BufferSegment *segment);
 
-    std::unique_ptr<Bucket> createFillBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketFill &fill);
+    std::unique_ptr<Bucket> createFillBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketFill &fill, BufferSegment &segment);
     std::unique_ptr<Bucket> createRasterBucket(const std::shared_ptr<Texturepool> &texturepool, const StyleBucketRaster &raster);
-    std::unique_ptr<Bucket> createLineBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketLine &line);
+    std::unique_ptr<Bucket> createLineBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketLine &line, BufferSegment &segment);
     std::unique_ptr<Bucket> createSymbolBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketSymbol &symbol);
 
     template <class Bucket> void addBucketGeometries(Bucket& bucket, const VectorTileLayer& layer, const FilterExpression &filter);
 
 private:
-    const VectorTile vector_data;
+    // The raw tile data, and the decompressed copy of it if the tile was compressed.
+    const std::string &data;
+    std::string decompressed;
+
+    VectorTile vector_data;
     VectorTileData& tile;
 
     // Cross-thread shared data.
@@ -67,6 +100,20 @@ private:
     std::shared_ptr<Texturepool> texturePool;
 
     std::unique_ptr<Collision> collision;
+
+    // Scratch memory of the symbol buckets, which are parsed one after another.
+    util::Arena symbolArena;
+
+    // State that is kept while the tile waits for glyphs or the sprite.
+    std::mutex mtx;
+    bool parsed = false;
+    bool waiting = false;
+    std::vector<std::shared_ptr<StyleBucket>> bucket_descs;
+    std::vector<std::unique_ptr<Bucket>> buckets;
+    std::vector<std::unique_ptr<BufferSegment>> segments;
+    std::vector<PendingSymbols> pendingSymbols;
+    std::map<std::string, std::set<GlyphRange>> glyphRanges;
+    bool needsSprite = false;
 };
 
 }
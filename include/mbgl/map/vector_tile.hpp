@@ -1,16 +1,17 @@
 #ifndef MBGL_MAP_VECTOR_TILE
 #define MBGL_MAP_VECTOR_TILE
 
+#include <mbgl/map/vector_tile_filter.hpp>
 #include <mbgl/style/filter_expression.hpp>
 #include <mbgl/style/value.hpp>
 #include <mbgl/text/glyph.hpp>
 #include <mbgl/util/pbf.hpp>
+#include <mbgl/util/string_view.hpp>
 
 #include <cstdint>
 #include <iosfwd>
 #include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace mbgl {
@@ -26,23 +27,22 @@ enum class FeatureType {
 
 std::ostream& operator<<(std::ostream&, const FeatureType& type);
 
-class VectorTileFeature {
-public:
-    VectorTileFeature(pbf feature, const VectorTileLayer& layer);
-
+// A feature record in the layer's feature index. The tags and the geometry refer to the tile
+// buffer and are decoded lazily.
+struct VectorTileFeature {
     uint64_t id = 0;
     FeatureType type = FeatureType::Unknown;
-    std::map<std::string, Value> properties;
+
+    // Packed varints of alternating key and value indices.
+    pbf tags;
     pbf geometry;
 };
 
-std::ostream& operator<<(std::ostream&, const VectorTileFeature& feature);
-
-
 class VectorTileTagExtractor {
 public:
     VectorTileTagExtractor(const VectorTileLayer &layer);
 
+    void setFeature(const VectorTileFeature &feature);
     void setTags(const pbf &pbf);
     std::vector<Value> getValues(const std::string &key) const;
     void setType(FilterExpression::GeometryType type);
@@ -57,22 +57,24 @@ private:
 /*
  * Allows iterating over the features of a VectorTileLayer using a
  * BucketDescription as filter. Only features matching the descriptions will
- * be returned (as pbf).
+ * be returned.
  */
 class FilteredVectorTileLayer {
 public:
     class iterator {
     public:
-        iterator(const FilteredVectorTileLayer& filter, const pbf& data);
+        typedef std::vector<VectorTileFeature>::const_iterator feature_iterator;
+
+        iterator(const FilteredVectorTileLayer& filter, feature_iterator it);
         void operator++();
         bool operator!=(const iterator& other) const;
-        const pbf& operator*() const;
+        const VectorTileFeature& operator*() const;
 
     private:
+        void advance();
+
         const FilteredVectorTileLayer& parent;
-        bool valid = false;
-        pbf feature;
-        pbf data;
+        feature_iterator it;
     };
 
 public:
@@ -84,21 +86,36 @@ public:
 private:
     const VectorTileLayer& layer;
     const FilterExpression& filterExpression;
+    const VectorTileFilter filter;
 };
 
 std::ostream& operator<<(std::ostream&, const PositionedGlyph& placement);
 
+// Decodes a layer in a single pass. Features are recorded in a flat index that is shared by all
+// buckets that are created from this layer; keys refer to the tile buffer, so the layer must not
+// outlive the data it was created from.
 class VectorTileLayer {
 public:
     VectorTileLayer(pbf data);
 
+    // Returns the index of the key, or -1 if the layer doesn't contain it. This scans the keys, so
+    // callers should resolve a key once per layer rather than once per feature.
+    int32_t getKeyIndex(const std::string &key) const;
+
+    // Returns the value the feature has for the key, or nullptr if it doesn't have one.
+    const Value *getValue(const VectorTileFeature &feature, int32_t key) const;
+    const Value *getValue(const VectorTileFeature &feature, const std::string &key) const;
+
+private:
+    void validateTags(VectorTileFeature &feature) const;
+
+public:
     const pbf data;
     std::string name;
     uint32_t extent = 4096;
-    std::vector<std::string> keys;
-    std::unordered_map<std::string, uint32_t> key_index;
+    std::vector<util::string_view> keys;
     std::vector<Value> values;
-    std::map<std::string, std::map<Value, Shaping>> shaping;
+    std::vector<VectorTileFeature> features;
 };
 
 class VectorTile {
@@ -9,6 +9,7 @@
 #include <mbgl/geometry/line_buffer.hpp>
 #include <mbgl/geometry/text_buffer.hpp>
 
+#include <atomic>
 #include <iosfwd>
 #include <memory>
 #include <unordered_map>
@@ -34,6 +35,9 @@ public:
     virtual void afterParse();
     virtual void render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const mat4 &matrix);
     virtual bool hasData(std::shared_ptr<StyleLayer> layer_desc) const;
+    virtual Bucket *getBucket(std::shared_ptr<StyleLayer> layer_desc);
+    virtual void releaseGPU();
+    virtual size_t bytes() const;
 
 protected:
     // Holds the actual geometries in this tile.
@@ -54,6 +58,11 @@ protected:
 
 public:
     const float depth;
+
+    // Size of the tile data as received and after decompression, in bytes. Both are the same for
+    // uncompressed tiles.
+    std::atomic<size_t> compressedBytes;
+    std::atomic<size_t> decompressedBytes;
 };
 
 }
@@ -0,0 +1,62 @@
+#ifndef MBGL_MAP_VECTOR_TILE_FILTER
+#define MBGL_MAP_VECTOR_TILE_FILTER
+
+#include <mbgl/style/filter_expression.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+
+class VectorTileLayer;
+struct VectorTileFeature;
+
+// A filter expression compiled for a particular tile layer. Field names are resolved to the layer's
+// key indices, and the expression tree is flattened into a program that is evaluated directly
+// over the packed tags of a feature. The result of a comparison only depends on the value index
+// of its field, so results are memoized per value and every value of the layer is compared to the
+// filter literals at most once.
+//
+// Evaluation doesn't allocate, except for features that have more than one value for a filtered
+// key. Compiled filters are not thread-safe.
+class VectorTileFilter {
+public:
+    VectorTileFilter(const FilterExpression &expression, const VectorTileLayer &layer);
+
+    bool matches(const VectorTileFeature &feature) const;
+
+private:
+    struct Instruction {
+        enum class Code : uint8_t { Expression, Comparison };
+
+        Code code;
+
+        // Expressions
+        FilterExpression::Operator op;
+        FilterExpression::GeometryType type;
+
+        // Index of the instruction after this one and all of its children.
+        uint32_t end;
+
+        // Comparisons
+        int32_t key;
+        bool missing;
+        uint32_t memo;
+        const FilterComparison *comparison;
+    };
+
+    void compile(const FilterExpression &expression);
+    bool evaluate(uint32_t pc, const VectorTileFeature &feature, FilterExpression::GeometryType type) const;
+    bool evaluateComparison(const Instruction &instruction, const VectorTileFeature &feature) const;
+
+private:
+    const VectorTileLayer &layer;
+    std::vector<Instruction> program;
+
+    // One entry per comparison and layer value; 0 means not yet evaluated.
+    mutable std::vector<uint8_t> results;
+};
+
+}
+
+#endif
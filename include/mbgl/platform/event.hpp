@@ -33,6 +33,7 @@ enum class Event : uint8_t {
     Render,
     HttpRequest,
     Sprite,
+    Database,
 };
 
 MBGL_DEFINE_ENUM_CLASS(EventClass, Event, {
@@ -44,6 +45,7 @@ MBGL_DEFINE_ENUM_CLASS(EventClass, Event, {
     { Event::Render, "Render" },
     { Event::HttpRequest, "HttpRequest" },
     { Event::Sprite, "Sprite" },
+    { Event::Database, "Database" },
     { Event(-1), "Unknown" },
 });
 
@@ -17,16 +17,31 @@ struct Response {
     int16_t code = -1;
     std::string body;
     std::string error_message;
+
+    // HTTP validity information, in seconds since the epoch (0 if unknown).
+    int64_t modified = 0;
+    int64_t expires = 0;
+    std::string etag;
+
+    // Cache-Control directives: no-store responses aren't cached, and no-cache responses are
+    // revalidated before they're used again.
+    bool noStore = false;
+    bool noCache = false;
+
     std::function<void(Response *)> callback;
 };
 
 // Makes an HTTP request of a URL, preferrably on a background thread, and calls a function with the
 // results in the original thread (which runs the libuv loop).
 // If the loop pointer is NULL, the callback function will be called on an arbitrary thread.
+// If an ETag or modification time of a cached copy is given, the request is conditional and
+// results in a 304 response with an empty body if the cached copy is still valid.
 // Returns a cancellable request.
 std::shared_ptr<Request> request_http(const std::string &url,
                                       std::function<void(Response *)> callback,
-                                      std::shared_ptr<uv::loop> loop = nullptr);
+                                      std::shared_ptr<uv::loop> loop = nullptr,
+                                      const std::string &etag = "",
+                                      int64_t modified = 0);
 
 // Cancels an HTTP request.
 void cancel_request_http(const std::shared_ptr<Request> &req);
@@ -17,6 +17,13 @@ public:
     virtual bool hasData() const = 0;
     virtual ~Bucket() {}
 
+    // Releases the GL objects of this bucket while keeping the CPU data that is required to
+    // recreate them.
+    virtual void releaseGPU() {}
+
+    // Returns the number of bytes held by buffers that this bucket owns.
+    virtual size_t bytes() const { return 0; }
+
 };
 
 }
@@ -22,6 +22,7 @@ public:
 
     virtual void render(Painter& painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID& id, const mat4 &matrix);
     virtual bool hasData() const;
+    virtual void releaseGPU();
 
     void drawLines(PlainShader& shader);
     void drawPoints(PlainShader& shader);
@@ -4,7 +4,9 @@
 #include <mbgl/renderer/bucket.hpp>
 #include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/geometry/fill_buffer.hpp>
+#include <mbgl/geometry/earcut.hpp>
 #include <mbgl/style/style_bucket.hpp>
+#include <mbgl/util/arena.hpp>
 
 #include <clipper/clipper.hpp>
 #include <libtess2/tesselator.h>
@@ -40,15 +42,26 @@ public:
     FillBucket(FillVertexBuffer& vertexBuffer,
                TriangleElementsBuffer& triangleElementsBuffer,
                LineElementsBuffer& lineElementsBuffer,
-               const StyleBucketFill& properties);
+               const StyleBucketFill& properties,
+               util::Arena& arena);
     ~FillBucket();
 
     virtual void render(Painter& painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID& id, const mat4 &matrix);
     virtual bool hasData() const;
+    virtual void releaseGPU();
 
     void addGeometry(pbf& data);
+
+    // Triangulates the rings of the current feature. Simple polygons are triangulated by ear
+    // clipping; everything else is clipped with Clipper and tessellated with libtess2.
     void tessellate();
 
+    // Appends the buffers this bucket was created with to the given buffers and uses them from
+    // now on. The original buffers should not contain geometry of other buckets.
+    void moveTo(FillVertexBuffer& vertexBuffer,
+                TriangleElementsBuffer& triangleElementsBuffer,
+                LineElementsBuffer& lineElementsBuffer);
+
     void drawElements(PlainShader& shader);
     void drawElements(PatternShader& shader);
     void drawVertices(OutlineShader& shader);
@@ -57,25 +70,35 @@ public:
     const StyleBucketFill &properties;
 
 private:
+    bool triangulate(size_t count);
+    void tessellateClipped();
+
+    // Scratch memory for the contours that are passed to libtess2.
+    util::Arena &arena;
+
     TESSalloc *allocator;
     TESStesselator *tesselator;
     ClipperLib::Clipper clipper;
+    Earcut earcut;
 
-    FillVertexBuffer& vertexBuffer;
-    TriangleElementsBuffer& triangleElementsBuffer;
-    LineElementsBuffer& lineElementsBuffer;
+    FillVertexBuffer *vertexBuffer;
+    TriangleElementsBuffer *triangleElementsBuffer;
+    LineElementsBuffer *lineElementsBuffer;
 
     // hold information on where the vertices are located in the FillBuffer
-    const size_t vertex_start;
-    const size_t triangle_elements_start;
-    const size_t line_elements_start;
+    size_t vertex_start;
+    size_t triangle_elements_start;
+    size_t line_elements_start;
     VertexArrayObject array;
 
     std::vector<triangle_group_type> triangleGroups;
     std::vector<line_group_type> lineGroups;
 
-    std::vector<ClipperLib::IntPoint> line;
-    bool hasVertices = false;
+    // Rings of the feature that is being added. The first ringCount rings are in use; the others
+    // are kept to reuse their memory for the next features.
+    std::vector<Earcut::Ring> rings;
+    size_t ringCount = 0;
+    std::vector<uint32_t> indices;
 
     static const int vertexSize = 2;
     static const int stride = sizeof(TESSreal) * vertexSize;
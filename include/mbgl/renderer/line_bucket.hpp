@@ -6,6 +6,7 @@
 #include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/geometry/line_buffer.hpp>
 #include <mbgl/style/style_bucket.hpp>
+#include <mbgl/util/arena.hpp>
 
 #include <memory>
 #include <vector>
@@ -26,14 +27,22 @@ public:
     LineBucket(LineVertexBuffer& vertexBuffer,
                TriangleElementsBuffer& triangleElementsBuffer,
                PointElementsBuffer& pointElementsBuffer,
-               const StyleBucketLine& properties);
+               const StyleBucketLine& properties,
+               util::Arena& arena);
 
     virtual void render(Painter& painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID& id, const mat4 &matrix);
     virtual bool hasData() const;
+    virtual void releaseGPU();
 
     void addGeometry(pbf& data);
     void addGeometry(const std::vector<Coordinate>& line);
 
+    // Appends the buffers this bucket was created with to the given buffers and uses them from
+    // now on. The original buffers should not contain geometry of other buckets.
+    void moveTo(LineVertexBuffer& vertexBuffer,
+                TriangleElementsBuffer& triangleElementsBuffer,
+                PointElementsBuffer& pointElementsBuffer);
+
     bool hasPoints() const;
 
     void drawLines(LineShader& shader);
@@ -43,17 +52,22 @@ public:
     const StyleBucketLine &properties;
 
 private:
+    // Scratch memory for the elements of a line.
+    util::Arena &arena;
 
-    LineVertexBuffer& vertexBuffer;
-    TriangleElementsBuffer& triangleElementsBuffer;
-    PointElementsBuffer& pointElementsBuffer;
+    LineVertexBuffer *vertexBuffer;
+    TriangleElementsBuffer *triangleElementsBuffer;
+    PointElementsBuffer *pointElementsBuffer;
 
-    const size_t vertex_start;
-    const size_t triangle_elements_start;
-    const size_t point_elements_start;
+    size_t vertex_start;
+    size_t triangle_elements_start;
+    size_t point_elements_start;
 
     std::vector<triangle_group_type> triangleGroups;
     std::vector<point_group_type> pointGroups;
+
+    // Vertices of the line that is being added; reused for all features.
+    std::vector<Coordinate> line;
 };
 
 }
@@ -20,6 +20,8 @@ public:
 
     virtual void render(Painter& painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID& id, const mat4 &matrix);
     virtual bool hasData() const;
+    virtual void releaseGPU();
+    virtual size_t bytes() const;
 
     bool setImage(const std::string &data);
 
@@ -6,13 +6,18 @@
 #include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/geometry/text_buffer.hpp>
 #include <mbgl/geometry/icon_buffer.hpp>
+#include <mbgl/geometry/opacity_buffer.hpp>
 #include <mbgl/map/vector_tile.hpp>
 #include <mbgl/text/types.hpp>
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/text/label_placement.hpp>
 #include <mbgl/style/style_bucket.hpp>
+#include <mbgl/util/arena.hpp>
+#include <mbgl/util/time.hpp>
 
 #include <memory>
 #include <map>
+#include <set>
 #include <vector>
 
 namespace mbgl {
@@ -54,30 +59,46 @@ class SymbolBucket : public Bucket {
     typedef ElementGroup<1> IconElementGroup;
 
 public:
-    SymbolBucket(const StyleBucketSymbol &properties, Collision &collision);
+    SymbolBucket(const StyleBucketSymbol &properties, Collision &collision, util::Arena &arena);
 
     virtual void render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const Tile::ID &id, const mat4 &matrix);
     virtual bool hasData() const;
     virtual bool hasTextData() const;
     virtual bool hasIconData() const;
+    virtual void releaseGPU();
+    virtual size_t bytes() const;
 
-    void addFeatures(const VectorTileLayer &layer, const FilterExpression &filter,
+    void setRetainAfterUpload(bool value);
+    void setBufferpool(const std::shared_ptr<Bufferpool> &pool);
+
+    // Collects the labels and icons of the layer's features, and adds the glyph ranges they need
+    // to ranges. The features are allocated from the bucket's arena.
+    util::ArenaVector<SymbolFeature> processFeatures(const VectorTileLayer &layer, const FilterExpression &filter, std::set<GlyphRange> &ranges);
+
+    // Shapes and places the features. Their glyph ranges and the sprite must have been loaded.
+    void addFeatures(const util::ArenaVector<SymbolFeature> &features,
                      const Tile::ID &id, SpriteAtlas &spriteAtlas, Sprite &sprite,
                      GlyphAtlas &glyphAtlas, GlyphStore &glyphStore);
 
     void addGlyphs(const PlacedGlyphs &glyphs, float placementZoom, PlacementRange placementRange,
                    float zoom);
 
-    void drawGlyphs(TextShader &shader);
-    void drawIcons(IconShader& shader);
+    // The labels and icons that the tile placement has added, for the viewport-wide placement.
+    inline const std::vector<SymbolInstance> &getSymbolInstances() const { return instances; }
 
-private:
+    // Shows the labels for which visible is set and hides the others. With fade, they fade in
+    // and out, starting at their current opacity.
+    void setPlacement(const std::vector<bool> &visible, timestamp now, bool fade);
 
-    std::vector<SymbolFeature> processFeatures(const VectorTileLayer &layer, const FilterExpression &filter, GlyphStore &glyphStore, const Sprite &sprite);
+    // Returns the share of the fade duration that has passed since the last placement.
+    float getFadeChange(timestamp now) const;
 
+    void drawGlyphs(TextShader &shader);
+    void drawIcons(IconShader& shader);
 
-    void addFeature(const pbf &geom_pbf, const Shaping &shaping, const GlyphPositions &face, const Rect<uint16_t> &image);
-    void addFeature(const std::vector<Coordinate> &line, const Shaping &shaping, const GlyphPositions &face, const Rect<uint16_t> &image);
+private:
+    void addFeature(const pbf &geom_pbf, uint32_t key, const Shaping &shaping, const GlyphPositions &face, const Rect<uint16_t> &image);
+    void addFeature(const std::vector<Coordinate> &line, uint32_t key, const Shaping &shaping, const GlyphPositions &face, const Rect<uint16_t> &image);
 
 
     // Adds placed items to the buffer.
@@ -94,18 +115,36 @@ public:
 private:
     Collision &collision;
 
+    // Scratch memory for the features and glyphs of the layer that is being added.
+    util::Arena &arena;
+
     struct {
         TextVertexBuffer vertices;
         TriangleElementsBuffer triangles;
+        OpacityVertexBuffer opacity;
         std::vector<TextElementGroup> groups;
     } text;
 
     struct {
         IconVertexBuffer vertices;
         TriangleElementsBuffer triangles;
+        OpacityVertexBuffer opacity;
         std::vector<IconElementGroup> groups;
     } icon;
 
+    std::vector<SymbolInstance> instances;
+
+    // Opacity of each label at the last placement, and whether it's fading in since then.
+    struct Fade {
+        float opacity = 0;
+        bool visible = false;
+    };
+    std::vector<Fade> fades;
+    timestamp placedAt = 0;
+
+    // Vertices of the line that is being added; reused for all features.
+    std::vector<Coordinate> line;
+
 };
 }
 
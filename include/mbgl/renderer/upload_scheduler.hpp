@@ -0,0 +1,49 @@
+#ifndef MBGL_RENDERER_UPLOAD_SCHEDULER
+#define MBGL_RENDERER_UPLOAD_SCHEDULER
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <cstddef>
+
+namespace mbgl {
+
+// Caps the number of texture bytes that are uploaded per frame, so that a burst of new tiles
+// doesn't stall rendering. Uploads that don't fit are deferred to the next frames, and the tiles
+// that wait for them are covered by their parents or children in the meantime.
+//
+// The scheduler is only used on the render thread.
+class UploadScheduler : private util::noncopyable {
+public:
+    struct Stats {
+        // Bytes uploaded in the current frame.
+        size_t uploaded = 0;
+
+        // Uploads that were deferred in the current frame, and their size.
+        size_t deferred = 0;
+        size_t deferredBytes = 0;
+    };
+
+    // Starts a new frame that may upload budget bytes.
+    void beginFrame(size_t budget);
+
+    // Returns whether an upload of the given size fits into the rest of this frame's budget, and
+    // accounts for it if it does. The first upload of a frame always fits, so that uploads larger
+    // than the budget still make progress.
+    bool acquire(size_t bytes);
+
+    // Accounts for an upload that can't be deferred because the frame can't be rendered without it.
+    void record(size_t bytes);
+
+    // Whether uploads were deferred, so that another frame needs to be rendered.
+    inline bool hasDeferred() const { return stats.deferred > 0; }
+
+    inline const Stats &getStats() const { return stats; }
+
+private:
+    size_t budget = 0;
+    Stats stats;
+};
+
+}
+
+#endif
@@ -11,6 +11,9 @@ public:
 
     void bind(char *offset);
 
+    // Binds the label opacity, which comes from a separate buffer that is bound to GL_ARRAY_BUFFER.
+    void bindFade(char *offset);
+
     void setExtrudeMatrix(const std::array<float, 16>& exmatrix);
     void setAngle(float angle);
     void setZoom(float zoom);
@@ -19,6 +22,7 @@ public:
     void setMinFadeZoom(float minfadezoom);
     void setMaxFadeZoom(float maxfadezoom);
     void setFadeZoom(float fadezoom);
+    void setFadeChange(float fadechange);
     void setOpacity(float opacity);
     void setTextureSize(const std::array<float, 2> &texsize);
 
@@ -32,6 +36,7 @@ private:
     int32_t a_rangeend = -1;
     int32_t a_rangestart = -1;
     int32_t a_labelminzoom = -1;
+    int32_t a_fade = -1;
 
     std::array<float, 16> exmatrix = {{}};
     int32_t u_exmatrix = -1;
@@ -57,6 +62,9 @@ private:
     float fadezoom = 0;
     int32_t u_fadezoom = -1;
 
+    float fadechange = 0;
+    int32_t u_fadechange = -1;
+
     float opacity = 0;
     int32_t u_opacity = -1;
 
@@ -11,6 +11,9 @@ public:
 
     void bind(char *offset);
 
+    // Binds the label opacity, which comes from a separate buffer that is bound to GL_ARRAY_BUFFER.
+    void bindFade(char *offset);
+
     void setColor(float r, float g, float b, float a);
     void setColor(const std::array<float, 4> &color);
     void setBuffer(float buffer);
@@ -23,6 +26,7 @@ public:
     void setMinFadeZoom(float minfadezoom);
     void setMaxFadeZoom(float maxfadezoom);
     void setFadeZoom(float fadezoom);
+    void setFadeChange(float fadechange);
     void setTextureSize(const std::array<float, 2> &texsize);
 
 private:
@@ -30,6 +34,7 @@ private:
     int32_t a_offset = -1;
     int32_t a_data1 = -1;
     int32_t a_data2 = -1;
+    int32_t a_fade = -1;
 
     std::array<float, 4> color = {{}};
     int32_t u_color = -1;
@@ -64,6 +69,9 @@ private:
     float fadezoom = 0.0f;
     int32_t u_fadezoom = -1;
 
+    float fadechange = 0.0f;
+    int32_t u_fadechange = -1;
+
     std::array<float, 2> texsize = {{}};
     int32_t u_texsize = -1;
 };
@@ -42,6 +42,9 @@ public:
     const std::string &getField() const;
     template <typename Extractor> inline bool compare(const Extractor &extractor) const;
 
+    // Compares the values a feature has for the field.
+    bool compare(const std::vector<Value> &values) const;
+
     template <typename ...Args>
     inline void add(Args&& ...args) {
         instances.emplace_back(::std::forward<Args>(args)...);
@@ -43,6 +43,7 @@ private:
     std::vector<FilterComparison> comparisons;
     std::vector<FilterExpression::Wrapper> expressions;
 
+    friend class VectorTileFilter;
     friend std::ostream& operator <<(std::ostream &, const FilterExpression &);
 };
 
@@ -8,6 +8,7 @@
 #include <mbgl/util/vec.hpp>
 #include <mbgl/util/variant.hpp>
 #include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/token.hpp>
 
 #include <memory>
 #include <forward_list>
@@ -48,7 +49,7 @@ public:
         bool optional = false;
         RotationAlignmentType rotation_alignment = RotationAlignmentType::Viewport;
         float max_size = 1.0f;
-        std::string image;
+        util::TokenTemplate image;
         float rotate = 0.0f;
         float padding = 2.0f;
         bool keep_upright = false;
@@ -58,7 +59,7 @@ public:
 
     struct {
         RotationAlignmentType rotation_alignment = RotationAlignmentType::Viewport;
-        std::string field;
+        util::TokenTemplate field;
         std::string font;
         float max_size = 16.0f;
         float max_width = 15.0f * 24 /* em */;
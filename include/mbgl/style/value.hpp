@@ -13,6 +13,9 @@ typedef util::variant<bool, int64_t, uint64_t, double, std::string> Value;
 
 std::string toString(const Value &value);
 
+// Appends the string representation of the value, like toString.
+void appendString(std::string &result, const Value &value);
+
 Value parseValue(pbf data);
 
 namespace util {
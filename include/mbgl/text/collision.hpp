@@ -2,6 +2,7 @@
 #define MBGL_TEXT_COLLISION
 
 #include <mbgl/text/types.hpp>
+#include <mbgl/util/noncopyable.hpp>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -15,6 +16,9 @@
 #include <boost/geometry/index/rtree.hpp>
 #pragma GCC diagnostic pop
 
+#include <memory>
+#include <vector>
+
 namespace mbgl {
 
 namespace bg = boost::geometry;
@@ -25,10 +29,32 @@ typedef bgm::box<Point> Box;
 typedef std::pair<Box, PlacementBox> PlacementValue;
 typedef bgi::rtree<PlacementValue, bgi::rstar<16>> Tree;
 
+// Spatial index of the boxes that have been placed in a tile.
+class PlacementIndex : private util::noncopyable {
+public:
+    virtual ~PlacementIndex() = default;
+
+    virtual void insert(const std::vector<PlacementValue> &values) = 0;
+
+    // Appends the values whose bounds intersect or touch the box. The pointers are valid until
+    // the next insert.
+    virtual void query(const Box &box, std::vector<const PlacementValue *> &result) = 0;
+};
+
+enum class PlacementIndexType {
+    // A uniform grid over the tile extent. Fast to insert into, and most labels are small
+    // compared to its cells.
+    Grid,
+
+    // A boost R*-tree, which is slower to insert into.
+    RTree,
+};
+
 class Collision {
 
 public:
-    Collision(float zoom, float tileExtent, float tileSize, float placementDepth = 1);
+    Collision(float zoom, float tileExtent, float tileSize, float placementDepth = 1,
+              PlacementIndexType indexType = PlacementIndexType::Grid);
 
     float getPlacementScale(const GlyphBoxes &glyphs, float minPlacementScale, bool avoidEdges);
     PlacementRange getPlacementRange(const GlyphBoxes &glyphs, float placementScale,
@@ -37,8 +63,13 @@ public:
                 const PlacementRange &placementRange, bool horizontal);
 
 private:
-    Tree hTree;
-    Tree cTree;
+    // Boxes of labels that stay horizontal and of labels that rotate with the map.
+    std::unique_ptr<PlacementIndex> hIndex;
+    std::unique_ptr<PlacementIndex> cIndex;
+
+    // Reused for the results of queries.
+    std::vector<const PlacementValue *> blocking;
+
     PlacementValue leftEdge;
     PlacementValue topEdge;
     PlacementValue rightEdge;
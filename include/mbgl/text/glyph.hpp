@@ -2,6 +2,7 @@
 #define MBGL_TEXT_GLYPH
 
 #include <mbgl/util/rect.hpp>
+#include <mbgl/util/arena.hpp>
 
 #include <cstdint>
 #include <vector>
@@ -42,7 +43,9 @@ struct Glyph {
     const GlyphMetrics metrics;
 };
 
-typedef std::map<uint32_t, Glyph> GlyphPositions;
+// Glyphs of a single label, which only live while the label is placed.
+typedef std::map<uint32_t, Glyph, std::less<uint32_t>,
+                 util::ArenaAllocator<std::pair<const uint32_t, Glyph>>> GlyphPositions;
 
 class PositionedGlyph {
 public:
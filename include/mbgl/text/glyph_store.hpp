@@ -2,12 +2,19 @@
 #define MBGL_TEXT_GLYPH_STORE
 
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/text/shaping_cache.hpp>
 #include <mbgl/util/pbf.hpp>
 #include <mbgl/util/vec.hpp>
+#include <mbgl/util/noncopyable.hpp>
 
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <future>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -27,37 +34,74 @@ public:
     GlyphMetrics metrics;
 };
 
-class FontStack {
+// The glyphs of a glyph range, indexed by the low byte of their code point. It is immutable once
+// it has been added to a font stack.
+class GlyphSet {
 public:
-    void insert(uint32_t id, const SDFGlyph &glyph);
-    const std::map<uint32_t, GlyphMetrics> &getMetrics() const;
-    const std::map<uint32_t, SDFGlyph> &getSDFs() const;
-    const Shaping getShaping(const std::u32string &string, float maxWidth, float lineHeight,
-                             float horizontalAlign, float verticalAlign, float justify,
-                             float spacing, const vec2<float> &translate) const;
+    static const uint32_t Size = 256;
+
+    void insert(const SDFGlyph &glyph);
+
+    std::array<SDFGlyph, Size> glyphs;
+    std::bitset<Size> present;
+};
+
+// The glyphs of a font stack. Every glyph range is published once, when it has been parsed, so
+// glyphs are read without locking.
+class FontStack : private util::noncopyable {
+public:
+    FontStack();
+    ~FontStack();
+
+    // Publishes the glyphs of the range that starts at the given code point. Later glyph sets for
+    // the same range are discarded.
+    void insert(uint32_t start, std::unique_ptr<const GlyphSet> glyphs);
+
+    // Returns the glyph for the code point, or nullptr if its range isn't loaded yet or doesn't
+    // contain it.
+    inline const SDFGlyph *getGlyph(uint32_t id) const {
+        if (id >= GlyphSet::Size * RangeCount) {
+            return nullptr;
+        }
+        const GlyphSet *set = ranges[id / GlyphSet::Size].load(std::memory_order_acquire);
+        if (!set || !set->present[id % GlyphSet::Size]) {
+            return nullptr;
+        }
+        return &set->glyphs[id % GlyphSet::Size];
+    }
+
+    // Returns whether the glyph ranges of all characters of the string are loaded, so that its
+    // shaping doesn't change anymore.
+    bool hasGlyphRanges(const std::u32string &string) const;
+
+    Shaping getShaping(const std::u32string &string, float maxWidth, float lineHeight,
+                       float horizontalAlign, float verticalAlign, float justify,
+                       float spacing, const vec2<float> &translate) const;
     void lineWrap(Shaping &shaping, float lineHeight, float maxWidth, float horizontalAlign,
                   float verticalAlign, float justify) const;
 
 private:
-    std::map<uint32_t, std::string> bitmaps;
-    std::map<uint32_t, GlyphMetrics> metrics;
-    std::map<uint32_t, SDFGlyph> sdfs;
-    mutable std::mutex mtx;
+    // Glyph ranges cover the Basic Multilingual Plane.
+    static const uint32_t RangeCount = 256;
+
+    std::array<std::atomic<const GlyphSet *>, RangeCount> ranges;
 };
 
-class GlyphPBF {
+class GlyphPBF : private util::noncopyable {
 public:
-    GlyphPBF(const std::string &glyphURL, const std::string &fontStack, GlyphRange glyphRange, const std::shared_ptr<FileSource> &fileSource);
-
-    void parse(FontStack &stack);
+    GlyphPBF(const std::string &glyphURL, const std::string &fontStack, GlyphRange glyphRange);
 
-    std::shared_future<GlyphPBF &> getFuture();
+    // Requests the glyphs and parses them into the font stack on the executor. The callback is
+    // invoked on the executor once the glyphs have been parsed, or when the request failed. It
+    // may be invoked before this function returns.
+    void load(FontStack &stack, const std::shared_ptr<FileSource> &fileSource, std::function<void()> callback);
 
 private:
-    std::string data;
-    std::promise<GlyphPBF &> promise;
-    std::shared_future<GlyphPBF &> future;
-    std::mutex mtx;
+    static std::unique_ptr<const GlyphSet> parse(GlyphRange range, const std::string &data);
+
+public:
+    const GlyphRange range;
+    const std::string url;
 };
 
 // Manages Glyphrange PBF loading.
@@ -65,16 +109,21 @@ class GlyphStore {
 public:
     GlyphStore(const std::shared_ptr<FileSource> &fileSource);
 
-    // Block until all specified GlyphRanges of the specified font stack are loaded.
-    void waitForGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges);
+    // Returns whether all specified GlyphRanges of the specified font stack are loaded. If they
+    // aren't, loads the missing ones and invokes the callback once all of them are, on the thread
+    // that finished loading the last one. The callback is optional.
+    bool requestGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges, std::function<void()> callback);
 
     FontStack &getFontStack(const std::string &fontStack);
 
+    // Shapings of the labels of all tiles.
+    inline ShapingCache &getShapingCache() { return shapingCache; }
+
     void setURL(const std::string &url);
 
 private:
-    // Loads an individual glyph range from the font stack and adds it to rangeSets
-    std::shared_future<GlyphPBF &> loadGlyphRange(const std::string &fontStack, std::map<GlyphRange, std::unique_ptr<GlyphPBF>> &rangeSets, GlyphRange range);
+    // Called when a glyph range has been parsed or failed to load.
+    void onGlyphRangeLoaded(const std::string &fontStack, GlyphRange range);
 
     FontStack &createFontStack(const std::string &fontStack);
 
@@ -82,10 +131,25 @@ public:
     std::string glyphURL;
 
 private:
+    struct Range {
+        std::unique_ptr<GlyphPBF> pbf;
+        bool loaded = false;
+    };
+
+    // A callback that waits for glyph ranges to be loaded.
+    struct Request {
+        std::string fontStack;
+        std::set<GlyphRange> ranges;
+        std::function<void()> callback;
+    };
+
     const std::shared_ptr<FileSource> fileSource;
-    std::unordered_map<std::string, std::map<GlyphRange, std::unique_ptr<GlyphPBF>>> ranges;
+    std::unordered_map<std::string, std::map<GlyphRange, Range>> ranges;
     std::unordered_map<std::string, std::unique_ptr<FontStack>> stacks;
+    std::vector<Request> requests;
     std::mutex mtx;
+
+    ShapingCache shapingCache;
 };
 
 
@@ -0,0 +1,123 @@
+#ifndef MBGL_TEXT_LABEL_PLACEMENT
+#define MBGL_TEXT_LABEL_PLACEMENT
+
+#include <mbgl/text/types.hpp>
+#include <mbgl/util/mat4.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/time.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mbgl {
+
+class SymbolBucket;
+class TileData;
+class TransformState;
+
+// A label or icon that a symbol bucket has placed within its tile.
+struct SymbolInstance {
+    // Labels with the same text and icon in the same layer have the same key in all tiles.
+    uint32_t key = 0;
+
+    // Position in tile units.
+    CollisionAnchor anchor;
+
+    // Extent around the anchor in screen pixels, including padding.
+    CollisionRect box { 0, 0, 0, 0 };
+
+    // Zoom level from which the tile placement shows the label.
+    float minZoom = 0;
+
+    // Labels with the same key that are closer than this, in screen pixels, are repetitions.
+    float repeatDistance = 0;
+
+    // Whether the box rotates with the map.
+    bool rotateWithMap = false;
+
+    // Whether the label is shown when it overlaps other labels, and whether it may be overlapped.
+    bool allowOverlap = false;
+    bool ignorePlacement = false;
+
+    // Vertices of the label in the bucket's text and icon buffers.
+    uint32_t textStart = 0, textEnd = 0;
+    uint32_t iconStart = 0, iconEnd = 0;
+};
+
+// Places the labels of all rendered tiles in one index that covers the viewport, so that labels of
+// different tiles don't overlap and labels that repeat on both sides of a tile boundary are shown
+// once. The tile placement decides at which zoom levels a label can be shown within its tile;
+// this placement decides which of those labels are shown in the current view. Symbol buckets fade
+// labels in and out when that changes.
+//
+// Placement runs on the executor, so that it doesn't hold up frames. The render thread commits
+// finished placements to the buckets and starts the next one when the view or the tiles changed.
+class LabelPlacement : private util::noncopyable {
+public:
+    // The labels of a symbol bucket in the current view.
+    struct Bucket {
+        // Keeps the bucket alive while it's being placed.
+        std::shared_ptr<TileData> tile;
+        SymbolBucket *bucket = nullptr;
+
+        const std::vector<SymbolInstance> *instances = nullptr;
+
+        // Converts tile units to screen pixels.
+        mat4 matrix;
+
+        // Whether each label is shown.
+        std::vector<bool> visible;
+    };
+
+    struct View {
+        float width = 0;
+        float height = 0;
+        float zoom = 0;
+    };
+
+    // Duration of fading a label in or out.
+    static const timestamp FadeDuration;
+
+    // The callback is invoked on a worker thread when a placement has finished.
+    explicit LabelPlacement(std::function<void()> onPlaced);
+
+    // Waits for a running placement.
+    ~LabelPlacement();
+
+    // Commits a finished placement to its buckets, and starts placing the given buckets unless a
+    // placement is still running or the view and the buckets are the same as in the last one.
+    // With wait, the placement runs to completion and is committed without fading. Returns
+    // whether frames are needed to finish fading labels in and out.
+    bool update(std::vector<Bucket> buckets, const View &view, timestamp now, bool wait = false);
+
+    // Decides which labels are shown. Labels of earlier buckets, and earlier labels within a
+    // bucket, take precedence.
+    static void place(std::vector<Bucket> &buckets, const View &view);
+
+private:
+    void commit(timestamp now, bool fade);
+
+    const std::function<void()> onPlaced;
+
+    std::mutex mtx;
+    std::condition_variable finished;
+    bool running = false;
+
+    // The placement that is running or that has finished and awaits its commit.
+    std::unique_ptr<std::vector<Bucket>> pending;
+
+    // What the last placement was started with.
+    std::vector<const SymbolBucket *> placedBuckets;
+    std::vector<mat4> placedMatrices;
+    View placedView;
+
+    timestamp committed = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef MBGL_TEXT_SHAPING_CACHE
+#define MBGL_TEXT_SHAPING_CACHE
+
+#include <mbgl/text/glyph.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/vec.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace mbgl {
+
+class FontStack;
+
+// Shapings of labels, shared by all tiles that contain them. Street and place names recur across
+// many tiles and zoom levels, so most labels of a tile have been shaped before. Shapings are
+// immutable and stay valid for the tiles that use them after they have been evicted.
+//
+// The tile parsers use the cache from all worker threads. It is bounded by the bytes that its
+// entries hold and evicts the least recently used shapings first.
+class ShapingCache : private util::noncopyable {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+
+        // Bytes and number of the cached shapings.
+        size_t size = 0;
+        size_t count = 0;
+
+        // Fraction of the lookups that found a shaping.
+        double hitRate() const;
+    };
+
+    explicit ShapingCache(size_t maximumSize = 0);
+
+    void setMaximumSize(size_t size);
+    size_t getMaximumSize() const;
+
+    // Returns the shaping of the string in the font stack, and shapes it if it isn't cached yet.
+    // Shapings are only cached once the glyph ranges of all characters are loaded, since the
+    // advances of missing glyphs change the shaping until then.
+    std::shared_ptr<const Shaping> getShaping(const std::string &fontStackName, const FontStack &stack,
+                                              const std::u32string &string, float maxWidth,
+                                              float lineHeight, float horizontalAlign,
+                                              float verticalAlign, float justify, float spacing,
+                                              const vec2<float> &translate);
+
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    // Refers to the strings of the entry, or of the caller for lookups.
+    struct Key {
+        const std::string *fontStack;
+        const std::u32string *string;
+        float maxWidth, lineHeight, horizontalAlign, verticalAlign, justify, spacing;
+        float translateX, translateY;
+        size_t hash;
+
+        bool operator==(const Key &other) const;
+    };
+
+    struct KeyHash {
+        inline size_t operator()(const Key &key) const { return key.hash; }
+    };
+
+    struct Entry {
+        std::string fontStack;
+        std::u32string string;
+        std::shared_ptr<const Shaping> shaping;
+        size_t size;
+        std::list<Key>::iterator recent;
+    };
+
+    void prune();
+
+private:
+    mutable std::mutex mtx;
+    size_t maximumSize;
+    Stats stats;
+
+    // Most recently used shapings come first.
+    std::list<Key> recent;
+    std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> entries;
+};
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef MBGL_UTIL_ARENA
+#define MBGL_UTIL_ARENA
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// A monotonic allocator for short-lived scratch memory. Allocations are carved out of large
+// blocks, and individual deallocations are free. Memory is only reused after a Scope ends, and
+// the blocks are released when the arena is destroyed.
+//
+// Arenas are not thread-safe. Every thread that parses a tile uses its own arena, so parser
+// threads don't contend for the global heap.
+class Arena : private util::noncopyable {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    // Returns size bytes aligned to alignment, which must be a power of two.
+    inline void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Returns the memory to the arena if it was the last allocation, so that vectors growing
+    // at the end of the arena don't leave their previous storage behind. Otherwise, this does
+    // nothing.
+    inline void deallocate(void *ptr, size_t size);
+
+    // Rewinds the arena to where it was when the scope was created when it goes out of scope.
+    // Everything that was allocated within the scope must be destroyed by then.
+    class Scope : private util::noncopyable {
+    public:
+        inline explicit Scope(Arena &arena);
+        inline ~Scope();
+
+    private:
+        Arena &arena;
+        const size_t block;
+        char *const cursor;
+    };
+
+    // Total size of the blocks the arena has allocated.
+    size_t capacity() const { return allocated; }
+
+private:
+    struct Block {
+        char *begin;
+        char *end;
+    };
+
+    void *allocateBlock(size_t size, size_t alignment);
+
+    const size_t blockSize;
+    std::vector<Block> blocks;
+
+    // Index of the block that's being used and the free space in it.
+    size_t current = 0;
+    char *cursor = nullptr;
+    char *end = nullptr;
+
+    size_t allocated = 0;
+};
+
+void *Arena::allocate(size_t size, size_t alignment) {
+    const uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~uintptr_t(alignment - 1);
+    char *ptr = reinterpret_cast<char *>(aligned);
+    if (cursor && ptr + size <= end) {
+        cursor = ptr + size;
+        return ptr;
+    }
+    return allocateBlock(size, alignment);
+}
+
+void Arena::deallocate(void *ptr, size_t size) {
+    if (static_cast<char *>(ptr) + size == cursor) {
+        cursor = static_cast<char *>(ptr);
+    }
+}
+
+Arena::Scope::Scope(Arena &arena_)
+    : arena(arena_), block(arena_.current), cursor(arena_.cursor) {}
+
+Arena::Scope::~Scope() {
+    arena.current = block;
+    arena.cursor = cursor;
+    arena.end = block < arena.blocks.size() ? arena.blocks[block].end : nullptr;
+}
+
+// Allocates from an arena. Use it for containers that only live while a tile is parsed.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind { typedef ArenaAllocator<U> other; };
+
+    explicit ArenaAllocator(Arena &arena_) noexcept : arena(&arena_) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept {
+        arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    Arena *arena;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena != b.arena;
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MBGL_UTIL_COMPRESSION
+#define MBGL_UTIL_COMPRESSION
+
+#include <string>
+
+namespace mbgl {
+namespace util {
+
+// Returns whether the data starts with a gzip or zlib header. Vector tiles never do, since the
+// first byte of a tile is the tag of a layer message.
+bool isCompressed(const std::string &data);
+
+// Decompresses gzip or zlib data in one pass. The output buffer of gzip data is sized from the
+// uncompressed length in the gzip trailer. Throws std::runtime_error if the data is corrupt.
+std::string decompress(const std::string &data);
+
+}
+}
+
+#endif
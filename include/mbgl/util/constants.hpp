@@ -2,6 +2,7 @@
 #define MBGL_UTIL_CONSTANTS
 
 #include <cmath>
+#include <cstddef>
 
 #include "vec.hpp"
 
@@ -11,6 +12,15 @@ namespace util {
 
 extern const float tileSize;
 
+// Default number of bytes of parsed tiles that each source keeps after they left the viewport.
+extern const size_t defaultTileCacheSize;
+
+// Number of bytes of label shapings that are kept even when the tile cache is small or disabled.
+extern const size_t minimumShapingCacheSize;
+
+// Default number of texture bytes that are uploaded per frame when rendering continuously.
+extern const size_t defaultUploadBudget;
+
 }
 
 namespace debug {
@@ -0,0 +1,168 @@
+#ifndef MBGL_UTIL_EXECUTOR
+#define MBGL_UTIL_EXECUTOR
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// A fixed pool of worker threads that runs tile parsing, glyph parsing and image decoding.
+//
+// Every worker has its own task queue, ordered by priority. Tasks posted from a worker go to that
+// worker's queue; other tasks are distributed round-robin. Workers run the most urgent task of
+// their own queue, and steal from the queues of other workers once their own queue is empty.
+//
+// Cancellation is cooperative: tasks should check whether their result is still needed (e.g. by
+// checking if their tile is obsolete) and return early.
+class Executor : private util::noncopyable {
+public:
+    typedef std::function<void()> Task;
+
+    // Tasks with lower values run first.
+    typedef int32_t Priority;
+
+    // Tile parsing uses the tile's distance to the viewport center in screen pixels as the priority.
+    static const Priority DefaultPriority = 0;
+
+    // For resources that tile parsing waits for, like glyphs and sprites.
+    static const Priority ResourcePriority = -1;
+
+    // For the label placement, which the next frame waits for.
+    static const Priority PlacementPriority = -2;
+
+    struct Stats {
+        // Tasks that are queued or running right now.
+        size_t queued = 0;
+        size_t running = 0;
+
+        size_t maxQueued = 0;
+        uint64_t completed = 0;
+
+        // Time the completed tasks have spent in the queue, in microseconds.
+        uint64_t totalWait = 0;
+        uint64_t maxWait = 0;
+    };
+
+    Executor(size_t threads);
+
+    // Calls shutdown().
+    ~Executor();
+
+    // Tasks posted after shutdown() run synchronously on the calling thread.
+    void post(Task task, Priority priority = DefaultPriority);
+
+    // Returns the current priority of a task while it is queued. It is called with the queue
+    // locked, so it must be cheap, e.g. read an atomic.
+    typedef std::function<Priority()> Rank;
+
+    // Like post(), but the task is ranked again after reprioritize() was called. Tile parsing uses
+    // this, since the distance of a tile to the viewport center changes while its task waits.
+    void post(Task task, Rank rank);
+
+    // Makes every queue rank its tasks again before its next task is taken.
+    void reprioritize();
+
+    // Stops the workers after they've run all queued tasks and joins them. Must not be called
+    // from a worker thread.
+    void shutdown();
+
+    size_t getThreadCount() const;
+    Stats getStats() const;
+
+    // The process-wide executor.
+    static Executor &shared();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        Priority priority;
+        uint64_t sequence;
+        Clock::time_point queued;
+        Task task;
+        Rank rank;
+
+        // Orders a heap so that the front is the entry with the lowest priority value, and
+        // entries of equal priority in the order in which they were posted.
+        bool operator<(const Entry &other) const {
+            return priority != other.priority ? priority > other.priority : sequence > other.sequence;
+        }
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::vector<Entry> queue;
+        std::thread thread;
+
+        // The generation the queue was last ranked in.
+        uint64_t generation = 0;
+    };
+
+    void push(Task task, Priority priority, Rank rank);
+    void run(size_t index);
+    bool pop(size_t index, Entry &entry);
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint64_t> sequence { 0 };
+
+    // Incremented by reprioritize().
+    std::atomic<uint64_t> generation { 0 };
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    size_t pending = 0;
+    bool started = false;
+    bool terminate = false;
+    bool stopped = false;
+    Stats stats;
+};
+
+// Runs a batch of tasks on an executor and waits for all of them to complete. The waiting thread
+// takes part in running the tasks, so waiting on a group from within an executor task can't
+// deadlock.
+class TaskGroup : private util::noncopyable {
+public:
+    TaskGroup(Executor &executor, Executor::Priority priority = Executor::DefaultPriority);
+    ~TaskGroup();
+
+    // Tasks must be added before calling wait().
+    void add(Executor::Task task);
+
+    // Blocks until all tasks have completed. Rethrows the first exception a task has thrown.
+    void wait();
+
+private:
+    struct State {
+        std::vector<Executor::Task> tasks;
+        std::atomic<size_t> claimed { 0 };
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t finished = 0;
+        std::exception_ptr error;
+
+        bool runNext();
+    };
+
+    Executor &executor;
+    const Executor::Priority priority;
+    std::shared_ptr<State> state;
+    bool waited = false;
+};
+
+}
+}
+
+#endif
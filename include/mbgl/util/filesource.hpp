@@ -2,10 +2,13 @@
 #define MBGL_UTIL_FILESOURCE
 
 #include <mbgl/util/uv.hpp>
+#include <mbgl/util/request_scheduler.hpp>
 
 #include <string>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <map>
 
 namespace mbgl {
 
@@ -13,6 +16,9 @@ namespace platform {
 struct Response;
 }
 
+class SQLiteCache;
+class MBTiles;
+
 enum class ResourceType : uint8_t {
     Unknown,
     Tile,
@@ -24,18 +30,41 @@ enum class ResourceType : uint8_t {
 class FileSource {
 public:
     FileSource();
+    ~FileSource();
 
     void setBase(const std::string &value);
     const std::string &getBase() const;
 
-    void load(ResourceType type, const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> loop = nullptr);
+    // Enables a persistent cache for HTTP resources stored at the given path. An empty path
+    // disables the cache.
+    void setCacheDatabase(const std::string &path, uint64_t maximumSize = 50 * 1024 * 1024);
+
+    // Returns a ticket that can be used to change the priority of the request while it is waiting
+    // for a network connection, and to cancel it.
+    typedef std::shared_ptr<util::RequestScheduler::Ticket> Ticket;
+    Ticket load(ResourceType type, const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> loop = nullptr);
+
+private:
+    void loadHTTP(ResourceType type, const std::string &url, const Ticket &ticket, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop);
+    void loadMBTiles(const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop);
+
+    std::shared_ptr<MBTiles> getMBTiles(const std::string &path);
 
 private:
     // Stores a URL that is used as a base for loading resources with relative path.
     std::string base;
 
-    // Stores the absolute path to the cache directory.
-    const std::string cache;
+    // Persistent cache for HTTP responses. It is shared with in-flight requests, which may outlive
+    // the FileSource object.
+    std::shared_ptr<SQLiteCache> cache;
+
+    // Limits the number of concurrent requests per host and orders waiting requests by priority.
+    // In-flight requests hold a weak reference to it.
+    const std::shared_ptr<util::RequestScheduler> scheduler;
+
+    // Open MBTiles archives, keyed by path.
+    std::mutex mbtilesMutex;
+    std::map<std::string, std::shared_ptr<MBTiles>> mbtiles;
 };
 
 }
@@ -0,0 +1,35 @@
+#ifndef MBGL_UTIL_MBTILES
+#define MBGL_UTIL_MBTILES
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+namespace sqlite {
+class Database;
+}
+
+namespace mbgl {
+
+// Read-only access to a tile archive in the MBTiles format (http://mbtiles.org). Tiles are stored
+// in TMS order, so the y coordinate is flipped on lookup.
+class MBTiles : private util::noncopyable {
+public:
+    MBTiles(const std::string &path);
+    ~MBTiles();
+
+    // Returns false if the archive doesn't contain the tile, or if the coordinates are outside of
+    // the tile pyramid.
+    bool getTile(int8_t z, int32_t x, int32_t y, std::string &data);
+
+private:
+    std::mutex mtx;
+    std::unique_ptr<sqlite::Database> db;
+};
+
+}
+
+#endif
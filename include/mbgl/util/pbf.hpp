@@ -8,6 +8,8 @@
  * Author: Josh Haberman <jhaberman@gmail.com>
  */
 
+#include <mbgl/util/varint.hpp>
+
 #include <string>
 #include <cstring>
 
@@ -30,6 +32,9 @@ struct pbf {
     template <typename T = uint32_t> inline T varint();
     template <typename T = uint32_t> inline T svarint();
 
+    // Decodes count consecutive zigzag-encoded varints, e.g. the coordinates of a geometry.
+    inline void svarints(int32_t *out, size_t count);
+
     template <typename T = uint32_t, int bytes = 4> inline T fixed();
     inline float float32();
     inline double float64();
@@ -114,6 +119,16 @@ T pbf::svarint() {
     return (n >> 1) ^ -(T)(n & 1);
 }
 
+void pbf::svarints(int32_t *out, size_t count) {
+    uint32_t *values = reinterpret_cast<uint32_t *>(out);
+    const uint8_t *pos = util::decodeVarints(data, end, values, count);
+    if (!pos) {
+        throw unterminated_varint_exception();
+    }
+    data = pos;
+    util::decodeZigZag(values, count);
+}
+
 template <typename T, int bytes>
 T pbf::fixed() {
     skipBytes(bytes);
@@ -14,6 +14,8 @@ typedef struct uv_loop_s uv_loop_t;
 
 namespace mbgl {
 
+class UploadScheduler;
+
 class Raster : public std::enable_shared_from_this<Raster> {
 
 public:
@@ -29,9 +31,23 @@ public:
     // bind prerendered texture
     void bind(const GLuint texture);
 
+    // Uploads the texture if the scheduler has room for it in the current frame. Returns whether
+    // the raster has a texture.
+    bool upload(UploadScheduler &scheduler);
+
     // loaded status
     bool isLoaded() const;
 
+    // Keeps the decoded pixels after uploading them so that the texture can be released and
+    // recreated later.
+    void setRetainAfterUpload(bool value);
+
+    // Returns the texture to the pool if we still have the pixels to recreate it.
+    void releaseGPU();
+
+    // Returns the number of bytes of decoded pixels held in main memory.
+    size_t bytes() const;
+
     // transitions
     void beginFadeInTransition();
     bool needsTransition() const;
@@ -50,6 +66,9 @@ public:
     // texture opacity
     double opacity = 0;
 
+private:
+    void createTexture(GLuint texture);
+
 private:
     mutable std::mutex mtx;
 
@@ -62,6 +81,9 @@ private:
     // min/mag filter
     uint32_t filter = 0;
 
+    // keep the raw pixels after uploading them
+    bool retain = false;
+
     // the raw pixels
     std::unique_ptr<util::Image> img;
 
@@ -0,0 +1,157 @@
+#ifndef MBGL_UTIL_REQUEST_SCHEDULER
+#define MBGL_UTIL_REQUEST_SCHEDULER
+
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/uv.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mbgl {
+
+namespace platform {
+struct Response;
+class Request;
+}
+
+namespace util {
+
+// Queues network requests in front of platform::request_http.
+//
+// Only a limited number of requests per host are in flight at any time; the others wait in a queue
+// ordered by priority. Callers can change the priority of their requests while they are queued, and
+// cancelling a queued request just removes it from the queue. Requests for a URL that is already
+// queued or in flight are attached to the existing request instead of hitting the network again.
+class RequestScheduler : public std::enable_shared_from_this<RequestScheduler>,
+                         private util::noncopyable {
+    struct Entry;
+
+public:
+    typedef std::function<void(platform::Response *)> Callback;
+
+    // Requests with lower values start first. Tiles use their distance to the viewport center in
+    // screen pixels.
+    typedef int32_t Priority;
+    static const Priority DefaultPriority = 0;
+
+    // For glyphs, sprites and other resources that tiles depend on.
+    static const Priority ResourcePriority = -1;
+
+    // A caller's interest in a URL. The callback is invoked at most once, and not at all if the
+    // ticket is cancelled before the response arrives.
+    class Ticket : private util::noncopyable {
+    public:
+        Ticket(Priority priority = DefaultPriority);
+
+        // Re-ranks the request if it is still queued.
+        void setPriority(Priority priority);
+        Priority getPriority() const;
+
+        // Drops the request from the queue, or cancels it if it is in flight and no other ticket
+        // waits for the same URL.
+        void cancel();
+        bool isCancelled() const;
+
+    private:
+        friend class RequestScheduler;
+
+        std::atomic<Priority> priority;
+        std::atomic<bool> cancelled;
+
+        // Set once the ticket was queued.
+        std::mutex mutex;
+        std::weak_ptr<RequestScheduler> scheduler;
+
+        // Guarded by the scheduler's mutex.
+        std::weak_ptr<Entry> entry;
+    };
+
+    struct Stats {
+        size_t queued = 0;
+        size_t active = 0;
+
+        uint64_t started = 0;
+        uint64_t completed = 0;
+
+        // Tickets that were attached to an existing request for the same URL.
+        uint64_t deduplicated = 0;
+
+        // Requests that were dropped from the queue or cancelled in flight.
+        uint64_t cancelled = 0;
+    };
+
+    RequestScheduler(size_t maximumRequestsPerHost = 6);
+    ~RequestScheduler();
+
+    // Queues a request for the URL. The callback is invoked on the loop thread, or on an arbitrary
+    // thread if no loop is given. Cancelled tickets are ignored. The validators are passed on to
+    // platform::request_http; only requests with the same validators are merged.
+    void request(const std::shared_ptr<Ticket> &ticket, const std::string &url, Callback callback,
+                 const std::shared_ptr<uv::loop> &loop = nullptr,
+                 const std::string &etag = "", int64_t modified = 0);
+
+    Stats getStats() const;
+
+    // Returns the host part of a URL, e.g. "a.tiles.mapbox.com" for
+    // "http://a.tiles.mapbox.com/v3/mapbox.mapbox-streets-v5/1/0/0.vector.pbf".
+    static std::string getHost(const std::string &url);
+
+private:
+    typedef std::tuple<std::string, uv::loop *, std::string, int64_t> Key;
+
+    struct Subscriber {
+        std::shared_ptr<Ticket> ticket;
+        Callback callback;
+    };
+
+    struct Entry {
+        enum class State : uint8_t { Queued, Active, Finished };
+
+        std::string url;
+        std::string host;
+        std::shared_ptr<uv::loop> loop;
+        std::string etag;
+        int64_t modified = 0;
+        State state = State::Queued;
+        uint64_t sequence = 0;
+        std::vector<Subscriber> subscribers;
+        std::shared_ptr<platform::Request> request;
+
+        // The most urgent priority of all subscribers.
+        Priority getPriority() const;
+
+        Key getKey() const;
+    };
+
+    typedef std::vector<std::shared_ptr<Entry>> Entries;
+
+    void cancel(Ticket &ticket);
+
+    // Moves the most urgent queued requests of hosts below the limit to the active state. Must be
+    // called with the mutex locked; the returned entries are started with start() after unlocking.
+    Entries dequeue();
+    void start(const Entries &entries);
+    static void finish(const std::weak_ptr<RequestScheduler> &scheduler, const std::shared_ptr<Entry> &entry, platform::Response *res);
+
+private:
+    const size_t maximumRequestsPerHost;
+
+    mutable std::mutex mutex;
+    std::map<Key, std::shared_ptr<Entry>> entries;
+    Entries queue;
+    std::map<std::string, size_t> activePerHost;
+    uint64_t sequence = 0;
+    Stats stats;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef MBGL_UTIL_SQLITE3
+#define MBGL_UTIL_SQLITE3
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <string>
+#include <stdexcept>
+#include <chrono>
+#include <cstdint>
+
+typedef struct sqlite3 sqlite3;
+typedef struct sqlite3_stmt sqlite3_stmt;
+
+namespace sqlite {
+
+enum OpenFlag : int {
+    ReadOnly = 0x00000001,
+    ReadWrite = 0x00000002,
+    Create = 0x00000004,
+    NoMutex = 0x00008000,
+    FullMutex = 0x00010000,
+    SharedCache = 0x00020000,
+    PrivateCache = 0x00040000,
+};
+
+struct Exception : std::runtime_error {
+    inline Exception(int err, const char *msg) : std::runtime_error(msg), code(err) {}
+    const int code = 0;
+};
+
+class Statement;
+
+class Database : private mbgl::util::noncopyable {
+public:
+    Database(const std::string &filename, int flags = 0);
+    ~Database();
+
+    explicit operator bool() const;
+
+    // Makes statements retry for up to the timeout while another connection holds a lock,
+    // instead of failing with SQLITE_BUSY right away.
+    void setBusyTimeout(std::chrono::milliseconds timeout);
+
+    void exec(const std::string &sql);
+    Statement prepare(const char *query);
+
+private:
+    sqlite3 *db = nullptr;
+};
+
+class Statement : private mbgl::util::noncopyable {
+private:
+    void check(int err);
+
+public:
+    Statement(sqlite3 *db, const char *sql);
+    Statement(Statement &&other);
+    ~Statement();
+
+    explicit operator bool() const;
+
+    template <typename T> void bind(int offset, T value);
+    void bind(int offset, const std::string &value, bool retain = true);
+    void bindBlob(int offset, const std::string &value, bool retain = true);
+    template <typename T> T get(int offset);
+
+    // Steps the statement. Returns true if there is a row available.
+    bool run();
+    void reset();
+
+private:
+    sqlite3_stmt *stmt = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef MBGL_UTIL_SQLITE_CACHE
+#define MBGL_UTIL_SQLITE_CACHE
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <cstdint>
+
+namespace sqlite {
+class Database;
+}
+
+namespace mbgl {
+
+enum class ResourceType : uint8_t;
+
+namespace platform {
+struct Response;
+}
+
+// Persistent HTTP response cache stored in a SQLite database. Entries are keyed by URL and
+// resource type and carry the HTTP validity information of the original response. The cache
+// is trimmed to a maximum size by evicting the least recently accessed entries.
+//
+// All methods are thread-safe. Lookups either block the caller, or are queued and run by a
+// dedicated reader thread. Writes are queued and applied by a dedicated writer thread so that
+// they never stall the caller.
+class SQLiteCache : private util::noncopyable {
+public:
+    SQLiteCache(const std::string &path, uint64_t maximumSize);
+    ~SQLiteCache();
+
+    // Looks up a cached response. Returns false if there is no entry. Otherwise fills in the
+    // response and returns true; the caller has to compare `expires` against the current time to
+    // determine whether the entry is still fresh. The access time of the entry is updated by the
+    // writer thread if it is older than an hour.
+    bool get(ResourceType type, const std::string &url, platform::Response &response);
+
+    // Like get(), but queues the lookup and calls the callback with its result on the reader
+    // thread. The response must stay alive until then. The callback must not release the last
+    // reference to the cache, since the reader thread can't join itself.
+    typedef std::function<void(bool found)> LookupCallback;
+    void get(ResourceType type, const std::string &url, platform::Response &response, LookupCallback callback);
+
+    // Stores a successful response and evicts old entries if the cache grew too large.
+    void put(ResourceType type, const std::string &url, const platform::Response &response);
+
+    // Updates the expiration time of an existing entry without rewriting its data.
+    void refresh(ResourceType type, const std::string &url, int64_t expires);
+
+    // Blocks until all queued writes have been applied.
+    void flush();
+
+    uint64_t getSize() const;
+
+private:
+    enum class Operation : uint8_t {
+        Store,
+        Refresh,
+        Access,
+    };
+
+    struct Write {
+        ResourceType type;
+        std::string url;
+        Operation operation;
+        int16_t code;
+        int64_t modified;
+        int64_t expires;
+        std::string etag;
+        std::string body;
+    };
+
+    struct Lookup {
+        ResourceType type;
+        std::string url;
+        platform::Response *response;
+        LookupCallback callback;
+    };
+
+    void createSchema();
+    void read();
+    void process();
+    void store(const Write &write);
+    void touch(const Write &write);
+    void access(const Write &write);
+    void prune();
+
+private:
+    const std::string path;
+    const uint64_t maximumSize;
+
+    // Guards the database connection and the size counter. The connection is used by the writer
+    // thread only.
+    mutable std::mutex mtx;
+    std::unique_ptr<sqlite::Database> db;
+    uint64_t size = 0;
+
+    // Guards the read-only connection used for lookups. With WAL, lookups don't wait for the
+    // writer's transactions.
+    std::mutex readMutex;
+    std::unique_ptr<sqlite::Database> readDb;
+
+    // Guards the write queue.
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::condition_variable flushCondition;
+    std::queue<Write> writes;
+    bool writing = false;
+    bool terminate = false;
+    std::thread writer;
+
+    // Guards the lookup queue.
+    std::mutex lookupMutex;
+    std::condition_variable lookupCondition;
+    std::queue<Lookup> lookups;
+    bool terminateReader = false;
+    std::thread reader;
+};
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef MBGL_UTIL_STRING_VIEW
+#define MBGL_UTIL_STRING_VIEW
+
+#include <string>
+#include <cstring>
+#include <ostream>
+
+namespace mbgl {
+namespace util {
+
+// A non-owning reference to a range of characters, e.g. a string stored inside of a tile buffer.
+// The referenced memory must outlive the view.
+class string_view {
+public:
+    string_view() {}
+    string_view(const char *str, size_t length) : data_(str), size_(length) {}
+    string_view(const std::string &str) : data_(str.data()), size_(str.size()) {}
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+
+    std::string to_string() const { return std::string(data_, size_); }
+
+    inline bool operator==(const string_view &other) const {
+        return size_ == other.size_ && (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+    }
+
+    inline bool operator!=(const string_view &other) const {
+        return !(*this == other);
+    }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const string_view &str) {
+    return os.write(str.data(), str.size());
+}
+
+}
+}
+
+#endif
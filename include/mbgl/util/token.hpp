@@ -1,40 +1,63 @@
 #ifndef MBGL_UTIL_TOKEN
 #define MBGL_UTIL_TOKEN
 
-#ifdef __linux__
-#include <boost/regex.hpp>
-namespace regex_impl = boost;
-#else
-#include <regex>
-namespace regex_impl = std;
-#endif
-
+#include <cstdint>
 #include <map>
+#include <string>
+#include <vector>
 
 namespace mbgl {
 namespace util {
 
-namespace detail {
-const regex_impl::regex tokenRegex("\\{([\\w-]+)\\}");
-const regex_impl::sregex_token_iterator tokensEnd = regex_impl::sregex_token_iterator();
-}
+// A string with {token} placeholders. Token names consist of letters, digits, underscores and
+// dashes; braces around anything else are literal text. The string is split into literal text and
+// tokens once, so that expanding it for every feature of a layer doesn't parse it again.
+class TokenTemplate {
+public:
+    TokenTemplate() = default;
+    TokenTemplate(const std::string &source);
+    TokenTemplate(const char *source);
 
-template <typename Lookup>
-std::string replaceTokens(const std::string &source, const Lookup &lookup) {
-    std::string result;
-    result.reserve(source.size());
+    inline const std::string &getSource() const { return source; }
+    inline bool empty() const { return source.empty(); }
 
-    bool token = false;
-    for (auto token_it = regex_impl::sregex_token_iterator(source.begin(), source.end(),
-                                                           detail::tokenRegex, {-1, 1});
-        token_it != detail::tokensEnd; ++token_it, token = !token) {
-        if (!token_it->matched) {
-            continue;
-        }
+    // Names of the tokens in the order of their first occurrence. Expansion refers to tokens by
+    // their index in this list, so that lookups can be resolved once, e.g. to the keys of a layer.
+    inline const std::vector<std::string> &getTokens() const { return tokens; }
 
-        result += token ? lookup(token_it->str()) : token_it->str();
+    // Appends the expansion to the result. For every token, lookup(index, result) appends its value.
+    template <typename Lookup>
+    void expand(std::string &result, const Lookup &lookup) const {
+        for (const Segment &segment : segments) {
+            if (segment.token >= 0) {
+                lookup(size_t(segment.token), result);
+            } else {
+                result.append(source, segment.begin, segment.length);
+            }
+        }
     }
 
+private:
+    // Literal text of the source, or a token.
+    struct Segment {
+        uint32_t begin;
+        uint32_t length;
+        int32_t token;
+    };
+
+    std::string source;
+    std::vector<std::string> tokens;
+    std::vector<Segment> segments;
+};
+
+template <typename Lookup>
+std::string replaceTokens(const std::string &source, const Lookup &lookup) {
+    const TokenTemplate tokens(source);
+    std::string result;
+    result.reserve(source.size());
+    tokens.expand(result, [&](size_t token, std::string &out) {
+        out += lookup(tokens.getTokens()[token]);
+    });
     return result;
 }
 
@@ -1,49 +1,52 @@
 #ifndef MBGL_UTIL_UTF
 #define MBGL_UTIL_UTF
 
-#include <memory>
-
-// g++/libstdc++ is missing c++11 codecvt support
-#ifdef __linux__
-#pragma GCC diagnostic push
-#ifndef __clang__
-#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
-#endif
-#include <boost/locale.hpp>
-#pragma GCC diagnostic pop
-#else
-#include <codecvt>
-#include <locale>
-#endif
+#include <cstddef>
+#include <string>
 
 namespace mbgl {
 
 namespace util {
 
-#ifdef __linux__
+// Decodes UTF-8 and appends the code points to the result. Invalid bytes, truncated sequences,
+// overlong encodings and surrogates are skipped; a truncated sequence doesn't swallow the byte that
+// follows it. Returns whether the input was valid.
+bool utf8ToUtf32(const char *data, size_t size, std::u32string &result);
+
+inline bool utf8ToUtf32(const std::string &utf8, std::u32string &result) {
+    return utf8ToUtf32(utf8.data(), utf8.size(), result);
+}
 
-class utf8_to_utf32 {
- public:
-    explicit utf8_to_utf32() {}
-    std::u32string convert(std::string const& utf8) {
-        return boost::locale::conv::utf_to_utf<char32_t>(utf8);
+// Simple case mappings of the Basic Multilingual Plane: characters whose other case consists of
+// several characters, like ß, and characters outside of the plane keep their case.
+char32_t toUpperSlow(char32_t c);
+char32_t toLowerSlow(char32_t c);
+
+inline char32_t toUpper(char32_t c) {
+    if (c < 0x80) {
+        return c >= 'a' && c <= 'z' ? c - ('a' - 'A') : c;
     }
-};
+    return toUpperSlow(c);
+}
 
-#else
+inline char32_t toLower(char32_t c) {
+    if (c < 0x80) {
+        return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+    }
+    return toLowerSlow(c);
+}
 
-class utf8_to_utf32 {
- public:
-    explicit utf8_to_utf32()
-        : utf32conv_() {}
-    std::u32string convert(std::string const& utf8) {
-        return utf32conv_.from_bytes(utf8);
+inline void toUpper(std::u32string &string) {
+    for (char32_t &c : string) {
+        c = toUpper(c);
     }
- private:
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> utf32conv_;
-};
+}
 
-#endif
+inline void toLower(std::u32string &string) {
+    for (char32_t &c : string) {
+        c = toLower(c);
+    }
+}
 
 }}
 
@@ -0,0 +1,148 @@
+#ifndef MBGL_UTIL_VARINT
+#define MBGL_UTIL_VARINT
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MBGL_VARINT_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MBGL_VARINT_NEON 1
+#endif
+
+namespace mbgl {
+namespace util {
+
+// Decodes one varint, keeping the lower 32 bits. Returns a pointer past the varint, or nullptr if
+// the varint is unterminated or longer than 10 bytes.
+inline const uint8_t *decodeVarint(const uint8_t *data, const uint8_t *end, uint32_t &value) {
+    // Most varints in vector tiles are one or two bytes long.
+    if (data < end && !(data[0] & 0x80)) {
+        value = data[0];
+        return data + 1;
+    }
+    if (end - data >= 2 && !(data[1] & 0x80)) {
+        value = (data[0] & 0x7F) | (uint32_t(data[1]) << 7);
+        return data + 2;
+    }
+
+    uint32_t result = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        if (data >= end) {
+            return nullptr;
+        }
+        const uint8_t byte = *data++;
+        if (shift < 32) {
+            result |= uint32_t(byte & 0x7F) << shift;
+        }
+        if (!(byte & 0x80)) {
+            value = result;
+            return data;
+        }
+    }
+    return nullptr;
+}
+
+// Decodes count varints with the scalar decoder. Bounds are only checked per byte near the end
+// of the buffer, where a varint of the maximum length might not fit. One and two byte varints
+// are decoded without branching on their length, since the lengths of coordinate deltas are
+// mixed unpredictably.
+inline const uint8_t *decodeVarintsScalar(const uint8_t *data, const uint8_t *end, uint32_t *out, size_t count) {
+    size_t i = 0;
+    for (; i < count && end - data >= 10; i++) {
+        const uint32_t b0 = data[0];
+        const uint32_t b1 = data[1];
+        if (!(b0 & b1 & 0x80)) {
+            const uint32_t two = b0 >> 7;
+            out[i] = (b0 & 0x7F) | (((b1 & 0x7F) << 7) & -two);
+            data += 1 + two;
+            continue;
+        }
+
+        uint32_t value = (b0 & 0x7F) | ((b1 & 0x7F) << 7);
+        data += 2;
+        for (int shift = 14; ; shift += 7) {
+            const uint32_t byte = *data++;
+            if (shift < 32) {
+                value |= (byte & 0x7F) << shift;
+            }
+            if (!(byte & 0x80)) {
+                break;
+            } else if (shift == 63) {
+                // Longer than 10 bytes.
+                return nullptr;
+            }
+        }
+        out[i] = value;
+    }
+    for (; i < count && data; i++) {
+        data = decodeVarint(data, end, out[i]);
+    }
+    return data;
+}
+
+// Decodes count varints into out. Runs of 16 single-byte varints are widened with one vector
+// operation on SSE2 and NEON; everything else goes through the scalar decoder. Returns a pointer
+// past the last varint, or nullptr if the data ends early.
+inline const uint8_t *decodeVarints(const uint8_t *data, const uint8_t *end, uint32_t *out, size_t count) {
+    while (count) {
+#if MBGL_VARINT_SSE2
+        if (count >= 16 && end - data >= 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            if (_mm_movemask_epi8(bytes) == 0) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4), _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8), _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 12), _mm_unpackhi_epi16(hi, zero));
+                data += 16;
+                out += 16;
+                count -= 16;
+                continue;
+            }
+        }
+#elif MBGL_VARINT_NEON
+        if (count >= 16 && end - data >= 16) {
+            const uint8x16_t bytes = vld1q_u8(data);
+            const uint64x2_t high = vreinterpretq_u64_u8(vandq_u8(bytes, vdupq_n_u8(0x80)));
+            if ((vgetq_lane_u64(high, 0) | vgetq_lane_u64(high, 1)) == 0) {
+                const uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+                const uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+                vst1q_u32(out, vmovl_u16(vget_low_u16(lo)));
+                vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo)));
+                vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+                vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi)));
+                data += 16;
+                out += 16;
+                count -= 16;
+                continue;
+            }
+        }
+#endif
+        // Decode up to the next vector-sized block with the scalar decoder.
+        const size_t n = count < 16 ? count : 16;
+        data = decodeVarintsScalar(data, end, out, n);
+        if (!data) {
+            return nullptr;
+        }
+        out += n;
+        count -= n;
+    }
+    return data;
+}
+
+// Reverses the zigzag encoding of signed varints in place.
+inline void decodeZigZag(uint32_t *values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        values[i] = (values[i] >> 1) ^ -(values[i] & 1);
+    }
+}
+
+}
+}
+
+#endif
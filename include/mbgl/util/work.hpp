@@ -0,0 +1,80 @@
+#ifndef MBGL_UTIL_WORK
+#define MBGL_UTIL_WORK
+
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/uv_detail.hpp>
+
+#include <memory>
+
+namespace mbgl {
+namespace util {
+
+// Like uv::work, but runs the work callback on the shared executor with the given priority. The
+// after work callback is invoked on the loop thread, and the object deletes itself afterwards.
+// Must be created on the loop thread.
+template <typename T>
+class work : private util::noncopyable {
+public:
+    typedef void (*work_callback)(T &object);
+    typedef void (*after_work_callback)(T &object);
+
+    template<typename... Args>
+    work(const std::shared_ptr<uv::loop> &loop, Executor::Priority priority, work_callback work_cb, after_work_callback after_work_cb, Args&&... args)
+        : work(Init(), loop, work_cb, after_work_cb, std::forward<Args>(args)...) {
+        Executor::shared().post([this]() {
+            run();
+        }, priority);
+    }
+
+    // The task is ranked again when the executor's priorities change. The rank is only called
+    // while the task is queued, so it may refer to the data of this object.
+    template<typename... Args>
+    work(const std::shared_ptr<uv::loop> &loop, Executor::Rank rank, work_callback work_cb, after_work_callback after_work_cb, Args&&... args)
+        : work(Init(), loop, work_cb, after_work_cb, std::forward<Args>(args)...) {
+        Executor::shared().post([this]() {
+            run();
+        }, std::move(rank));
+    }
+
+private:
+    // Distinguishes the constructor that both public constructors delegate to.
+    struct Init {};
+
+    template<typename... Args>
+    work(Init, const std::shared_ptr<uv::loop> &loop, work_callback work_cb, after_work_callback after_work_cb, Args&&... args)
+        : loop(loop),
+          async(new uv_async_t()),
+          data(std::forward<Args>(args)...),
+          work_cb(work_cb),
+          after_work_cb(after_work_cb) {
+        // The async handle keeps the loop alive until the work is done.
+        async->data = this;
+        uv_async_init(**loop, async, after_work);
+    }
+
+    void run() {
+        work_cb(data);
+        uv_async_send(async);
+    }
+
+    static void after_work(uv_async_t *async) {
+        work<T> *w = static_cast<work<T> *>(async->data);
+        w->after_work_cb(w->data);
+        uv_close((uv_handle_t *)async, [](uv_handle_t *handle) {
+            delete static_cast<work<T> *>(handle->data);
+            delete (uv_async_t *)handle;
+        });
+    }
+
+private:
+    std::shared_ptr<uv::loop> loop;
+    uv_async_t *async;
+    T data;
+    work_callback work_cb;
+    after_work_callback after_work_cb;
+};
+
+}
+}
+
+#endif
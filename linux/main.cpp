@@ -1,6 +1,7 @@
 #include <mbgl/mbgl.hpp>
 #include <mbgl/platform/platform.hpp>
 #include <mbgl/util/uv.hpp>
+#include <mbgl/util/filesource.hpp>
 
 #include <signal.h>
 #include <getopt.h>
@@ -63,6 +64,9 @@ int main(int argc, char *argv[]) {
         map.setAccessToken(std::string(token));
     }
 
+    // Keep downloaded resources around between runs
+    map.getFileSource()->setCacheDatabase(uv::cwd() + "/cache.db");
+
     // Load style
     const std::string style = std::string("file://") + uv::cwd() + std::string("/styles/bright/style.json");
     map.setStyleURL(style);
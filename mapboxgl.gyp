@@ -134,6 +134,7 @@
         'OTHER_CPLUSPLUSFLAGS':[
           '<@(png_cflags)',
           '<@(uv_cflags)',
+          '<@(sqlite3_cflags)',
           '-I<(boost_root)/include',
         ]
       },
@@ -142,6 +143,7 @@
       ],
       'cflags': [
           '<@(png_cflags)',
+          '<@(sqlite3_cflags)',
           '-I<(boost_root)/include',
       ],
       'direct_dependent_settings': {
@@ -164,12 +166,16 @@
                 'OTHER_LDFLAGS': [
                     '<@(png_libraries)',
                     '<@(uv_libraries)',
+                    '<@(sqlite3_libraries)',
+                    '-lz',
                 ]
               }
             }, {
               'libraries': [
                 '<@(png_libraries)',
                 '<@(uv_libraries)',
+                '<@(sqlite3_libraries)',
+                '-lz',
               ]
             }]
           ]
@@ -204,6 +210,7 @@
         'OTHER_CPLUSPLUSFLAGS':[
           '<@(png_cflags)',
           '<@(uv_cflags)',
+          '<@(sqlite3_cflags)',
           '-I<(boost_root)/include',
         ]
       },
@@ -213,6 +220,7 @@
       'cflags': [
           '<@(png_cflags)',
           '<@(uv_cflags)',
+          '<@(sqlite3_cflags)',
           '-I<(boost_root)/include',
       ],
       'direct_dependent_settings': {
@@ -235,12 +243,16 @@
                 'OTHER_LDFLAGS': [
                     '<@(png_libraries)',
                     '<@(uv_libraries)',
+                    '<@(sqlite3_libraries)',
+                    '-lz',
                 ]
               }
             }, {
               'libraries': [
                 '<@(png_libraries)',
-                '<@(uv_libraries)'
+                '<@(uv_libraries)',
+                '<@(sqlite3_libraries)',
+                '-lz',
               ]
             }]
           ]
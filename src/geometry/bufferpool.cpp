@@ -0,0 +1,144 @@
+#include <mbgl/geometry/bufferpool.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+using namespace mbgl;
+
+// Allocations start at multiples of this, so that any vertex attribute or index type can be read
+// from their beginning.
+const size_t BufferAlignment = 16;
+
+// Large allocations get buffers that are a multiple of this.
+const size_t BufferGranularity = 64 * 1024;
+
+// Number of empty buffers per target that are kept for new tiles.
+const size_t IdleBuffers = 1;
+
+Bufferpool::Bufferpool(size_t pageSize_) : pageSize(pageSize_) {}
+
+Bufferpool::~Bufferpool() {
+    for (const Page &page : pages) {
+        glDeleteBuffers(1, &page.buffer);
+    }
+}
+
+Bufferpool::Allocation Bufferpool::allocate(GLenum target, size_t length) {
+    length = std::max(BufferAlignment, (length + BufferAlignment - 1) & ~(BufferAlignment - 1));
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // Pick the smallest free range that fits, to keep the large ranges for large tiles.
+    Page *page = nullptr;
+    std::map<size_t, size_t>::iterator range;
+    for (Page &candidate : pages) {
+        if (candidate.target != target || candidate.capacity - candidate.used < length) {
+            continue;
+        }
+        for (auto it = candidate.free.begin(); it != candidate.free.end(); ++it) {
+            if (it->second >= length && (!page || it->second < range->second)) {
+                page = &candidate;
+                range = it;
+            }
+        }
+    }
+
+    if (!page) {
+        Page created;
+        created.target = target;
+        created.capacity = length <= pageSize ? pageSize : (length + BufferGranularity - 1) & ~(BufferGranularity - 1);
+        created.used = 0;
+        created.free.emplace(0, created.capacity);
+
+        glGenBuffers(1, &created.buffer);
+        glBindBuffer(target, created.buffer);
+        glBufferData(target, created.capacity, nullptr, GL_DYNAMIC_DRAW);
+
+        pages.push_back(std::move(created));
+        page = &pages.back();
+        range = page->free.begin();
+    }
+
+    Allocation allocation;
+    allocation.buffer = page->buffer;
+    allocation.offset = range->first;
+    allocation.length = length;
+
+    if (range->second > length) {
+        page->free.emplace(range->first + length, range->second - length);
+    }
+    page->free.erase(range);
+    page->used += length;
+
+    return allocation;
+}
+
+void Bufferpool::release(const Allocation &allocation) {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto page = std::find_if(pages.begin(), pages.end(), [&](const Page &candidate) {
+        return candidate.buffer == allocation.buffer;
+    });
+    assert(page != pages.end());
+    if (page == pages.end()) {
+        return;
+    }
+
+    page->used -= allocation.length;
+
+    size_t offset = allocation.offset;
+    size_t length = allocation.length;
+    auto next = page->free.lower_bound(offset);
+    if (next != page->free.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            length += prev->second;
+            page->free.erase(prev);
+        }
+    }
+    if (next != page->free.end() && offset + length == next->first) {
+        length += next->second;
+        page->free.erase(next);
+    }
+    page->free.emplace(offset, length);
+}
+
+void Bufferpool::upload(GLenum target, const Allocation &allocation, const void *data, size_t length) {
+    assert(length <= allocation.length);
+    glBufferSubData(target, allocation.offset, length, data);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    uploaded += length;
+    totalUploaded += length;
+}
+
+void Bufferpool::beginFrame() {
+    std::lock_guard<std::mutex> lock(mtx);
+    uploaded = 0;
+
+    std::map<GLenum, size_t> idle;
+    auto end = std::remove_if(pages.begin(), pages.end(), [&](const Page &page) {
+        if (page.used > 0 || idle[page.target]++ < IdleBuffers) {
+            return false;
+        }
+        glDeleteBuffers(1, &page.buffer);
+        return true;
+    });
+    pages.erase(end, pages.end());
+}
+
+Bufferpool::Stats Bufferpool::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    Stats stats;
+    stats.buffers = pages.size();
+    for (const Page &page : pages) {
+        stats.capacity += page.capacity;
+        stats.used += page.used;
+    }
+    stats.uploaded = uploaded;
+    stats.totalUploaded = totalUploaded;
+    return stats;
+}
@@ -0,0 +1,720 @@
+#include <mbgl/geometry/earcut.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace mbgl;
+
+using ClipperLib::IntPoint;
+
+namespace {
+
+// Twice the signed area of the triangle pqr, as the triangulation uses it: negative for
+// convex corners of the outer ring.
+template <typename Point>
+inline double area(const Point *p, const Point *q, const Point *r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+template <typename Point>
+inline bool equals(const Point *a, const Point *b) {
+    return a->x == b->x && a->y == b->y;
+}
+
+inline bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+inline int sign(double value) {
+    return (value > 0) - (value < 0);
+}
+
+// Returns whether q lies in the bounding box of the segment pr.
+template <typename Point>
+inline bool onSegment(const Point *p, const Point *q, const Point *r) {
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+           q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+// Returns whether the segments p1q1 and p2q2 have at least one point in common.
+template <typename Point>
+bool intersects(const Point *p1, const Point *q1, const Point *p2, const Point *q2) {
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) return true;
+    if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+    if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+    if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+    if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+    return false;
+}
+
+// Adapts clipper points to the accessors of the functions above.
+struct Vertex {
+    Vertex(const IntPoint &point) : x(point.X), y(point.Y) {}
+    const double x;
+    const double y;
+};
+
+bool segmentsTouch(const IntPoint &a, const IntPoint &b, const IntPoint &c, const IntPoint &d) {
+    const Vertex p1(a), q1(b), p2(c), q2(d);
+    return intersects(&p1, &q1, &p2, &q2);
+}
+
+// Returns whether the path a, b, c turns back onto itself at b.
+bool foldsBack(const IntPoint &a, const IntPoint &b, const IntPoint &c) {
+    const Vertex p(a), q(b), r(c);
+    return area(&p, &q, &r) == 0 &&
+           (q.x - p.x) * (r.x - q.x) + (q.y - p.y) * (r.y - q.y) < 0;
+}
+
+bool pointInRing(const IntPoint &point, const Earcut::Ring &ring) {
+    bool inside = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        const IntPoint &a = ring[i];
+        const IntPoint &b = ring[j];
+        if ((a.Y > point.Y) != (b.Y > point.Y) &&
+            point.X < double(b.X - a.X) * double(point.Y - a.Y) / double(b.Y - a.Y) + a.X) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+}
+
+bool Earcut::isSimple(const std::vector<Ring> &rings, size_t count) {
+    segments.clear();
+    bounds.clear();
+    outer.clear();
+
+    for (uint32_t r = 0; r < count; r++) {
+        const Ring &ring = rings[r];
+        if (ring.size() < 3) {
+            return false;
+        }
+
+        const double ringArea = ClipperLib::Area(ring);
+        if (ringArea == 0 || (r == 0 && ringArea < 0)) {
+            return false;
+        }
+        outer.push_back(ringArea > 0);
+
+        Bounds box { ring[0].X, ring[0].Y, ring[0].X, ring[0].Y };
+        const uint32_t size = ring.size();
+        for (uint32_t i = 0; i < size; i++) {
+            const IntPoint &a = ring[i];
+            const IntPoint &b = ring[i + 1 < size ? i + 1 : 0];
+            segments.push_back({ &a, &b, std::min(a.X, b.X), std::max(a.X, b.X), r, i });
+            box.minX = std::min(box.minX, a.X);
+            box.minY = std::min(box.minY, a.Y);
+            box.maxX = std::max(box.maxX, a.X);
+            box.maxY = std::max(box.maxY, a.Y);
+        }
+        bounds.push_back(box);
+    }
+
+    // Sweep over the edges from left to right and only compare edges whose x ranges overlap.
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+        return a.minX < b.minX;
+    });
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        const Segment &s = segments[i];
+        for (size_t j = i + 1; j < segments.size() && segments[j].minX <= s.maxX; j++) {
+            const Segment &t = segments[j];
+            if (s.ring == t.ring) {
+                // Consecutive edges share a vertex, but they must not overlap.
+                const uint32_t size = rings[s.ring].size();
+                if ((s.index + 1) % size == t.index) {
+                    if (foldsBack(*s.a, *s.b, *t.b)) return false;
+                    continue;
+                } else if ((t.index + 1) % size == s.index) {
+                    if (foldsBack(*t.a, *t.b, *s.b)) return false;
+                    continue;
+                }
+            }
+            if (segmentsTouch(*s.a, *s.b, *t.a, *t.b)) {
+                return false;
+            }
+        }
+    }
+
+    // Since no edges touch, a single vertex tells whether a ring lies inside another one.
+    const auto overlaps = [&](size_t a, size_t b) {
+        return bounds[a].minX <= bounds[b].maxX && bounds[b].minX <= bounds[a].maxX &&
+               bounds[a].minY <= bounds[b].maxY && bounds[b].minY <= bounds[a].maxY;
+    };
+    const auto inside = [&](size_t a, size_t b) {
+        return overlaps(a, b) && pointInRing(rings[a][0], rings[b]);
+    };
+    const auto inHole = [&](size_t a, size_t o) {
+        for (size_t h = o + 1; h < count && !outer[h]; h++) {
+            if (inside(a, h)) return true;
+        }
+        return false;
+    };
+
+    size_t owner = 0;
+    for (size_t r = 1; r < count; r++) {
+        if (!outer[r]) {
+            if (!inside(r, owner)) {
+                return false;
+            }
+            for (size_t h = owner + 1; h < r; h++) {
+                if (inside(r, h) || inside(h, r)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        owner = r;
+        for (size_t o = 0; o < r; o++) {
+            if (!outer[o]) continue;
+            if (inside(r, o) && !inHole(r, o)) {
+                return false;
+            }
+            if (inside(o, r) && !inHole(o, r)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Earcut::triangulate(const std::vector<Ring> &rings, size_t begin, size_t end, std::vector<uint32_t> &indices) {
+    assert(begin < end && end <= rings.size());
+
+    // Every hole adds two nodes for its bridge, and every split of the polygon adds two more.
+    // There are fewer splits than triangles.
+    size_t vertices = 0;
+    for (size_t r = begin; r < end; r++) {
+        vertices += rings[r].size();
+    }
+    nodes.clear();
+    nodes.reserve(3 * vertices + 6 * (end - begin));
+
+    output = &indices;
+    failed = false;
+
+    Node *outerNode = linkedList(rings[begin], 0, true);
+    if (!outerNode || outerNode->next == outerNode->prev) {
+        return false;
+    }
+
+    if (end - begin > 1) {
+        outerNode = eliminateHoles(rings, begin + 1, end, outerNode, rings[begin].size());
+    }
+
+    // Large polygons look up points in ears through a z-order curve.
+    hashed = vertices > 80;
+    if (hashed) {
+        const Ring &ring = rings[begin];
+        double maxX = minX = ring[0].X;
+        double maxY = minY = ring[0].Y;
+        for (const IntPoint &point : ring) {
+            minX = std::min<double>(minX, point.X);
+            minY = std::min<double>(minY, point.Y);
+            maxX = std::max<double>(maxX, point.X);
+            maxY = std::max<double>(maxY, point.Y);
+        }
+        const double size = std::max(maxX - minX, maxY - minY);
+        invSize = size != 0 ? 32767 / size : 0;
+        hashed = invSize != 0;
+    }
+
+    earcutLinked(outerNode);
+
+    output = nullptr;
+    return !failed;
+}
+
+Earcut::Node *Earcut::createNode(uint32_t i, double x, double y, Node *last) {
+    assert(nodes.size() < nodes.capacity());
+    nodes.emplace_back(i, x, y);
+    Node *p = &nodes.back();
+
+    if (!last) {
+        p->prev = p;
+        p->next = p;
+    } else {
+        p->next = last->next;
+        p->prev = last;
+        last->next->prev = p;
+        last->next = p;
+    }
+    return p;
+}
+
+// Creates a circular linked list from the ring in the given winding order.
+Earcut::Node *Earcut::linkedList(const Ring &ring, uint32_t offset, bool clockwise) {
+    double sum = 0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        sum += double(ring[j].X - ring[i].X) * double(ring[i].Y + ring[j].Y);
+    }
+
+    Node *last = nullptr;
+    if (clockwise == (sum > 0)) {
+        for (size_t i = 0; i < ring.size(); i++) {
+            last = createNode(offset + i, ring[i].X, ring[i].Y, last);
+        }
+    } else {
+        for (size_t i = ring.size(); i-- > 0;) {
+            last = createNode(offset + i, ring[i].X, ring[i].Y, last);
+        }
+    }
+
+    if (last && equals(last, last->next)) {
+        removeNode(last);
+        last = last->next;
+    }
+
+    return last;
+}
+
+// Removes duplicate and collinear points.
+Earcut::Node *Earcut::filterPoints(Node *start, Node *end) {
+    if (!start) return start;
+    if (!end) end = start;
+
+    Node *p = start;
+    bool again;
+    do {
+        again = false;
+
+        if (equals(p, p->next) || area(p->prev, p, p->next) == 0) {
+            removeNode(p);
+            p = end = p->prev;
+            if (p == p->next) break;
+            again = true;
+        } else {
+            p = p->next;
+        }
+    } while (again || p != end);
+
+    return end;
+}
+
+// Clips off ears until the polygon is a single triangle. When no ear can be found, the polygon is
+// cleaned up and retried, then local self-intersections are cured, and finally the polygon is
+// split in two.
+void Earcut::earcutLinked(Node *ear, int pass) {
+    if (!ear) return;
+
+    if (!pass && hashed) indexCurve(ear);
+
+    Node *stop = ear;
+    while (ear->prev != ear->next) {
+        Node *prev = ear->prev;
+        Node *next = ear->next;
+
+        if (hashed ? isEarHashed(ear) : isEar(ear)) {
+            addTriangle(prev, ear, next);
+            removeNode(ear);
+
+            // Skipping the next vertex leads to less sliver triangles.
+            ear = next->next;
+            stop = next->next;
+            continue;
+        }
+
+        ear = next;
+
+        if (ear == stop) {
+            if (!pass) {
+                earcutLinked(filterPoints(ear), 1);
+            } else if (pass == 1) {
+                ear = cureLocalIntersections(filterPoints(ear));
+                earcutLinked(ear, 2);
+            } else if (pass == 2) {
+                splitEarcut(ear);
+            }
+            break;
+        }
+    }
+}
+
+// Returns whether the corner at ear is convex and contains no other points of the polygon.
+bool Earcut::isEar(Node *ear) {
+    const Node *a = ear->prev;
+    const Node *b = ear;
+    const Node *c = ear->next;
+
+    if (area(a, b, c) >= 0) return false;
+
+    const double x0 = std::min({ a->x, b->x, c->x });
+    const double y0 = std::min({ a->y, b->y, c->y });
+    const double x1 = std::max({ a->x, b->x, c->x });
+    const double y1 = std::max({ a->y, b->y, c->y });
+
+    for (const Node *p = c->next; p != a; p = p->next) {
+        if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+            pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            area(p->prev, p, p->next) >= 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Like isEar(), but only looks at points whose z-order is within the range of the triangle.
+bool Earcut::isEarHashed(Node *ear) {
+    const Node *a = ear->prev;
+    const Node *b = ear;
+    const Node *c = ear->next;
+
+    if (area(a, b, c) >= 0) return false;
+
+    const double x0 = std::min({ a->x, b->x, c->x });
+    const double y0 = std::min({ a->y, b->y, c->y });
+    const double x1 = std::max({ a->x, b->x, c->x });
+    const double y1 = std::max({ a->y, b->y, c->y });
+
+    const int32_t minZ = zOrder(x0, y0);
+    const int32_t maxZ = zOrder(x1, y1);
+
+    const auto blocks = [&](const Node *p) {
+        return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+               pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+               area(p->prev, p, p->next) >= 0;
+    };
+
+    // Look in both directions of the z-order curve at the same time.
+    const Node *p = ear->prevZ;
+    const Node *n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+        if (blocks(p)) return false;
+        p = p->prevZ;
+        if (blocks(n)) return false;
+        n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ) {
+        if (blocks(p)) return false;
+    }
+    for (; n && n->z <= maxZ; n = n->nextZ) {
+        if (blocks(n)) return false;
+    }
+
+    return true;
+}
+
+// Clips off the triangles of local self-intersections, where an edge crosses the next but one.
+Earcut::Node *Earcut::cureLocalIntersections(Node *start) {
+    Node *p = start;
+    do {
+        Node *a = p->prev;
+        Node *b = p->next->next;
+
+        if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+            addTriangle(a, p, b);
+            removeNode(p);
+            removeNode(p->next);
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return filterPoints(p);
+}
+
+// Splits the polygon along a valid diagonal and triangulates both halves separately.
+void Earcut::splitEarcut(Node *start) {
+    Node *a = start;
+    do {
+        for (Node *b = a->next->next; b != a->prev; b = b->next) {
+            if (a->i != b->i && isValidDiagonal(a, b)) {
+                Node *c = splitPolygon(a, b);
+                a = filterPoints(a, a->next);
+                c = filterPoints(c, c->next);
+                earcutLinked(a);
+                earcutLinked(c);
+                return;
+            }
+        }
+        a = a->next;
+    } while (a != start);
+
+    // The remaining polygon is degenerate.
+    failed = true;
+}
+
+// Links every hole into the outer ring, starting with the leftmost hole.
+Earcut::Node *Earcut::eliminateHoles(const std::vector<Ring> &rings, size_t begin, size_t end, Node *outerNode, uint32_t offset) {
+    queue.clear();
+    for (size_t r = begin; r < end; r++) {
+        Node *list = linkedList(rings[r], offset, false);
+        offset += rings[r].size();
+        if (list) {
+            queue.push_back(getLeftmost(list));
+        }
+    }
+
+    std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) {
+        return a->x < b->x;
+    });
+
+    for (Node *hole : queue) {
+        outerNode = eliminateHole(hole, outerNode);
+    }
+
+    return outerNode;
+}
+
+Earcut::Node *Earcut::eliminateHole(Node *hole, Node *outerNode) {
+    Node *bridge = findHoleBridge(hole, outerNode);
+    if (!bridge) {
+        failed = true;
+        return outerNode;
+    }
+
+    Node *bridgeReverse = splitPolygon(bridge, hole);
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    return filterPoints(bridge, bridge->next);
+}
+
+// Finds a vertex of the outer ring that can be connected to the leftmost vertex of the hole
+// without crossing any edges (David Eberly's algorithm).
+Earcut::Node *Earcut::findHoleBridge(Node *hole, Node *outerNode) {
+    Node *p = outerNode;
+    const double hx = hole->x;
+    const double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node *m = nullptr;
+
+    // Find the segment left of the hole vertex that is closest to it on the horizontal ray.
+    do {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+            const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if (x == hx) {
+                    // The hole touches the outer segment; pick the leftmost endpoint.
+                    return m;
+                }
+            }
+        }
+        p = p->next;
+    } while (p != outerNode);
+
+    if (!m) return nullptr;
+
+    // Look for points inside the triangle of the hole vertex, the segment intersection and its
+    // endpoint. If there are any, connect to the one with the smallest angle to the ray.
+    const Node *stop = m;
+    const double mx = m->x;
+    const double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+
+    p = m;
+    do {
+        if (hx >= p->x && p->x >= mx && hx != p->x &&
+            pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+            const double tan = std::abs(hy - p->y) / (hx - p->x);
+            if (locallyInside(p, hole) &&
+                (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                m = p;
+                tanMin = tan;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+
+    return m;
+}
+
+void Earcut::indexCurve(Node *start) {
+    Node *p = start;
+    do {
+        if (p->z == 0) p->z = zOrder(p->x, p->y);
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while (p != start);
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+
+    sortLinked(p);
+}
+
+// Sorts the nodes by z-order with Simon Tatham's linked list merge sort.
+Earcut::Node *Earcut::sortLinked(Node *list) {
+    int inSize = 1;
+    int numMerges;
+    do {
+        Node *p = list;
+        Node *tail = nullptr;
+        list = nullptr;
+        numMerges = 0;
+
+        while (p) {
+            numMerges++;
+            Node *q = p;
+            int pSize = 0;
+            for (int i = 0; i < inSize; i++) {
+                pSize++;
+                q = q->nextZ;
+                if (!q) break;
+            }
+            int qSize = inSize;
+
+            while (pSize > 0 || (qSize > 0 && q)) {
+                Node *e;
+                if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                } else {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+
+                if (tail) tail->nextZ = e;
+                else list = e;
+
+                e->prevZ = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        tail->nextZ = nullptr;
+        inSize *= 2;
+    } while (numMerges > 1);
+
+    return list;
+}
+
+// Interleaves the bits of the coordinates, scaled to 15 bits, into a z-order curve value.
+int32_t Earcut::zOrder(double x_, double y_) const {
+    int32_t x = static_cast<int32_t>((x_ - minX) * invSize);
+    int32_t y = static_cast<int32_t>((y_ - minY) * invSize);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+// Connects a and b with a bridge. If they are in the same ring, this splits the ring in two;
+// otherwise the rings are merged into one. Returns the copy of b.
+Earcut::Node *Earcut::splitPolygon(Node *a, Node *b) {
+    assert(nodes.size() + 2 <= nodes.capacity());
+    nodes.emplace_back(a->i, a->x, a->y);
+    Node *a2 = &nodes.back();
+    nodes.emplace_back(b->i, b->x, b->y);
+    Node *b2 = &nodes.back();
+    Node *an = a->next;
+    Node *bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
+}
+
+void Earcut::addTriangle(const Node *a, const Node *b, const Node *c) {
+    output->push_back(a->i);
+    output->push_back(b->i);
+    output->push_back(c->i);
+}
+
+void Earcut::removeNode(Node *p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+Earcut::Node *Earcut::getLeftmost(Node *start) {
+    Node *p = start;
+    Node *leftmost = start;
+    do {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) {
+            leftmost = p;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return leftmost;
+}
+
+// Returns whether a diagonal between a and b lies inside the polygon and crosses no edges.
+bool Earcut::isValidDiagonal(Node *a, Node *b) {
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+           ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+             (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||
+            (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0));
+}
+
+bool Earcut::intersectsPolygon(Node *a, Node *b) {
+    Node *p = a;
+    do {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+            intersects(p, p->next, a, b)) {
+            return true;
+        }
+        p = p->next;
+    } while (p != a);
+
+    return false;
+}
+
+// Returns whether the diagonal from a to b starts on the inner side of the corner at a.
+bool Earcut::locallyInside(const Node *a, const Node *b) {
+    return area(a->prev, a, a->next) < 0 ?
+        area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+        area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// Returns whether the middle of the diagonal from a to b lies inside the polygon.
+bool Earcut::middleInside(Node *a, Node *b) {
+    Node *p = a;
+    bool inside = false;
+    const double px = (a->x + b->x) / 2;
+    const double py = (a->y + b->y) / 2;
+    do {
+        if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+            (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) {
+            inside = !inside;
+        }
+        p = p->next;
+    } while (p != a);
+
+    return inside;
+}
+
+// Returns whether the corner at p lies inside the corner at m.
+bool Earcut::sectorContainsSector(const Node *m, const Node *p) {
+    return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+}
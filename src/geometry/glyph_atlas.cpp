@@ -4,16 +4,27 @@
 #include <mbgl/platform/platform.hpp>
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
+#include <limits>
 
 
 using namespace mbgl;
 
+// Beyond this number of changed regions, the rows that contain them are uploaded in one call.
+const size_t MaxRegionUploads = 16;
+
+// Text vertices store texture coordinates divided by 4 in a byte, so the atlas can't be larger.
+const uint16_t MaxSize = 1024;
+
+// Marks glyphs that no live tile referenced most recently.
+const uint64_t NoTile = std::numeric_limits<uint64_t>::max();
+
 GlyphAtlas::GlyphAtlas(uint16_t width, uint16_t height)
     : width(width),
       height(height),
       bin(width, height),
-      data(new char[width *height]),
+      data(new char[width * height]()),
       dirty(true) {
 }
 
@@ -28,13 +39,17 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uint64_t tile_id, const std::string& face_na
     // Use constant value for now.
     const uint8_t buffer = 3;
 
-    std::map<uint32_t, GlyphValue>& face = index[face_name];
-    std::map<uint32_t, GlyphValue>::iterator it = face.find(glyph.id);
+    Face& face = index[face_name];
+    Face::iterator it = face.find(glyph.id);
 
     // The glyph is already in this texture.
     if (it != face.end()) {
         GlyphValue& value = it->second;
-        value.ids.insert(tile_id);
+        if (value.lastTile != tile_id) {
+            value.lastTile = tile_id;
+            value.refs++;
+            tiles[tile_id].push_back({ &face, it });
+        }
         return value.rect;
     }
 
@@ -57,28 +72,27 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uint64_t tile_id, const std::string& face_na
     pack_height += (4 - pack_height % 4);
 
     Rect<uint16_t> rect = bin.allocate(pack_width, pack_height);
+    while (rect.w == 0 && grow()) {
+        rect = bin.allocate(pack_width, pack_height);
+    }
     if (rect.w == 0) {
-        fprintf(stderr, "glyph bitmap overflow");
+        fprintf(stderr, "glyph bitmap overflow\n");
         return rect;
     }
 
     assert(rect.x + rect.w <= width);
     assert(rect.y + rect.h <= height);
 
-    face.emplace(glyph.id, GlyphValue { rect, tile_id });
+    it = face.emplace(glyph.id, GlyphValue { rect, tile_id }).first;
+    tiles[tile_id].push_back({ &face, it });
 
     // Copy the bitmap
-    char *target = data;
     const char *source = glyph.bitmap.data();
     for (uint32_t y = 0; y < buffered_height; y++) {
-        uint32_t y1 = width * (rect.y + y) + rect.x;
-        uint32_t y2 = buffered_width * y;
-        for (uint32_t x = 0; x < buffered_width; x++) {
-            target[y1 + x] = source[y2 + x];
-        }
+        std::memcpy(data + width * (rect.y + y) + rect.x, source + buffered_width * y, buffered_width);
     }
 
-    dirty = true;
+    markDirty(rect);
 
     return rect;
 }
@@ -86,52 +100,120 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uint64_t tile_id, const std::string& face_na
 void GlyphAtlas::removeGlyphs(uint64_t tile_id) {
     std::lock_guard<std::mutex> lock(mtx);
 
-    for (auto& faces : index) {
-        std::map<uint32_t, GlyphValue>& face = faces.second;
-        for (auto it = face.begin(); it != face.end(); /* we advance in the body */) {
-            GlyphValue& value = it->second;
-            value.ids.erase(tile_id);
-
-            if (!value.ids.size()) {
-                const Rect<uint16_t>& rect = value.rect;
-
-                // Clear out the bitmap.
-                char *target = data;
-                for (uint32_t y = 0; y < rect.h; y++) {
-                    uint32_t y1 = width * (rect.y + y) + rect.x;
-                    for (uint32_t x = 0; x < rect.w; x++) {
-                        target[y1 + x] = 0;
-                    }
-                }
-
-                dirty = true;
-
-                bin.release(rect);
-
-                // Make sure to post-increment the iterator: This will return the
-                // current iterator, but will go to the next position before we
-                // erase the element from the map. That way, the iterator stays
-                // valid.
-                face.erase(it++);
-            } else {
-                ++it;
+    auto tile_it = tiles.find(tile_id);
+    if (tile_it == tiles.end()) {
+        return;
+    }
+
+    for (const GlyphRef& ref : tile_it->second) {
+        GlyphValue& value = ref.it->second;
+        if (value.lastTile == tile_id) {
+            value.lastTile = NoTile;
+        }
+
+        if (--value.refs == 0) {
+            const Rect<uint16_t>& rect = value.rect;
+
+            // Clear out the bitmap.
+            for (uint32_t y = 0; y < rect.h; y++) {
+                std::memset(data + width * (rect.y + y) + rect.x, 0, rect.w);
             }
+
+            markDirty(rect);
+
+            bin.release(rect);
+            ref.face->erase(ref.it);
         }
     }
+
+    tiles.erase(tile_it);
+}
+
+bool GlyphAtlas::grow() {
+    if (width >= MaxSize && height >= MaxSize) {
+        return false;
+    }
+
+    const uint16_t newWidth = std::max(width, std::min<uint16_t>(width * 2, MaxSize));
+    const uint16_t newHeight = std::max(height, std::min<uint16_t>(height * 2, MaxSize));
+
+    // Glyphs keep their position, so that existing texture coordinates stay valid.
+    char *newData = new char[newWidth * newHeight]();
+    for (uint32_t y = 0; y < height; y++) {
+        std::memcpy(newData + newWidth * y, data + width * y, width);
+    }
+    delete[] data;
+    data = newData;
+
+    width = newWidth;
+    height = newHeight;
+    bin.resize(width, height);
+
+    // The texture has to be recreated with the new size.
+    textured = false;
+    dirtyRects.clear();
+    dirty = true;
+
+    return true;
 }
 
-void GlyphAtlas::upload() {
-    if (dirty) {
-        bind();
+void GlyphAtlas::markDirty(const Rect<uint16_t>& rect) {
+    dirtyRects.push_back(rect);
+    dirty = true;
+}
+
+size_t GlyphAtlas::upload() {
+    if (!dirty) {
+        return 0;
+    }
+
+    bind();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t bytes = 0;
 
-        std::lock_guard<std::mutex> lock(mtx);
+    if (!textured) {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, data);
-        dirty = false;
+        textured = true;
+        textureWidth = width;
+        textureHeight = height;
+        bytes = size_t(width) * height;
+    } else if (dirtyRects.size() > MaxRegionUploads) {
+        // Upload all rows that contain changes at once instead of issuing many small uploads.
+        uint16_t top = height, bottom = 0;
+        for (const Rect<uint16_t>& rect : dirtyRects) {
+            top = std::min(top, rect.y);
+            bottom = std::max<uint16_t>(bottom, rect.y + rect.h);
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, top, width, bottom - top, GL_ALPHA, GL_UNSIGNED_BYTE, data + width * top);
+        bytes = size_t(width) * (bottom - top);
+    } else {
+        // OpenGL ES 2 can't upload a rectangle out of a larger image, so we copy each region into
+        // a contiguous buffer first. Regions are multiples of 4 pixels wide, so their rows meet
+        // the default unpack alignment.
+        for (const Rect<uint16_t>& rect : dirtyRects) {
+            staging.resize(rect.w * rect.h);
+            for (uint32_t y = 0; y < rect.h; y++) {
+                std::memcpy(staging.data() + rect.w * y, data + width * (rect.y + y) + rect.x, rect.w);
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.w, rect.h, GL_ALPHA, GL_UNSIGNED_BYTE, staging.data());
+            bytes += staging.size();
+        }
+    }
+
+    dirtyRects.clear();
+    dirty = false;
 
 #if defined(DEBUG)
-        // platform::show_debug_image("Glyph Atlas", data, width, height);
+    // platform::show_debug_image("Glyph Atlas", data, width, height);
 #endif
-    }
+
+    return bytes;
+}
+
+GlyphAtlas::Stats GlyphAtlas::getStats() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return Stats { width, height, bin.occupancy(), bin.fragmentation() };
 }
 
 void GlyphAtlas::bind() {
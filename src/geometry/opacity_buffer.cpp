@@ -0,0 +1,30 @@
+#include <mbgl/geometry/opacity_buffer.hpp>
+
+#include <cmath>
+
+using namespace mbgl;
+
+void OpacityVertexBuffer::add(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *ubytes = static_cast<uint8_t *>(addElement());
+        ubytes[0] = ubytes[1] = ubytes[2] = ubytes[3] = 0;
+    }
+}
+
+void OpacityVertexBuffer::set(size_t start, size_t end, float opacity, bool visible) {
+    const uint8_t value = std::round(opacity * 255);
+    const uint8_t target = visible ? 255 : 0;
+    for (size_t i = start; i < end; i++) {
+        uint8_t *ubytes = static_cast<uint8_t *>(getElement(i));
+        if (ubytes[0] != value || ubytes[1] != target) {
+            ubytes[0] = value;
+            ubytes[1] = target;
+            changed = true;
+        }
+    }
+}
+
+void OpacityVertexBuffer::bind() {
+    Buffer::bind(changed && getID() != 0);
+    changed = false;
+}
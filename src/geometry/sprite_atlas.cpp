@@ -54,7 +54,7 @@ bool SpriteAtlas::resize(const float newRatio) {
         }
 
         free(old_data);
-        dirty = true;
+        markDirty(0, new_h);
 
         // Mark all sprite images as in need of update
         for (const auto &pair : images) {
@@ -133,11 +133,6 @@ Rect<SpriteAtlas::dimension> SpriteAtlas::getImage(const std::string &name, cons
 }
 
 
-Rect<SpriteAtlas::dimension> SpriteAtlas::waitForImage(const std::string &name, const Sprite &sprite) {
-    sprite.waitUntilLoaded();
-    return getImage(name, sprite);
-}
-
 void SpriteAtlas::allocate() {
     if (!data) {
         dimension w = static_cast<dimension>(width * pixelRatio);
@@ -165,6 +160,17 @@ void SpriteAtlas::copy(const Rect<dimension> &dst, const SpritePosition &src, co
         /* icon dimension */ src.height
     );
 
+    markDirty(dst.y * pixelRatio, dst.y * pixelRatio + src.height);
+}
+
+void SpriteAtlas::markDirty(uint32_t top, uint32_t bottom) {
+    if (dirtyTop < dirtyBottom) {
+        dirtyTop = std::min(dirtyTop, top);
+        dirtyBottom = std::max(dirtyBottom, bottom);
+    } else {
+        dirtyTop = top;
+        dirtyBottom = bottom;
+    }
     dirty = true;
 }
 
@@ -184,6 +190,7 @@ void SpriteAtlas::update(const Sprite &sprite) {
         }
 
         if (src.width == dst.w * atlas.pixelRatio && src.height == dst.h * atlas.pixelRatio && src.pixelRatio == atlas.pixelRatio) {
+            std::lock_guard<std::mutex> lock(atlas.mtx);
             atlas.copy(dst, src, sprite);
             return true;
         } else {
@@ -213,44 +220,59 @@ void SpriteAtlas::bind(bool linear) {
     }
 }
 
-void SpriteAtlas::upload() {
-    if (dirty) {
-        bool exists = texture;
-        bind(filter); // Make sure we don't change the filter value.
+size_t SpriteAtlas::upload() {
+    if (!dirty) {
+        return 0;
+    }
 
-        std::lock_guard<std::mutex> lock(mtx);
-        allocate();
+    bind(filter); // Make sure we don't change the filter value.
 
-        if (!exists) {
-            glTexImage2D(
-                GL_TEXTURE_2D, // GLenum target
-                0, // GLint level
-                GL_RGBA, // GLint internalformat
-                width * pixelRatio, // GLsizei width
-                height * pixelRatio, // GLsizei height
-                0, // GLint border
-                GL_RGBA, // GLenum format
-                GL_UNSIGNED_BYTE, // GLenum type
-                data // const GLvoid * data
-            );
-        } else {
-            glTexSubImage2D(GL_TEXTURE_2D, // GLenum target
-                0, // GLint level
-                0, // GLint xoffset
-                0, // GLint yoffset
-                width * pixelRatio, // GLsizei width
-                height * pixelRatio, // GLsizei height
-                GL_RGBA, // GLenum format
-                GL_UNSIGNED_BYTE, // GLenum type
-                data // const GLvoid *pixels
-            );
-        }
+    std::lock_guard<std::mutex> lock(mtx);
+    allocate();
+
+    const uint32_t textureWidth = width * pixelRatio;
+    const uint32_t textureHeight = height * pixelRatio;
+    size_t bytes = 0;
+
+    if (textureRatio != pixelRatio) {
+        // The texture doesn't exist yet or has a different size.
+        glTexImage2D(
+            GL_TEXTURE_2D, // GLenum target
+            0, // GLint level
+            GL_RGBA, // GLint internalformat
+            textureWidth, // GLsizei width
+            textureHeight, // GLsizei height
+            0, // GLint border
+            GL_RGBA, // GLenum format
+            GL_UNSIGNED_BYTE, // GLenum type
+            data // const GLvoid * data
+        );
+        textureRatio = pixelRatio;
+        bytes = textureWidth * textureHeight * sizeof(uint32_t);
+    } else if (dirtyTop < dirtyBottom) {
+        // OpenGL ES 2 can't upload a rectangle out of a larger image, so we upload whole rows.
+        const uint32_t bottom = std::min(dirtyBottom, textureHeight);
+        glTexSubImage2D(GL_TEXTURE_2D, // GLenum target
+            0, // GLint level
+            0, // GLint xoffset
+            dirtyTop, // GLint yoffset
+            textureWidth, // GLsizei width
+            bottom - dirtyTop, // GLsizei height
+            GL_RGBA, // GLenum format
+            GL_UNSIGNED_BYTE, // GLenum type
+            data + dirtyTop * textureWidth // const GLvoid *pixels
+        );
+        bytes = textureWidth * (bottom - dirtyTop) * sizeof(uint32_t);
+    }
 
 #if defined(DEBUG)
-        // platform::show_color_debug_image("Sprite Atlas", reinterpret_cast<char *>(data), width, height, width * pixelRatio, height * pixelRatio);
+    // platform::show_color_debug_image("Sprite Atlas", reinterpret_cast<char *>(data), width, height, width * pixelRatio, height * pixelRatio);
 #endif
-        dirty = false;
-    }
+
+    dirtyTop = dirtyBottom = 0;
+    dirty = false;
+
+    return bytes;
 }
 
 SpriteAtlas::~SpriteAtlas() {
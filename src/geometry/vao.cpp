@@ -10,6 +10,18 @@ VertexArrayObject::~VertexArrayObject() {
     }
 }
 
+void VertexArrayObject::releaseGPU() {
+    if (vao) {
+        glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+    bound_shader = 0;
+    bound_shader_name = "";
+    bound_vertex_buffer = 0;
+    bound_elements_buffer = 0;
+    bound_offset = 0;
+}
+
 void VertexArrayObject::bindVertexArrayObject() {
     if (!vao) {
         glGenVertexArrays(1, &vao);
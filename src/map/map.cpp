@@ -17,6 +17,8 @@
 #include <mbgl/style/style_layer_group.hpp>
 #include <mbgl/style/style_bucket.hpp>
 #include <mbgl/util/texturepool.hpp>
+#include <mbgl/geometry/bufferpool.hpp>
+#include <mbgl/renderer/upload_scheduler.hpp>
 #include <mbgl/geometry/sprite_atlas.hpp>
 #include <mbgl/util/filesource.hpp>
 #include <mbgl/platform/log.hpp>
@@ -24,6 +26,7 @@
 #include <algorithm>
 #include <memory>
 #include <iostream>
+#include <limits>
 
 #define _USE_MATH_DEFINES
 #include <cmath>
@@ -37,11 +40,17 @@ Map::Map(View& view)
       transform(view),
       fileSource(std::make_shared<FileSource>()),
       style(std::make_shared<Style>()),
-      glyphAtlas(std::make_shared<GlyphAtlas>(1024, 1024)),
+      glyphAtlas(std::make_shared<GlyphAtlas>(512, 512)),
       glyphStore(std::make_shared<GlyphStore>(fileSource)),
       spriteAtlas(std::make_shared<SpriteAtlas>(512, 512)),
       texturepool(std::make_shared<Texturepool>()),
-      painter(*this) {
+      bufferpool(std::make_shared<Bufferpool>()),
+      uploadScheduler(std::make_shared<UploadScheduler>()),
+      labelPlacement(std::make_unique<LabelPlacement>([this]() { update(); })),
+      painter(*this),
+      tileCacheSize(util::defaultTileCacheSize) {
+
+    setTileCacheSize(tileCacheSize);
 
     view.initialize(this);
 
@@ -59,6 +68,9 @@ Map::~Map() {
     if (async) {
         stop();
     }
+
+    // Waits for a running placement, which may still call update().
+    labelPlacement.reset();
 }
 
 void Map::start() {
@@ -433,6 +445,22 @@ bool Map::getDebug() const {
     return debug;
 }
 
+#pragma mark - Memory
+
+void Map::setTileCacheSize(size_t bytes) {
+    tileCacheSize = bytes;
+
+    // Tiles that were evicted from the tile cache are parsed again when they come back into view,
+    // and most of their labels were shaped before. Without a tile cache, shapings are still shared
+    // by the tiles that are being loaded.
+    glyphStore->getShapingCache().setMaximumSize(
+        std::max(bytes / 8, util::minimumShapingCacheSize));
+}
+
+size_t Map::getTileCacheSize() const {
+    return tileCacheSize;
+}
+
 void Map::setAppliedClasses(const std::vector<std::string> &classes) {
     style->setAppliedClasses(classes);
     if (style->hasTransitions()) {
@@ -523,6 +551,48 @@ void Map::updateRenderState() {
     }
 }
 
+void Map::placeLabels() {
+    std::vector<LabelPlacement::Bucket> buckets;
+    collectLabels(style->layers, buckets);
+
+    LabelPlacement::View placementView;
+    placementView.width = state.getWidth();
+    placementView.height = state.getHeight();
+    placementView.zoom = state.getNormalizedZoom();
+
+    // A static render places the labels right away; continuous rendering picks up the placement
+    // in a later frame and fades labels in and out.
+    if (labelPlacement->update(std::move(buckets), placementView, util::now(), !async)) {
+        update();
+    }
+}
+
+void Map::collectLabels(const std::shared_ptr<StyleLayerGroup> &group, std::vector<LabelPlacement::Bucket> &buckets) {
+    if (!group) {
+        return;
+    }
+    for (const std::shared_ptr<StyleLayer> &layer : group->layers) {
+        if (!layer) continue;
+        if (layer->bucket) {
+            if (layer->type != StyleLayerType::Symbol || !layer->bucket->style_source ||
+                !layer->bucket->style_source->source) {
+                continue;
+            }
+
+            // Labels of layers that aren't rendered don't take up space.
+            const double zoom = state.getZoom();
+            if (layer->bucket->min_zoom > zoom || layer->bucket->max_zoom <= zoom ||
+                !layer->getProperties<SymbolProperties>().isVisible()) {
+                continue;
+            }
+
+            layer->bucket->style_source->source->collectLabels(layer, state, buckets);
+        } else if (layer->layers) {
+            collectLabels(layer->layers, buckets);
+        }
+    }
+}
+
 void Map::prepare() {
     view.make_active();
 
@@ -539,6 +609,10 @@ void Map::prepare() {
     bool dimensionsChanged = oldState.getFramebufferWidth() != state.getFramebufferWidth() ||
                              oldState.getFramebufferHeight() != state.getFramebufferHeight();
 
+    // Continuous rendering spreads texture uploads over several frames. A static render has to
+    // upload everything in its only frame.
+    uploadScheduler->beginFrame(async ? util::defaultUploadBudget : std::numeric_limits<size_t>::max());
+
     animationTime = util::now();
     updateSources();
     style->updateProperties(state.getNormalizedZoom(), animationTime);
@@ -548,6 +622,11 @@ void Map::prepare() {
     spriteAtlas->update(*getSprite());
 
     updateTiles();
+
+    // Tiles whose textures didn't fit into this frame are uploaded in the next one.
+    if (uploadScheduler->hasDeferred()) {
+        update();
+    }
 }
 
 void Map::render() {
@@ -555,8 +634,10 @@ void Map::render() {
     std::vector<std::string> debug;
 #endif
 
-    glyphAtlas->upload();
-    spriteAtlas->upload();
+    bufferpool->beginFrame();
+
+    uploadScheduler->record(glyphAtlas->upload());
+    uploadScheduler->record(spriteAtlas->upload());
 
     painter.clear();
 
@@ -566,6 +647,8 @@ void Map::render() {
 
     updateRenderState();
 
+    placeLabels();
+
     painter.drawClippingMasks(getActiveSources());
 
     // Actually render the layers
@@ -581,6 +664,20 @@ void Map::render() {
         source->source->finishRender(painter);
     }
 
+    if (debug) {
+        const Bufferpool::Stats stats = bufferpool->getStats();
+        Log::Debug(Event::Render, "buffer pool: %zu kB of %zu kB used in %zu buffers, %zu kB uploaded",
+                   stats.used / 1024, stats.capacity / 1024, stats.buffers, stats.uploaded / 1024);
+
+        const UploadScheduler::Stats &uploads = uploadScheduler->getStats();
+        Log::Debug(Event::Render, "textures: %zu kB uploaded, %zu uploads (%zu kB) deferred",
+                   uploads.uploaded / 1024, uploads.deferred, uploads.deferredBytes / 1024);
+
+        const GlyphAtlas::Stats glyphs = glyphAtlas->getStats();
+        Log::Debug(Event::Render, "glyph atlas: %ux%u, %.0f%% occupied, %.0f%% of free space fragmented",
+                   glyphs.width, glyphs.height, glyphs.occupancy * 100, glyphs.fragmentation * 100);
+    }
+
     // Schedule another rerender when we definitely need a next frame.
     if (transform.needsTransition() || style->hasTransitions()) {
         update();
@@ -8,6 +8,7 @@ using namespace mbgl;
 RasterTileData::RasterTileData(Tile::ID id, Map &map, const SourceInfo &source)
     : TileData(id, map, source),
     bucket(map.getTexturepool(), properties) {
+    bucket.raster.setRetainAfterUpload(retainAfterUpload);
 }
 
 RasterTileData::~RasterTileData() {
@@ -29,6 +30,23 @@ void RasterTileData::render(Painter &painter, std::shared_ptr<StyleLayer> layer_
     bucket.render(painter, layer_desc, id, matrix);
 }
 
+void RasterTileData::releaseGPU() {
+    TileData::releaseGPU();
+    bucket.releaseGPU();
+}
+
+bool RasterTileData::upload(UploadScheduler &scheduler) {
+    return bucket.raster.upload(scheduler);
+}
+
+bool RasterTileData::isUploaded() const {
+    return bucket.raster.textured;
+}
+
+size_t RasterTileData::bytes() const {
+    return TileData::bytes() + bucket.bytes();
+}
+
 bool RasterTileData::hasData(std::shared_ptr<StyleLayer> /*layer_desc*/) const {
     return bucket.hasData();
 }
@@ -2,6 +2,8 @@
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/renderer/painter.hpp>
+#include <mbgl/renderer/symbol_bucket.hpp>
+#include <mbgl/renderer/upload_scheduler.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/raster.hpp>
 #include <mbgl/util/string.hpp>
@@ -15,6 +17,10 @@
 #include <mbgl/map/vector_tile_data.hpp>
 #include <mbgl/map/raster_tile_data.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 namespace mbgl {
 
 Source::Source(SourceInfo info, const std::string &access_token)
@@ -101,7 +107,38 @@ void Source::finishRender(Painter &painter) {
         painter.renderTileDebug(tile);
     }
 }
+void Source::collectLabels(std::shared_ptr<StyleLayer> layer_desc, const TransformState &state,
+                           std::vector<LabelPlacement::Bucket> &buckets) {
+    const size_t first = buckets.size();
+    for (const std::pair<const Tile::ID, std::unique_ptr<Tile>> &pair : tiles) {
+        Tile &tile = *pair.second;
+        Bucket *bucket = tile.data ? tile.data->getBucket(layer_desc) : nullptr;
+        if (!bucket) {
+            continue;
+        }
 
+        SymbolBucket *symbols = static_cast<SymbolBucket *>(bucket);
+        if (symbols->getSymbolInstances().empty()) {
+            continue;
+        }
+
+        LabelPlacement::Bucket placement;
+        placement.tile = tile.data;
+        placement.bucket = symbols;
+        placement.instances = &symbols->getSymbolInstances();
+        state.matrixFor(placement.matrix, tile.id);
+        buckets.push_back(std::move(placement));
+    }
+
+    int32_t clamped_zoom = state.getIntegerZoom();
+    if (clamped_zoom > info.max_zoom) clamped_zoom = info.max_zoom;
+    if (clamped_zoom < info.min_zoom) clamped_zoom = info.min_zoom;
+
+    std::stable_sort(buckets.begin() + first, buckets.end(),
+        [clamped_zoom](const LabelPlacement::Bucket &a, const LabelPlacement::Bucket &b) {
+            return std::abs(a.tile->id.z - clamped_zoom) < std::abs(b.tile->id.z - clamped_zoom);
+        });
+}
 
 std::forward_list<Tile::ID> Source::getIDs() const {
     std::forward_list<Tile::ID> ptrs;
@@ -125,6 +162,16 @@ TileData::State Source::hasTile(const Tile::ID& id) {
     return TileData::State::invalid;
 }
 
+bool Source::isReady(const Tile::ID& id) {
+    auto it = tiles.find(id);
+    if (it == tiles.end() || !it->second->data) {
+        return false;
+    }
+
+    TileData &data = *it->second->data;
+    return data.state == TileData::State::parsed && data.isUploaded();
+}
+
 TileData::State Source::addTile(Map &map, const Tile::ID& id) {
     const TileData::State state = hasTile(id);
 
@@ -150,6 +197,14 @@ TileData::State Source::addTile(Map &map, const Tile::ID& id) {
         new_tile.data.reset();
     }
 
+    if (!new_tile.data) {
+        // Reuse a previously parsed tile if we still have it in the cache.
+        new_tile.data = cache.get(normalized_id);
+        if (new_tile.data) {
+            tile_data[normalized_id] = new_tile.data;
+        }
+    }
+
     if (!new_tile.data) {
         // If we don't find working tile data, we're just going to load it.
         if (info.type == SourceType::Vector) {
@@ -183,8 +238,7 @@ bool Source::findLoadedChildren(const Tile::ID& id, int32_t maxCoveringZoom, std
 
     auto ids = id.children(z + 1);
     for (const Tile::ID& child_id : ids) {
-        const TileData::State state = hasTile(child_id);
-        if (state == TileData::State::parsed) {
+        if (isReady(child_id)) {
             retain.emplace_front(child_id);
         } else {
             complete = false;
@@ -209,8 +263,7 @@ bool Source::findLoadedChildren(const Tile::ID& id, int32_t maxCoveringZoom, std
 bool Source::findLoadedParent(const Tile::ID& id, int32_t minCoveringZoom, std::forward_list<Tile::ID>& retain) {
     for (int32_t z = id.z - 1; z >= minCoveringZoom; --z) {
         const Tile::ID parent_id = id.parent(z);
-        const TileData::State state = hasTile(parent_id);
-        if (state == TileData::State::parsed) {
+        if (isReady(parent_id)) {
             retain.emplace_front(parent_id);
             return true;
         }
@@ -221,6 +274,10 @@ bool Source::findLoadedParent(const Tile::ID& id, int32_t minCoveringZoom, std::
 bool Source::updateTiles(Map &map) {
     bool changed = false;
 
+    cache.setMaximumSize(map.getTileCacheSize());
+
+    UploadScheduler &scheduler = *map.getUploadScheduler();
+
     // Figure out what tiles we need to load
     int32_t clamped_zoom = map.getState().getIntegerZoom();
     if (clamped_zoom > info.max_zoom) clamped_zoom = info.max_zoom;
@@ -249,7 +306,23 @@ bool Source::updateTiles(Map &map) {
     for (const Tile::ID& id : required) {
         const TileData::State state = addTile(map, id);
 
-        if (state != TileData::State::parsed) {
+        // Tiles closer to the center of the viewport are downloaded and parsed first. The distance
+        // is measured in screen pixels, so that the tiles of all sources share one order. Requests
+        // for tiles that are no longer required are cancelled below.
+        auto tile_it = tiles.find(id);
+        if (tile_it != tiles.end() && tile_it->second->data) {
+            TileData &data = *tile_it->second->data;
+            data.setPriority(getPriority(map.getState(), clamped_zoom, box, id));
+
+            // This is the upload step: every required tile asks for the upload of its textures
+            // once per frame, closest to the viewport center first. Parents and children that
+            // cover tiles in the meantime are only used if they're uploaded already.
+            if (data.state == TileData::State::parsed) {
+                data.upload(scheduler);
+            }
+        }
+
+        if (!isReady(id)) {
 //            if (use_raster && (transform.rotating || transform.scaling || transform.panning))
 //                break;
 
@@ -286,8 +359,9 @@ bool Source::updateTiles(Map &map) {
         return obsolete;
     });
 
-    // Remove all the expired pointers from the set.
-    util::erase_if(tile_data, [&retain_data](std::pair<const Tile::ID, std::weak_ptr<TileData>> &pair) {
+    // Remove all the expired pointers from the set. Tiles that are fully parsed are moved to the
+    // cache instead of being discarded.
+    util::erase_if(tile_data, [this, &retain_data](std::pair<const Tile::ID, std::weak_ptr<TileData>> &pair) {
         const std::shared_ptr<TileData> tile = pair.second.lock();
         if (!tile) {
             return true;
@@ -295,7 +369,11 @@ bool Source::updateTiles(Map &map) {
 
         bool obsolete = retain_data.find(tile->id) == retain_data.end();
         if (obsolete) {
-            tile->cancel();
+            if (tile->state == TileData::State::parsed && tile->retainAfterUpload && cache.getMaximumSize()) {
+                cache.add(tile->id, tile);
+            } else {
+                tile->cancel();
+            }
             return true;
         } else {
             return false;
@@ -375,6 +453,15 @@ double Source::getZoom(const TransformState &state) const {
     return state.getZoom() + offset;
 }
 
+util::Executor::Priority Source::getPriority(const TransformState &state, int32_t clamped_zoom, const box& points, const Tile::ID& id) const {
+    // Raster sources cover the viewport with children of the tiles at the clamped zoom level.
+    const double scale = std::pow(2, clamped_zoom - id.z);
+    const double dx = std::fabs((id.x + 0.5) * scale - points.center.x);
+    const double dy = std::fabs((id.y + 0.5) * scale - points.center.y);
+    const double pixels = state.getScale() * util::tileSize / std::pow(2, clamped_zoom);
+    return util::Executor::DefaultPriority + util::Executor::Priority((dx + dy) * pixels);
+}
+
 std::forward_list<mbgl::Tile::ID> Source::covering_tiles(const TransformState &state, int32_t clamped_zoom, const box& points) {
     int32_t dim = std::pow(2, clamped_zoom);
     std::forward_list<mbgl::Tile::ID> tiles;
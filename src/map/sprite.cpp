@@ -8,6 +8,7 @@
 #include <mbgl/util/filesource.hpp>
 #include <mbgl/util/uv_detail.hpp>
 #include <mbgl/util/std.hpp>
+#include <mbgl/util/executor.hpp>
 
 #include <rapidjson/document.h>
 
@@ -35,11 +36,18 @@ Sprite::Sprite(const Key &, const std::string& base_url, float pixelRatio)
       raster(),
       loadedImage(false),
       loadedJSON(false),
-      future(promise.get_future()) {
+      failed(false) {
 }
 
-void Sprite::waitUntilLoaded() const {
-    future.wait();
+bool Sprite::requestLoaded(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (completed) {
+        return true;
+    }
+    if (callback) {
+        callbacks.push_back(std::move(callback));
+    }
+    return false;
 }
 
 Sprite::operator bool() const {
@@ -55,7 +63,7 @@ void Sprite::load(const std::shared_ptr<FileSource> &fileSource) {
         // Treat a non-existent sprite as a successfully loaded empty sprite.
         loadedImage = true;
         loadedJSON = true;
-        promise.set_value();
+        completed = true;
         return;
     }
 
@@ -65,33 +73,48 @@ void Sprite::load(const std::shared_ptr<FileSource> &fileSource) {
         if (res->code == 200) {
             sprite->body.swap(res->body);
             sprite->parseJSON();
-            sprite->complete();
         } else {
             Log::Warning(Event::Sprite, "Failed to load sprite info: Error %d: %s", res->code, res->error_message.c_str());
-            if (!sprite->future.valid()) {
-                sprite->promise.set_exception(std::make_exception_ptr(std::runtime_error(res->error_message)));
-            }
+            sprite->failed = true;
         }
+        sprite->complete();
     });
 
     fileSource->load(ResourceType::Image, spriteURL, [sprite](platform::Response *res) {
         if (res->code == 200) {
             sprite->image.swap(res->body);
-            sprite->parseImage();
-            sprite->complete();
+
+            // Decoding the image is expensive, so we're not doing it on the request thread.
+            util::Executor::shared().post([sprite]() {
+                sprite->parseImage();
+                sprite->complete();
+            }, util::Executor::ResourcePriority);
         } else {
             Log::Warning(Event::Sprite, "Failed to load sprite image: Error %d: %s", res->code, res->error_message.c_str());
-            if (!sprite->future.valid()) {
-                sprite->promise.set_exception(std::make_exception_ptr(std::runtime_error(res->error_message)));
-            }
+            sprite->failed = true;
+            sprite->complete();
         }
     });
 }
 
 void Sprite::complete() {
-    if (loadedImage && loadedJSON) {
+    std::vector<std::function<void()>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (completed || !(isLoaded() || failed)) {
+            return;
+        }
+        completed = true;
+        waiting.swap(callbacks);
+    }
+
+    if (!failed) {
         Log::Info(Event::Sprite, "loaded %s", spriteURL.c_str());
-        promise.set_value();
+    }
+
+    // Symbols are placed without icons if the sprite failed to load.
+    for (const std::function<void()> &callback : waiting) {
+        callback();
     }
 }
 
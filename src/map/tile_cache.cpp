@@ -0,0 +1,76 @@
+#include <mbgl/map/tile_cache.hpp>
+#include <mbgl/map/tile_data.hpp>
+
+namespace mbgl {
+
+TileCache::TileCache(size_t maximumSize_) : maximumSize(maximumSize_) {}
+
+void TileCache::setMaximumSize(size_t size_) {
+    if (maximumSize != size_) {
+        maximumSize = size_;
+        prune();
+    }
+}
+
+size_t TileCache::getMaximumSize() const {
+    return maximumSize;
+}
+
+void TileCache::add(const Tile::ID &id, const std::shared_ptr<TileData> &data) {
+    // Tiles that didn't keep the CPU copies of their buffers would be empty once their GL objects
+    // are released.
+    if (!data || !data->retainAfterUpload || !maximumSize || index.count(id)) {
+        return;
+    }
+
+    data->releaseGPU();
+
+    const size_t bytes = data->bytes();
+    entries.push_front({ id, data, bytes });
+    index.emplace(id, entries.begin());
+    size += bytes;
+
+    prune();
+}
+
+std::shared_ptr<TileData> TileCache::get(const Tile::ID &id) {
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<TileData> data = std::move(it->second->data);
+    size -= it->second->size;
+    entries.erase(it->second);
+    index.erase(it);
+    return data;
+}
+
+bool TileCache::has(const Tile::ID &id) const {
+    return index.count(id) > 0;
+}
+
+void TileCache::clear() {
+    entries.clear();
+    index.clear();
+    size = 0;
+}
+
+size_t TileCache::getSize() const {
+    return size;
+}
+
+size_t TileCache::getTileCount() const {
+    return entries.size();
+}
+
+void TileCache::prune() {
+    while (size > maximumSize && !entries.empty()) {
+        const Entry &entry = entries.back();
+        size -= entry.size;
+        index.erase(entry.id);
+        entries.pop_back();
+    }
+}
+
+}
@@ -6,12 +6,69 @@
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/filesource.hpp>
 #include <mbgl/util/uv_detail.hpp>
+#include <mbgl/util/work.hpp>
+
+#include <mutex>
 
 using namespace mbgl;
 
+// Carries a reparse from the thread that loaded a dependency of the tile back to the map thread.
+// The async handle keeps the loop alive while the tile waits.
+class TileData::Reparse : private util::noncopyable {
+public:
+    Reparse(const std::shared_ptr<TileData> &tile_, const std::shared_ptr<uv::loop> &loop_)
+        : tile(tile_), loop(loop_), async(new uv_async_t()) {
+        async->data = this;
+        uv_async_init(**loop, async, run);
+    }
+
+    // May be called on any thread.
+    void send() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (async) {
+            uv_async_send(async);
+        }
+    }
+
+    // Must be called on the map thread.
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (async) {
+            // The map closes all handles when it terminates.
+            if (!uv_is_closing((uv_handle_t *)async)) {
+                uv_close((uv_handle_t *)async, [](uv_handle_t *handle) {
+                    delete (uv_async_t *)handle;
+                });
+            }
+            async = nullptr;
+        }
+    }
+
+private:
+    static void run(uv_async_t *async) {
+        Reparse *reparse = static_cast<Reparse *>(async->data);
+        reparse->close();
+
+        // The tile closes the handle before it is destroyed.
+        std::shared_ptr<TileData> data = reparse->tile.lock();
+        data->pendingReparse.reset();
+        if (data->state == State::loaded) {
+            data->reparse();
+        }
+    }
+
+private:
+    const std::weak_ptr<TileData> tile;
+    const std::shared_ptr<uv::loop> loop;
+    std::mutex mtx;
+    uv_async_t *async;
+};
+
 TileData::TileData(Tile::ID id, Map &map, const SourceInfo &source)
     : id(id),
       state(State::initial),
+      priority(util::Executor::DefaultPriority),
+      retainAfterUpload(map.getTileCacheSize() > 0),
       map(map),
       source(source),
       url(util::replaceTokens(source.url, [&](const std::string &token) -> std::string {
@@ -22,6 +79,8 @@ TileData::TileData(Tile::ID id, Map &map, const SourceInfo &source)
           return "";
       })),
       debugBucket(debugFontBuffer) {
+    debugFontBuffer.setRetainAfterUpload(retainAfterUpload);
+
     // Initialize tile debug coordinates
     const std::string str = util::sprintf<32>("%d/%d/%d", id.z, id.x, id.y);
     debugFontBuffer.addText(str.c_str(), 50, 200, 5);
@@ -38,9 +97,9 @@ const std::string TileData::toString() const {
 void TileData::request() {
     state = State::loading;
 
-    // Note: Somehow this feels slower than the change to request_http()
+    // The response is delivered on the map thread, which creates the parse work.
     std::weak_ptr<TileData> weak_tile = shared_from_this();
-    map.getFileSource()->load(ResourceType::Tile, url, [weak_tile](platform::Response *res) {
+    req = map.getFileSource()->load(ResourceType::Tile, url, [weak_tile](platform::Response *res) {
         std::shared_ptr<TileData> tile = weak_tile.lock();
         if (!tile || tile->state == State::obsolete) {
             // noop. Tile is obsolete and we're now just waiting for the refcount
@@ -57,16 +116,56 @@ void TileData::request() {
             fprintf(stderr, "[%s] tile loading failed: %d, %s\n", tile->url.c_str(), res->code, res->error_message.c_str());
 #endif
         }
-    });
+    }, map.getLoop());
 }
 
 void TileData::cancel() {
     if (state != State::obsolete) {
         state = State::obsolete;
-        platform::cancel_request_http(req.lock());
+        if (req) {
+            req->cancel();
+        }
+
+        // Parsing only cancels tiles that don't wait for a reparse, so this runs on the map thread
+        // whenever there is one.
+        if (pendingReparse) {
+            pendingReparse->close();
+            pendingReparse.reset();
+        }
     }
 }
 
+void TileData::setPriority(util::Executor::Priority value) {
+    // Parse tasks that are already queued read the new priority once the executor ranks its
+    // queues again.
+    if (priority.exchange(value) != value) {
+        util::Executor::shared().reprioritize();
+    }
+    if (req) {
+        req->setPriority(value);
+    }
+}
+
+void TileData::releaseGPU() {
+    debugBucket.releaseGPU();
+}
+
+Bucket *TileData::getBucket(std::shared_ptr<StyleLayer>) {
+    return nullptr;
+}
+
+bool TileData::upload(UploadScheduler &) {
+    return true;
+}
+
+bool TileData::isUploaded() const {
+    return true;
+}
+
+size_t TileData::bytes() const {
+    return data.size() + debugFontBuffer.bytes();
+}
+
 void TileData::beforeParse() {}
 
 void TileData::reparse() {
@@ -74,9 +173,11 @@ void TileData::reparse() {
 
     // We're creating a new work request. The work request deletes itself after it executed
     // the after work handler
-    new uv::work<std::shared_ptr<TileData>>(
+    new util::work<std::shared_ptr<TileData>>(
         map.getLoop(),
+        [this]() -> util::Executor::Priority { return priority; },
         [](std::shared_ptr<TileData> &tile) {
+            // Obsolete tiles are skipped by parse().
             tile->parse();
         },
         [](std::shared_ptr<TileData> &tile) {
@@ -87,3 +188,15 @@ void TileData::reparse() {
 }
 
 void TileData::afterParse() {}
+
+std::function<void()> TileData::reparseOnMapThread() {
+    if (pendingReparse) {
+        pendingReparse->close();
+    }
+
+    std::shared_ptr<Reparse> reparse = std::make_shared<Reparse>(shared_from_this(), map.getLoop());
+    pendingReparse = reparse;
+    return [reparse]() {
+        reparse->send();
+    };
+}
@@ -10,25 +10,18 @@
 #include <mbgl/renderer/raster_bucket.hpp>
 #include <mbgl/util/raster.hpp>
 #include <mbgl/util/constants.hpp>
-#include <mbgl/util/token.hpp>
 #include <mbgl/geometry/glyph_atlas.hpp>
 #include <mbgl/text/glyph_store.hpp>
 #include <mbgl/text/collision.hpp>
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/map/sprite.hpp>
 #include <mbgl/map/map.hpp>
 
 #include <mbgl/util/std.hpp>
-#include <mbgl/util/utf.hpp>
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/compression.hpp>
 
-#include <locale>
-
-#ifdef __linux__
-#include <boost/regex.hpp>
-namespace regex_impl = boost;
-#else
-#include <regex>
-namespace regex_impl = std;
-#endif
+#include <algorithm>
 
 namespace mbgl {
 
@@ -43,7 +36,7 @@ TileParser::TileParser(const std::string &data, VectorTileData &tile,
                        const std::shared_ptr<GlyphStore> &glyphStore,
                        const std::shared_ptr<SpriteAtlas> &spriteAtlas,
                        const std::shared_ptr<Sprite> &sprite)
-    : vector_data(pbf((const uint8_t *)data.data(), data.size())),
+    : data(data),
       tile(tile),
       style(style),
       glyphAtlas(glyphAtlas),
@@ -53,42 +46,202 @@ TileParser::TileParser(const std::string &data, VectorTileData &tile,
       collision(std::make_unique<Collision>(tile.id.z, 4096, tile.source.tile_size, tile.depth)) {
 }
 
-void TileParser::parse() {
-    parseStyleLayers(style->layers);
+struct TileParser::BufferSegment {
+    FillVertexBuffer fillVertexBuffer;
+    LineVertexBuffer lineVertexBuffer;
+    TriangleElementsBuffer triangleElementsBuffer;
+    LineElementsBuffer lineElementsBuffer;
+    PointElementsBuffer pointElementsBuffer;
+
+    // Scratch memory of the bucket. Every bucket is parsed on its own thread, so they can't
+    // share an arena.
+    util::Arena arena;
+};
+
+bool TileParser::parse() {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (!parsed) {
+        parseBuckets();
+        parsed = true;
+    }
+
+    if (obsolete()) {
+        waiting = false;
+        return true;
+    }
+
+    // The tile registers for the missing resources once it is back on the map thread.
+    waiting = !requestDependencies(nullptr);
+    if (waiting) {
+        return false;
+    }
+
+    // Symbol buckets are placed in the order of the style layers because they share the collision
+    // index.
+    for (PendingSymbols &pending : pendingSymbols) {
+        if (obsolete()) {
+            return true;
+        }
+        pending.bucket->addFeatures(pending.features, tile.id, *spriteAtlas, *sprite, *glyphAtlas, *glyphStore);
+    }
+    pendingSymbols.clear();
+
+    if (!obsolete()) {
+        moveBuckets();
+    }
+    return true;
+}
+
+bool TileParser::done() {
+    // A parse that is running right now deletes the parser when it has finished.
+    std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+    return lock.owns_lock() && !waiting;
+}
+
+void TileParser::parseBuckets() {
+    // Some tile servers compress tiles without setting a Content-Encoding header, so they arrive
+    // compressed. We're decoding them here, on the worker thread.
+    const std::string *raw = &data;
+    if (util::isCompressed(data)) {
+        decompressed = util::decompress(data);
+        raw = &decompressed;
+    }
+    tile.compressedBytes = data.size();
+    tile.decompressedBytes = raw->size();
+
+    vector_data = VectorTile(pbf((const uint8_t *)raw->data(), raw->size()));
+
+    collectBuckets(style->layers, bucket_descs);
+
+    const size_t count = bucket_descs.size();
+    buckets.resize(count);
+    segments.resize(count);
+    std::vector<size_t> symbols;
+
+    util::TaskGroup group(util::Executor::shared(), tile.priority);
+
+    for (size_t i = 0; i < count; i++) {
+        if (bucket_descs[i]->render.is<StyleBucketSymbol>()) {
+            symbols.push_back(i);
+        }
+    }
+
+    // Symbol buckets collect their features and the glyphs they need one after another, so that
+    // they're placed in the order of the style layers later. They're usually the most expensive
+    // part of the tile, so we're starting them first.
+    if (!symbols.empty()) {
+        group.add([&]() {
+            for (size_t i : symbols) {
+                if (obsolete()) {
+                    return;
+                }
+                buckets[i] = createBucket(bucket_descs[i], nullptr);
+            }
+        });
+    }
+
+    // All other buckets are independent of each other. Each of them writes to its own buffers,
+    // which are concatenated once all buckets are done.
+    for (size_t i = 0; i < count; i++) {
+        if (!bucket_descs[i]->render.is<StyleBucketSymbol>()) {
+            segments[i] = std::make_unique<BufferSegment>();
+            group.add([&, i]() {
+                if (!obsolete()) {
+                    buckets[i] = createBucket(bucket_descs[i], segments[i].get());
+                }
+            });
+        }
+    }
+
+    group.wait();
+}
+
+void TileParser::notifyWhenLoaded(std::function<void()> callback) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (waiting && !requestDependencies(callback)) {
+            return;
+        }
+    }
+    callback();
+}
+
+bool TileParser::requestDependencies(const std::function<void()> &callback) {
+    // We're only registering the callback with one resource, so that the tile is reparsed once for
+    // every resource it waits for. All of them are requested right away though.
+    bool loaded = true;
+    for (const std::pair<const std::string, std::set<GlyphRange>> &pair : glyphRanges) {
+        loaded = glyphStore->requestGlyphRanges(pair.first, pair.second, loaded ? callback : nullptr) && loaded;
+    }
+    if (loaded && needsSprite) {
+        loaded = sprite->requestLoaded(callback);
+    }
+    return loaded;
+}
+
+void TileParser::moveBuckets() {
+    const size_t count = bucket_descs.size();
+
+    // Size the tile buffers for all segments up front, so that concatenating them doesn't
+    // reallocate.
+    size_t fillVertices = 0, lineVertices = 0, triangles = 0, lines = 0, points = 0;
+    for (const std::unique_ptr<BufferSegment> &segment : segments) {
+        if (segment) {
+            fillVertices += segment->fillVertexBuffer.index();
+            lineVertices += segment->lineVertexBuffer.index();
+            triangles += segment->triangleElementsBuffer.index();
+            lines += segment->lineElementsBuffer.index();
+            points += segment->pointElementsBuffer.index();
+        }
+    }
+    tile.fillVertexBuffer.reserve(fillVertices);
+    tile.lineVertexBuffer.reserve(lineVertices);
+    tile.triangleElementsBuffer.reserve(triangles);
+    tile.lineElementsBuffer.reserve(lines);
+    tile.pointElementsBuffer.reserve(points);
+
+    // Concatenate the buffers in the order of the style layers, so that the buffer layout is the
+    // same as if the buckets had been parsed serially.
+    for (size_t i = 0; i < count; i++) {
+        if (!buckets[i]) {
+            continue;
+        }
+
+        const StyleBucket &bucket_desc = *bucket_descs[i];
+        if (bucket_desc.render.is<StyleBucketFill>()) {
+            static_cast<FillBucket &>(*buckets[i]).moveTo(tile.fillVertexBuffer, tile.triangleElementsBuffer, tile.lineElementsBuffer);
+        } else if (bucket_desc.render.is<StyleBucketLine>()) {
+            static_cast<LineBucket &>(*buckets[i]).moveTo(tile.lineVertexBuffer, tile.triangleElementsBuffer, tile.pointElementsBuffer);
+        }
+        tile.buckets[bucket_desc.name] = std::move(buckets[i]);
+    }
 }
 
 bool TileParser::obsolete() const { return tile.state == TileData::State::obsolete; }
 
-void TileParser::parseStyleLayers(std::shared_ptr<StyleLayerGroup> group) {
+void TileParser::collectBuckets(std::shared_ptr<StyleLayerGroup> group, std::vector<std::shared_ptr<StyleBucket>> &bucket_descs) {
     if (!group) {
         return;
     }
 
     for (const std::shared_ptr<StyleLayer> &layer_desc : group->layers) {
-        // Cancel early when parsing.
-        if (obsolete()) {
-            return;
-        }
-
         if (layer_desc->isBackground()) {
             // background is a special, fake bucket
             continue;
         } else if (layer_desc->layers) {
             // This is a layer group.
-            parseStyleLayers(layer_desc->layers);
+            collectBuckets(layer_desc->layers, bucket_descs);
         }
         if (layer_desc->bucket) {
             // This is a singular layer. Check if this bucket already exists. If not,
             // parse this bucket.
-            auto bucket_it = tile.buckets.find(layer_desc->bucket->name);
-            if (bucket_it == tile.buckets.end()) {
-                // We need to create this bucket since it doesn't exist yet.
-                std::unique_ptr<Bucket> bucket = createBucket(layer_desc->bucket);
-                if (bucket) {
-                    // Bucket creation might fail because the data tile may not
-                    // contain any data that falls into this bucket.
-                    tile.buckets[layer_desc->bucket->name] = std::move(bucket);
-                }
+            const std::string &name = layer_desc->bucket->name;
+            if (tile.buckets.find(name) == tile.buckets.end() &&
+                std::find_if(bucket_descs.begin(), bucket_descs.end(), [&](const std::shared_ptr<StyleBucket> &desc) {
+                    return desc->name == name;
+                }) == bucket_descs.end()) {
+                bucket_descs.push_back(layer_desc->bucket);
             }
         } else {
             fprintf(stderr, "[WARNING] layer '%s' does not have child layers or buckets\n", layer_desc->id.c_str());
@@ -96,7 +249,7 @@ void TileParser::parseStyleLayers(std::shared_ptr<StyleLayerGroup> group) {
     }
 }
 
-std::unique_ptr<Bucket> TileParser::createBucket(std::shared_ptr<StyleBucket> bucket_desc) {
+std::unique_ptr<Bucket> TileParser::createBucket(std::shared_ptr<StyleBucket> bucket_desc, BufferSegment *segment) {
     if (!bucket_desc) {
         fprintf(stderr, "missing bucket desc\n");
         return nullptr;
@@ -110,9 +263,9 @@ std::unique_ptr<Bucket> TileParser::createBucket(std::shared_ptr<StyleBucket> bu
     if (layer_it != vector_data.layers.end()) {
         const VectorTileLayer &layer = layer_it->second;
         if (bucket_desc->render.is<StyleBucketFill>()) {
-            return createFillBucket(layer, bucket_desc->filter, bucket_desc->render.get<StyleBucketFill>());
+            return createFillBucket(layer, bucket_desc->filter, bucket_desc->render.get<StyleBucketFill>(), *segment);
         } else if (bucket_desc->render.is<StyleBucketLine>()) {
-            return createLineBucket(layer, bucket_desc->filter, bucket_desc->render.get<StyleBucketLine>());
+            return createLineBucket(layer, bucket_desc->filter, bucket_desc->render.get<StyleBucketLine>(), *segment);
         } else if (bucket_desc->render.is<StyleBucketSymbol>()) {
             return createSymbolBucket(layer, bucket_desc->filter, bucket_desc->render.get<StyleBucketSymbol>());
         } else if (bucket_desc->render.is<StyleBucketRaster>()) {
@@ -136,23 +289,21 @@ std::unique_ptr<Bucket> TileParser::createBucket(std::shared_ptr<StyleBucket> bu
 template <class Bucket>
 void TileParser::addBucketGeometries(Bucket& bucket, const VectorTileLayer& layer, const FilterExpression &filter) {
     FilteredVectorTileLayer filtered_layer(layer, filter);
-    for (pbf feature : filtered_layer) {
+    for (const VectorTileFeature &feature : filtered_layer) {
         if (obsolete())
             return;
 
-        while (feature.next(4)) { // geometry
-            pbf geometry_pbf = feature.message();
-            if (geometry_pbf) {
-                bucket->addGeometry(geometry_pbf);
-            } else if (debug::tileParseWarnings) {
-                fprintf(stderr, "[WARNING] geometry is empty\n");
-            }
+        pbf geometry_pbf = feature.geometry;
+        if (geometry_pbf) {
+            bucket->addGeometry(geometry_pbf);
+        } else if (debug::tileParseWarnings) {
+            fprintf(stderr, "[WARNING] geometry is empty\n");
         }
     }
 }
 
-std::unique_ptr<Bucket> TileParser::createFillBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketFill &fill) {
-    std::unique_ptr<FillBucket> bucket = std::make_unique<FillBucket>(tile.fillVertexBuffer, tile.triangleElementsBuffer, tile.lineElementsBuffer, fill);
+std::unique_ptr<Bucket> TileParser::createFillBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketFill &fill, BufferSegment &segment) {
+    std::unique_ptr<FillBucket> bucket = std::make_unique<FillBucket>(segment.fillVertexBuffer, segment.triangleElementsBuffer, segment.lineElementsBuffer, fill, segment.arena);
     addBucketGeometries(bucket, layer, filter);
     return obsolete() ? nullptr : std::move(bucket);
 }
@@ -162,16 +313,27 @@ std::unique_ptr<Bucket> TileParser::createRasterBucket(const std::shared_ptr<Tex
     return obsolete() ? nullptr : std::move(bucket);
 }
 
-std::unique_ptr<Bucket> TileParser::createLineBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketLine &line) {
-    std::unique_ptr<LineBucket> bucket = std::make_unique<LineBucket>(tile.lineVertexBuffer, tile.triangleElementsBuffer, tile.pointElementsBuffer, line);
+std::unique_ptr<Bucket> TileParser::createLineBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketLine &line, BufferSegment &segment) {
+    std::unique_ptr<LineBucket> bucket = std::make_unique<LineBucket>(segment.lineVertexBuffer, segment.triangleElementsBuffer, segment.pointElementsBuffer, line, segment.arena);
     addBucketGeometries(bucket, layer, filter);
     return obsolete() ? nullptr : std::move(bucket);
 }
 
 std::unique_ptr<Bucket> TileParser::createSymbolBucket(const VectorTileLayer& layer, const FilterExpression &filter, const StyleBucketSymbol &symbol) {
-    std::unique_ptr<SymbolBucket> bucket = std::make_unique<SymbolBucket>(symbol, *collision);
-    bucket->addFeatures(layer, filter, tile.id, *spriteAtlas, *sprite, *glyphAtlas, *glyphStore);
-    return obsolete() ? nullptr : std::move(bucket);
+    std::unique_ptr<SymbolBucket> bucket = std::make_unique<SymbolBucket>(symbol, *collision, symbolArena);
+    bucket->setRetainAfterUpload(tile.retainAfterUpload);
+    bucket->setBufferpool(tile.map.getBufferpool());
+
+    // The features are placed once the glyphs and the sprite they need are loaded.
+    util::ArenaVector<SymbolFeature> features = bucket->processFeatures(layer, filter, glyphRanges[symbol.text.font]);
+    if (obsolete()) {
+        return nullptr;
+    }
+    pendingSymbols.push_back({ bucket.get(), std::move(features) });
+    if (!symbol.icon.image.empty()) {
+        needsSprite = true;
+    }
+    return std::move(bucket);
 }
 
 }
@@ -1,9 +1,11 @@
 #include <mbgl/map/vector_tile.hpp>
 #include <mbgl/style/filter_expression_private.hpp>
 #include <mbgl/style/filter_comparison_private.hpp>
+#include <mbgl/util/constants.hpp>
 
 #include <algorithm>
 #include <iostream>
+#include <cstdio>
 
 using namespace mbgl;
 
@@ -18,51 +20,6 @@ std::ostream& mbgl::operator<<(std::ostream& os, const FeatureType& type) {
     }
 }
 
-VectorTileFeature::VectorTileFeature(pbf feature, const VectorTileLayer& layer) {
-    while (feature.next()) {
-        if (feature.tag == 1) { // id
-            id = feature.varint<uint64_t>();
-        } else if (feature.tag == 2) { // tags
-            // tags are packed varints. They should have an even length.
-            pbf tags = feature.message();
-            while (tags) {
-                uint32_t tag_key = tags.varint();
-
-                if (layer.keys.size() <= tag_key) {
-                    throw std::runtime_error("feature referenced out of range key");
-                }
-
-                if (tags) {
-                    uint32_t tag_val = tags.varint();
-                    if (layer.values.size() <= tag_val) {
-                        throw std::runtime_error("feature referenced out of range value");
-                    }
-
-                    properties.emplace(layer.keys[tag_key], layer.values[tag_val]);
-                } else {
-                    throw std::runtime_error("uneven number of feature tag ids");
-                }
-            }
-        } else if (feature.tag == 3) { // type
-            type = (FeatureType)feature.varint();
-        } else if (feature.tag == 4) { // geometry
-            geometry = feature.message();
-        } else {
-            feature.skip();
-        }
-    }
-}
-
-
-std::ostream& mbgl::operator<<(std::ostream& os, const VectorTileFeature& feature) {
-    os << "Feature(" << feature.id << "): " << feature.type << std::endl;
-    for (const auto& prop : feature.properties) {
-        os << "  - " << prop.first << ": " << prop.second << std::endl;
-    }
-    return os;
-}
-
-
 VectorTile::VectorTile() {}
 
 
@@ -85,14 +42,29 @@ VectorTile& VectorTile::operator=(VectorTile && other) {
 }
 
 VectorTileLayer::VectorTileLayer(pbf layer) : data(layer) {
-    std::vector<std::string> stacks;
-
     while (layer.next()) {
         if (layer.tag == 1) { // name
             name = layer.string();
+        } else if (layer.tag == 2) { // feature
+            pbf feature_pbf = layer.message();
+            VectorTileFeature feature;
+            while (feature_pbf.next()) {
+                if (feature_pbf.tag == 1) { // id
+                    feature.id = feature_pbf.varint<uint64_t>();
+                } else if (feature_pbf.tag == 2) { // tags
+                    feature.tags = feature_pbf.message();
+                } else if (feature_pbf.tag == 3) { // type
+                    feature.type = (FeatureType)feature_pbf.varint();
+                } else if (feature_pbf.tag == 4) { // geometry
+                    feature.geometry = feature_pbf.message();
+                } else {
+                    feature_pbf.skip();
+                }
+            }
+            features.push_back(feature);
         } else if (layer.tag == 3) { // keys
-            keys.emplace_back(layer.string());
-            key_index.emplace(keys.back(), keys.size() - 1);
+            pbf key = layer.message();
+            keys.emplace_back(reinterpret_cast<const char *>(key.data), key.end - key.data);
         } else if (layer.tag == 4) { // values
             values.emplace_back(std::move(parseValue(layer.message())));
         } else if (layer.tag == 5) { // extent
@@ -101,26 +73,94 @@ VectorTileLayer::VectorTileLayer(pbf layer) : data(layer) {
             layer.skip();
         }
     }
+
+    // Features may precede the keys and values in the layer, so we can only check the tags once
+    // the entire layer has been read. Afterwards, lookups don't need to do any range checks.
+    for (VectorTileFeature &feature : features) {
+        validateTags(feature);
+    }
+}
+
+void VectorTileLayer::validateTags(VectorTileFeature &feature) const {
+    // tags are packed varints. They should have an even length.
+    pbf tags = feature.tags;
+    try {
+        while (tags) {
+            if (tags.varint() >= keys.size()) {
+                if (debug::tileParseWarnings) {
+                    fprintf(stderr, "[WARNING] feature references out of range key\n");
+                }
+            } else if (!tags) {
+                if (debug::tileParseWarnings) {
+                    fprintf(stderr, "[WARNING] uneven number of feature tag ids\n");
+                }
+            } else if (tags.varint() >= values.size()) {
+                if (debug::tileParseWarnings) {
+                    fprintf(stderr, "[WARNING] feature references out of range value\n");
+                }
+            } else {
+                continue;
+            }
+            feature.tags = pbf();
+            return;
+        }
+    } catch (const pbf::exception &) {
+        if (debug::tileParseWarnings) {
+            fprintf(stderr, "[WARNING] feature has invalid tags\n");
+        }
+        feature.tags = pbf();
+    }
+}
+
+int32_t VectorTileLayer::getKeyIndex(const std::string &key) const {
+    const util::string_view needle(key);
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == needle) {
+            return int32_t(i);
+        }
+    }
+    return -1;
+}
+
+const Value *VectorTileLayer::getValue(const VectorTileFeature &feature, int32_t key) const {
+    if (key < 0) {
+        return nullptr;
+    }
+
+    pbf tags = feature.tags;
+    while (tags) {
+        const uint32_t tag_key = tags.varint();
+        // Note: We need to read the value in all cases, even if the keys don't match.
+        const uint32_t tag_val = tags.varint();
+        if (tag_key == uint32_t(key)) {
+            return &values[tag_val];
+        }
+    }
+    return nullptr;
+}
+
+const Value *VectorTileLayer::getValue(const VectorTileFeature &feature, const std::string &key) const {
+    return getValue(feature, getKeyIndex(key));
 }
 
 FilteredVectorTileLayer::FilteredVectorTileLayer(const VectorTileLayer& layer, const FilterExpression &filterExpression)
     : layer(layer),
-      filterExpression(filterExpression) {
+      filterExpression(filterExpression),
+      filter(filterExpression, layer) {
 }
 
 FilteredVectorTileLayer::iterator FilteredVectorTileLayer::begin() const {
-    return iterator(*this, layer.data);
+    return iterator(*this, layer.features.begin());
 }
 
 FilteredVectorTileLayer::iterator FilteredVectorTileLayer::end() const {
-    return iterator(*this, pbf(layer.data.end, 0));
+    return iterator(*this, layer.features.end());
 }
 
-FilteredVectorTileLayer::iterator::iterator(const FilteredVectorTileLayer& parent, const pbf& data)
+FilteredVectorTileLayer::iterator::iterator(const FilteredVectorTileLayer& parent, feature_iterator it)
     : parent(parent),
-      feature(pbf()),
-      data(data) {
-    operator++();
+      it(it) {
+    advance();
 }
 
 //bool FilteredVectorTileLayer::iterator::matchesFilterExpression(const FilterExpression &filterExpression, const pbf &tags_pbf) {
@@ -201,6 +241,16 @@ FilteredVectorTileLayer::iterator::iterator(const FilteredVectorTileLayer& paren
 VectorTileTagExtractor::VectorTileTagExtractor(const VectorTileLayer &layer) : layer_(layer) {}
 
 
+void VectorTileTagExtractor::setFeature(const VectorTileFeature &feature) {
+    tags_ = feature.tags;
+    switch (feature.type) {
+        case FeatureType::Point:      type_ = FilterExpression::GeometryType::Point; break;
+        case FeatureType::LineString: type_ = FilterExpression::GeometryType::LineString; break;
+        case FeatureType::Polygon:    type_ = FilterExpression::GeometryType::Polygon; break;
+        default:                      type_ = FilterExpression::GeometryType::Any; break;
+    }
+}
+
 void VectorTileTagExtractor::setTags(const pbf &pbf) {
     tags_ = pbf;
 }
@@ -208,31 +258,16 @@ void VectorTileTagExtractor::setTags(const pbf &pbf) {
 std::vector<Value> VectorTileTagExtractor::getValues(const std::string &key) const {
     std::vector<Value> values;
 
-    auto field_it = layer_.key_index.find(key);
-    if (field_it != layer_.key_index.end()) {
-        const uint32_t filter_key = field_it->second;
-
-        // Now loop through all the key/value pair tags.
-        // tags are packed varints. They should have an even length.
+    const int32_t filter_key = layer_.getKeyIndex(key);
+    if (filter_key >= 0) {
+        // Now loop through all the key/value pair tags. The layer has already made sure that they
+        // come in pairs and are in range.
         pbf tags_pbf = tags_;
-        uint32_t tag_key, tag_val;
         while (tags_pbf) {
-            tag_key = tags_pbf.varint();
-            if (!tags_pbf) {
-                // This should not happen; otherwise the vector tile is invalid.
-                fprintf(stderr, "[WARNING] uneven number of feature tag ids\n");
-                return values;
-            }
-            // Note: We need to run this command in all cases, even if the keys don't match.
-            tag_val = tags_pbf.varint();
-
-            if (tag_key == filter_key) {
-                if (layer_.values.size() > tag_val) {
-                    values.emplace_back(layer_.values[tag_val]);
-                } else {
-                    fprintf(stderr, "[WARNING] feature references out of range value\n");
-                    break;
-                }
+            const uint32_t tag_key = tags_pbf.varint();
+            const uint32_t tag_val = tags_pbf.varint();
+            if (tag_key == uint32_t(filter_key)) {
+                values.emplace_back(layer_.values[tag_val]);
             }
         }
     }
@@ -249,55 +284,29 @@ FilterExpression::GeometryType VectorTileTagExtractor::getType() const {
 }
 
 void FilteredVectorTileLayer::iterator::operator++() {
-    valid = false;
+    ++it;
+    advance();
+}
 
+void FilteredVectorTileLayer::iterator::advance() {
     const FilterExpression &expression = parent.filterExpression;
 
-    while (data.next(2)) { // feature
-        feature = data.message();
-        pbf feature_pbf = feature;
-        bool matched = false;
-
-        // Treat the absence of any expression filters as a match.
-        if (expression.empty()) {
-            matched = true;
-        }
-
-        if (!matched) {
-            VectorTileTagExtractor extractor(parent.layer);
-
-            // Retrieve the basic information
-            while (feature_pbf.next()) {
-                if (feature_pbf.tag == 2) { // tags
-                    extractor.setTags(feature_pbf.message());
-                } else if (feature_pbf.tag == 3) { // geometry type
-                    switch (FeatureType(feature_pbf.varint())) {
-                        case FeatureType::Point:      extractor.setType(FilterExpression::GeometryType::Point); break;
-                        case FeatureType::LineString: extractor.setType(FilterExpression::GeometryType::LineString); break;
-                        case FeatureType::Polygon:    extractor.setType(FilterExpression::GeometryType::Polygon); break;
-                        default: break;
-                    }
-                } else {
-                    feature_pbf.skip();
-                }
-            }
-
-            matched = expression.compare(extractor);
-        }
+    // Treat the absence of any expression filters as a match.
+    if (expression.empty()) {
+        return;
+    }
 
-        if (matched) {
-            valid = true;
-            return; // data loop
-        } else {
-            valid = false;
+    for (const auto end = parent.layer.features.end(); it != end; ++it) {
+        if (parent.filter.matches(*it)) {
+            return;
         }
     }
 }
 
 bool FilteredVectorTileLayer::iterator::operator!=(const iterator& other) const {
-    return !(data.data == other.data.data && data.end == other.data.end && valid == other.valid);
+    return it != other.it;
 }
 
-const pbf& FilteredVectorTileLayer::iterator:: operator*() const {
-    return feature;
+const VectorTileFeature& FilteredVectorTileLayer::iterator::operator*() const {
+    return *it;
 }
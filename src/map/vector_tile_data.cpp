@@ -10,7 +10,25 @@ using namespace mbgl;
 
 VectorTileData::VectorTileData(Tile::ID id, Map &map, const SourceInfo &source)
     : TileData(id, map, source),
-      depth(id.z >= source.max_zoom ? map.getMaxZoom() - id.z : 1) {
+      depth(id.z >= source.max_zoom ? map.getMaxZoom() - id.z : 1),
+      compressedBytes(0),
+      decompressedBytes(0) {
+    fillVertexBuffer.setRetainAfterUpload(retainAfterUpload);
+    lineVertexBuffer.setRetainAfterUpload(retainAfterUpload);
+    iconVertexBuffer.setRetainAfterUpload(retainAfterUpload);
+    textVertexBuffer.setRetainAfterUpload(retainAfterUpload);
+    triangleElementsBuffer.setRetainAfterUpload(retainAfterUpload);
+    lineElementsBuffer.setRetainAfterUpload(retainAfterUpload);
+    pointElementsBuffer.setRetainAfterUpload(retainAfterUpload);
+
+    const std::shared_ptr<Bufferpool> pool = map.getBufferpool();
+    fillVertexBuffer.setPool(pool);
+    lineVertexBuffer.setPool(pool);
+    iconVertexBuffer.setPool(pool);
+    textVertexBuffer.setPool(pool);
+    triangleElementsBuffer.setPool(pool);
+    lineElementsBuffer.setPool(pool);
+    pointElementsBuffer.setPool(pool);
 }
 
 VectorTileData::~VectorTileData() {
@@ -21,6 +39,10 @@ VectorTileData::~VectorTileData() {
 }
 
 void VectorTileData::beforeParse() {
+    // A parser that waits for glyphs or the sprite is reused when the tile is reparsed.
+    if (parser) {
+        return;
+    }
 
     parser = std::make_unique<TileParser>(data, *this, map.getStyle(), map.getGlyphAtlas(), map.getGlyphStore(), map.getSpriteAtlas(), map.getSprite());
 }
@@ -34,7 +56,10 @@ void VectorTileData::parse() {
         // Parsing creates state that is encapsulated in TileParser. While parsing,
         // the TileParser object writes results into this objects. All other state
         // is going to be discarded afterwards.
-        parser->parse();
+        if (!parser->parse()) {
+            // The tile is reparsed once the glyphs and the sprite it needs are loaded.
+            return;
+        }
     } catch (const std::exception& ex) {
 #if defined(DEBUG)
         fprintf(stderr, "[%p] exception [%d/%d/%d]... failed: %s\n", this, id.z, id.x, id.y, ex.what());
@@ -49,7 +74,17 @@ void VectorTileData::parse() {
 }
 
 void VectorTileData::afterParse() {
-    parser.reset();
+    if (!parser) {
+        return;
+    }
+
+    if (parser->done()) {
+        parser.reset();
+    } else if (state == State::loaded) {
+        // Glyphs and sprites are loaded on other threads, so the reparse is sent back to the map
+        // thread.
+        parser->notifyWhenLoaded(reparseOnMapThread());
+    }
 }
 
 void VectorTileData::render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc, const mat4 &matrix) {
@@ -62,6 +97,33 @@ void VectorTileData::render(Painter &painter, std::shared_ptr<StyleLayer> layer_
     }
 }
 
+void VectorTileData::releaseGPU() {
+    TileData::releaseGPU();
+
+    for (std::pair<const std::string, std::unique_ptr<Bucket>> &pair : buckets) {
+        pair.second->releaseGPU();
+    }
+
+    fillVertexBuffer.releaseGPU();
+    lineVertexBuffer.releaseGPU();
+    iconVertexBuffer.releaseGPU();
+    textVertexBuffer.releaseGPU();
+    triangleElementsBuffer.releaseGPU();
+    lineElementsBuffer.releaseGPU();
+    pointElementsBuffer.releaseGPU();
+}
+
+size_t VectorTileData::bytes() const {
+    size_t result = TileData::bytes();
+    result += fillVertexBuffer.bytes() + lineVertexBuffer.bytes() + iconVertexBuffer.bytes() +
+              textVertexBuffer.bytes() + triangleElementsBuffer.bytes() + lineElementsBuffer.bytes() +
+              pointElementsBuffer.bytes();
+    for (const std::pair<const std::string, std::unique_ptr<Bucket>> &pair : buckets) {
+        result += pair.second->bytes();
+    }
+    return result;
+}
+
 bool VectorTileData::hasData(std::shared_ptr<StyleLayer> layer_desc) const {
     if (state == State::parsed && layer_desc->bucket) {
         auto databucket_it = buckets.find(layer_desc->bucket->name);
@@ -72,3 +134,14 @@ bool VectorTileData::hasData(std::shared_ptr<StyleLayer> layer_desc) const {
     }
     return false;
 }
+
+Bucket *VectorTileData::getBucket(std::shared_ptr<StyleLayer> layer_desc) {
+    if (state == State::parsed && layer_desc->bucket) {
+        auto databucket_it = buckets.find(layer_desc->bucket->name);
+        if (databucket_it != buckets.end()) {
+            assert(databucket_it->second);
+            return databucket_it->second.get();
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,145 @@
+#include <mbgl/map/vector_tile_filter.hpp>
+#include <mbgl/map/vector_tile.hpp>
+
+namespace mbgl {
+
+namespace {
+
+enum : uint8_t { Unknown = 0, False = 1, True = 2 };
+
+FilterExpression::GeometryType geometryType(FeatureType type) {
+    switch (type) {
+        case FeatureType::Point:      return FilterExpression::GeometryType::Point;
+        case FeatureType::LineString: return FilterExpression::GeometryType::LineString;
+        case FeatureType::Polygon:    return FilterExpression::GeometryType::Polygon;
+        default:                      return FilterExpression::GeometryType::Any;
+    }
+}
+
+}
+
+VectorTileFilter::VectorTileFilter(const FilterExpression &expression, const VectorTileLayer &layer_)
+    : layer(layer_) {
+    compile(expression);
+}
+
+void VectorTileFilter::compile(const FilterExpression &expression) {
+    const uint32_t pc = program.size();
+    program.push_back({ Instruction::Code::Expression, expression.op, expression.type, 0, -1, false, 0, nullptr });
+
+    // Children are emitted in the same order FilterExpression::compare() visits them.
+    for (const FilterComparison &comparison : expression.comparisons) {
+        Instruction instruction { Instruction::Code::Comparison, expression.op, expression.type, 0, -1, false, 0, &comparison };
+        instruction.end = program.size() + 1;
+        instruction.key = layer.getKeyIndex(comparison.getField());
+        instruction.missing = comparison.compare(std::vector<Value>());
+        instruction.memo = results.size();
+        if (instruction.key >= 0) {
+            results.resize(results.size() + layer.values.size(), Unknown);
+        }
+        program.push_back(instruction);
+    }
+
+    for (const FilterExpression &child : expression.expressions) {
+        compile(child);
+    }
+
+    program[pc].end = program.size();
+}
+
+bool VectorTileFilter::matches(const VectorTileFeature &feature) const {
+    return evaluate(0, feature, geometryType(feature.type));
+}
+
+bool VectorTileFilter::evaluate(uint32_t pc, const VectorTileFeature &feature, FilterExpression::GeometryType type) const {
+    const Instruction &instruction = program[pc];
+    if (instruction.code == Instruction::Code::Comparison) {
+        return evaluateComparison(instruction, feature);
+    }
+
+    if (instruction.type != FilterExpression::GeometryType::Any && type != instruction.type && type != FilterExpression::GeometryType::Any) {
+        return false;
+    }
+
+    const uint32_t end = instruction.end;
+    switch (instruction.op) {
+    case FilterExpression::Operator::And:
+        for (uint32_t child = pc + 1; child < end; child = program[child].end) {
+            if (!evaluate(child, feature, type)) {
+                return false;
+            }
+        }
+        return true;
+    case FilterExpression::Operator::Or:
+        for (uint32_t child = pc + 1; child < end; child = program[child].end) {
+            if (evaluate(child, feature, type)) {
+                return true;
+            }
+        }
+        return false;
+    case FilterExpression::Operator::Xor: {
+        int count = 0;
+        for (uint32_t child = pc + 1; child < end; child = program[child].end) {
+            count += evaluate(child, feature, type);
+            if (count > 1) {
+                return false;
+            }
+        }
+        return count == 1;
+    }
+    case FilterExpression::Operator::Nor:
+        for (uint32_t child = pc + 1; child < end; child = program[child].end) {
+            if (evaluate(child, feature, type)) {
+                return false;
+            }
+        }
+        return true;
+    default:
+        return true;
+    }
+}
+
+bool VectorTileFilter::evaluateComparison(const Instruction &instruction, const VectorTileFeature &feature) const {
+    if (instruction.key < 0) {
+        return instruction.missing;
+    }
+
+    // Find the value of the field. The layer has already made sure that tags come in pairs and
+    // are in range.
+    const uint32_t key = instruction.key;
+    uint32_t value = 0;
+    uint32_t count = 0;
+    pbf tags = feature.tags;
+    while (tags) {
+        const uint32_t tag_key = tags.varint();
+        const uint32_t tag_val = tags.varint();
+        if (tag_key == key) {
+            value = tag_val;
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return instruction.missing;
+    } else if (count > 1) {
+        // Multiple values for the same key are rare enough that we don't memoize them.
+        std::vector<Value> values;
+        tags = feature.tags;
+        while (tags) {
+            const uint32_t tag_key = tags.varint();
+            const uint32_t tag_val = tags.varint();
+            if (tag_key == key) {
+                values.push_back(layer.values[tag_val]);
+            }
+        }
+        return instruction.comparison->compare(values);
+    }
+
+    uint8_t &result = results[instruction.memo + value];
+    if (result == Unknown) {
+        result = instruction.comparison->compare(std::vector<Value> { layer.values[value] }) ? True : False;
+    }
+    return result == True;
+}
+
+}
@@ -22,6 +22,11 @@ bool DebugBucket::hasData() const {
     return fontBuffer.index() > 0;
 }
 
+void DebugBucket::releaseGPU() {
+    array.releaseGPU();
+    fontBuffer.releaseGPU();
+}
+
 void DebugBucket::drawLines(PlainShader& shader) {
     array.bind(shader, fontBuffer, BUFFER_OFFSET(0));
     glDrawArrays(GL_LINES, 0, (GLsizei)(fontBuffer.index()));
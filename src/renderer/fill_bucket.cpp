@@ -10,6 +10,7 @@
 #include <mbgl/platform/gl.hpp>
 
 
+#include <algorithm>
 #include <cassert>
 
 struct geometry_too_long_exception : std::exception {};
@@ -33,8 +34,10 @@ void FillBucket::free(void *, void *ptr) {
 FillBucket::FillBucket(FillVertexBuffer &vertexBuffer,
                        TriangleElementsBuffer &triangleElementsBuffer,
                        LineElementsBuffer &lineElementsBuffer,
-                       const StyleBucketFill &properties)
+                       const StyleBucketFill &properties,
+                       util::Arena &arena)
     : properties(properties),
+      arena(arena),
       allocator(new TESSalloc{&alloc, &realloc, &free, nullptr, // userData
                               64,                               // meshEdgeBucketSize
                               64,                               // meshVertexBucketSize
@@ -44,9 +47,9 @@ FillBucket::FillBucket(FillVertexBuffer &vertexBuffer,
                               128, // extraVertices allocated for the priority queue.
       }),
       tesselator(tessNewTess(allocator)),
-      vertexBuffer(vertexBuffer),
-      triangleElementsBuffer(triangleElementsBuffer),
-      lineElementsBuffer(lineElementsBuffer),
+      vertexBuffer(&vertexBuffer),
+      triangleElementsBuffer(&triangleElementsBuffer),
+      lineElementsBuffer(&lineElementsBuffer),
       vertex_start(vertexBuffer.index()),
       triangle_elements_start(triangleElementsBuffer.index()),
       line_elements_start(lineElementsBuffer.index()) {
@@ -63,37 +66,137 @@ FillBucket::~FillBucket() {
 }
 
 void FillBucket::addGeometry(pbf& geom) {
-    Geometry::command cmd;
-
-    Coordinate coord;
     Geometry geometry(geom);
-    int32_t x, y;
-    while ((cmd = geometry.next(x, y)) != Geometry::end) {
-        if (cmd == Geometry::move_to) {
-            if (line.size()) {
-                clipper.AddPath(line, ClipperLib::ptSubject, true);
-                line.clear();
-                hasVertices = true;
-            }
+    while (true) {
+        if (ringCount == rings.size()) {
+            rings.emplace_back();
+        }
+        Earcut::Ring& ring = rings[ringCount];
+        if (!geometry.nextRing(ring)) {
+            break;
         }
-        line.emplace_back(x, y);
-    }
 
-    if (line.size()) {
-        clipper.AddPath(line, ClipperLib::ptSubject, true);
-        line.clear();
-        hasVertices = true;
+        // Drop repeated vertices, including the one that closes the ring. Rings with less than
+        // three vertices don't cover any area.
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+        if (ring.size() > 1 && ring.front() == ring.back()) {
+            ring.pop_back();
+        }
+        if (ring.size() >= 3) {
+            ringCount++;
+        }
     }
 
     tessellate();
 }
 
 void FillBucket::tessellate() {
-    if (!hasVertices) {
+    if (!ringCount) {
+        return;
+    }
+
+    const size_t count = ringCount;
+    ringCount = 0;
+
+    if (triangulate(count)) {
         return;
     }
-    hasVertices = false;
 
+    for (size_t i = 0; i < count; i++) {
+        clipper.AddPath(rings[i], ClipperLib::ptSubject, true);
+    }
+    tessellateClipped();
+}
+
+bool FillBucket::triangulate(size_t count) {
+    if (!earcut.isSimple(rings, count)) {
+        return false;
+    }
+
+    size_t total_vertex_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        total_vertex_count += rings[i].size();
+    }
+
+    if (total_vertex_count > 65536) {
+        throw geometry_too_long_exception();
+    }
+
+    // Triangulate every outer ring together with the holes that follow it. Nothing is added to
+    // the buffers until all of them succeeded, so we can still fall back to libtess2.
+    indices.clear();
+    uint32_t offset = 0;
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin + 1;
+        while (end < count && !ClipperLib::Orientation(rings[end])) {
+            end++;
+        }
+
+        const size_t first = indices.size();
+        if (!earcut.triangulate(rings, begin, end, indices)) {
+            return false;
+        }
+        for (size_t i = first; i < indices.size(); i++) {
+            indices[i] += offset;
+        }
+
+        for (; begin < end; begin++) {
+            offset += rings[begin].size();
+        }
+    }
+
+    if (!lineGroups.size() || (lineGroups.back().vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        lineGroups.emplace_back();
+    }
+
+    line_group_type& lineGroup = lineGroups.back();
+    uint32_t lineIndex = lineGroup.vertex_length;
+
+    vertexBuffer->reserve(vertexBuffer->index() + total_vertex_count);
+    lineElementsBuffer->reserve(lineElementsBuffer->index() + total_vertex_count);
+    triangleElementsBuffer->reserve(triangleElementsBuffer->index() + indices.size() / 3);
+
+    for (size_t r = 0; r < count; r++) {
+        const Earcut::Ring& ring = rings[r];
+        const size_t group_count = ring.size();
+
+        for (const ClipperLib::IntPoint& pt : ring) {
+            vertexBuffer->add(pt.X, pt.Y);
+        }
+
+        for (size_t i = 0; i < group_count; i++) {
+            const size_t prev_i = (i == 0 ? group_count : i) - 1;
+            lineElementsBuffer->add(lineIndex + prev_i, lineIndex + i);
+        }
+
+        lineIndex += group_count;
+    }
+
+    lineGroup.vertex_length += total_vertex_count;
+    lineGroup.elements_length += total_vertex_count;
+
+    if (!triangleGroups.size() || (triangleGroups.back().vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        triangleGroups.emplace_back();
+    }
+
+    triangle_group_type& triangleGroup = triangleGroups.back();
+    uint32_t triangleIndex = triangleGroup.vertex_length;
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        triangleElementsBuffer->add(triangleIndex + indices[i],
+                                    triangleIndex + indices[i + 1],
+                                    triangleIndex + indices[i + 2]);
+    }
+
+    triangleGroup.vertex_length += total_vertex_count;
+    triangleGroup.elements_length += indices.size() / 3;
+
+    return true;
+}
+
+void FillBucket::tessellateClipped() {
     std::vector<std::vector<ClipperLib::IntPoint>> polygons;
     clipper.Execute(ClipperLib::ctUnion, polygons, ClipperLib::pftPositive);
     clipper.Clear();
@@ -119,20 +222,25 @@ void FillBucket::tessellate() {
     line_group_type& lineGroup = lineGroups.back();
     uint32_t lineIndex = lineGroup.vertex_length;
 
+    // libtess2 copies the contours, so they are only needed until they're added.
+    util::Arena::Scope scope(arena);
+    util::ArenaVector<TESSreal> line { util::ArenaAllocator<TESSreal>(arena) };
+
     for (const std::vector<ClipperLib::IntPoint>& polygon : polygons) {
         const size_t group_count = polygon.size();
         assert(group_count >= 3);
 
-        std::vector<TESSreal> line;
+        line.clear();
+        line.reserve(group_count * 2);
         for (const ClipperLib::IntPoint& pt : polygon) {
             line.push_back(pt.X);
             line.push_back(pt.Y);
-            vertexBuffer.add(pt.X, pt.Y);
+            vertexBuffer->add(pt.X, pt.Y);
         }
 
         for (size_t i = 0; i < group_count; i++) {
             const size_t prev_i = (i == 0 ? group_count : i) - 1;
-            lineElementsBuffer.add(lineIndex + prev_i, lineIndex + i);
+            lineElementsBuffer->add(lineIndex + prev_i, lineIndex + i);
         }
 
         lineIndex += group_count;
@@ -151,7 +259,7 @@ void FillBucket::tessellate() {
 
         for (size_t i = 0; i < vertex_count; ++i) {
             if (vertex_indices[i] == TESS_UNDEF) {
-                vertexBuffer.add(std::round(vertices[i * 2]), std::round(vertices[i * 2 + 1]));
+                vertexBuffer->add(std::round(vertices[i * 2]), std::round(vertices[i * 2 + 1]));
                 vertex_indices[i] = (TESSindex)total_vertex_count;
                 total_vertex_count++;
             }
@@ -176,7 +284,7 @@ void FillBucket::tessellate() {
                 const TESSindex c = vertex_indices[element_group[2]];
 
                 if (a != TESS_UNDEF && b != TESS_UNDEF && c != TESS_UNDEF) {
-                    triangleElementsBuffer.add(triangleIndex + a, triangleIndex + b, triangleIndex + c);
+                    triangleElementsBuffer->add(triangleIndex + a, triangleIndex + b, triangleIndex + c);
                 } else {
 #if defined(DEBUG)
                     // TODO: We're missing a vertex that was not part of the line.
@@ -212,35 +320,56 @@ bool FillBucket::hasData() const {
     return !triangleGroups.empty() || !lineGroups.empty();
 }
 
+void FillBucket::moveTo(FillVertexBuffer &vertexBuffer_,
+                        TriangleElementsBuffer &triangleElementsBuffer_,
+                        LineElementsBuffer &lineElementsBuffer_) {
+    vertex_start += vertexBuffer_.append(*vertexBuffer);
+    triangle_elements_start += triangleElementsBuffer_.append(*triangleElementsBuffer);
+    line_elements_start += lineElementsBuffer_.append(*lineElementsBuffer);
+    vertexBuffer = &vertexBuffer_;
+    triangleElementsBuffer = &triangleElementsBuffer_;
+    lineElementsBuffer = &lineElementsBuffer_;
+}
+
+void FillBucket::releaseGPU() {
+    array.releaseGPU();
+    for (triangle_group_type& group : triangleGroups) {
+        group.releaseGPU();
+    }
+    for (line_group_type& group : lineGroups) {
+        group.releaseGPU();
+    }
+}
+
 void FillBucket::drawElements(PlainShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (triangle_group_type& group : triangleGroups) {
-        group.array[0].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
-        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index);
-        vertex_index += group.vertex_length * vertexBuffer.itemSize;
-        elements_index += group.elements_length * triangleElementsBuffer.itemSize;
+        group.array[0].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
+        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index + triangleElementsBuffer->getOffset());
+        vertex_index += group.vertex_length * vertexBuffer->itemSize;
+        elements_index += group.elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void FillBucket::drawElements(PatternShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (triangle_group_type& group : triangleGroups) {
-        group.array[1].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
-        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index);
-        vertex_index += group.vertex_length * vertexBuffer.itemSize;
-        elements_index += group.elements_length * triangleElementsBuffer.itemSize;
+        group.array[1].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
+        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index + triangleElementsBuffer->getOffset());
+        vertex_index += group.vertex_length * vertexBuffer->itemSize;
+        elements_index += group.elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void FillBucket::drawVertices(OutlineShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(line_elements_start * lineElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(line_elements_start * lineElementsBuffer->itemSize);
     for (line_group_type& group : lineGroups) {
-        group.array[0].bind(shader, vertexBuffer, lineElementsBuffer, vertex_index);
-        glDrawElements(GL_LINES, group.elements_length * 2, GL_UNSIGNED_SHORT, elements_index);
-        vertex_index += group.vertex_length * vertexBuffer.itemSize;
-        elements_index += group.elements_length * lineElementsBuffer.itemSize;
+        group.array[0].bind(shader, *vertexBuffer, *lineElementsBuffer, vertex_index);
+        glDrawElements(GL_LINES, group.elements_length * 2, GL_UNSIGNED_SHORT, elements_index + lineElementsBuffer->getOffset());
+        vertex_index += group.vertex_length * vertexBuffer->itemSize;
+        elements_index += group.elements_length * lineElementsBuffer->itemSize;
     }
 }
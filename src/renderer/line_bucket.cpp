@@ -20,11 +20,13 @@ using namespace mbgl;
 LineBucket::LineBucket(LineVertexBuffer& vertexBuffer,
                        TriangleElementsBuffer& triangleElementsBuffer,
                        PointElementsBuffer& pointElementsBuffer,
-                       const StyleBucketLine& properties)
+                       const StyleBucketLine& properties,
+                       util::Arena& arena)
     : properties(properties),
-      vertexBuffer(vertexBuffer),
-      triangleElementsBuffer(triangleElementsBuffer),
-      pointElementsBuffer(pointElementsBuffer),
+      arena(arena),
+      vertexBuffer(&vertexBuffer),
+      triangleElementsBuffer(&triangleElementsBuffer),
+      pointElementsBuffer(&pointElementsBuffer),
       vertex_start(vertexBuffer.index()),
       triangle_elements_start(triangleElementsBuffer.index()),
       point_elements_start(pointElementsBuffer.index())
@@ -32,22 +34,8 @@ LineBucket::LineBucket(LineVertexBuffer& vertexBuffer,
 }
 
 void LineBucket::addGeometry(pbf& geom) {
-    std::vector<Coordinate> line;
-    Geometry::command cmd;
-
-    Coordinate coord;
     Geometry geometry(geom);
-    int32_t x, y;
-    while ((cmd = geometry.next(x, y)) != Geometry::end) {
-        if (cmd == Geometry::move_to) {
-            if (!line.empty()) {
-                addGeometry(line);
-                line.clear();
-            }
-        }
-        line.emplace_back(x, y);
-    }
-    if (line.size()) {
+    while (geometry.nextRing(line)) {
         addGeometry(line);
     }
 }
@@ -98,10 +86,14 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         nextNormal = util::normal<double>(currentVertex, lastVertex);
     }
 
-    int32_t start_vertex = (int32_t)vertexBuffer.index();
+    int32_t start_vertex = (int32_t)vertexBuffer->index();
 
-    std::vector<TriangleElement> triangle_store;
-    std::vector<PointElement> point_store;
+    // The elements are only needed until they are copied to the buffers below.
+    util::Arena::Scope scope(arena);
+    util::ArenaVector<TriangleElement> triangle_store { util::ArenaAllocator<TriangleElement>(arena) };
+    util::ArenaVector<PointElement> point_store { util::ArenaAllocator<PointElement>(arena) };
+    triangle_store.reserve(vertices.size() * 2);
+    vertexBuffer->reserve(vertexBuffer->index() + vertices.size() * 2);
 
     for (size_t i = 0; i < vertices.size(); ++i) {
         if (nextNormal) prevNormal = { -nextNormal.x, -nextNormal.y };
@@ -169,7 +161,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         // Add offset square begin cap.
         if (!prevVertex && beginCap == CapType::Square) {
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * (prevNormal.x + prevNormal.y), flip * (-prevNormal.x + prevNormal.y), // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -177,7 +169,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * (prevNormal.x - prevNormal.y), flip * (prevNormal.x + prevNormal.y), // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -188,7 +180,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         // Add offset square end cap.
         else if (!nextVertex && endCap == CapType::Square) {
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    nextNormal.x - flip * nextNormal.y, flip * nextNormal.x + nextNormal.y, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -196,7 +188,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    nextNormal.x + flip * nextNormal.y, -flip * nextNormal.x + nextNormal.y, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -222,7 +214,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             }
 
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * joinNormal.x, flip * joinNormal.y, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -230,7 +222,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * joinNormal.x, -flip * joinNormal.y, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -246,7 +238,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         else {
             // Close up the previous line
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * prevNormal.y, -flip * prevNormal.x, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -254,7 +246,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex.
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * prevNormal.y, flip * prevNormal.x, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -284,7 +276,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
             // Start the new quad.
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * nextNormal.y, flip * nextNormal.x, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -292,7 +284,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * nextNormal.y, -flip * nextNormal.x, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -301,7 +293,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         }
     }
 
-    size_t end_vertex = vertexBuffer.index();
+    size_t end_vertex = vertexBuffer->index();
     size_t vertex_count = end_vertex - start_vertex;
 
     // Store the triangle/line groups.
@@ -312,8 +304,9 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         }
 
         triangle_group_type& group = triangleGroups.back();
+        triangleElementsBuffer->reserve(triangleElementsBuffer->index() + triangle_store.size());
         for (const TriangleElement& triangle : triangle_store) {
-            triangleElementsBuffer.add(
+            triangleElementsBuffer->add(
                 group.vertex_length + triangle.a,
                 group.vertex_length + triangle.b,
                 group.vertex_length + triangle.c
@@ -332,8 +325,9 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         }
 
         point_group_type& group = pointGroups.back();
+        pointElementsBuffer->reserve(pointElementsBuffer->index() + point_store.size());
         for (PointElement point : point_store) {
-            pointElementsBuffer.add(group.vertex_length + point);
+            pointElementsBuffer->add(group.vertex_length + point);
         }
 
         group.vertex_length += vertex_count;
@@ -349,6 +343,26 @@ bool LineBucket::hasData() const {
     return !triangleGroups.empty() || !pointGroups.empty();
 }
 
+void LineBucket::moveTo(LineVertexBuffer &vertexBuffer_,
+                        TriangleElementsBuffer &triangleElementsBuffer_,
+                        PointElementsBuffer &pointElementsBuffer_) {
+    vertex_start += vertexBuffer_.append(*vertexBuffer);
+    triangle_elements_start += triangleElementsBuffer_.append(*triangleElementsBuffer);
+    point_elements_start += pointElementsBuffer_.append(*pointElementsBuffer);
+    vertexBuffer = &vertexBuffer_;
+    triangleElementsBuffer = &triangleElementsBuffer_;
+    pointElementsBuffer = &pointElementsBuffer_;
+}
+
+void LineBucket::releaseGPU() {
+    for (triangle_group_type& group : triangleGroups) {
+        group.releaseGPU();
+    }
+    for (point_group_type& group : pointGroups) {
+        group.releaseGPU();
+    }
+}
+
 bool LineBucket::hasPoints() const {
     if (!pointGroups.empty()) {
         for (const point_group_type& group : pointGroups) {
@@ -361,29 +375,29 @@ bool LineBucket::hasPoints() const {
 }
 
 void LineBucket::drawLines(LineShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (triangle_group_type& group : triangleGroups) {
         if (!group.elements_length) {
             continue;
         }
-        group.array[0].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
-        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index);
-        vertex_index += group.vertex_length * vertexBuffer.itemSize;
-        elements_index += group.elements_length * triangleElementsBuffer.itemSize;
+        group.array[0].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
+        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index + triangleElementsBuffer->getOffset());
+        vertex_index += group.vertex_length * vertexBuffer->itemSize;
+        elements_index += group.elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void LineBucket::drawPoints(LinejoinShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(point_elements_start * pointElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(point_elements_start * pointElementsBuffer->itemSize);
     for (point_group_type& group : pointGroups) {
         if (!group.elements_length) {
             continue;
         }
-        group.array[0].bind(shader, vertexBuffer, pointElementsBuffer, vertex_index);
-        glDrawElements(GL_POINTS, group.elements_length, GL_UNSIGNED_SHORT, elements_index);
-        vertex_index += group.vertex_length * vertexBuffer.itemSize;
-        elements_index += group.elements_length * pointElementsBuffer.itemSize;
+        group.array[0].bind(shader, *vertexBuffer, *pointElementsBuffer, vertex_index);
+        glDrawElements(GL_POINTS, group.elements_length, GL_UNSIGNED_SHORT, elements_index + pointElementsBuffer->getOffset());
+        vertex_index += group.vertex_length * vertexBuffer->itemSize;
+        elements_index += group.elements_length * pointElementsBuffer->itemSize;
     }
 }
@@ -38,7 +38,7 @@ void Painter::renderSymbol(SymbolBucket &bucket, std::shared_ptr<StyleLayer> lay
         GlyphAtlas &glyphAtlas = *map.getGlyphAtlas();
         glyphAtlas.bind();
         textShader->setTextureSize(
-            {{static_cast<float>(glyphAtlas.width), static_cast<float>(glyphAtlas.height)}});
+            {{static_cast<float>(glyphAtlas.getTextureWidth()), static_cast<float>(glyphAtlas.getTextureHeight())}});
 
         // Convert the -pi..pi to an int8 range.
         float angle = std::round((map.getState().getAngle()) / M_PI * 128);
@@ -94,6 +94,7 @@ void Painter::renderSymbol(SymbolBucket &bucket, std::shared_ptr<StyleLayer> lay
         textShader->setMinFadeZoom(std::floor(lowZ * 10));
         textShader->setMaxFadeZoom(std::floor(highZ * 10));
         textShader->setFadeZoom((map.getState().getNormalizedZoom() + bump) * 10);
+        textShader->setFadeChange(bucket.getFadeChange(currentTime));
 
         // This defines the gamma around the SDF cutoff value.
         const float sdfGamma = 1.0f / 10.0f;
@@ -210,6 +211,7 @@ void Painter::renderSymbol(SymbolBucket &bucket, std::shared_ptr<StyleLayer> lay
         iconShader->setMaxFadeZoom(map.getState().getNormalizedZoom() * 10);
         iconShader->setFadeZoom(map.getState().getNormalizedZoom() * 10);
         iconShader->setOpacity(properties.icon.opacity);
+        iconShader->setFadeChange(bucket.getFadeChange(util::now()));
 
         depthRange(strata, 1.0f);
         bucket.drawIcons(*iconShader);
@@ -32,5 +32,14 @@ void RasterBucket::drawRaster(RasterShader& shader, StaticVertexBuffer &vertices
 }
 
 bool RasterBucket::hasData() const {
-    return raster.isLoaded();
+    // Rasters whose upload was deferred are left out until they have a texture.
+    return raster.isLoaded() && raster.textured;
+}
+
+void RasterBucket::releaseGPU() {
+    raster.releaseGPU();
+}
+
+size_t RasterBucket::bytes() const {
+    return raster.bytes();
 }
@@ -17,10 +17,13 @@
 #include <mbgl/util/token.hpp>
 #include <mbgl/util/math.hpp>
 
+#include <functional>
+#include <limits>
+
 namespace mbgl {
 
-SymbolBucket::SymbolBucket(const StyleBucketSymbol &properties, Collision &collision)
-    : properties(properties), collision(collision) {}
+SymbolBucket::SymbolBucket(const StyleBucketSymbol &properties, Collision &collision, util::Arena &arena)
+    : properties(properties), collision(collision), arena(arena) {}
 
 void SymbolBucket::render(Painter &painter, std::shared_ptr<StyleLayer> layer_desc,
                           const Tile::ID &id, const mat4 &matrix) {
@@ -33,56 +36,108 @@ bool SymbolBucket::hasTextData() const { return !text.groups.empty(); }
 
 bool SymbolBucket::hasIconData() const { return !icon.groups.empty(); }
 
+void SymbolBucket::releaseGPU() {
+    text.vertices.releaseGPU();
+    text.triangles.releaseGPU();
+    text.opacity.releaseGPU();
+    for (TextElementGroup &group : text.groups) {
+        group.releaseGPU();
+    }
+
+    icon.vertices.releaseGPU();
+    icon.triangles.releaseGPU();
+    icon.opacity.releaseGPU();
+    for (IconElementGroup &group : icon.groups) {
+        group.releaseGPU();
+    }
+}
+
+size_t SymbolBucket::bytes() const {
+    return text.vertices.bytes() + text.triangles.bytes() + text.opacity.bytes() +
+           icon.vertices.bytes() + icon.triangles.bytes() + icon.opacity.bytes();
+}
+
+void SymbolBucket::setRetainAfterUpload(bool value) {
+    text.vertices.setRetainAfterUpload(value);
+    text.triangles.setRetainAfterUpload(value);
+    icon.vertices.setRetainAfterUpload(value);
+    icon.triangles.setRetainAfterUpload(value);
+}
+
+void SymbolBucket::setBufferpool(const std::shared_ptr<Bufferpool> &pool) {
+    text.vertices.setPool(pool);
+    text.triangles.setPool(pool);
+    icon.vertices.setPool(pool);
+    icon.triangles.setPool(pool);
+}
+
 void SymbolBucket::addGlyphsToAtlas(uint64_t tileid, const std::string stackname,
                                     const std::u32string &string, const FontStack &fontStack,
                                     GlyphAtlas &glyphAtlas, GlyphPositions &face) {
-    const std::map<uint32_t, SDFGlyph> &sdfs = fontStack.getSDFs();
     // Loop through all characters and add glyph to atlas, positions.
     for (uint32_t chr : string) {
-        auto sdf_it = sdfs.find(chr);
-        if (sdf_it != sdfs.end()) {
-            const SDFGlyph &sdf = sdf_it->second;
-            const Rect<uint16_t> rect = glyphAtlas.addGlyph(tileid, stackname, sdf);
-            face.emplace(chr, Glyph{rect, sdf.metrics});
+        const SDFGlyph *sdf = fontStack.getGlyph(chr);
+        if (sdf) {
+            const Rect<uint16_t> rect = glyphAtlas.addGlyph(tileid, stackname, *sdf);
+            face.emplace(chr, Glyph{rect, sdf->metrics});
         }
     }
 }
 
-std::vector<SymbolFeature> SymbolBucket::processFeatures(const VectorTileLayer &layer,
-                                                         const FilterExpression &filter,
-                                                         GlyphStore &glyphStore,
-                                                         const Sprite &sprite) {
-    const bool text = properties.text.field.size();
-    const bool icon = properties.icon.image.size();
+// Resolves the tokens of a template to the keys of the layer.
+std::vector<int32_t> tokenKeys(const util::TokenTemplate &tokens, const VectorTileLayer &layer) {
+    std::vector<int32_t> keys;
+    for (const std::string &token : tokens.getTokens()) {
+        keys.push_back(layer.getKeyIndex(token));
+    }
+    return keys;
+}
 
-    std::vector<SymbolFeature> features;
+util::ArenaVector<SymbolFeature> SymbolBucket::processFeatures(const VectorTileLayer &layer,
+                                                               const FilterExpression &filter,
+                                                               std::set<GlyphRange> &ranges) {
+    const bool text = !properties.text.field.empty();
+    const bool icon = !properties.icon.image.empty();
+
+    util::ArenaVector<SymbolFeature> features { util::ArenaAllocator<SymbolFeature>(arena) };
 
     if (!text && !icon) {
         return features;
     }
 
-    util::utf8_to_utf32 ucs4conv;
+    const std::vector<int32_t> textKeys = tokenKeys(properties.text.field, layer);
+    const std::vector<int32_t> iconKeys = tokenKeys(properties.icon.image, layer);
 
-    // Determine and load glyph ranges
-    std::set<GlyphRange> ranges;
+    std::string u8string;
+    std::u32string label;
 
     FilteredVectorTileLayer filtered_layer(layer, filter);
-    for (const pbf &feature_pbf : filtered_layer) {
-        const VectorTileFeature feature{feature_pbf, layer};
+    for (const VectorTileFeature &feature : filtered_layer) {
+        const auto appendValue = [&layer, &feature](int32_t key, std::string &result) {
+            const Value *value = layer.getValue(feature, key);
+            if (value) {
+                appendString(result, *value);
+            }
+        };
 
         SymbolFeature ft;
 
         if (text) {
-            std::string u8string = util::replaceTokens(properties.text.field, feature.properties);
+            u8string.clear();
+            properties.text.field.expand(u8string, [&](size_t token, std::string &result) {
+                appendValue(textKeys[token], result);
+            });
+
+            label.clear();
+            util::utf8ToUtf32(u8string, label);
 
-            auto &convert = std::use_facet<std::ctype<char>>(std::locale());
             if (properties.text.transform == TextTransformType::Uppercase) {
-                convert.toupper(&u8string[0], &u8string[0] + u8string.size());
+                util::toUpper(label);
             } else if (properties.text.transform == TextTransformType::Lowercase) {
-                convert.tolower(&u8string[0], &u8string[0] + u8string.size());
+                util::toLower(label);
             }
 
-            ft.label = ucs4conv.convert(u8string);
+            ft.label = label;
 
             if (ft.label.size()) {
                 // Loop through all characters of this text and collect unique codepoints.
@@ -93,7 +148,9 @@ std::vector<SymbolFeature> SymbolBucket::processFeatures(const VectorTileLayer &
         }
 
         if (icon) {
-            ft.sprite = util::replaceTokens(properties.icon.image, feature.properties);
+            properties.icon.image.expand(ft.sprite, [&](size_t token, std::string &result) {
+                appendValue(iconKeys[token], result);
+            });
         }
 
         if (ft.label.length() || ft.sprite.length()) {
@@ -102,18 +159,21 @@ std::vector<SymbolFeature> SymbolBucket::processFeatures(const VectorTileLayer &
         }
     }
 
-    glyphStore.waitForGlyphRanges(properties.text.font, ranges);
-    sprite.waitUntilLoaded();
-
     return features;
 }
 
-void SymbolBucket::addFeatures(const VectorTileLayer &layer, const FilterExpression &filter,
+// Labels with the same text and icon in the same layer get the same key in all tiles.
+uint32_t symbolKey(const StyleBucketSymbol &properties, const SymbolFeature &feature) {
+    size_t hash = std::hash<const void *>()(&properties);
+    hash ^= std::hash<std::u32string>()(feature.label) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<std::string>()(feature.sprite) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    const uint32_t key = uint32_t(hash ^ (uint64_t(hash) >> 32));
+    return key ? key : 1;
+}
+
+void SymbolBucket::addFeatures(const util::ArenaVector<SymbolFeature> &features,
                                const Tile::ID &id, SpriteAtlas &spriteAtlas, Sprite &sprite,
                                GlyphAtlas &glyphAtlas, GlyphStore &glyphStore) {
-
-    const std::vector<SymbolFeature> features = processFeatures(layer, filter, glyphStore, sprite);
-
     float horizontalAlign = 0.5;
     if (properties.text.horizontal_align == TextHorizontalAlignType::Right)
         horizontalAlign = 1;
@@ -131,15 +191,20 @@ void SymbolBucket::addFeatures(const VectorTileLayer &layer, const FilterExpress
     else if (properties.text.justify == TextJustifyType::Left) justify = 0;
 
     const FontStack &fontStack = glyphStore.getFontStack(properties.text.font);
+    ShapingCache &shapingCache = glyphStore.getShapingCache();
+    const Shaping noShaping;
 
     for (const SymbolFeature &feature : features) {
-        Shaping shaping;
+        util::Arena::Scope featureScope(arena);
+        std::shared_ptr<const Shaping> shapingPtr;
         Rect<uint16_t> image;
-        GlyphPositions face;
+        GlyphPositions face { std::less<uint32_t>(), GlyphPositions::allocator_type(arena) };
 
         // if feature has text, shape the text
         if (feature.label.length()) {
-            shaping = fontStack.getShaping(
+            shapingPtr = shapingCache.getShaping(
+                /* fontStackName */ properties.text.font,
+                /* stack */ fontStack,
                 /* string */ feature.label,
                 /* maxWidth */ properties.text.max_width,
                 /* lineHeight */ properties.text.line_height,
@@ -148,47 +213,34 @@ void SymbolBucket::addFeatures(const VectorTileLayer &layer, const FilterExpress
                 /* justify */ justify,
                 /* spacing */ properties.text.letter_spacing,
                 /* translate */ properties.text.offset);
+        }
+        const Shaping &shaping = shapingPtr ? *shapingPtr : noShaping;
 
-            // Add the glyphs we need for this label to the glyph atlas.
-            if (shaping.size()) {
-                addGlyphsToAtlas(id.to_uint64(), properties.text.font, feature.label, fontStack,
-                                 glyphAtlas, face);
-            }
+        // Add the glyphs we need for this label to the glyph atlas.
+        if (shaping.size()) {
+            addGlyphsToAtlas(id.to_uint64(), properties.text.font, feature.label, fontStack,
+                             glyphAtlas, face);
         }
 
         // if feature has icon, get sprite atlas position
         if (feature.sprite.length()) {
-            image = spriteAtlas.waitForImage(feature.sprite, sprite);
+            image = spriteAtlas.getImage(feature.sprite, sprite);
         }
 
         // if either shaping or icon position is present, add the feature
         if (shaping.size() || image) {
-            addFeature(feature.geometry, shaping, face, image);
+            addFeature(feature.geometry, symbolKey(properties, feature), shaping, face, image);
         }
     }
 }
 
-void SymbolBucket::addFeature(const pbf &geom_pbf, const Shaping &shaping,
+void SymbolBucket::addFeature(const pbf &geom_pbf, uint32_t key, const Shaping &shaping,
                               const GlyphPositions &face, const Rect<uint16_t> &image) {
     // Decode all lines.
-    std::vector<Coordinate> line;
-    Geometry::command cmd;
-
-    Coordinate coord;
     pbf geom(geom_pbf);
     Geometry geometry(geom);
-    int32_t x, y;
-    while ((cmd = geometry.next(x, y)) != Geometry::end) {
-        if (cmd == Geometry::move_to) {
-            if (!line.empty()) {
-                addFeature(line, shaping, face, image);
-                line.clear();
-            }
-        }
-        line.emplace_back(x, y);
-    }
-    if (line.size()) {
-        addFeature(line, shaping, face, image);
+    while (geometry.nextRing(line)) {
+        addFeature(line, key, shaping, face, image);
     }
 }
 
@@ -196,7 +248,21 @@ bool byScale(const Anchor &a, const Anchor &b) { return a.scale < b.scale; }
 
 const PlacementRange fullRange{{2 * M_PI, 0}};
 
-void SymbolBucket::addFeature(const std::vector<Coordinate> &line, const Shaping &shaping,
+// Extends the box, in screen pixels around the anchor, by the placement boxes.
+void addBoxes(CollisionRect &box, const GlyphBoxes &boxes, const Anchor &anchor, float tilePixelRatio) {
+    for (const GlyphBox &glyph : boxes) {
+        // Glyphs of curved labels are placed around their own anchors along the line.
+        const bool ownAnchor = glyph.anchor.x || glyph.anchor.y;
+        const float dx = ownAnchor ? (glyph.anchor.x - anchor.x) / tilePixelRatio : 0;
+        const float dy = ownAnchor ? (glyph.anchor.y - anchor.y) / tilePixelRatio : 0;
+        box.tl.x = util::min(box.tl.x, dx + glyph.box.tl.x / tilePixelRatio - glyph.padding);
+        box.tl.y = util::min(box.tl.y, dy + glyph.box.tl.y / tilePixelRatio - glyph.padding);
+        box.br.x = util::max(box.br.x, dx + glyph.box.br.x / tilePixelRatio + glyph.padding);
+        box.br.y = util::max(box.br.y, dy + glyph.box.br.y / tilePixelRatio + glyph.padding);
+    }
+}
+
+void SymbolBucket::addFeature(const std::vector<Coordinate> &line, uint32_t key, const Shaping &shaping,
                               const GlyphPositions &face, const Rect<uint16_t> &image) {
     assert(line.size());
 
@@ -295,20 +361,51 @@ void SymbolBucket::addFeature(const std::vector<Coordinate> &line, const Shaping
             iconRange = maxRange;
         }
 
+        // Labels of this tile are placed against those of the other tiles in the view as well.
+        SymbolInstance instance;
+        instance.key = key;
+        instance.anchor = CollisionAnchor{anchor.x, anchor.y};
+        instance.minZoom = std::log(util::max(glyphScale, iconScale)) / std::log(2) + collision.zoom;
+        if (properties.placement == PlacementType::Line) {
+            instance.repeatDistance = properties.min_distance;
+        }
+        instance.allowOverlap = (!glyphScale || properties.text.allow_overlap) &&
+                                (!iconScale || properties.icon.allow_overlap);
+        instance.ignorePlacement = (!glyphScale || properties.text.ignore_placement) &&
+                                   (!iconScale || properties.icon.ignore_placement);
+        instance.rotateWithMap = (glyphScale && !horizontalText) || (iconScale && !horizontalIcon);
+
+        const float inf = std::numeric_limits<float>::infinity();
+        instance.box = CollisionRect{inf, inf, -inf, -inf};
+
         // Insert final placement into collision tree and add glyphs/icons to buffers
         if (glyphScale) {
             if (!properties.text.ignore_placement) {
                 collision.insert(glyphPlacement.boxes, anchor, glyphScale, glyphRange,
                                  horizontalText);
             }
-            if (inside) addSymbols(text, glyphPlacement.shapes, glyphScale, glyphRange);
+            if (inside) {
+                instance.textStart = text.vertices.index();
+                addSymbols(text, glyphPlacement.shapes, glyphScale, glyphRange);
+                instance.textEnd = text.vertices.index();
+                addBoxes(instance.box, glyphPlacement.boxes, anchor, collision.tilePixelRatio);
+            }
         }
 
         if (iconScale) {
             if (!properties.icon.ignore_placement) {
                 collision.insert(iconPlacement.boxes, anchor, iconScale, iconRange, horizontalIcon);
             }
-            if (inside) addSymbols(icon, iconPlacement.shapes, iconScale, iconRange);
+            if (inside) {
+                instance.iconStart = icon.vertices.index();
+                addSymbols(icon, iconPlacement.shapes, iconScale, iconRange);
+                instance.iconEnd = icon.vertices.index();
+                addBoxes(instance.box, iconPlacement.boxes, anchor, collision.tilePixelRatio);
+            }
+        }
+
+        if (instance.textEnd > instance.textStart || instance.iconEnd > instance.iconStart) {
+            instances.push_back(instance);
         }
     }
 }
@@ -320,6 +417,10 @@ void SymbolBucket::addSymbols(Buffer &buffer, const PlacedGlyphs &symbols, float
 
     const float placementZoom = std::log(scale) / std::log(2) + zoom;
 
+    // Every glyph is a quad of four vertices and two triangles.
+    buffer.vertices.reserve(buffer.vertices.index() + symbols.size() * 4);
+    buffer.triangles.reserve(buffer.triangles.index() + symbols.size() * 2);
+
     for (const PlacedGlyph &symbol : symbols) {
         const auto &tl = symbol.tl;
         const auto &tr = symbol.tr;
@@ -372,15 +473,50 @@ void SymbolBucket::addSymbols(Buffer &buffer, const PlacedGlyphs &symbols, float
         triangleGroup.vertex_length += glyph_vertex_length;
         triangleGroup.elements_length += 2;
     }
+
+    // Labels are hidden until they have been placed in the view.
+    buffer.opacity.add(buffer.vertices.index() - buffer.opacity.index());
+}
+
+void SymbolBucket::setPlacement(const std::vector<bool> &visible, timestamp now, bool fade) {
+    assert(visible.size() == instances.size());
+    const float change = getFadeChange(now);
+    fades.resize(instances.size());
+
+    for (size_t i = 0; i < instances.size(); i++) {
+        const SymbolInstance &instance = instances[i];
+        Fade &state = fades[i];
+
+        // The opacity that the label has faded to by now, which is where the next fade starts.
+        if (fade) {
+            state.opacity = util::clamp(state.opacity + (state.visible ? change : -change), 0.0f, 1.0f);
+        } else {
+            state.opacity = visible[i] ? 1 : 0;
+        }
+        state.visible = visible[i];
+
+        text.opacity.set(instance.textStart, instance.textEnd, state.opacity, state.visible);
+        icon.opacity.set(instance.iconStart, instance.iconEnd, state.opacity, state.visible);
+    }
+
+    placedAt = now;
+}
+
+float SymbolBucket::getFadeChange(timestamp now) const {
+    return util::min(float(now - placedAt) / LabelPlacement::FadeDuration, 1.0f);
 }
 
 void SymbolBucket::drawGlyphs(TextShader &shader) {
     char *vertex_index = BUFFER_OFFSET(0);
     char *elements_index = BUFFER_OFFSET(0);
+    char *fade_index = BUFFER_OFFSET(0);
     for (TextElementGroup &group : text.groups) {
         group.array[0].bind(shader, text.vertices, text.triangles, vertex_index);
-        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index);
+        text.opacity.bind();
+        shader.bindFade(fade_index);
+        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index + text.triangles.getOffset());
         vertex_index += group.vertex_length * text.vertices.itemSize;
+        fade_index += group.vertex_length * text.opacity.itemSize;
         elements_index += group.elements_length * text.triangles.itemSize;
     }
 }
@@ -388,10 +524,14 @@ void SymbolBucket::drawGlyphs(TextShader &shader) {
 void SymbolBucket::drawIcons(IconShader &shader) {
     char *vertex_index = BUFFER_OFFSET(0);
     char *elements_index = BUFFER_OFFSET(0);
+    char *fade_index = BUFFER_OFFSET(0);
     for (IconElementGroup &group : icon.groups) {
         group.array[0].bind(shader, icon.vertices, icon.triangles, vertex_index);
-        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index);
+        icon.opacity.bind();
+        shader.bindFade(fade_index);
+        glDrawElements(GL_TRIANGLES, group.elements_length * 3, GL_UNSIGNED_SHORT, elements_index + icon.triangles.getOffset());
         vertex_index += group.vertex_length * icon.vertices.itemSize;
+        fade_index += group.vertex_length * icon.opacity.itemSize;
         elements_index += group.elements_length * icon.triangles.itemSize;
     }
 }
@@ -0,0 +1,22 @@
+#include <mbgl/renderer/upload_scheduler.hpp>
+
+using namespace mbgl;
+
+void UploadScheduler::beginFrame(size_t budget_) {
+    budget = budget_;
+    stats = Stats();
+}
+
+bool UploadScheduler::acquire(size_t bytes) {
+    if (stats.uploaded > 0 && stats.uploaded + bytes > budget) {
+        stats.deferred++;
+        stats.deferredBytes += bytes;
+        return false;
+    }
+    stats.uploaded += bytes;
+    return true;
+}
+
+void UploadScheduler::record(size_t bytes) {
+    stats.uploaded += bytes;
+}
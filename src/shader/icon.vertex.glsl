@@ -7,6 +7,7 @@ attribute float a_maxzoom;
 attribute float a_rangeend;
 attribute float a_rangestart;
 attribute float a_labelminzoom;
+attribute vec2 a_fade;
 
 
 // posmatrix is for the vertex position, exmatrix is for rotating and projecting
@@ -20,6 +21,7 @@ uniform float u_fadedist;
 uniform float u_minfadezoom;
 uniform float u_maxfadezoom;
 uniform float u_fadezoom;
+uniform float u_fadechange;
 uniform float u_opacity;
 
 uniform vec2 u_texsize;
@@ -59,6 +61,10 @@ void main() {
         v_alpha = 1.0;
     }
 
+    // fade labels in and out as the label placement shows and hides them; a_fade is the opacity
+    // at the last placement and whether the label is fading in
+    v_alpha *= clamp(a_fade.x + (a_fade.y * 2.0 - 1.0) * u_fadechange, 0.0, 1.0);
+
     // if label has been faded out, clip it
     z += step(v_alpha, 0.0);
 
@@ -26,6 +26,7 @@ IconShader::IconShader()
     a_rangeend = glGetAttribLocation(program, "a_rangeend");
     a_rangestart = glGetAttribLocation(program, "a_rangestart");
     a_labelminzoom = glGetAttribLocation(program, "a_labelminzoom");
+    a_fade = glGetAttribLocation(program, "a_fade");
 
     u_matrix = glGetUniformLocation(program, "u_matrix");
     u_exmatrix = glGetUniformLocation(program, "u_exmatrix");
@@ -36,6 +37,7 @@ IconShader::IconShader()
     u_minfadezoom = glGetUniformLocation(program, "u_minfadezoom");
     u_maxfadezoom = glGetUniformLocation(program, "u_maxfadezoom");
     u_fadezoom = glGetUniformLocation(program, "u_fadezoom");
+    u_fadechange = glGetUniformLocation(program, "u_fadechange");
     u_opacity = glGetUniformLocation(program, "u_opacity");
     u_texsize = glGetUniformLocation(program, "u_texsize");
 
@@ -83,6 +85,11 @@ void IconShader::bind(char *offset) {
     glVertexAttribPointer(a_tex, 2, GL_SHORT, false, stride, offset + 16);
 }
 
+void IconShader::bindFade(char *offset) {
+    glEnableVertexAttribArray(a_fade);
+    glVertexAttribPointer(a_fade, 2, GL_UNSIGNED_BYTE, true, 4, offset);
+}
+
 void IconShader::setExtrudeMatrix(const std::array<float, 16>& new_exmatrix) {
     if (exmatrix != new_exmatrix) {
         glUniformMatrix4fv(u_exmatrix, 1, GL_FALSE, new_exmatrix.data());
@@ -139,6 +146,13 @@ void IconShader::setFadeZoom(float new_fadezoom) {
     }
 }
 
+void IconShader::setFadeChange(float new_fadechange) {
+    if (fadechange != new_fadechange) {
+        glUniform1f(u_fadechange, new_fadechange);
+        fadechange = new_fadechange;
+    }
+}
+
 void IconShader::setOpacity(float new_opacity) {
     if (opacity != new_opacity) {
         glUniform1f(u_opacity, new_opacity);
@@ -2,6 +2,7 @@ attribute vec2 a_pos;
 attribute vec2 a_offset;
 attribute vec4 a_data1;
 attribute vec4 a_data2;
+attribute vec2 a_fade;
 
 
 // posmatrix is for the vertex position, exmatrix is for rotating and projecting
@@ -15,6 +16,7 @@ uniform float u_fadedist;
 uniform float u_minfadezoom;
 uniform float u_maxfadezoom;
 uniform float u_fadezoom;
+uniform float u_fadechange;
 
 uniform vec2 u_texsize;
 
@@ -57,6 +59,10 @@ void main() {
         v_alpha = 1.0;
     }
 
+    // fade labels in and out as the label placement shows and hides them; a_fade is the opacity
+    // at the last placement and whether the label is fading in
+    v_alpha *= clamp(a_fade.x + (a_fade.y * 2.0 - 1.0) * u_fadechange, 0.0, 1.0);
+
     // if label has been faded out, clip it
     z += step(v_alpha, 0.0);
 
@@ -21,6 +21,7 @@ TextShader::TextShader()
     a_offset = glGetAttribLocation(program, "a_offset");
     a_data1 = glGetAttribLocation(program, "a_data1");
     a_data2 = glGetAttribLocation(program, "a_data2");
+    a_fade = glGetAttribLocation(program, "a_fade");
 
     u_matrix = glGetUniformLocation(program, "u_matrix");
     u_color = glGetUniformLocation(program, "u_color");
@@ -34,6 +35,7 @@ TextShader::TextShader()
     u_minfadezoom = glGetUniformLocation(program, "u_minfadezoom");
     u_maxfadezoom = glGetUniformLocation(program, "u_maxfadezoom");
     u_fadezoom = glGetUniformLocation(program, "u_fadezoom");
+    u_fadechange = glGetUniformLocation(program, "u_fadechange");
     u_texsize = glGetUniformLocation(program, "u_texsize");
 
     // fprintf(stderr, "TextShader:\n");
@@ -70,6 +72,11 @@ void TextShader::bind(char *offset) {
     glVertexAttribPointer(a_data2, 4, GL_UNSIGNED_BYTE, false, 16, offset + 12);
 }
 
+void TextShader::bindFade(char *offset) {
+    glEnableVertexAttribArray(a_fade);
+    glVertexAttribPointer(a_fade, 2, GL_UNSIGNED_BYTE, true, 4, offset);
+}
+
 void TextShader::setColor(const std::array<float, 4>& new_color) {
     if (color != new_color) {
         glUniform4fv(u_color, 1, new_color.data());
@@ -151,6 +158,13 @@ void TextShader::setFadeZoom(float new_fadezoom) {
     }
 }
 
+void TextShader::setFadeChange(float new_fadechange) {
+    if (fadechange != new_fadechange) {
+        glUniform1f(u_fadechange, new_fadechange);
+        fadechange = new_fadechange;
+    }
+}
+
 void TextShader::setTextureSize(const std::array<float, 2> &new_texsize) {
     if (texsize != new_texsize) {
         glUniform2fv(u_texsize, 1, new_texsize.data());
@@ -92,6 +92,16 @@ bool FilterComparison::Instance::compare(const std::vector<Value> &property_valu
 }
 
 
+bool FilterComparison::compare(const std::vector<Value> &values) const {
+    // All instances are ANDed together.
+    for (const Instance &instance : instances) {
+        if (!instance.compare(values)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 const std::string &FilterComparison::getField() const {
     return field;
 }
@@ -90,6 +90,15 @@ template<> bool StyleParser::parseRenderProperty(JSVal value, std::string &targe
     return false;
 }
 
+template<> bool StyleParser::parseRenderProperty(JSVal value, util::TokenTemplate &target, const char *name) {
+    std::string source;
+    if (parseRenderProperty(value, source, name)) {
+        target = source;
+        return true;
+    }
+    return false;
+}
+
 template<> bool StyleParser::parseRenderProperty(JSVal value, float &target, const char *name) {
     if (value.HasMember(name)) {
         JSVal property = replaceConstant(value[name]);
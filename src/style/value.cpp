@@ -35,10 +35,16 @@ mbgl::Value mbgl::parseValue(pbf data) {
 }
 
 std::string mbgl::toString(const mbgl::Value& value) {
-    if (value.is<std::string>()) return value.get<std::string>();
-    else if (value.is<bool>()) return value.get<bool>() ? "true" : "false";
-    else if (value.is<int64_t>()) return std::to_string(value.get<int64_t>());
-    else if (value.is<uint64_t>()) return std::to_string(value.get<uint64_t>());
-    else if (value.is<double>()) return boost::lexical_cast<std::string>(value.get<double>());
-    else return "null";
+    std::string result;
+    appendString(result, value);
+    return result;
+}
+
+void mbgl::appendString(std::string &result, const mbgl::Value& value) {
+    if (value.is<std::string>()) result += value.get<std::string>();
+    else if (value.is<bool>()) result += value.get<bool>() ? "true" : "false";
+    else if (value.is<int64_t>()) result += std::to_string(value.get<int64_t>());
+    else if (value.is<uint64_t>()) result += std::to_string(value.get<uint64_t>());
+    else if (value.is<double>()) result += boost::lexical_cast<std::string>(value.get<double>());
+    else result += "null";
 }
@@ -1,10 +1,123 @@
 #include <mbgl/text/collision.hpp>
 #include <mbgl/text/rotation_range.hpp>
 #include <mbgl/util/math.hpp>
+#include <mbgl/util/std.hpp>
 
+#include <algorithm>
 
 using namespace mbgl;
 
+namespace {
+
+// Cells of the grid index are this many tile units wide, so that the 4096 extent is covered by
+// 8x8 cells. Boxes of labels are searched at half their size and with room for rotation, which
+// makes them several hundred units wide; smaller cells would store most of them many times.
+// Cells along the border also hold the boxes that extend beyond the tile.
+const float GridCellSize = 512;
+const int GridSize = 8;
+
+class GridIndex : public PlacementIndex {
+public:
+    GridIndex() : cells(GridSize * GridSize) {}
+
+    virtual void insert(const std::vector<PlacementValue> &placed) {
+        for (const PlacementValue &value : placed) {
+            const Entry entry {
+                value.first.min_corner().get<0>(), value.first.min_corner().get<1>(),
+                value.first.max_corner().get<0>(), value.first.max_corner().get<1>(),
+                uint32_t(values.size())
+            };
+            values.push_back(value);
+            seen.push_back(0);
+            forEachCell(value.first, [&entry](std::vector<Entry> &cell) {
+                cell.push_back(entry);
+            });
+        }
+    }
+
+    virtual void query(const Box &box, std::vector<const PlacementValue *> &result) {
+        if (values.empty()) {
+            return;
+        }
+
+        // Values that span several cells are reported once.
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+
+        const float x1 = box.min_corner().get<0>(), y1 = box.min_corner().get<1>();
+        const float x2 = box.max_corner().get<0>(), y2 = box.max_corner().get<1>();
+        forEachCell(box, [&](const std::vector<Entry> &cell) {
+            for (const Entry &entry : cell) {
+                if (!(entry.x2 < x1 || x2 < entry.x1 || entry.y2 < y1 || y2 < entry.y1) &&
+                    seen[entry.index] != stamp) {
+                    seen[entry.index] = stamp;
+                    result.push_back(&values[entry.index]);
+                }
+            }
+        });
+    }
+
+private:
+    // The bounds are stored in the cells, so that queries don't have to look up the values of
+    // boxes that don't intersect.
+    struct Entry {
+        float x1, y1, x2, y2;
+        uint32_t index;
+    };
+
+    static int cell(float position) {
+        if (!(position >= GridCellSize)) return 0;
+        if (position >= GridCellSize * (GridSize - 1)) return GridSize - 1;
+        return position / GridCellSize;
+    }
+
+    template <typename Fn>
+    void forEachCell(const Box &box, Fn fn) {
+        const int x1 = cell(box.min_corner().get<0>()), x2 = cell(box.max_corner().get<0>());
+        const int y1 = cell(box.min_corner().get<1>()), y2 = cell(box.max_corner().get<1>());
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) {
+                fn(cells[y * GridSize + x]);
+            }
+        }
+    }
+
+    std::vector<std::vector<Entry>> cells;
+    std::vector<PlacementValue> values;
+
+    // The last query that reported each value.
+    std::vector<uint32_t> seen;
+    uint32_t stamp = 0;
+};
+
+class RTreeIndex : public PlacementIndex {
+public:
+    virtual void insert(const std::vector<PlacementValue> &placed) {
+        tree.insert(placed.begin(), placed.end());
+    }
+
+    virtual void query(const Box &box, std::vector<const PlacementValue *> &result) {
+        // Query iterators refer to the values in the tree.
+        for (auto it = tree.qbegin(bgi::intersects(box)); it != tree.qend(); ++it) {
+            result.push_back(&*it);
+        }
+    }
+
+private:
+    Tree tree;
+};
+
+std::unique_ptr<PlacementIndex> createIndex(PlacementIndexType type) {
+    if (type == PlacementIndexType::RTree) {
+        return std::make_unique<RTreeIndex>();
+    }
+    return std::make_unique<GridIndex>();
+}
+
+}
+
 Box getBox(const CollisionAnchor &anchor, const CollisionRect &bbox, float minScale,
            float maxScale) {
     return Box{
@@ -19,9 +132,13 @@ Box getBox(const CollisionAnchor &anchor, const CollisionRect &bbox, float minSc
     };
 };
 
-Collision::Collision(float zoom, float tileExtent, float tileSize, float placementDepth)
+Collision::Collision(float zoom, float tileExtent, float tileSize, float placementDepth,
+                     PlacementIndexType indexType)
+    : hIndex(createIndex(indexType)),
+      cIndex(createIndex(indexType)),
+
       // tile pixels per screen pixels at the tile's zoom level
-    : tilePixelRatio(tileExtent / tileSize),
+      tilePixelRatio(tileExtent / tileSize),
 
       zoom(zoom),
 
@@ -126,23 +243,23 @@ float Collision::getPlacementScale(const GlyphBoxes &glyphs, float minPlacementS
         // Compute the scaled bounding box of the unrotated glyph
         const Box searchBox = getBox(anchor, bbox, minScale, maxScale);
 
-        std::vector<PlacementValue> blocking;
-        hTree.query(bgi::intersects(searchBox), std::back_inserter(blocking));
-        cTree.query(bgi::intersects(searchBox), std::back_inserter(blocking));
+        blocking.clear();
+        hIndex->query(searchBox, blocking);
+        cIndex->query(searchBox, blocking);
 
         if (avoidEdges) {
-            if (searchBox.min_corner().get<0>() < 0) blocking.emplace_back(leftEdge);
-            if (searchBox.min_corner().get<1>() < 0) blocking.emplace_back(topEdge);
-            if (searchBox.max_corner().get<0>() >= 4096) blocking.emplace_back(rightEdge);
-            if (searchBox.max_corner().get<1>() >= 4096) blocking.emplace_back(bottomEdge);
+            if (searchBox.min_corner().get<0>() < 0) blocking.push_back(&leftEdge);
+            if (searchBox.min_corner().get<1>() < 0) blocking.push_back(&topEdge);
+            if (searchBox.max_corner().get<0>() >= 4096) blocking.push_back(&rightEdge);
+            if (searchBox.max_corner().get<1>() >= 4096) blocking.push_back(&bottomEdge);
         }
 
         if (blocking.size()) {
             const CollisionAnchor &na = anchor; // new anchor
             const CollisionRect &nb = box;      // new box
 
-            for (const PlacementValue &value : blocking) {
-                const PlacementBox &placement = std::get<1>(value);
+            for (const PlacementValue *value : blocking) {
+                const PlacementBox &placement = value->second;
                 const CollisionAnchor &oa = placement.anchor; // old anchor
                 const CollisionRect &ob = placement.box;      // old box
 
@@ -209,16 +326,16 @@ PlacementRange Collision::getPlacementRange(const GlyphBoxes &glyphs, float plac
 
         Box query_box{Point{minPlacedX, minPlacedY}, Point{maxPlacedX, maxPlacedY}};
 
-        std::vector<PlacementValue> blocking;
-        hTree.query(bgi::intersects(query_box), std::back_inserter(blocking));
+        blocking.clear();
+        hIndex->query(query_box, blocking);
 
         if (horizontal) {
-            cTree.query(bgi::intersects(query_box), std::back_inserter(blocking));
+            cIndex->query(query_box, blocking);
         }
 
-        for (const PlacementValue &value : blocking) {
-            const Box &s = std::get<0>(value);
-            const PlacementBox &b = std::get<1>(value);
+        for (const PlacementValue *value : blocking) {
+            const Box &s = value->first;
+            const PlacementBox &b = value->second;
             const CollisionRect &bbox2 = b.hBox ? b.hBox.get() : b.box;
 
             float x1, x2, y1, y2, intersectX, intersectY;
@@ -290,8 +407,8 @@ void Collision::insert(const GlyphBoxes &glyphs, const CollisionAnchor &anchor,
 
     // Bulk-insert all glyph boxes
     if (horizontal) {
-        hTree.insert(allBounds.begin(), allBounds.end());
+        hIndex->insert(allBounds);
     } else {
-        cTree.insert(allBounds.begin(), allBounds.end());
+        cIndex->insert(allBounds);
     }
 }
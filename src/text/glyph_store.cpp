@@ -2,42 +2,65 @@
 
 #include <mbgl/util/std.hpp>
 #include <mbgl/util/string.hpp>
-#include <mbgl/util/utf.hpp>
 #include <mbgl/util/pbf.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/token.hpp>
 #include <mbgl/util/math.hpp>
 #include <mbgl/util/filesource.hpp>
+#include <mbgl/util/executor.hpp>
 #include <mbgl/platform/platform.hpp>
+#include <mbgl/platform/log.hpp>
 #include <mbgl/util/uv_detail.hpp>
 #include <algorithm>
 
 namespace mbgl {
 
 
-void FontStack::insert(uint32_t id, const SDFGlyph &glyph) {
-    std::lock_guard<std::mutex> lock(mtx);
-    metrics.emplace(id, glyph.metrics);
-    bitmaps.emplace(id, glyph.bitmap);
-    sdfs.emplace(id, glyph);
+const uint32_t GlyphSet::Size;
+const uint32_t FontStack::RangeCount;
+
+void GlyphSet::insert(const SDFGlyph &glyph) {
+    glyphs[glyph.id % Size] = glyph;
+    present.set(glyph.id % Size);
 }
 
-const std::map<uint32_t, GlyphMetrics> &FontStack::getMetrics() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return metrics;
+FontStack::FontStack() {
+    for (std::atomic<const GlyphSet *> &range : ranges) {
+        range.store(nullptr, std::memory_order_relaxed);
+    }
 }
 
-const std::map<uint32_t, SDFGlyph> &FontStack::getSDFs() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return sdfs;
+FontStack::~FontStack() {
+    for (std::atomic<const GlyphSet *> &range : ranges) {
+        delete range.load(std::memory_order_relaxed);
+    }
 }
 
-const Shaping FontStack::getShaping(const std::u32string &string, const float maxWidth,
-                                    const float lineHeight, const float horizontalAlign,
-                                    const float verticalAlign, const float justify,
-                                    const float spacing, const vec2<float> &translate) const {
-    std::lock_guard<std::mutex> lock(mtx);
+void FontStack::insert(uint32_t start, std::unique_ptr<const GlyphSet> glyphs) {
+    if (start >= GlyphSet::Size * RangeCount) {
+        return;
+    }
+    const GlyphSet *expected = nullptr;
+    if (ranges[start / GlyphSet::Size].compare_exchange_strong(expected, glyphs.get(), std::memory_order_release)) {
+        glyphs.release();
+    }
+}
 
+bool FontStack::hasGlyphRanges(const std::u32string &string) const {
+    for (char32_t chr : string) {
+        // Characters outside of the ranges never get glyphs.
+        if (chr < GlyphSet::Size * RangeCount &&
+            !ranges[chr / GlyphSet::Size].load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Shaping FontStack::getShaping(const std::u32string &string, const float maxWidth,
+                              const float lineHeight, const float horizontalAlign,
+                              const float verticalAlign, const float justify,
+                              const float spacing, const vec2<float> &translate) const {
     Shaping shaping;
 
     int32_t x = std::round(translate.x * 24); // one em
@@ -46,9 +69,9 @@ const Shaping FontStack::getShaping(const std::u32string &string, const float ma
     // Loop through all characters of this label and shape.
     for (uint32_t chr : string) {
         shaping.emplace_back(chr, x, y);
-        auto metric = metrics.find(chr);
-        if (metric != metrics.end()) {
-            x += metric->second.advance + spacing;
+        const SDFGlyph *glyph = getGlyph(chr);
+        if (glyph) {
+            x += glyph->metrics.advance + spacing;
         }
     }
 
@@ -72,12 +95,12 @@ void align(Shaping &shaping, const float justify, const float horizontalAlign,
     }
 }
 
-void justifyLine(Shaping &shaping, const std::map<uint32_t, GlyphMetrics> &metrics, uint32_t start,
-                 uint32_t end, float justify) {
+void justifyLine(Shaping &shaping, const FontStack &stack, uint32_t start, uint32_t end,
+                 float justify) {
     PositionedGlyph &glyph = shaping[end];
-    auto metric = metrics.find(glyph.glyph);
-    if (metric != metrics.end()) {
-        const uint32_t lastAdvance = metric->second.advance;
+    const SDFGlyph *sdf = stack.getGlyph(glyph.glyph);
+    if (sdf) {
+        const uint32_t lastAdvance = sdf->metrics.advance;
         const float lineIndent = float(glyph.x + lastAdvance) * justify;
 
         for (uint32_t j = start; j <= end; j++) {
@@ -115,7 +138,7 @@ void FontStack::lineWrap(Shaping &shaping, const float lineHeight, const float m
                 }
 
                 if (justify) {
-                    justifyLine(shaping, metrics, lineStartIndex, lastSafeBreak - 1, justify);
+                    justifyLine(shaping, *this, lineStartIndex, lastSafeBreak - 1, justify);
                 }
 
                 lineStartIndex = lastSafeBreak + 1;
@@ -132,55 +155,51 @@ void FontStack::lineWrap(Shaping &shaping, const float lineHeight, const float m
 
     maxLineLength = maxLineLength || shaping.back().x;
 
-    justifyLine(shaping, metrics, lineStartIndex, shaping.size() - 1, justify);
+    justifyLine(shaping, *this, lineStartIndex, shaping.size() - 1, justify);
     align(shaping, justify, horizontalAlign, verticalAlign, maxLineLength, lineHeight, line);
 }
 
-GlyphPBF::GlyphPBF(const std::string &glyphURL, const std::string &fontStack, GlyphRange glyphRange, const std::shared_ptr<FileSource> &fileSource)
-    : future(promise.get_future().share())
-{
-    // Load the glyph set URL
-    std::string url = util::replaceTokens(glyphURL, [&](const std::string &name) -> std::string {
-        if (name == "fontstack") return fontStack;
-        if (name == "range") return std::to_string(glyphRange.first) + "-" + std::to_string(glyphRange.second);
-        return "";
-    });
-
-    // TODO: Find more reliable URL normalization function
-    std::replace(url.begin(), url.end(), ' ', '+');
+GlyphPBF::GlyphPBF(const std::string &glyphURL, const std::string &fontStack, GlyphRange glyphRange)
+    : range(glyphRange),
+      url([&]() {
+          std::string result = util::replaceTokens(glyphURL, [&](const std::string &name) -> std::string {
+              if (name == "fontstack") return fontStack;
+              if (name == "range") return std::to_string(glyphRange.first) + "-" + std::to_string(glyphRange.second);
+              return "";
+          });
+
+          // TODO: Find more reliable URL normalization function
+          std::replace(result.begin(), result.end(), ' ', '+');
+          return result;
+      }()) {
+}
 
+void GlyphPBF::load(FontStack &stack, const std::shared_ptr<FileSource> &fileSource, std::function<void()> callback) {
 #if defined(DEBUG)
     fprintf(stderr, "%s\n", url.c_str());
 #endif
 
-    fileSource->load(ResourceType::Glyphs, url, [&](platform::Response *res) {
+    const GlyphRange glyphRange = range;
+    fileSource->load(ResourceType::Glyphs, url, [&stack, glyphRange, callback](platform::Response *res) {
         if (res->code != 200) {
-            // Something went wrong with loading the glyph pbf. Pass on the error to the future listeners.
-            const std::string msg = util::sprintf<255>("[ERROR] failed to load glyphs (%d): %s\n", res->code, res->error_message.c_str());
-            promise.set_exception(std::make_exception_ptr(std::runtime_error(msg)));
-        } else {
-            // Transfer the data to the GlyphSet and signal its availability.
-            // Once it is available, the caller will need to call parse() to actually
-            // parse the data we received. We are not doing this here since this callback is being
-            // called from another (unknown) thread.
-            data.swap(res->body);
-            promise.set_value(*this);
+            // Labels are rendered without the glyphs of this range, rather than waiting forever.
+            Log::Warning(Event::ParseTile, "failed to load glyphs (%d): %s", res->code, res->error_message.c_str());
+            callback();
+            return;
         }
-    });
-}
 
-std::shared_future<GlyphPBF &> GlyphPBF::getFuture() {
-    return future;
+        // We're parsing the data on the executor rather than on this (unknown) thread.
+        std::shared_ptr<std::string> data = std::make_shared<std::string>();
+        data->swap(res->body);
+        util::Executor::shared().post([&stack, glyphRange, data, callback]() {
+            stack.insert(glyphRange.first, parse(glyphRange, *data));
+            callback();
+        }, util::Executor::ResourcePriority);
+    });
 }
 
-void GlyphPBF::parse(FontStack &stack) {
-    std::lock_guard<std::mutex> lock(mtx);
-
-    if (!data.size()) {
-        // If there is no data, this means we either haven't received any data, or
-        // we have already parsed the data.
-        return;
-    }
+std::unique_ptr<const GlyphSet> GlyphPBF::parse(const GlyphRange range, const std::string &data) {
+    std::unique_ptr<GlyphSet> set = std::make_unique<GlyphSet>();
 
     // Parse the glyph PBF
     pbf glyphs_pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size());
@@ -214,7 +233,9 @@ void GlyphPBF::parse(FontStack &stack) {
                         }
                     }
 
-                    stack.insert(glyph.id, glyph);
+                    if (glyph.id >= range.first && glyph.id <= range.second) {
+                        set->insert(glyph);
+                    }
                 } else {
                     fontstack_pbf.skip();
                 }
@@ -224,56 +245,87 @@ void GlyphPBF::parse(FontStack &stack) {
         }
     }
 
-    data.clear();
+    return std::move(set);
 }
 
-GlyphStore::GlyphStore(const std::shared_ptr<FileSource> &fileSource) : fileSource(fileSource) {}
+GlyphStore::GlyphStore(const std::shared_ptr<FileSource> &fileSource)
+    : fileSource(fileSource), shapingCache(util::minimumShapingCacheSize) {}
 
 void GlyphStore::setURL(const std::string &url) {
     glyphURL = url;
 }
 
 
-void GlyphStore::waitForGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges) {
-    // We are implementing a blocking wait with futures: Every GlyphSet has a future that we are
-    // waiting for until it is loaded.
+bool GlyphStore::requestGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges, std::function<void()> callback) {
     if (glyphRanges.empty()) {
-        return;
+        return true;
     }
 
     FontStack *stack = nullptr;
-
-    std::vector<std::shared_future<GlyphPBF &>> futures;
-    futures.reserve(glyphRanges.size());
+    std::vector<std::pair<GlyphRange, GlyphPBF *>> created;
     {
         std::lock_guard<std::mutex> lock(mtx);
         auto &rangeSets = ranges[fontStack];
 
         stack = &createFontStack(fontStack);
 
-        // Attempt to load the glyph range. If the GlyphSet already exists, we are getting back
-        // the same shared_future.
+        bool loaded = true;
         for (GlyphRange range : glyphRanges) {
-            futures.emplace_back(loadGlyphRange(fontStack, rangeSets, range));
+            Range &entry = rangeSets[range];
+            if (!entry.pbf) {
+                // We don't have this glyph set yet for this font stack.
+                entry.pbf = std::make_unique<GlyphPBF>(glyphURL, fontStack, range);
+                created.emplace_back(range, entry.pbf.get());
+            }
+            loaded = loaded && entry.loaded;
+        }
+
+        if (loaded) {
+            return true;
+        }
+
+        if (callback) {
+            requests.push_back({ fontStack, glyphRanges, std::move(callback) });
         }
     }
 
-    // Now that we potentially created all GlyphSets, we are waiting for the results, one by one.
-    // When we get a result (or the GlyphSet is aready loaded), we are attempting to parse the
-    // GlyphSet.
-    for (std::shared_future<GlyphPBF &> &future : futures) {
-        future.get().parse(*stack);
+    // Responses may arrive before load() returns, so we're starting the requests without holding
+    // the lock.
+    for (const std::pair<GlyphRange, GlyphPBF *> &pair : created) {
+        const GlyphRange range = pair.first;
+        pair.second->load(*stack, fileSource, [this, fontStack, range]() {
+            onGlyphRangeLoaded(fontStack, range);
+        });
     }
+
+    return false;
 }
 
-std::shared_future<GlyphPBF &> GlyphStore::loadGlyphRange(const std::string &fontStack, std::map<GlyphRange, std::unique_ptr<GlyphPBF>> &rangeSets, const GlyphRange range) {
-    auto range_it = rangeSets.find(range);
-    if (range_it == rangeSets.end()) {
-        // We don't have this glyph set yet for this font stack.
-        range_it = rangeSets.emplace(range, std::make_unique<GlyphPBF>(glyphURL, fontStack, range, fileSource)).first;
+void GlyphStore::onGlyphRangeLoaded(const std::string &fontStack, GlyphRange range) {
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto &rangeSets = ranges[fontStack];
+        rangeSets[range].loaded = true;
+
+        auto end = std::partition(requests.begin(), requests.end(), [&](const Request &request) {
+            if (request.fontStack != fontStack) {
+                return true;
+            }
+            return std::any_of(request.ranges.begin(), request.ranges.end(), [&](GlyphRange other) {
+                return !rangeSets[other].loaded;
+            });
+        });
+        for (auto it = end; it != requests.end(); ++it) {
+            callbacks.push_back(std::move(it->callback));
+        }
+        requests.erase(end, requests.end());
     }
 
-    return range_it->second->getFuture();
+    // The callbacks may request more glyphs.
+    for (const std::function<void()> &callback : callbacks) {
+        callback();
+    }
 }
 
 FontStack &GlyphStore::createFontStack(const std::string &fontStack) {
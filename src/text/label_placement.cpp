@@ -0,0 +1,233 @@
+#include <mbgl/text/label_placement.hpp>
+#include <mbgl/renderer/symbol_bucket.hpp>
+#include <mbgl/map/tile_data.hpp>
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/math.hpp>
+#include <mbgl/util/std.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+using namespace mbgl;
+
+const timestamp LabelPlacement::FadeDuration = 300_milliseconds;
+
+namespace {
+
+// Size of the cells of the viewport grid, in screen pixels. Most labels cover a few cells.
+const float CellSize = 64;
+
+// Labels are placed in a margin around the viewport as well, so that labels that are about to be
+// panned into view don't collide with labels that were placed in the meantime.
+const float ViewportMargin = 64;
+
+// A uniform grid over the viewport. Boxes are stored in every cell that they overlap.
+class GridIndex {
+public:
+    GridIndex(float width, float height)
+        : columns(std::max(1, int(std::ceil((width + 2 * ViewportMargin) / CellSize)))),
+          rows(std::max(1, int(std::ceil((height + 2 * ViewportMargin) / CellSize)))),
+          cells(columns * rows) {}
+
+    void insert(const CollisionRect &box) {
+        const uint32_t index = boxes.size();
+        boxes.push_back(box);
+        forEachCell(box, [&](std::vector<uint32_t> &cell) {
+            cell.push_back(index);
+            return true;
+        });
+    }
+
+    bool hitTest(const CollisionRect &box) {
+        bool hit = false;
+        forEachCell(box, [&](const std::vector<uint32_t> &cell) {
+            for (uint32_t index : cell) {
+                const CollisionRect &other = boxes[index];
+                if (box.tl.x < other.br.x && other.tl.x < box.br.x &&
+                    box.tl.y < other.br.y && other.tl.y < box.br.y) {
+                    hit = true;
+                    return false;
+                }
+            }
+            return true;
+        });
+        return hit;
+    }
+
+private:
+    int cell(float position, int count) const {
+        return util::clamp(int((position + ViewportMargin) / CellSize), 0, count - 1);
+    }
+
+    // Calls fn for every cell that the box overlaps, until it returns false.
+    template <typename Fn>
+    void forEachCell(const CollisionRect &box, Fn fn) {
+        const int x1 = cell(box.tl.x, columns), x2 = cell(box.br.x, columns);
+        const int y1 = cell(box.tl.y, rows), y2 = cell(box.br.y, rows);
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) {
+                if (!fn(cells[y * columns + x])) {
+                    return;
+                }
+            }
+        }
+    }
+
+    const int columns;
+    const int rows;
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<CollisionRect> boxes;
+};
+
+}
+
+LabelPlacement::LabelPlacement(std::function<void()> onPlaced_) : onPlaced(onPlaced_) {}
+
+LabelPlacement::~LabelPlacement() {
+    std::unique_lock<std::mutex> lock(mtx);
+    finished.wait(lock, [this] { return !running; });
+}
+
+void LabelPlacement::place(std::vector<Bucket> &buckets, const View &view) {
+    GridIndex grid(view.width, view.height);
+
+    // Anchors of the labels that are shown, by key.
+    std::unordered_map<uint32_t, std::vector<CollisionPoint>> shown;
+
+    for (Bucket &bucket : buckets) {
+        const std::vector<SymbolInstance> &instances = *bucket.instances;
+        const mat4 &m = bucket.matrix;
+        bucket.visible.assign(instances.size(), true);
+
+        // Screen pixels per tile unit, and the direction of the tile's x axis on screen.
+        const float scale = std::sqrt(m[0] * m[0] + m[1] * m[1]);
+        const float cos = m[0] / scale, sin = m[1] / scale;
+
+        for (size_t i = 0; i < instances.size(); i++) {
+            const SymbolInstance &instance = instances[i];
+
+            // The tile placement hides the label at this zoom level anyway.
+            if (view.zoom < instance.minZoom) {
+                continue;
+            }
+
+            const CollisionPoint anchor {
+                m[0] * instance.anchor.x + m[4] * instance.anchor.y + m[12],
+                m[1] * instance.anchor.x + m[5] * instance.anchor.y + m[13]
+            };
+
+            CollisionRect box = instance.box;
+            if (instance.rotateWithMap) {
+                const CollisionRect &b = instance.box;
+                const float xs[4] = { b.tl.x * cos, b.br.x * cos, b.tl.x * sin, b.br.x * sin };
+                const float ys[4] = { -b.tl.y * sin, -b.br.y * sin, b.tl.y * cos, b.br.y * cos };
+                box.tl.x = util::min(xs[0], xs[1]) + util::min(ys[0], ys[1]);
+                box.br.x = util::max(xs[0], xs[1]) + util::max(ys[0], ys[1]);
+                box.tl.y = util::min(xs[2], xs[3]) + util::min(ys[2], ys[3]);
+                box.br.y = util::max(xs[2], xs[3]) + util::max(ys[2], ys[3]);
+            }
+            box.tl.x += anchor.x;
+            box.tl.y += anchor.y;
+            box.br.x += anchor.x;
+            box.br.y += anchor.y;
+
+            // Labels outside of the viewport don't take up space.
+            if (box.br.x < -ViewportMargin || box.tl.x > view.width + ViewportMargin ||
+                box.br.y < -ViewportMargin || box.tl.y > view.height + ViewportMargin) {
+                continue;
+            }
+
+            std::vector<CollisionPoint> *repetitions = nullptr;
+            if (instance.key && instance.repeatDistance > 0) {
+                repetitions = &shown[instance.key];
+                const float distance = instance.repeatDistance;
+                const bool repeated = std::any_of(repetitions->begin(), repetitions->end(),
+                    [&](const CollisionPoint &other) {
+                        return util::dist<float>(anchor, other) < distance;
+                    });
+                if (repeated) {
+                    bucket.visible[i] = false;
+                    continue;
+                }
+            }
+
+            if (!instance.allowOverlap && grid.hitTest(box)) {
+                bucket.visible[i] = false;
+                continue;
+            }
+
+            if (!instance.ignorePlacement) {
+                grid.insert(box);
+            }
+            if (repetitions) {
+                repetitions->push_back(anchor);
+            }
+        }
+    }
+}
+
+bool LabelPlacement::update(std::vector<Bucket> buckets, const View &view, timestamp now, bool wait) {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (wait) {
+            finished.wait(lock, [this] { return !running; });
+        } else if (running) {
+            return now < committed + FadeDuration;
+        }
+    }
+
+    // Buckets are only changed on this thread, once their placement has finished.
+    if (pending) {
+        commit(now, true);
+    }
+
+    std::vector<const SymbolBucket *> placing;
+    std::vector<mat4> matrices;
+    placing.reserve(buckets.size());
+    matrices.reserve(buckets.size());
+    for (const Bucket &bucket : buckets) {
+        placing.push_back(bucket.bucket);
+        matrices.push_back(bucket.matrix);
+    }
+
+    const bool changed = placing != placedBuckets || matrices != placedMatrices ||
+                         view.width != placedView.width || view.height != placedView.height ||
+                         view.zoom != placedView.zoom;
+    if (changed) {
+        placedBuckets = std::move(placing);
+        placedMatrices = std::move(matrices);
+        placedView = view;
+        pending = std::make_unique<std::vector<Bucket>>(std::move(buckets));
+
+        if (wait) {
+            place(*pending, view);
+            commit(now, false);
+        } else {
+            running = true;
+            std::vector<Bucket> *placement = pending.get();
+            util::Executor::shared().post([this, placement, view] {
+                place(*placement, view);
+
+                // The next frame commits the placement. The lock keeps this object alive until
+                // the callback has returned.
+                std::lock_guard<std::mutex> lock(mtx);
+                running = false;
+                onPlaced();
+                finished.notify_all();
+            }, util::Executor::PlacementPriority);
+        }
+    }
+
+    return now < committed + FadeDuration;
+}
+
+void LabelPlacement::commit(timestamp now, bool fade) {
+    for (const Bucket &bucket : *pending) {
+        bucket.bucket->setPlacement(bucket.visible, now, fade);
+    }
+    committed = fade ? now : 0;
+
+    // Releases the tiles on this thread, since they own GL objects.
+    pending.reset();
+}
@@ -0,0 +1,127 @@
+#include <mbgl/text/shaping_cache.hpp>
+#include <mbgl/text/glyph_store.hpp>
+
+namespace mbgl {
+
+namespace {
+
+inline void combine(size_t &hash, size_t value) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+}
+
+double ShapingCache::Stats::hitRate() const {
+    const size_t lookups = hits + misses;
+    return lookups ? double(hits) / lookups : 0;
+}
+
+bool ShapingCache::Key::operator==(const Key &other) const {
+    return hash == other.hash && maxWidth == other.maxWidth && lineHeight == other.lineHeight &&
+           horizontalAlign == other.horizontalAlign && verticalAlign == other.verticalAlign &&
+           justify == other.justify && spacing == other.spacing &&
+           translateX == other.translateX && translateY == other.translateY &&
+           *string == *other.string && *fontStack == *other.fontStack;
+}
+
+ShapingCache::ShapingCache(size_t maximumSize_) : maximumSize(maximumSize_) {}
+
+void ShapingCache::setMaximumSize(size_t size) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (maximumSize != size) {
+        maximumSize = size;
+        prune();
+    }
+}
+
+size_t ShapingCache::getMaximumSize() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return maximumSize;
+}
+
+std::shared_ptr<const Shaping> ShapingCache::getShaping(const std::string &fontStackName,
+                                                        const FontStack &stack,
+                                                        const std::u32string &string,
+                                                        float maxWidth, float lineHeight,
+                                                        float horizontalAlign, float verticalAlign,
+                                                        float justify, float spacing,
+                                                        const vec2<float> &translate) {
+    Key key { &fontStackName, &string, maxWidth, lineHeight, horizontalAlign, verticalAlign,
+              justify, spacing, translate.x, translate.y, std::hash<std::u32string>()(string) };
+    combine(key.hash, std::hash<std::string>()(fontStackName));
+    for (float param : { maxWidth, lineHeight, horizontalAlign, verticalAlign, justify, spacing,
+                         translate.x, translate.y }) {
+        combine(key.hash, std::hash<float>()(param));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            stats.hits++;
+            recent.splice(recent.begin(), recent, it->second->recent);
+            return it->second->shaping;
+        }
+        stats.misses++;
+    }
+
+    // Shapes outside of the lock, so that other threads can look up shapings in the meantime.
+    std::shared_ptr<const Shaping> shaping = std::make_shared<const Shaping>(stack.getShaping(
+        string, maxWidth, lineHeight, horizontalAlign, verticalAlign, justify, spacing, translate));
+    if (!stack.hasGlyphRanges(string)) {
+        return shaping;
+    }
+
+    std::unique_ptr<Entry> entry(new Entry { fontStackName, string, shaping, 0, {} });
+    entry->size = sizeof(Entry) + sizeof(Key) * 2 + entry->fontStack.capacity() +
+                  entry->string.capacity() * sizeof(char32_t) +
+                  shaping->capacity() * sizeof(PositionedGlyph);
+    key.fontStack = &entry->fontStack;
+    key.string = &entry->string;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (entry->size > maximumSize) {
+        return shaping;
+    }
+
+    // Another thread may have shaped the same label in the meantime.
+    auto inserted = entries.emplace(key, nullptr);
+    if (!inserted.second) {
+        return inserted.first->second->shaping;
+    }
+
+    recent.push_front(key);
+    entry->recent = recent.begin();
+    stats.size += entry->size;
+    stats.count++;
+    inserted.first->second = std::move(entry);
+
+    prune();
+    return shaping;
+}
+
+void ShapingCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+    recent.clear();
+    stats.size = 0;
+    stats.count = 0;
+}
+
+ShapingCache::Stats ShapingCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stats;
+}
+
+void ShapingCache::prune() {
+    while (stats.size > maximumSize && !recent.empty()) {
+        auto it = entries.find(recent.back());
+        stats.size -= it->second->size;
+        stats.count--;
+        stats.evictions++;
+        entries.erase(it);
+        recent.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+#include <mbgl/util/arena.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace mbgl {
+namespace util {
+
+Arena::Arena(size_t blockSize_) : blockSize(blockSize_) {}
+
+Arena::~Arena() {
+    for (const Block &block : blocks) {
+        std::free(block.begin);
+    }
+}
+
+void *Arena::allocateBlock(size_t size, size_t alignment) {
+    const auto fit = [&](const Block &block) -> char * {
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(block.begin) + alignment - 1) & ~uintptr_t(alignment - 1);
+        char *ptr = reinterpret_cast<char *>(aligned);
+        return ptr + size <= block.end ? ptr : nullptr;
+    };
+
+    // Blocks after the current one are left over from scopes that ended, so they're empty. If
+    // the arena was rewound to its very beginning, the current block is empty as well.
+    const size_t first = cursor ? current + 1 : current;
+    for (size_t i = first; i < blocks.size(); i++) {
+        if (char *ptr = fit(blocks[i])) {
+            current = i;
+            cursor = ptr + size;
+            end = blocks[i].end;
+            return ptr;
+        }
+    }
+
+    const size_t length = std::max(blockSize, size + alignment);
+    char *begin = static_cast<char *>(std::malloc(length));
+    if (!begin) {
+        throw std::bad_alloc();
+    }
+    allocated += length;
+
+    blocks.insert(blocks.begin() + first, Block { begin, begin + length });
+    current = first;
+    char *ptr = fit(blocks[current]);
+    cursor = ptr + size;
+    end = blocks[current].end;
+    return ptr;
+}
+
+}
+}
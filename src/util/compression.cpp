@@ -0,0 +1,84 @@
+#include <mbgl/util/compression.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+bool isGzip(const std::string &data) {
+    return data.size() >= 18 && uint8_t(data[0]) == 0x1F && uint8_t(data[1]) == 0x8B;
+}
+
+bool isZlib(const std::string &data) {
+    // The compression method is deflate, and the header checksum is valid.
+    const uint8_t cmf = data.size() >= 2 ? data[0] : 0;
+    const uint8_t flg = data.size() >= 2 ? data[1] : 0;
+    return (cmf & 0x0F) == 8 && (cmf >> 4) <= 7 && (cmf * 256 + flg) % 31 == 0;
+}
+
+}
+
+bool isCompressed(const std::string &data) {
+    return isGzip(data) || isZlib(data);
+}
+
+std::string decompress(const std::string &data) {
+    std::string result;
+
+    if (isGzip(data)) {
+        // The last four bytes of a gzip stream contain the uncompressed size modulo 2^32. It's
+        // only a hint, since the data may consist of several gzip members.
+        const uint8_t *trailer = reinterpret_cast<const uint8_t *>(data.data() + data.size() - 4);
+        const uint32_t size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (uint32_t(trailer[3]) << 24);
+        // Deflate can't compress better than about 1:1032, so larger values must be bogus.
+        result.resize(size && size / 1032 <= data.size() ? size : data.size() * 4);
+    } else {
+        result.resize(data.size() * 4);
+    }
+
+    z_stream stream = {};
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = uInt(data.size());
+
+    // Adding 32 to the window bits enables automatic detection of gzip and zlib headers.
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+        throw std::runtime_error(stream.msg ? stream.msg : "failed to initialize zlib");
+    }
+
+    int code = Z_OK;
+    while (code == Z_OK) {
+        if (stream.total_out == result.size()) {
+            result.resize(std::max<size_t>(result.size() * 2, 1024));
+        }
+        stream.next_out = reinterpret_cast<Bytef *>(&result[stream.total_out]);
+        stream.avail_out = uInt(result.size() - stream.total_out);
+        code = inflate(&stream, Z_NO_FLUSH);
+
+        if (code == Z_BUF_ERROR && stream.avail_out > 0) {
+            // We're out of input, but the stream isn't complete.
+            break;
+        }
+        if (code == Z_BUF_ERROR) {
+            code = Z_OK;
+        }
+    }
+
+    const std::string error = stream.msg ? stream.msg : "truncated data";
+    result.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    if (code != Z_STREAM_END) {
+        throw std::runtime_error("failed to decompress data: " + error);
+    }
+
+    return result;
+}
+
+}
+}
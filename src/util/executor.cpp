@@ -0,0 +1,256 @@
+#include <mbgl/util/executor.hpp>
+
+#include <algorithm>
+
+namespace mbgl {
+namespace util {
+
+const Executor::Priority Executor::DefaultPriority;
+const Executor::Priority Executor::ResourcePriority;
+const Executor::Priority Executor::PlacementPriority;
+
+Executor::Executor(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(new Worker);
+    }
+    // Start the threads only after all queues exist, since workers steal from each other.
+    for (size_t i = 0; i < threads; i++) {
+        workers[i]->thread = std::thread(&Executor::run, this, i);
+    }
+
+    // post() identifies workers by their thread, so workers wait until all threads are assigned.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = true;
+    }
+    condition.notify_all();
+}
+
+Executor::~Executor() {
+    shutdown();
+}
+
+Executor &Executor::shared() {
+    // Tasks never wait for downloads, so one thread per core keeps all cores busy.
+    static Executor executor(std::max(std::thread::hardware_concurrency(), 1u));
+    return executor;
+}
+
+size_t Executor::getThreadCount() const {
+    return workers.size();
+}
+
+Executor::Stats Executor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void Executor::post(Task task, Priority priority) {
+    push(std::move(task), priority, nullptr);
+}
+
+void Executor::post(Task task, Rank rank) {
+    const Priority priority = rank();
+    push(std::move(task), priority, std::move(rank));
+}
+
+void Executor::reprioritize() {
+    generation++;
+}
+
+void Executor::push(Task task, Priority priority, Rank rank) {
+    bool synchronous = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (terminate) {
+            synchronous = true;
+        } else {
+            pending++;
+            stats.queued++;
+            stats.maxQueued = std::max(stats.maxQueued, stats.queued);
+        }
+    }
+
+    if (synchronous) {
+        // The workers are gone, so we're running tasks synchronously instead of dropping them.
+        // Otherwise, objects waiting for a task to complete would never be notified.
+        task();
+        return;
+    }
+
+    // Tasks posted from a worker thread stay on that worker, so that related work runs on the same
+    // core unless another worker runs out of tasks.
+    const std::thread::id self = std::this_thread::get_id();
+    const uint64_t seq = sequence++;
+    size_t index = seq % workers.size();
+    for (size_t i = 0; i < workers.size(); i++) {
+        if (workers[i]->thread.get_id() == self) {
+            index = i;
+            break;
+        }
+    }
+
+    {
+        Worker &worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back({ priority, seq, Clock::now(), std::move(task), std::move(rank) });
+        std::push_heap(worker.queue.begin(), worker.queue.end());
+    }
+    condition.notify_one();
+}
+
+bool Executor::pop(size_t index, Entry &entry) {
+    // Take the most urgent task of our own queue. Only when it is empty, we're stealing the most
+    // urgent task of the next worker that has one, so that a pop usually takes a single lock.
+    for (size_t i = 0; i < workers.size(); i++) {
+        Worker &worker = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.queue.empty()) {
+            // Priorities changed since we've built the heap. Tasks without a rank keep theirs.
+            const uint64_t current = generation;
+            if (worker.generation != current) {
+                for (Entry &queued : worker.queue) {
+                    if (queued.rank) {
+                        queued.priority = queued.rank();
+                    }
+                }
+                std::make_heap(worker.queue.begin(), worker.queue.end());
+                worker.generation = current;
+            }
+
+            std::pop_heap(worker.queue.begin(), worker.queue.end());
+            entry = std::move(worker.queue.back());
+            worker.queue.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::run(size_t index) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return started; });
+    }
+
+    Entry entry;
+    while (true) {
+        if (pop(index, entry)) {
+            const uint64_t wait = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.queued).count();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+                stats.queued--;
+                stats.running++;
+                stats.totalWait += wait;
+                stats.maxWait = std::max(stats.maxWait, wait);
+            }
+
+            entry.task();
+            entry.task = nullptr;
+            entry.rank = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.running--;
+            stats.completed++;
+            continue;
+        }
+
+        // The pending count is incremented before a task is queued, so we may briefly see pending
+        // tasks that we can't pop yet.
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return pending > 0 || terminate; });
+        if (terminate && pending == 0) {
+            return;
+        }
+    }
+}
+
+void Executor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped) {
+            return;
+        }
+        terminate = true;
+        stopped = true;
+    }
+    condition.notify_all();
+
+    for (const std::unique_ptr<Worker> &worker : workers) {
+        worker->thread.join();
+    }
+}
+
+
+TaskGroup::TaskGroup(Executor &executor_, Executor::Priority priority_)
+    : executor(executor_), priority(priority_), state(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+    if (!waited) {
+        try {
+            wait();
+        } catch (...) {
+            // Errors are only reported to explicit wait() calls.
+        }
+    }
+}
+
+void TaskGroup::add(Executor::Task task) {
+    state->tasks.push_back(std::move(task));
+}
+
+bool TaskGroup::State::runNext() {
+    const size_t index = claimed++;
+    if (index >= tasks.size()) {
+        return false;
+    }
+
+    std::exception_ptr exception;
+    try {
+        tasks[index]();
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    tasks[index] = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (exception && !error) {
+        error = exception;
+    }
+    if (++finished == tasks.size()) {
+        condition.notify_all();
+    }
+    return true;
+}
+
+void TaskGroup::wait() {
+    waited = true;
+
+    const size_t count = state->tasks.size();
+    if (count == 0) {
+        return;
+    }
+
+    // Workers claim tasks one by one until all of them are taken, so we only need to wake up as
+    // many workers as can help. The calling thread runs tasks too.
+    const size_t helpers = std::min(count - 1, executor.getThreadCount());
+    for (size_t i = 0; i < helpers; i++) {
+        std::shared_ptr<State> group = state;
+        executor.post([group] {
+            while (group->runNext()) {}
+        }, priority);
+    }
+
+    while (state->runNext()) {}
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [this, count] { return state->finished == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+}
+}
@@ -1,13 +1,125 @@
 #include <mbgl/util/filesource.hpp>
+#include <mbgl/util/sqlite_cache.hpp>
+#include <mbgl/util/sqlite3.hpp>
+#include <mbgl/util/mbtiles.hpp>
+#include <mbgl/util/uv_detail.hpp>
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/std.hpp>
 #include <mbgl/platform/platform.hpp>
 
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <ctime>
 
 namespace mbgl {
 
-FileSource::FileSource() {}
+namespace {
 
+// Carries a cache lookup to the threadpool and back to the main loop, or to the executor.
+struct CacheLookup {
+    CacheLookup(const std::shared_ptr<SQLiteCache> &cache_, const std::shared_ptr<util::RequestScheduler> &scheduler_,
+                ResourceType type_, const std::string &url_, const FileSource::Ticket &ticket_,
+                std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop_)
+        : cache(cache_), scheduler(scheduler_), type(type_), url(url_), ticket(ticket_), loop(loop_),
+          response(std::make_unique<platform::Response>(callback)) {}
+
+    const std::shared_ptr<SQLiteCache> cache;
+    const std::shared_ptr<util::RequestScheduler> scheduler;
+    const ResourceType type;
+    const std::string url;
+    const FileSource::Ticket ticket;
+    const std::shared_ptr<uv::loop> loop;
+    std::unique_ptr<platform::Response> response;
+    bool found = false;
+};
+
+// Carries an MBTiles lookup to the threadpool and back to the main loop.
+struct TileLookup {
+    TileLookup(const std::shared_ptr<MBTiles> &archive_, int8_t z_, int32_t x_, int32_t y_,
+               std::function<void(platform::Response *)> callback)
+        : archive(archive_), z(z_), x(x_), y(y_), response(callback) {}
+
+    const std::shared_ptr<MBTiles> archive;
+    const int8_t z;
+    const int32_t x, y;
+    platform::Response response;
+};
+
+bool isFresh(const platform::Response &response) {
+    return response.expires > int64_t(std::time(nullptr));
+}
+
+// Requests the resource from the network and stores successful responses in the cache. If we have
+// a stale copy of the resource, the request is conditional, and we're using the stale copy if the
+// server tells us that it is still valid, or if the request fails.
+void requestNetwork(const std::shared_ptr<SQLiteCache> &cache, const std::shared_ptr<util::RequestScheduler> &scheduler,
+                    ResourceType type, const std::string &url, const FileSource::Ticket &ticket,
+                    std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop,
+                    std::shared_ptr<platform::Response> stale) {
+    scheduler->request(ticket, url, [cache, type, url, callback, stale](platform::Response *res) {
+        if (res->code == 200) {
+            // This only queues the write; the actual database work happens on the cache's writer
+            // thread so that we don't block the request thread.
+            if (!res->noStore) {
+                cache->put(type, url, *res);
+            }
+        } else if (res->code == 304 && stale) {
+            // Not modified: extend the lifetime of the cached copy without transferring it again.
+            stale->expires = res->expires;
+            cache->refresh(type, url, res->expires);
+            callback(stale.get());
+            return;
+        } else if (res->code < 0 && stale) {
+            callback(stale.get());
+            return;
+        }
+        callback(res);
+    }, loop, stale ? stale->etag : "", stale ? stale->modified : 0);
+}
+
+void lookupCache(CacheLookup &lookup) {
+    if (!lookup.ticket->isCancelled()) {
+        lookup.found = lookup.cache->get(lookup.type, lookup.url, *lookup.response);
+    }
+}
+
+// Uses the cached response if it is fresh, and requests the resource from the network otherwise.
+void afterLookup(CacheLookup &lookup) {
+    platform::Response &response = *lookup.response;
+    if (lookup.ticket->isCancelled()) {
+        return;
+    } else if (lookup.found && isFresh(response)) {
+        response.callback(&response);
+    } else {
+        std::function<void(platform::Response *)> callback = response.callback;
+        std::shared_ptr<platform::Response> stale;
+        if (lookup.found) {
+            stale = std::move(lookup.response);
+        }
+        requestNetwork(lookup.cache, lookup.scheduler, lookup.type, lookup.url, lookup.ticket, callback, lookup.loop, stale);
+    }
+}
+
+void lookupTile(TileLookup &lookup) {
+    try {
+        if (!lookup.archive->getTile(lookup.z, lookup.x, lookup.y, lookup.response.body)) {
+            lookup.response.code = 404;
+            lookup.response.error_message = "tile not found in archive";
+        } else {
+            lookup.response.code = 200;
+        }
+    } catch (sqlite::Exception &ex) {
+        lookup.response.error_message = ex.what();
+    }
+}
+
+}
+
+FileSource::FileSource()
+    : scheduler(std::make_shared<util::RequestScheduler>()) {}
+
+FileSource::~FileSource() {}
 
 void FileSource::setBase(const std::string &value) {
     base = value;
@@ -17,7 +129,20 @@ const std::string &FileSource::getBase() const {
     return base;
 }
 
-void FileSource::load(ResourceType type, const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> loop) {
+void FileSource::setCacheDatabase(const std::string &path, uint64_t maximumSize) {
+    if (path.empty()) {
+        cache.reset();
+    } else {
+        cache = std::make_shared<SQLiteCache>(path, maximumSize);
+    }
+}
+
+FileSource::Ticket FileSource::load(ResourceType type, const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> loop) {
+    // Tiles can't be parsed or rendered without the glyphs, sprites and styles, so they come first.
+    // Tile priorities are updated by their owners.
+    const Ticket ticket = std::make_shared<util::RequestScheduler::Ticket>(
+        type == ResourceType::Tile ? util::RequestScheduler::DefaultPriority : util::RequestScheduler::ResourcePriority);
+
     // convert relative URLs to absolute URLs
 
     const std::string absoluteURL = [&]() -> std::string {
@@ -49,10 +174,108 @@ void FileSource::load(ResourceType type, const std::string &url, std::function<v
         }
 
         callback(&response);
+    } else if (protocol == "mbtiles") {
+        // load from a local tile archive
+        loadMBTiles(absoluteURL.substr(separator + 3), callback, loop);
+    } else if (cache && (protocol == "http" || protocol == "https")) {
+        // load from the cache, and fall back to the internet
+        loadHTTP(type, absoluteURL, ticket, callback, loop);
     } else {
         // load from the internet
-        platform::request_http(absoluteURL, callback, loop);
+        scheduler->request(ticket, absoluteURL, callback, loop);
+    }
+
+    return ticket;
+}
+
+void FileSource::loadHTTP(ResourceType type, const std::string &url, const Ticket &ticket, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop) {
+    if (!loop) {
+        // Sprites and glyphs are requested without a loop, from the map thread and from executor
+        // threads. The lookup may have to wait for the disk, so it runs on the cache's reader
+        // thread, and only the result is handed to the executor.
+        std::shared_ptr<CacheLookup> lookup = std::make_shared<CacheLookup>(cache, scheduler, type, url, ticket, callback, loop);
+        platform::Response &response = *lookup->response;
+        cache->get(type, url, response, [lookup](bool found) mutable {
+            lookup->found = found;
+
+            // The executor task takes over the only reference to the lookup, so that the reader
+            // thread never releases the cache.
+            std::shared_ptr<CacheLookup> result = std::move(lookup);
+            util::Executor::shared().post([result]() {
+                afterLookup(*result);
+            }, util::Executor::ResourcePriority);
+        });
+        return;
+    }
+
+    // Do the lookup in the threadpool so that neither the main loop nor the request thread have
+    // to wait for the disk.
+    new uv::work<std::unique_ptr<CacheLookup>>(
+        loop,
+        [](std::unique_ptr<CacheLookup> &lookup) {
+            lookupCache(*lookup);
+        },
+        [](std::unique_ptr<CacheLookup> &lookup) {
+            afterLookup(*lookup);
+        },
+        std::make_unique<CacheLookup>(cache, scheduler, type, url, ticket, callback, loop));
+}
+
+void FileSource::loadMBTiles(const std::string &url, std::function<void(platform::Response *)> callback, const std::shared_ptr<uv::loop> &loop) {
+    // URLs have the form mbtiles:///path/to/archive.mbtiles/{z}/{x}/{y}[.ext]
+    static const std::string extension = ".mbtiles/";
+    const size_t pos = url.find(extension);
+
+    int z = 0, x = 0, y = 0;
+    std::shared_ptr<MBTiles> archive;
+    platform::Response error(callback);
+
+    // Coordinates outside of the tile pyramid can't be in the archive, and the TMS row of a zoom
+    // level beyond 30 doesn't fit into an integer.
+    if (pos == std::string::npos ||
+        std::sscanf(url.c_str() + pos + extension.size(), "%d/%d/%d", &z, &x, &y) != 3 ||
+        z < 0 || z > 30 || x < 0 || x >= (1 << z) || y < 0 || y >= (1 << z)) {
+        error.error_message = "invalid MBTiles URL (" + url + ")";
+    } else {
+        try {
+            archive = getMBTiles(url.substr(0, pos + extension.size() - 1));
+        } catch (sqlite::Exception &ex) {
+            error.error_message = ex.what();
+        }
+    }
+
+    if (!archive) {
+        callback(&error);
+        return;
+    }
+
+    if (!loop) {
+        TileLookup lookup(archive, z, x, y, callback);
+        lookupTile(lookup);
+        callback(&lookup.response);
+        return;
     }
+
+    new uv::work<TileLookup>(
+        loop,
+        lookupTile,
+        [](TileLookup &lookup) {
+            lookup.response.callback(&lookup.response);
+        },
+        archive, z, x, y, callback);
+}
+
+std::shared_ptr<MBTiles> FileSource::getMBTiles(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mbtilesMutex);
+    auto it = mbtiles.find(path);
+    if (it != mbtiles.end()) {
+        return it->second;
+    }
+
+    // Archives are opened read-only and kept open for the lifetime of the FileSource.
+    std::shared_ptr<MBTiles> archive = std::make_shared<MBTiles>(path);
+    mbtiles.emplace(path, archive);
+    return archive;
 }
 
-}
\ No newline at end of file
+}
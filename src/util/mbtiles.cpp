@@ -0,0 +1,33 @@
+#include <mbgl/util/mbtiles.hpp>
+#include <mbgl/util/sqlite3.hpp>
+#include <mbgl/util/std.hpp>
+
+namespace mbgl {
+
+MBTiles::MBTiles(const std::string &path)
+    : db(std::make_unique<sqlite::Database>(path, sqlite::ReadOnly | sqlite::NoMutex)) {}
+
+MBTiles::~MBTiles() {}
+
+bool MBTiles::getTile(int8_t z, int32_t x, int32_t y, std::string &data) {
+    if (z < 0 || z > 30 || x < 0 || x >= (1 << z) || y < 0 || y >= (1 << z)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    sqlite::Statement stmt = db->prepare(
+        "SELECT `tile_data` FROM `tiles` "
+        "WHERE `zoom_level` = ? AND `tile_column` = ? AND `tile_row` = ?");
+    stmt.bind(1, int(z));
+    stmt.bind(2, int(x));
+    stmt.bind(3, int((1 << z) - 1 - y));
+    if (!stmt.run()) {
+        return false;
+    }
+
+    data = stmt.get<std::string>(0);
+    return true;
+}
+
+}
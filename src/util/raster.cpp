@@ -9,6 +9,7 @@
 #include <mbgl/util/time.hpp>
 #include <mbgl/util/uv_detail.hpp>
 #include <mbgl/util/std.hpp>
+#include <mbgl/renderer/upload_scheduler.hpp>
 
 #include <png.h>
 
@@ -41,6 +42,23 @@ bool Raster::load(const std::string &data) {
     return loaded;
 }
 
+void Raster::setRetainAfterUpload(bool value) {
+    retain = value;
+}
+
+void Raster::releaseGPU() {
+    if (textured && img) {
+        if (texture) {
+            texturepool->removeTextureID(texture);
+            texture = 0;
+        }
+        textured = false;
+    }
+}
+
+size_t Raster::bytes() const {
+    return img ? img->getWidth() * img->getHeight() * 4 : 0;
+}
 
 void Raster::bind(bool linear) {
     if (!width || !height) {
@@ -50,12 +68,8 @@ void Raster::bind(bool linear) {
 
     if (img && !textured) {
         texture = texturepool->getTextureID();
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img->getData());
-        img.reset();
-        textured = true;
+        filter = 0;
+        createTexture(texture);
     } else if (textured) {
         glBindTexture(GL_TEXTURE_2D, texture);
     }
@@ -71,12 +85,7 @@ void Raster::bind(bool linear) {
 // overload ::bind for prerendered raster textures
 void Raster::bind(const GLuint texture) {
     if (img && !textured) {
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img->getData());
-        img.reset();
-        textured = true;
+        createTexture(texture);
     } else if (textured) {
         glBindTexture(GL_TEXTURE_2D, texture);
     }
@@ -90,6 +99,26 @@ void Raster::bind(const GLuint texture) {
 
 }
 
+bool Raster::upload(UploadScheduler &scheduler) {
+    if (img && !textured && width && height && scheduler.acquire(bytes())) {
+        texture = texturepool->getTextureID();
+        filter = 0;
+        createTexture(texture);
+    }
+    return textured;
+}
+
+void Raster::createTexture(GLuint texture_) {
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img->getData());
+    if (!retain) {
+        img.reset();
+    }
+    textured = true;
+}
+
 void Raster::beginFadeInTransition() {
     timestamp start = util::now();
     fade_transition = std::make_shared<util::ease_transition<double>>(opacity, 1.0, opacity, start, 250_milliseconds);
@@ -0,0 +1,260 @@
+#include <mbgl/util/request_scheduler.hpp>
+#include <mbgl/platform/platform.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace mbgl {
+namespace util {
+
+const RequestScheduler::Priority RequestScheduler::DefaultPriority;
+const RequestScheduler::Priority RequestScheduler::ResourcePriority;
+
+RequestScheduler::Ticket::Ticket(Priority priority_)
+    : priority(priority_), cancelled(false) {}
+
+void RequestScheduler::Ticket::setPriority(Priority value) {
+    // Queued requests are ranked when a slot becomes available, so there's nothing else to do.
+    priority = value;
+}
+
+RequestScheduler::Priority RequestScheduler::Ticket::getPriority() const {
+    return priority;
+}
+
+void RequestScheduler::Ticket::cancel() {
+    if (cancelled.exchange(true)) {
+        return;
+    }
+
+    std::shared_ptr<RequestScheduler> owner;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        owner = scheduler.lock();
+    }
+
+    // Tickets that haven't been queued yet are skipped by request().
+    if (owner) {
+        owner->cancel(*this);
+    }
+}
+
+bool RequestScheduler::Ticket::isCancelled() const {
+    return cancelled;
+}
+
+RequestScheduler::Priority RequestScheduler::Entry::getPriority() const {
+    Priority result = std::numeric_limits<Priority>::max();
+    for (const Subscriber &subscriber : subscribers) {
+        result = std::min<Priority>(result, subscriber.ticket->priority);
+    }
+    return result;
+}
+
+RequestScheduler::Key RequestScheduler::Entry::getKey() const {
+    return Key { url, loop.get(), etag, modified };
+}
+
+RequestScheduler::RequestScheduler(size_t maximumRequestsPerHost_)
+    : maximumRequestsPerHost(std::max<size_t>(maximumRequestsPerHost_, 1)) {}
+
+// Requests that are in flight still invoke their callbacks, but queued requests are dropped.
+RequestScheduler::~RequestScheduler() {}
+
+std::string RequestScheduler::getHost(const std::string &url) {
+    const size_t separator = url.find("://");
+    const size_t begin = separator == std::string::npos ? 0 : separator + 3;
+    const size_t end = url.find_first_of("/?#", begin);
+    return url.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+void RequestScheduler::request(const std::shared_ptr<Ticket> &ticket, const std::string &url, Callback callback,
+                               const std::shared_ptr<uv::loop> &loop, const std::string &etag, int64_t modified) {
+    {
+        std::lock_guard<std::mutex> lock(ticket->mutex);
+        ticket->scheduler = shared_from_this();
+    }
+
+    Entries ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // If the ticket was cancelled before it knew the scheduler, we're the only ones to notice.
+        if (ticket->cancelled) {
+            return;
+        }
+
+        std::shared_ptr<Entry> &entry = entries[Key { url, loop.get(), etag, modified }];
+        if (entry) {
+            stats.deduplicated++;
+        } else {
+            entry = std::make_shared<Entry>();
+            entry->url = url;
+            entry->host = getHost(url);
+            entry->loop = loop;
+            entry->etag = etag;
+            entry->modified = modified;
+            entry->sequence = sequence++;
+            queue.push_back(entry);
+            stats.queued++;
+        }
+
+        entry->subscribers.push_back({ ticket, callback });
+        ticket->entry = entry;
+        ready = dequeue();
+    }
+
+    start(ready);
+}
+
+RequestScheduler::Stats RequestScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void RequestScheduler::cancel(Ticket &ticket) {
+    std::shared_ptr<platform::Request> abort;
+    Entries ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const std::shared_ptr<Entry> entry = ticket.entry.lock();
+        if (!entry || entry->state == Entry::State::Finished) {
+            return;
+        }
+
+        std::vector<Subscriber> &subscribers = entry->subscribers;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [&ticket](const Subscriber &subscriber) {
+            return subscriber.ticket.get() == &ticket;
+        }), subscribers.end());
+        if (!subscribers.empty()) {
+            // Other callers still want this resource.
+            return;
+        }
+
+        entries.erase(entry->getKey());
+        stats.cancelled++;
+
+        if (entry->state == Entry::State::Queued) {
+            queue.erase(std::find(queue.begin(), queue.end(), entry));
+            stats.queued--;
+        } else {
+            // The request may still be starting, in which case start() aborts it.
+            abort = std::move(entry->request);
+            activePerHost[entry->host]--;
+            stats.active--;
+            ready = dequeue();
+        }
+        entry->state = Entry::State::Finished;
+    }
+
+    if (abort) {
+        platform::cancel_request_http(abort);
+    }
+    start(ready);
+}
+
+RequestScheduler::Entries RequestScheduler::dequeue() {
+    Entries ready;
+    while (!queue.empty()) {
+        // Find the most urgent request of a host that has a free slot. Requests of equal priority
+        // start in the order in which they were queued.
+        auto best = queue.end();
+        Priority bestPriority = 0;
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (activePerHost[(*it)->host] >= maximumRequestsPerHost) {
+                continue;
+            }
+            const Priority priority = (*it)->getPriority();
+            if (best == queue.end() || priority < bestPriority ||
+                (priority == bestPriority && (*it)->sequence < (*best)->sequence)) {
+                best = it;
+                bestPriority = priority;
+            }
+        }
+
+        if (best == queue.end()) {
+            break;
+        }
+
+        std::shared_ptr<Entry> entry = *best;
+        queue.erase(best);
+        entry->state = Entry::State::Active;
+        activePerHost[entry->host]++;
+        stats.queued--;
+        stats.active++;
+        stats.started++;
+        ready.push_back(std::move(entry));
+    }
+    return ready;
+}
+
+void RequestScheduler::start(const Entries &ready) {
+    const std::weak_ptr<RequestScheduler> weak = shared_from_this();
+    for (const std::shared_ptr<Entry> &entry : ready) {
+        // Some platforms complete requests synchronously, so we can't hold the lock here.
+        std::shared_ptr<platform::Request> req = platform::request_http(entry->url, [weak, entry](platform::Response *res) {
+            finish(weak, entry, res);
+        }, entry->loop, entry->etag, entry->modified);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entry->state == Entry::State::Active) {
+            entry->request = req;
+        } else {
+            // All tickets were cancelled while we were starting the request, or it has completed
+            // already. Cancelling a completed request is a no-op.
+            platform::cancel_request_http(req);
+        }
+    }
+}
+
+void RequestScheduler::finish(const std::weak_ptr<RequestScheduler> &weak, const std::shared_ptr<Entry> &entry, platform::Response *res) {
+    std::vector<Subscriber> subscribers;
+    Entries ready;
+
+    const std::shared_ptr<RequestScheduler> scheduler = weak.lock();
+    if (scheduler) {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        if (entry->state != Entry::State::Active) {
+            // The request was cancelled.
+            return;
+        }
+
+        auto it = scheduler->entries.find(entry->getKey());
+        if (it != scheduler->entries.end() && it->second == entry) {
+            scheduler->entries.erase(it);
+        }
+        scheduler->activePerHost[entry->host]--;
+        scheduler->stats.active--;
+        scheduler->stats.completed++;
+        entry->state = Entry::State::Finished;
+        entry->request.reset();
+        subscribers.swap(entry->subscribers);
+        ready = scheduler->dequeue();
+    } else {
+        // The scheduler is gone, so nobody else can touch the entry anymore.
+        entry->state = Entry::State::Finished;
+        subscribers.swap(entry->subscribers);
+    }
+
+    if (scheduler) {
+        scheduler->start(ready);
+    }
+
+    for (size_t i = 0; i < subscribers.size(); i++) {
+        const Subscriber &subscriber = subscribers[i];
+        if (subscriber.ticket->cancelled) {
+            continue;
+        }
+        if (i + 1 < subscribers.size()) {
+            // Callbacks may take the body, so all but the last subscriber get a copy.
+            platform::Response copy(*res);
+            subscriber.callback(&copy);
+        } else {
+            subscriber.callback(res);
+        }
+    }
+}
+
+}
+}
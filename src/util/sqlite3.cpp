@@ -0,0 +1,172 @@
+#include <mbgl/util/sqlite3.hpp>
+
+#include <sqlite3.h>
+
+#include <cassert>
+
+namespace sqlite {
+
+Database::Database(const std::string &filename, int flags) {
+    const int err = sqlite3_open_v2(filename.c_str(), &db, flags, nullptr);
+    if (err != SQLITE_OK) {
+        Exception ex { err, db ? sqlite3_errmsg(db) : sqlite3_errstr(err) };
+        sqlite3_close_v2(db);
+        db = nullptr;
+        throw ex;
+    }
+}
+
+Database::~Database() {
+    if (db) {
+        const int err = sqlite3_close_v2(db);
+        if (err != SQLITE_OK) {
+            // Destructors must not throw; all statements are finalized by their owners, so this
+            // should never happen.
+            assert(false);
+        }
+    }
+}
+
+Database::operator bool() const {
+    return db != nullptr;
+}
+
+void Database::setBusyTimeout(std::chrono::milliseconds timeout) {
+    assert(db);
+    const int err = sqlite3_busy_timeout(db, int(timeout.count()));
+    if (err != SQLITE_OK) {
+        throw Exception { err, sqlite3_errmsg(db) };
+    }
+}
+
+void Database::exec(const std::string &sql) {
+    assert(db);
+    char *msg = nullptr;
+    const int err = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &msg);
+    if (msg) {
+        Exception ex { err, msg };
+        sqlite3_free(msg);
+        throw ex;
+    } else if (err != SQLITE_OK) {
+        throw Exception { err, sqlite3_errmsg(db) };
+    }
+}
+
+Statement Database::prepare(const char *query) {
+    assert(db);
+    return Statement(db, query);
+}
+
+Statement::Statement(sqlite3 *db, const char *sql) {
+    const int err = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    if (err != SQLITE_OK) {
+        stmt = nullptr;
+        throw Exception { err, sqlite3_errmsg(db) };
+    }
+}
+
+Statement::Statement(Statement &&other) {
+    std::swap(stmt, other.stmt);
+}
+
+Statement::~Statement() {
+    if (stmt) {
+        sqlite3_finalize(stmt);
+    }
+}
+
+Statement::operator bool() const {
+    return stmt != nullptr;
+}
+
+void Statement::check(int err) {
+    if (err != SQLITE_OK) {
+        throw Exception { err, sqlite3_errmsg(sqlite3_db_handle(stmt)) };
+    }
+}
+
+template <> void Statement::bind(int offset, int value) {
+    assert(stmt);
+    check(sqlite3_bind_int(stmt, offset, value));
+}
+
+template <> void Statement::bind(int offset, int64_t value) {
+    assert(stmt);
+    check(sqlite3_bind_int64(stmt, offset, value));
+}
+
+template <> void Statement::bind(int offset, uint8_t value) {
+    assert(stmt);
+    check(sqlite3_bind_int(stmt, offset, value));
+}
+
+template <> void Statement::bind(int offset, double value) {
+    assert(stmt);
+    check(sqlite3_bind_double(stmt, offset, value));
+}
+
+template <> void Statement::bind(int offset, std::nullptr_t) {
+    assert(stmt);
+    check(sqlite3_bind_null(stmt, offset));
+}
+
+template <> void Statement::bind(int offset, const char *value) {
+    assert(stmt);
+    check(sqlite3_bind_text(stmt, offset, value, -1, SQLITE_STATIC));
+}
+
+void Statement::bind(int offset, const std::string &value, bool retain) {
+    assert(stmt);
+    check(sqlite3_bind_text(stmt, offset, value.data(), int(value.size()),
+                            retain ? SQLITE_TRANSIENT : SQLITE_STATIC));
+}
+
+void Statement::bindBlob(int offset, const std::string &value, bool retain) {
+    assert(stmt);
+    check(sqlite3_bind_blob(stmt, offset, value.data(), int(value.size()),
+                            retain ? SQLITE_TRANSIENT : SQLITE_STATIC));
+}
+
+bool Statement::run() {
+    assert(stmt);
+    const int err = sqlite3_step(stmt);
+    if (err == SQLITE_DONE) {
+        return false;
+    } else if (err == SQLITE_ROW) {
+        return true;
+    } else {
+        throw Exception { err, sqlite3_errmsg(sqlite3_db_handle(stmt)) };
+    }
+}
+
+template <> int Statement::get(int offset) {
+    assert(stmt);
+    return sqlite3_column_int(stmt, offset);
+}
+
+template <> int64_t Statement::get(int offset) {
+    assert(stmt);
+    return sqlite3_column_int64(stmt, offset);
+}
+
+template <> double Statement::get(int offset) {
+    assert(stmt);
+    return sqlite3_column_double(stmt, offset);
+}
+
+template <> std::string Statement::get(int offset) {
+    assert(stmt);
+    // Works for both TEXT and BLOB columns. sqlite3_column_blob must be called before
+    // sqlite3_column_bytes so that the byte count refers to the returned buffer.
+    const char *data = reinterpret_cast<const char *>(sqlite3_column_blob(stmt, offset));
+    const int bytes = sqlite3_column_bytes(stmt, offset);
+    return data ? std::string { data, size_t(bytes) } : std::string {};
+}
+
+void Statement::reset() {
+    assert(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+}
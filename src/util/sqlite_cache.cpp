@@ -0,0 +1,314 @@
+#include <mbgl/util/sqlite_cache.hpp>
+#include <mbgl/util/sqlite3.hpp>
+#include <mbgl/util/filesource.hpp>
+#include <mbgl/util/std.hpp>
+#include <mbgl/platform/platform.hpp>
+#include <mbgl/platform/log.hpp>
+
+#include <ctime>
+
+namespace mbgl {
+
+namespace {
+
+// Lookups are made from the reader thread and from the threadpool, which can afford to wait for a
+// moment while the writer thread or another process commits.
+const std::chrono::milliseconds busyTimeout { 1000 };
+
+// The access time only determines the eviction order, so it is updated at most once per hour and
+// reading a warm cache doesn't turn every lookup into a write.
+const int64_t accessResolution = 60 * 60;
+
+}
+
+SQLiteCache::SQLiteCache(const std::string &path_, uint64_t maximumSize_)
+    : path(path_), maximumSize(maximumSize_) {
+    try {
+        db = std::make_unique<sqlite::Database>(path, sqlite::ReadWrite | sqlite::Create | sqlite::NoMutex);
+        db->setBusyTimeout(busyTimeout);
+        createSchema();
+
+        sqlite::Statement stmt = db->prepare("SELECT SUM(`size`) FROM `http_cache`");
+        if (stmt.run()) {
+            size = stmt.get<int64_t>(0);
+        }
+
+        readDb = std::make_unique<sqlite::Database>(path, sqlite::ReadOnly | sqlite::NoMutex);
+        readDb->setBusyTimeout(busyTimeout);
+    } catch (sqlite::Exception &ex) {
+        Log::Warning(Event::Database, "failed to open cache %s: %s (%d)", path.c_str(), ex.what(), ex.code);
+        db.reset();
+        readDb.reset();
+    }
+
+    writer = std::thread([this]() { process(); });
+    reader = std::thread([this]() { read(); });
+}
+
+SQLiteCache::~SQLiteCache() {
+    {
+        std::lock_guard<std::mutex> lock(lookupMutex);
+        terminateReader = true;
+    }
+    lookupCondition.notify_one();
+    reader.join();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        terminate = true;
+    }
+    queueCondition.notify_one();
+    writer.join();
+}
+
+void SQLiteCache::createSchema() {
+    db->exec("PRAGMA journal_mode = WAL");
+    db->exec("PRAGMA synchronous = NORMAL");
+    db->exec("CREATE TABLE IF NOT EXISTS `http_cache` ("
+             "    `url` TEXT NOT NULL,"
+             "    `type` INTEGER NOT NULL,"
+             "    `code` INTEGER NOT NULL,"
+             "    `modified` INTEGER,"
+             "    `etag` TEXT,"
+             "    `expires` INTEGER,"
+             "    `accessed` INTEGER NOT NULL,"
+             "    `size` INTEGER NOT NULL,"
+             "    `data` BLOB,"
+             "    PRIMARY KEY (`url`, `type`)"
+             ")");
+    db->exec("CREATE INDEX IF NOT EXISTS `http_cache_accessed` ON `http_cache` (`accessed`)");
+}
+
+bool SQLiteCache::get(ResourceType type, const std::string &url, platform::Response &response) {
+    int64_t accessed = 0;
+    {
+        std::lock_guard<std::mutex> lock(readMutex);
+        if (!readDb) {
+            return false;
+        }
+
+        try {
+            sqlite::Statement stmt = readDb->prepare(
+                "SELECT `code`, `modified`, `etag`, `expires`, `data`, `accessed` FROM `http_cache` "
+                "WHERE `url` = ? AND `type` = ?");
+            stmt.bind(1, url, false);
+            stmt.bind(2, int(type));
+            if (!stmt.run()) {
+                return false;
+            }
+
+            response.code = stmt.get<int>(0);
+            response.modified = stmt.get<int64_t>(1);
+            response.etag = stmt.get<std::string>(2);
+            response.expires = stmt.get<int64_t>(3);
+            response.body = stmt.get<std::string>(4);
+            accessed = stmt.get<int64_t>(5);
+        } catch (sqlite::Exception &ex) {
+            Log::Warning(Event::Database, "cache lookup failed: %s (%d)", ex.what(), ex.code);
+            return false;
+        }
+    }
+
+    // Bump the access time so that this entry is evicted last. This is a write, so it goes through
+    // the writer thread and can't turn a successful lookup into a miss.
+    if (int64_t(std::time(nullptr)) - accessed >= accessResolution) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            writes.push({ type, url, Operation::Access, 0, 0, 0, "", "" });
+        }
+        queueCondition.notify_one();
+    }
+
+    return true;
+}
+
+void SQLiteCache::get(ResourceType type, const std::string &url, platform::Response &response, LookupCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(lookupMutex);
+        lookups.push({ type, url, &response, std::move(callback) });
+    }
+    lookupCondition.notify_one();
+}
+
+void SQLiteCache::put(ResourceType type, const std::string &url, const platform::Response &response) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writes.push({ type, url, Operation::Store, response.code, response.modified, response.expires, response.etag, response.body });
+    }
+    queueCondition.notify_one();
+}
+
+void SQLiteCache::refresh(ResourceType type, const std::string &url, int64_t expires) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writes.push({ type, url, Operation::Refresh, 0, 0, expires, "", "" });
+    }
+    queueCondition.notify_one();
+}
+
+void SQLiteCache::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    flushCondition.wait(lock, [this]() { return writes.empty() && !writing; });
+}
+
+void SQLiteCache::read() {
+    std::unique_lock<std::mutex> lock(lookupMutex);
+    while (true) {
+        lookupCondition.wait(lock, [this]() { return terminateReader || !lookups.empty(); });
+        if (lookups.empty()) {
+            // Only reached when terminating; pending lookups are always answered first.
+            break;
+        }
+
+        Lookup lookup = std::move(lookups.front());
+        lookups.pop();
+        lock.unlock();
+
+        lookup.callback(get(lookup.type, lookup.url, *lookup.response));
+
+        lock.lock();
+    }
+}
+
+void SQLiteCache::process() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait(lock, [this]() { return terminate || !writes.empty(); });
+        if (writes.empty()) {
+            // Only reached when terminating; pending writes are always drained first.
+            break;
+        }
+
+        Write write = std::move(writes.front());
+        writes.pop();
+        writing = true;
+        lock.unlock();
+
+        switch (write.operation) {
+            case Operation::Store: store(write); break;
+            case Operation::Refresh: touch(write); break;
+            case Operation::Access: access(write); break;
+        }
+
+        lock.lock();
+        writing = false;
+        if (writes.empty()) {
+            flushCondition.notify_all();
+        }
+    }
+}
+
+void SQLiteCache::store(const Write &write) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) {
+        return;
+    }
+
+    try {
+        db->exec("BEGIN TRANSACTION");
+
+        int64_t previous = 0;
+        sqlite::Statement select = db->prepare(
+            "SELECT `size` FROM `http_cache` WHERE `url` = ? AND `type` = ?");
+        select.bind(1, write.url, false);
+        select.bind(2, int(write.type));
+        if (select.run()) {
+            previous = select.get<int64_t>(0);
+        }
+
+        sqlite::Statement stmt = db->prepare(
+            "REPLACE INTO `http_cache` (`url`, `type`, `code`, `modified`, `etag`, `expires`, "
+            "`accessed`, `size`, `data`) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        stmt.bind(1, write.url, false);
+        stmt.bind(2, int(write.type));
+        stmt.bind(3, int(write.code));
+        stmt.bind(4, write.modified);
+        stmt.bind(5, write.etag, false);
+        stmt.bind(6, write.expires);
+        stmt.bind(7, int64_t(std::time(nullptr)));
+        stmt.bind(8, int64_t(write.body.size()));
+        stmt.bindBlob(9, write.body, false);
+        stmt.run();
+
+        size = size - previous + write.body.size();
+
+        if (size > maximumSize) {
+            prune();
+        }
+
+        db->exec("COMMIT");
+    } catch (sqlite::Exception &ex) {
+        Log::Warning(Event::Database, "failed to store %s in cache: %s (%d)", write.url.c_str(), ex.what(), ex.code);
+        try {
+            db->exec("ROLLBACK");
+        } catch (sqlite::Exception &) {
+            // The transaction may already have been rolled back automatically.
+        }
+    }
+}
+
+void SQLiteCache::touch(const Write &write) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) {
+        return;
+    }
+
+    try {
+        sqlite::Statement stmt = db->prepare(
+            "UPDATE `http_cache` SET `expires` = ?, `accessed` = ? WHERE `url` = ? AND `type` = ?");
+        stmt.bind(1, write.expires);
+        stmt.bind(2, int64_t(std::time(nullptr)));
+        stmt.bind(3, write.url, false);
+        stmt.bind(4, int(write.type));
+        stmt.run();
+    } catch (sqlite::Exception &ex) {
+        Log::Warning(Event::Database, "failed to refresh %s in cache: %s (%d)", write.url.c_str(), ex.what(), ex.code);
+    }
+}
+
+void SQLiteCache::access(const Write &write) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) {
+        return;
+    }
+
+    try {
+        sqlite::Statement stmt = db->prepare(
+            "UPDATE `http_cache` SET `accessed` = ? WHERE `url` = ? AND `type` = ?");
+        stmt.bind(1, int64_t(std::time(nullptr)));
+        stmt.bind(2, write.url, false);
+        stmt.bind(3, int(write.type));
+        stmt.run();
+    } catch (sqlite::Exception &ex) {
+        // Only affects the eviction order.
+        Log::Warning(Event::Database, "failed to update access time of %s in cache: %s (%d)", write.url.c_str(), ex.what(), ex.code);
+    }
+}
+
+uint64_t SQLiteCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return size;
+}
+
+// Must be called with the mutex held and inside a transaction.
+void SQLiteCache::prune() {
+    // Evict down to 90% of the maximum size so that we don't have to prune on every insert once
+    // the cache is full.
+    const uint64_t target = maximumSize / 10 * 9;
+
+    sqlite::Statement select = db->prepare(
+        "SELECT `url`, `type`, `size` FROM `http_cache` ORDER BY `accessed` ASC");
+    sqlite::Statement remove = db->prepare(
+        "DELETE FROM `http_cache` WHERE `url` = ? AND `type` = ?");
+
+    while (size > target && select.run()) {
+        const std::string url = select.get<std::string>(0);
+        remove.bind(1, url, false);
+        remove.bind(2, select.get<int>(1));
+        remove.run();
+        remove.reset();
+        size -= select.get<int64_t>(2);
+    }
+}
+
+}
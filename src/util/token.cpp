@@ -0,0 +1,56 @@
+#include <mbgl/util/token.hpp>
+
+#include <algorithm>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+inline bool isTokenChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '-';
+}
+
+}
+
+TokenTemplate::TokenTemplate(const char *source_) : TokenTemplate(std::string(source_)) {}
+
+TokenTemplate::TokenTemplate(const std::string &source_) : source(source_) {
+    const size_t size = source.size();
+    size_t literal = 0;
+    size_t pos = 0;
+
+    while ((pos = source.find('{', pos)) != std::string::npos) {
+        size_t end = pos + 1;
+        while (end < size && isTokenChar(source[end])) {
+            end++;
+        }
+
+        // Braces without a name, or with other characters in between, are literal text.
+        if (end == pos + 1 || end == size || source[end] != '}') {
+            pos++;
+            continue;
+        }
+
+        if (pos > literal) {
+            segments.push_back({ uint32_t(literal), uint32_t(pos - literal), -1 });
+        }
+
+        const std::string name = source.substr(pos + 1, end - pos - 1);
+        auto it = std::find(tokens.begin(), tokens.end(), name);
+        if (it == tokens.end()) {
+            it = tokens.insert(tokens.end(), name);
+        }
+        segments.push_back({ uint32_t(pos), uint32_t(end + 1 - pos), int32_t(it - tokens.begin()) });
+
+        literal = pos = end + 1;
+    }
+
+    if (literal < size) {
+        segments.push_back({ uint32_t(literal), uint32_t(size - literal), -1 });
+    }
+}
+
+}
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/arena.hpp>
+
+#include <map>
+
+using namespace mbgl;
+
+TEST(Arena, Alignment) {
+    util::Arena arena(256);
+    arena.allocate(1, 1);
+    void *ptr = arena.allocate(8, 8);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % 8);
+    ptr = arena.allocate(3, 1);
+    ptr = arena.allocate(16, 16);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % 16);
+}
+
+TEST(Arena, LargeAllocations) {
+    util::Arena arena(256);
+    char *small = static_cast<char *>(arena.allocate(16));
+    char *large = static_cast<char *>(arena.allocate(4096));
+    std::fill(large, large + 4096, 1);
+    std::fill(small, small + 16, 2);
+    EXPECT_EQ(1, large[0]);
+    EXPECT_EQ(1, large[4095]);
+    EXPECT_GE(arena.capacity(), 4096u + 256u);
+}
+
+TEST(Arena, Scope) {
+    util::Arena arena(256);
+    void *first;
+    {
+        util::Arena::Scope scope(arena);
+        first = arena.allocate(64);
+        for (int i = 0; i < 10; i++) {
+            arena.allocate(200);
+        }
+    }
+    const size_t capacity = arena.capacity();
+
+    // Memory is reused after the scope ended, without allocating new blocks.
+    for (int i = 0; i < 3; i++) {
+        util::Arena::Scope scope(arena);
+        EXPECT_EQ(first, arena.allocate(64));
+        for (int j = 0; j < 10; j++) {
+            arena.allocate(200);
+        }
+        EXPECT_EQ(capacity, arena.capacity());
+    }
+
+    // Nested scopes only rewind to their own start.
+    util::Arena::Scope outer(arena);
+    void *kept = arena.allocate(32);
+    {
+        util::Arena::Scope inner(arena);
+        arena.allocate(32);
+    }
+    EXPECT_NE(kept, arena.allocate(32));
+}
+
+TEST(Arena, Deallocate) {
+    util::Arena arena;
+    void *a = arena.allocate(32);
+    void *b = arena.allocate(32);
+
+    // Only the last allocation can be returned.
+    arena.deallocate(a, 32);
+    EXPECT_NE(a, arena.allocate(32));
+    void *c = arena.allocate(32);
+    arena.deallocate(c, 32);
+    EXPECT_EQ(c, arena.allocate(32));
+    EXPECT_NE(b, c);
+}
+
+TEST(Arena, Containers) {
+    util::Arena arena(1024);
+    util::Arena::Scope scope(arena);
+
+    util::ArenaVector<int> vector { util::ArenaAllocator<int>(arena) };
+    for (int i = 0; i < 10000; i++) {
+        vector.push_back(i);
+    }
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(i, vector[i]);
+    }
+
+    std::map<int, int, std::less<int>, util::ArenaAllocator<std::pair<const int, int>>> map {
+        std::less<int>(), util::ArenaAllocator<std::pair<const int, int>>(arena)
+    };
+    for (int i = 0; i < 1000; i++) {
+        map.emplace(i, i * 2);
+    }
+    EXPECT_EQ(1000u, map.size());
+    EXPECT_EQ(1998, map[999]);
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/geometry/binpack.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// Tracks which pixels are allocated to verify that rects don't overlap.
+class Coverage {
+public:
+    Coverage(uint16_t width, uint16_t height) : width(width), height(height), pixels(width * height) {}
+
+    bool add(const Rect<uint16_t> &rect) {
+        if (rect.x + rect.w > width || rect.y + rect.h > height) {
+            return false;
+        }
+        for (int y = rect.y; y < rect.y + rect.h; y++) {
+            for (int x = rect.x; x < rect.x + rect.w; x++) {
+                if (pixels[y * width + x]) {
+                    return false;
+                }
+                pixels[y * width + x] = true;
+            }
+        }
+        return true;
+    }
+
+    void remove(const Rect<uint16_t> &rect) {
+        for (int y = rect.y; y < rect.y + rect.h; y++) {
+            for (int x = rect.x; x < rect.x + rect.w; x++) {
+                pixels[y * width + x] = false;
+            }
+        }
+    }
+
+private:
+    const uint16_t width, height;
+    std::vector<bool> pixels;
+};
+
+}
+
+TEST(BinPack, Allocate) {
+    BinPack<uint16_t> bin(64, 64);
+    const Rect<uint16_t> a = bin.allocate(32, 16);
+    const Rect<uint16_t> b = bin.allocate(32, 16);
+    const Rect<uint16_t> c = bin.allocate(64, 48);
+    EXPECT_EQ(0, a.y);
+    EXPECT_EQ(0, b.y);
+    EXPECT_EQ(32, b.x);
+    EXPECT_EQ(16, c.y);
+    EXPECT_FLOAT_EQ(1.0f, bin.occupancy());
+
+    // The area is full.
+    EXPECT_FALSE(bin.allocate(1, 1));
+    EXPECT_FALSE(bin.allocate(65, 1));
+}
+
+TEST(BinPack, Reuse) {
+    BinPack<uint16_t> bin(64, 32);
+    const Rect<uint16_t> a = bin.allocate(16, 16);
+    bin.allocate(16, 16);
+    bin.allocate(32, 16);
+    bin.allocate(64, 16);
+    EXPECT_FALSE(bin.allocate(4, 4));
+
+    // Released rects are reused, also for smaller rects.
+    bin.release(a);
+    EXPECT_GT(bin.fragmentation(), 0.0f);
+    const Rect<uint16_t> b = bin.allocate(12, 16);
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.y, b.y);
+    EXPECT_FALSE(bin.allocate(16, 16));
+    EXPECT_FLOAT_EQ(0.0f, bin.fragmentation());
+}
+
+TEST(BinPack, EmptyShelves) {
+    BinPack<uint16_t> bin(64, 64);
+    std::vector<Rect<uint16_t>> shelves[4];
+    for (int i = 0; i < 4; i++) {
+        shelves[i].push_back(bin.allocate(32, 16));
+        shelves[i].push_back(bin.allocate(32, 16));
+    }
+    EXPECT_FALSE(bin.allocate(4, 4));
+
+    // Empty shelves are merged and can be reused for rects of any height.
+    for (int i = 1; i < 3; i++) {
+        for (const Rect<uint16_t> &rect : shelves[i]) {
+            bin.release(rect);
+        }
+    }
+    EXPECT_FLOAT_EQ(0.0f, bin.fragmentation());
+    const Rect<uint16_t> a = bin.allocate(64, 8);
+    const Rect<uint16_t> b = bin.allocate(64, 24);
+    EXPECT_EQ(16, a.y);
+    EXPECT_EQ(24, b.y);
+    EXPECT_FALSE(bin.allocate(4, 4));
+}
+
+TEST(BinPack, Reset) {
+    BinPack<uint16_t> bin(64, 64);
+    std::vector<Rect<uint16_t>> rects;
+    for (int i = 0; i < 16; i++) {
+        rects.push_back(bin.allocate(12, 4 + i % 3 * 4));
+    }
+    for (const Rect<uint16_t> &rect : rects) {
+        bin.release(rect);
+    }
+    EXPECT_EQ(0u, bin.used());
+    EXPECT_FLOAT_EQ(0.0f, bin.fragmentation());
+    EXPECT_TRUE(bin.allocate(64, 64));
+}
+
+TEST(BinPack, Resize) {
+    BinPack<uint16_t> bin(32, 32);
+    const Rect<uint16_t> a = bin.allocate(32, 32);
+    EXPECT_FALSE(bin.allocate(32, 32));
+
+    bin.resize(64, 64);
+    EXPECT_EQ(64, bin.getWidth());
+    EXPECT_EQ(64, bin.getHeight());
+    const Rect<uint16_t> b = bin.allocate(32, 32);
+    const Rect<uint16_t> c = bin.allocate(64, 32);
+    EXPECT_TRUE(b);
+    EXPECT_TRUE(c);
+    EXPECT_FALSE(b.x == a.x && b.y == a.y);
+    EXPECT_FLOAT_EQ(1.0f, bin.occupancy());
+}
+
+TEST(BinPack, Random) {
+    const uint16_t size = 256;
+    BinPack<uint16_t> bin(size, size);
+    Coverage coverage(size, size);
+    std::vector<Rect<uint16_t>> rects;
+    std::mt19937 rng(42);
+
+    for (int i = 0; i < 20000; i++) {
+        if (rects.size() && rng() % 2) {
+            const size_t index = rng() % rects.size();
+            bin.release(rects[index]);
+            coverage.remove(rects[index]);
+            rects[index] = rects.back();
+            rects.pop_back();
+        } else {
+            const Rect<uint16_t> rect = bin.allocate(4 + rng() % 28, 4 + rng() % 28);
+            if (rect) {
+                ASSERT_TRUE(coverage.add(rect));
+                rects.push_back(rect);
+            }
+        }
+    }
+
+    size_t used = 0;
+    for (const Rect<uint16_t> &rect : rects) {
+        used += rect.w * rect.h;
+    }
+    EXPECT_EQ(used, bin.used());
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/geometry/bufferpool.hpp>
+
+#include "../common/headless_view.hpp"
+
+using namespace mbgl;
+
+class BufferpoolTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        view.make_active();
+    }
+
+    HeadlessView view;
+};
+
+TEST_F(BufferpoolTest, SubAllocation) {
+    Bufferpool pool(4096);
+    const Bufferpool::Allocation a = pool.allocate(GL_ARRAY_BUFFER, 100);
+    const Bufferpool::Allocation b = pool.allocate(GL_ARRAY_BUFFER, 100);
+    const Bufferpool::Allocation c = pool.allocate(GL_ELEMENT_ARRAY_BUFFER, 60);
+
+    // Allocations share a buffer per target and are aligned.
+    EXPECT_NE(0u, a.buffer);
+    EXPECT_EQ(a.buffer, b.buffer);
+    EXPECT_NE(a.buffer, c.buffer);
+    EXPECT_EQ(0u, a.offset);
+    EXPECT_EQ(112u, b.offset);
+    EXPECT_EQ(0u, c.offset);
+
+    const Bufferpool::Stats stats = pool.getStats();
+    EXPECT_EQ(2u, stats.buffers);
+    EXPECT_EQ(8192u, stats.capacity);
+    EXPECT_EQ(112u + 112u + 64u, stats.used);
+}
+
+TEST_F(BufferpoolTest, Reuse) {
+    Bufferpool pool(4096);
+    const Bufferpool::Allocation a = pool.allocate(GL_ARRAY_BUFFER, 100);
+    const Bufferpool::Allocation b = pool.allocate(GL_ARRAY_BUFFER, 100);
+    const Bufferpool::Allocation c = pool.allocate(GL_ARRAY_BUFFER, 100);
+
+    // The smallest gap that fits is reused.
+    pool.release(a);
+    EXPECT_EQ(a.offset, pool.allocate(GL_ARRAY_BUFFER, 50).offset);
+
+    // Released neighbors are merged, so that the rest of the buffer fits in one piece.
+    pool.release(b);
+    pool.release(c);
+    const Bufferpool::Allocation d = pool.allocate(GL_ARRAY_BUFFER, 4096 - 64);
+    EXPECT_EQ(a.buffer, d.buffer);
+    EXPECT_EQ(64u, d.offset);
+    EXPECT_EQ(1u, pool.getStats().buffers);
+}
+
+TEST_F(BufferpoolTest, LargeAllocations) {
+    Bufferpool pool(4096);
+    const Bufferpool::Allocation small = pool.allocate(GL_ARRAY_BUFFER, 100);
+    const Bufferpool::Allocation large = pool.allocate(GL_ARRAY_BUFFER, 100000);
+    EXPECT_NE(small.buffer, large.buffer);
+    EXPECT_EQ(0u, large.offset);
+
+    const Bufferpool::Stats stats = pool.getStats();
+    EXPECT_EQ(2u, stats.buffers);
+    EXPECT_EQ(4096u + 128u * 1024u, stats.capacity);
+}
+
+TEST_F(BufferpoolTest, IdleBuffers) {
+    Bufferpool pool(4096);
+    const Bufferpool::Allocation a = pool.allocate(GL_ARRAY_BUFFER, 4096);
+    const Bufferpool::Allocation b = pool.allocate(GL_ARRAY_BUFFER, 4096);
+    const Bufferpool::Allocation c = pool.allocate(GL_ELEMENT_ARRAY_BUFFER, 4096);
+    EXPECT_EQ(3u, pool.getStats().buffers);
+
+    // Empty buffers are deleted when a frame starts, except for one per target.
+    pool.release(a);
+    pool.release(b);
+    pool.release(c);
+    EXPECT_EQ(3u, pool.getStats().buffers);
+    pool.beginFrame();
+    EXPECT_EQ(2u, pool.getStats().buffers);
+    EXPECT_EQ(0u, pool.getStats().used);
+
+    // The remaining buffer is recycled.
+    const Bufferpool::Allocation d = pool.allocate(GL_ARRAY_BUFFER, 1000);
+    EXPECT_EQ(2u, pool.getStats().buffers);
+    EXPECT_TRUE(d.buffer == a.buffer || d.buffer == b.buffer);
+}
+
+TEST_F(BufferpoolTest, Upload) {
+    Bufferpool pool(4096);
+    const std::vector<uint8_t> data(100, 42);
+    const Bufferpool::Allocation a = pool.allocate(GL_ARRAY_BUFFER, data.size());
+    glBindBuffer(GL_ARRAY_BUFFER, a.buffer);
+    pool.upload(GL_ARRAY_BUFFER, a, data.data(), data.size());
+    pool.upload(GL_ARRAY_BUFFER, a, data.data(), data.size());
+    EXPECT_EQ(200u, pool.getStats().uploaded);
+
+    pool.beginFrame();
+    EXPECT_EQ(0u, pool.getStats().uploaded);
+    EXPECT_EQ(200u, pool.getStats().totalUploaded);
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/text/collision.hpp>
+
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+struct Label {
+    CollisionAnchor anchor;
+    GlyphBoxes boxes;
+    bool horizontal;
+};
+
+// Labels like the ones of a label-dense tile: horizontal point labels with a single merged box,
+// and line labels with a box per glyph, some of them close to or beyond the tile edges.
+std::vector<Label> labels(size_t count, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> position(-200, 4296);
+    std::uniform_real_distribution<float> size(40, 600);
+    std::uniform_real_distribution<float> scale(0.5, 4);
+    std::uniform_int_distribution<int> glyphs(2, 12);
+
+    std::vector<Label> result;
+    for (size_t i = 0; i < count; i++) {
+        Label label;
+        label.anchor = CollisionAnchor{ position(generator), position(generator) };
+        label.horizontal = i % 3 != 0;
+
+        const float width = size(generator);
+        const float height = width / 5;
+        const float padding = i % 4;
+        if (label.horizontal) {
+            GlyphBox box(CollisionRect{ -width / 2, -height / 2, width / 2, height / 2 }, label.anchor,
+                         0.5f, std::numeric_limits<float>::infinity(), padding);
+            const float diag = std::sqrt(width * width + height * height) / 2;
+            box.hBox = CollisionRect{ -diag, -diag, diag, diag };
+            label.boxes.push_back(box);
+        } else {
+            const int count = glyphs(generator);
+            const float maxScale = i % 2 ? scale(generator) : std::numeric_limits<float>::infinity();
+            for (int g = 0; g < count; g++) {
+                const CollisionAnchor anchor { label.anchor.x + g * 60, label.anchor.y + g * 10 };
+                label.boxes.emplace_back(CollisionRect{ -30, -height / 2, 30, height / 2 }, anchor,
+                                         scale(generator) / 2, maxScale, padding);
+            }
+        }
+        result.push_back(std::move(label));
+    }
+    return result;
+}
+
+struct Result {
+    float scale;
+    PlacementRange range;
+};
+
+// Places the labels like SymbolBucket does.
+std::vector<Result> place(const std::vector<Label> &labels, PlacementIndexType type, bool avoidEdges) {
+    Collision collision(14, 4096, 512, 1, type);
+    std::vector<Result> results;
+    for (const Label &label : labels) {
+        Result result { collision.getPlacementScale(label.boxes, 0.5f, avoidEdges), {{ 0, 0 }} };
+        if (result.scale) {
+            result.range = collision.getPlacementRange(label.boxes, result.scale, label.horizontal);
+            collision.insert(label.boxes, label.anchor, result.scale, result.range, label.horizontal);
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+}
+
+TEST(Collision, GridMatchesRTree) {
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        for (bool avoidEdges : { false, true }) {
+            const std::vector<Label> input = labels(1500, seed);
+            const std::vector<Result> grid = place(input, PlacementIndexType::Grid, avoidEdges);
+            const std::vector<Result> rtree = place(input, PlacementIndexType::RTree, avoidEdges);
+
+            size_t placed = 0;
+            for (size_t i = 0; i < input.size(); i++) {
+                ASSERT_EQ(rtree[i].scale, grid[i].scale) << "label " << i << " of seed " << seed;
+                ASSERT_EQ(rtree[i].range[0], grid[i].range[0]) << "label " << i << " of seed " << seed;
+                ASSERT_EQ(rtree[i].range[1], grid[i].range[1]) << "label " << i << " of seed " << seed;
+                placed += grid[i].scale != 0;
+            }
+
+            // Some labels are placed, and some are pushed to higher zoom levels or dropped.
+            EXPECT_GT(placed, 0u);
+            EXPECT_LT(placed, input.size());
+        }
+    }
+}
+
+TEST(Collision, LargeBoxes) {
+    // A box that spans many cells blocks a label in any of them, and is only reported once.
+    for (PlacementIndexType type : { PlacementIndexType::Grid, PlacementIndexType::RTree }) {
+        Collision collision(14, 4096, 512, 1, type);
+        const CollisionAnchor anchor { 2048, 2048 };
+        const GlyphBoxes large { GlyphBox(CollisionRect{ -3000, -100, 3000, 100 }, anchor, 0.5f,
+                                          std::numeric_limits<float>::infinity(), 0) };
+        ASSERT_EQ(0.5f, collision.getPlacementScale(large, 0.5f, false));
+        collision.insert(large, anchor, 0.5f, {{ 2.0f * M_PI, 0 }}, true);
+
+        const CollisionAnchor other { 100, 2100 };
+        const GlyphBoxes small { GlyphBox(CollisionRect{ -20, -20, 20, 20 }, other, 0.5f,
+                                          std::numeric_limits<float>::infinity(), 0) };
+        EXPECT_LT(0.5f, collision.getPlacementScale(small, 0.5f, false));
+    }
+}
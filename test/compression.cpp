@@ -0,0 +1,74 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/compression.hpp>
+
+#include <zlib.h>
+
+#include <stdexcept>
+
+using namespace mbgl;
+
+namespace {
+
+// Compresses the data with a gzip header (windowBits 31) or a zlib header (windowBits 15).
+std::string compress(const std::string &data, int windowBits) {
+    z_stream stream = {};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+
+    std::string result(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = (Bytef *)data.data();
+    stream.avail_in = data.size();
+    stream.next_out = (Bytef *)&result[0];
+    stream.avail_out = result.size();
+    deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+std::string tile() {
+    // Starts like a vector tile: field 3 (layers), length-delimited.
+    std::string data = "\x1a\x7f";
+    for (int i = 0; i < 1000; i++) {
+        data += "layer " + std::to_string(i % 7) + ";";
+    }
+    return data;
+}
+
+}
+
+TEST(Compression, Detect) {
+    EXPECT_FALSE(util::isCompressed(tile()));
+    EXPECT_FALSE(util::isCompressed(""));
+    EXPECT_TRUE(util::isCompressed(compress(tile(), 31)));
+    EXPECT_TRUE(util::isCompressed(compress(tile(), 15)));
+}
+
+TEST(Compression, Gzip) {
+    const std::string data = tile();
+    const std::string compressed = compress(data, 31);
+    EXPECT_LT(compressed.size(), data.size());
+    EXPECT_EQ(data, util::decompress(compressed));
+}
+
+TEST(Compression, Zlib) {
+    // Without a size hint, the output buffer has to grow several times.
+    const std::string data(1 << 20, 'x');
+    EXPECT_EQ(data, util::decompress(compress(data, 15)));
+}
+
+TEST(Compression, Empty) {
+    EXPECT_EQ("", util::decompress(compress("", 31)));
+}
+
+TEST(Compression, Corrupt) {
+    std::string compressed = compress(tile(), 31);
+
+    // Truncated streams are rejected.
+    EXPECT_THROW(util::decompress(compressed.substr(0, compressed.size() / 2)), std::runtime_error);
+
+    // So are streams with invalid data.
+    compressed[compressed.size() / 2] ^= 0xFF;
+    EXPECT_THROW(util::decompress(compressed), std::runtime_error);
+}
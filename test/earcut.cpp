@@ -0,0 +1,212 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/geometry/earcut.hpp>
+#include <mbgl/geometry/geometry.hpp>
+#include <libtess2/tesselator.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "../benchmark/fixtures/fixture_tile.hpp"
+
+using namespace mbgl;
+
+namespace {
+
+typedef Earcut::Ring Ring;
+
+Ring ring(std::initializer_list<ClipperLib::IntPoint> points) {
+    return Ring(points);
+}
+
+double triangleArea(const ClipperLib::IntPoint &a, const ClipperLib::IntPoint &b, const ClipperLib::IntPoint &c) {
+    return std::abs(double(b.X - a.X) * double(c.Y - a.Y) - double(b.Y - a.Y) * double(c.X - a.X)) / 2;
+}
+
+// Area covered by the triangles that Earcut produced for the outer ring rings[begin] and its holes.
+double earcutArea(const std::vector<Ring> &rings, size_t begin, size_t end, const std::vector<uint32_t> &indices) {
+    std::vector<ClipperLib::IntPoint> vertices;
+    for (size_t r = begin; r < end; r++) {
+        vertices.insert(vertices.end(), rings[r].begin(), rings[r].end());
+    }
+    double area = 0;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        EXPECT_LT(indices[i + 2], vertices.size());
+        area += triangleArea(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]);
+    }
+    return area;
+}
+
+// Area covered by the triangles of the previous FillBucket path: a union with Clipper,
+// tessellated with libtess2.
+double libtessArea(const std::vector<Ring> &rings) {
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(rings, ClipperLib::ptSubject, true);
+    std::vector<Ring> polygons;
+    clipper.Execute(ClipperLib::ctUnion, polygons, ClipperLib::pftPositive);
+
+    TESStesselator *tesselator = tessNewTess(nullptr);
+    for (const Ring &polygon : polygons) {
+        std::vector<TESSreal> contour;
+        for (const ClipperLib::IntPoint &point : polygon) {
+            contour.push_back(point.X);
+            contour.push_back(point.Y);
+        }
+        tessAddContour(tesselator, 2, contour.data(), sizeof(TESSreal) * 2, int(contour.size() / 2));
+    }
+
+    double area = 0;
+    if (tessTesselate(tesselator, TESS_WINDING_POSITIVE, TESS_POLYGONS, 3, 2, 0)) {
+        const TESSreal *vertices = tessGetVertices(tesselator);
+        const TESSindex *elements = tessGetElements(tesselator);
+        for (int i = 0; i < tessGetElementCount(tesselator); i++) {
+            const TESSindex *triangle = &elements[i * 3];
+            const auto vertex = [&](int j) {
+                return ClipperLib::IntPoint(vertices[triangle[j] * 2], vertices[triangle[j] * 2 + 1]);
+            };
+            area += triangleArea(vertex(0), vertex(1), vertex(2));
+        }
+    }
+    tessDeleteTess(tesselator);
+    return area;
+}
+
+// Decodes the rings of a feature the way FillBucket does.
+std::vector<Ring> featureRings(const VectorTileFeature &feature) {
+    pbf data = feature.geometry;
+    Geometry geometry(data);
+    std::vector<Ring> rings;
+    Ring ring;
+    while (geometry.nextRing(ring)) {
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+        if (ring.size() > 1 && ring.front() == ring.back()) {
+            ring.pop_back();
+        }
+        if (ring.size() >= 3) {
+            rings.push_back(ring);
+        }
+    }
+    return rings;
+}
+
+const FixtureTile &fixture() {
+    static const FixtureTile fixture;
+    return fixture;
+}
+
+}
+
+TEST(Earcut, Square) {
+    Earcut earcut;
+    const std::vector<Ring> rings { ring({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } }) };
+    ASSERT_TRUE(earcut.isSimple(rings, 1));
+
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(earcut.triangulate(rings, 0, 1, indices));
+    EXPECT_EQ(6u, indices.size());
+    EXPECT_DOUBLE_EQ(100, earcutArea(rings, 0, 1, indices));
+}
+
+TEST(Earcut, Hole) {
+    Earcut earcut;
+    const std::vector<Ring> rings {
+        ring({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } }),
+        ring({ { 3, 3 }, { 3, 7 }, { 7, 7 }, { 7, 3 } }),
+    };
+    ASSERT_TRUE(earcut.isSimple(rings, 2));
+
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(earcut.triangulate(rings, 0, 2, indices));
+    EXPECT_EQ(8u * 3, indices.size());
+    EXPECT_DOUBLE_EQ(84, earcutArea(rings, 0, 2, indices));
+}
+
+TEST(Earcut, Concave) {
+    // A U shape with collinear vertices on its bottom edge.
+    Earcut earcut;
+    const std::vector<Ring> rings {
+        ring({ { 0, 0 }, { 5, 0 }, { 10, 0 }, { 15, 0 }, { 15, 10 }, { 10, 10 }, { 10, 5 }, { 5, 5 }, { 5, 10 }, { 0, 10 } }),
+    };
+    ASSERT_TRUE(earcut.isSimple(rings, 1));
+
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(earcut.triangulate(rings, 0, 1, indices));
+    EXPECT_DOUBLE_EQ(125, earcutArea(rings, 0, 1, indices));
+}
+
+TEST(Earcut, IsSimple) {
+    Earcut earcut;
+    const Ring square = ring({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+    const Ring hole = ring({ { 3, 3 }, { 3, 7 }, { 7, 7 }, { 7, 3 } });
+    const Ring island = ring({ { 4, 4 }, { 6, 4 }, { 6, 6 }, { 4, 6 } });
+
+    // Self-intersecting
+    EXPECT_FALSE(earcut.isSimple({ ring({ { 0, 0 }, { 10, 10 }, { 10, 0 }, { 0, 10 } }) }, 1));
+    // Touching itself in a vertex
+    EXPECT_FALSE(earcut.isSimple({ ring({ { 0, 0 }, { 10, 0 }, { 5, 5 }, { 10, 10 }, { 0, 10 }, { 5, 5 } }) }, 1));
+    // Folding back onto itself
+    EXPECT_FALSE(earcut.isSimple({ ring({ { 0, 0 }, { 10, 0 }, { 15, 0 }, { 12, 0 }, { 10, 10 } }) }, 1));
+    // Hole first
+    EXPECT_FALSE(earcut.isSimple({ hole, square }, 2));
+    // Hole outside of the outer ring
+    EXPECT_FALSE(earcut.isSimple({ square, ring({ { 23, 3 }, { 23, 7 }, { 27, 7 }, { 27, 3 } }) }, 2));
+    // Hole touching the outer ring
+    EXPECT_FALSE(earcut.isSimple({ square, ring({ { 0, 3 }, { 3, 7 }, { 7, 7 }, { 7, 3 } }) }, 2));
+    // Outer rings inside each other
+    EXPECT_FALSE(earcut.isSimple({ square, island }, 2));
+    EXPECT_FALSE(earcut.isSimple({ island, square }, 2));
+    // Overlapping outer rings
+    EXPECT_FALSE(earcut.isSimple({ square, ring({ { 5, 5 }, { 15, 5 }, { 15, 15 }, { 5, 15 } }) }, 2));
+
+    // Island in a hole
+    EXPECT_TRUE(earcut.isSimple({ square, hole, island }, 3));
+    // Separate outer rings
+    EXPECT_TRUE(earcut.isSimple({ square, ring({ { 20, 0 }, { 30, 0 }, { 30, 10 }, { 20, 10 } }) }, 2));
+    // Only the first count rings are checked.
+    EXPECT_TRUE(earcut.isSimple({ square, island }, 1));
+}
+
+// Triangulates the fixture polygons and compares the covered area with the previous
+// Clipper and libtess2 triangulation.
+TEST(Earcut, Fixtures) {
+    Earcut earcut;
+    std::vector<uint32_t> indices;
+
+    for (const std::string name : { "building", "water" }) {
+        const VectorTileLayer &layer = fixture().layer(name);
+        size_t simple = 0;
+
+        for (const VectorTileFeature &feature : layer.features) {
+            const std::vector<Ring> rings = featureRings(feature);
+            if (rings.empty() || !earcut.isSimple(rings, rings.size())) {
+                continue;
+            }
+            simple++;
+
+            double area = 0;
+            for (size_t begin = 0; begin < rings.size();) {
+                size_t end = begin + 1;
+                while (end < rings.size() && !ClipperLib::Orientation(rings[end])) {
+                    end++;
+                }
+
+                indices.clear();
+                ASSERT_TRUE(earcut.triangulate(rings, begin, end, indices)) << name << " " << feature.id;
+                area += earcutArea(rings, begin, end, indices);
+                begin = end;
+            }
+
+            EXPECT_NEAR(libtessArea(rings), area, 1e-6 * area) << name << " " << feature.id;
+        }
+
+        if (name == "building") {
+            // Self-intersecting footprints and some of the buildings that were clamped to the
+            // tile buffer need to be clipped, everything else is simple.
+            EXPECT_GT(layer.features.size(), simple);
+            EXPECT_LT(layer.features.size() * 95 / 100, simple);
+        } else {
+            EXPECT_LT(0u, simple);
+        }
+    }
+}
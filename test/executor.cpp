@@ -0,0 +1,192 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/executor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
+
+using namespace mbgl;
+
+TEST(Executor, Post) {
+    std::atomic<int> count { 0 };
+    {
+        util::Executor executor(4);
+        for (int i = 0; i < 100; i++) {
+            executor.post([&count] { count++; });
+        }
+        // The destructor runs all remaining tasks before joining the workers.
+    }
+    EXPECT_EQ(100, count);
+}
+
+TEST(Executor, TaskGroup) {
+    util::Executor executor(4);
+
+    std::vector<int> results(64, 0);
+    util::TaskGroup group(executor);
+    for (size_t i = 0; i < results.size(); i++) {
+        group.add([&results, i] { results[i] = int(i) * 2; });
+    }
+    group.wait();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(int(i) * 2, results[i]);
+    }
+}
+
+TEST(Executor, TaskGroupException) {
+    util::Executor executor(2);
+
+    std::atomic<int> count { 0 };
+    util::TaskGroup group(executor);
+    for (int i = 0; i < 10; i++) {
+        group.add([&count, i] {
+            count++;
+            if (i == 5) {
+                throw std::runtime_error("task failed");
+            }
+        });
+    }
+
+    // The remaining tasks still run.
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_EQ(10, count);
+}
+
+TEST(Executor, NestedTaskGroup) {
+    // Every worker waits on a nested group; the waiting threads run the nested tasks themselves.
+    util::Executor executor(2);
+
+    std::atomic<int> count { 0 };
+    util::TaskGroup outer(executor);
+    for (int i = 0; i < 4; i++) {
+        outer.add([&executor, &count] {
+            util::TaskGroup inner(executor);
+            for (int j = 0; j < 8; j++) {
+                inner.add([&count] { count++; });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+
+    EXPECT_EQ(32, count);
+}
+
+TEST(Executor, Priority) {
+    util::Executor executor(1);
+
+    // Block the only worker until all tasks are queued.
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    executor.post([&mutex] { std::lock_guard<std::mutex> lock(mutex); });
+
+    std::vector<int> order;
+    executor.post([&order] { order.push_back(3); }, 3);
+    executor.post([&order] { order.push_back(1); }, 1);
+    executor.post([&order] { order.push_back(-1); }, util::Executor::ResourcePriority);
+    executor.post([&order] { order.push_back(2); }, 1);
+    block.unlock();
+
+    executor.shutdown();
+    EXPECT_EQ((std::vector<int>{ -1, 1, 2, 3 }), order);
+}
+
+TEST(Executor, Reprioritize) {
+    util::Executor executor(1);
+
+    // Block the only worker until all tasks are queued.
+    std::mutex mutex;
+    std::unique_lock<std::mutex> block(mutex);
+    executor.post([&mutex] { std::lock_guard<std::mutex> lock(mutex); });
+
+    std::vector<int> order;
+    std::atomic<util::Executor::Priority> far { 1 };
+    std::atomic<util::Executor::Priority> near { 2 };
+    executor.post([&order] { order.push_back(1); }, [&far] { return far.load(); });
+    executor.post([&order] { order.push_back(2); }, [&near] { return near.load(); });
+    executor.post([&order] { order.push_back(3); }, 3);
+
+    // The viewport moved: queued tasks are ranked by their new priorities.
+    far = 4;
+    near = 0;
+    executor.reprioritize();
+    block.unlock();
+
+    executor.shutdown();
+    EXPECT_EQ((std::vector<int>{ 2, 3, 1 }), order);
+}
+
+TEST(Executor, Stealing) {
+    util::Executor executor(2);
+
+    // Tasks posted from a worker go to its own queue. The worker is busy until they're done, so
+    // the other worker has to steal them.
+    std::atomic<int> count { 0 };
+    std::atomic<bool> stolen { false };
+    executor.post([&executor, &count, &stolen] {
+        const std::thread::id self = std::this_thread::get_id();
+        for (int i = 0; i < 4; i++) {
+            executor.post([&count, &stolen, self] {
+                stolen = stolen || std::this_thread::get_id() != self;
+                count++;
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        while (count < 4 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            std::this_thread::yield();
+        }
+    });
+
+    // Tasks posted after shutdown() would run synchronously.
+    const auto start = std::chrono::steady_clock::now();
+    while (count < 4 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::yield();
+    }
+
+    executor.shutdown();
+    EXPECT_EQ(4, count);
+    EXPECT_TRUE(stolen);
+}
+
+TEST(Executor, Shutdown) {
+    util::Executor executor(2);
+    for (int i = 0; i < 10; i++) {
+        executor.post([] {});
+    }
+    executor.shutdown();
+
+    const util::Executor::Stats stats = executor.getStats();
+    EXPECT_EQ(10u, stats.completed);
+    EXPECT_EQ(0u, stats.queued);
+    EXPECT_EQ(0u, stats.running);
+    EXPECT_GE(stats.maxQueued, 1u);
+
+    // Tasks posted after shutdown run on the calling thread.
+    bool ran = false;
+    executor.post([&ran] { ran = true; });
+    EXPECT_TRUE(ran);
+}
+
+TEST(Executor, PostFromStartingWorkers) {
+    // Tasks that post more tasks right after the executor is created, while its threads start.
+    for (int round = 0; round < 20; round++) {
+        std::atomic<int> count { 0 };
+        {
+            util::Executor executor(8);
+            for (int i = 0; i < 8; i++) {
+                executor.post([&executor, &count] {
+                    for (int j = 0; j < 8; j++) {
+                        executor.post([&count] { count++; });
+                    }
+                });
+            }
+        }
+        EXPECT_EQ(64, count);
+    }
+}
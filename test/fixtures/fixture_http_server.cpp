@@ -0,0 +1,180 @@
+#include "fixture_http_server.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mbgl {
+
+namespace {
+
+std::string lowercase(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+std::string trim(const std::string &str) {
+    const size_t begin = str.find_first_not_of(" \t");
+    const size_t end = str.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? "" : str.substr(begin, end - begin + 1);
+}
+
+const char *reason(int code) {
+    switch (code) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 404: return "Not Found";
+    default: return "Unknown";
+    }
+}
+
+}
+
+std::string FixtureHTTPServer::Request::header(const std::string &name) const {
+    auto it = headers.find(lowercase(name));
+    return it != headers.end() ? it->second : "";
+}
+
+FixtureHTTPServer::FixtureHTTPServer(Handler handler_) : handler(handler_) {
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("can't create socket");
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listener, (sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listener, 16) != 0 ||
+        getsockname(listener, (sockaddr *)&address, &length) != 0) {
+        close(listener);
+        throw std::runtime_error("can't listen on a local port");
+    }
+    port = ntohs(address.sin_port);
+
+    acceptor = std::thread(&FixtureHTTPServer::accept, this);
+}
+
+FixtureHTTPServer::~FixtureHTTPServer() {
+    // Unblocks accept() and all reads.
+    shutdown(listener, SHUT_RDWR);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : connections) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    acceptor.join();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (int fd : connections) {
+        close(fd);
+    }
+    close(listener);
+}
+
+std::string FixtureHTTPServer::url(const std::string &path) const {
+    return "http://127.0.0.1:" + std::to_string(port) + path;
+}
+
+std::vector<FixtureHTTPServer::Request> FixtureHTTPServer::getRequests() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests;
+}
+
+void FixtureHTTPServer::accept() {
+    while (true) {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.push_back(fd);
+        threads.emplace_back(&FixtureHTTPServer::serve, this, fd, connections.size());
+    }
+}
+
+void FixtureHTTPServer::serve(int fd, size_t connection) {
+    std::string buffer;
+    char chunk[4096];
+
+    while (true) {
+        // Read until we have the complete request header.
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+            if (count <= 0) {
+                return;
+            }
+            buffer.append(chunk, count);
+        }
+
+        Request request;
+        request.connection = connection;
+
+        const std::string head = buffer.substr(0, end + 2);
+        size_t pos = head.find("\r\n");
+        const std::string line = head.substr(0, pos);
+        const size_t space = line.find(' ');
+        request.method = line.substr(0, space);
+        request.path = line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+
+        while (pos + 2 < head.size()) {
+            const size_t next = head.find("\r\n", pos + 2);
+            const std::string header = head.substr(pos + 2, next - pos - 2);
+            const size_t colon = header.find(':');
+            if (colon != std::string::npos) {
+                request.headers[lowercase(header.substr(0, colon))] = trim(header.substr(colon + 1));
+            }
+            pos = next;
+        }
+
+        // Skip the request body.
+        const size_t bodyLength = std::atol(request.header("Content-Length").c_str());
+        while (buffer.size() < end + 4 + bodyLength) {
+            const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+            if (count <= 0) {
+                return;
+            }
+            buffer.append(chunk, count);
+        }
+        buffer.erase(0, end + 4 + bodyLength);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(request);
+        }
+
+        const Reply reply = handler(request);
+        std::string response = "HTTP/1.1 " + std::to_string(reply.code) + " " + reason(reply.code) + "\r\n";
+        for (const auto &header : reply.headers) {
+            response += header.first + ": " + header.second + "\r\n";
+        }
+        if (reply.code == 304) {
+            response += "\r\n";
+        } else {
+            response += "Content-Length: " + std::to_string(reply.body.size()) + "\r\n\r\n" + reply.body;
+        }
+
+        size_t sent = 0;
+        while (sent < response.size()) {
+            const ssize_t count = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (count <= 0) {
+                return;
+            }
+            sent += count;
+        }
+    }
+}
+
+}
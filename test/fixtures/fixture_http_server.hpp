@@ -0,0 +1,66 @@
+#ifndef MBGL_TEST_FIXTURE_HTTP_SERVER
+#define MBGL_TEST_FIXTURE_HTTP_SERVER
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mbgl {
+
+// A minimal HTTP/1.1 server on a random local port. It supports persistent connections, but no
+// chunked request bodies. Every request is answered by the handler.
+class FixtureHTTPServer : private util::noncopyable {
+public:
+    struct Request {
+        std::string method;
+        std::string path;
+
+        // Header names are lowercase.
+        std::map<std::string, std::string> headers;
+
+        // Counts the connections the server has accepted so far, starting at 1.
+        size_t connection = 0;
+
+        std::string header(const std::string &name) const;
+    };
+
+    struct Reply {
+        int code = 200;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+    };
+
+    typedef std::function<Reply(const Request &)> Handler;
+
+    FixtureHTTPServer(Handler handler);
+    ~FixtureHTTPServer();
+
+    // Returns an absolute URL for the path, e.g. "http://127.0.0.1:49152/tile".
+    std::string url(const std::string &path) const;
+
+    std::vector<Request> getRequests() const;
+
+private:
+    void accept();
+    void serve(int fd, size_t connection);
+
+private:
+    const Handler handler;
+    int listener = -1;
+    int port = 0;
+
+    mutable std::mutex mutex;
+    std::vector<Request> requests;
+    std::vector<int> connections;
+    std::vector<std::thread> threads;
+    std::thread acceptor;
+};
+
+}
+
+#endif
@@ -15,7 +15,9 @@ namespace mbgl {
 std::shared_ptr<platform::Request>
 platform::request_http(const std::string &url,
                        std::function<void(Response *)> callback,
-                       std::shared_ptr<uv::loop> loop) {
+                       std::shared_ptr<uv::loop> loop,
+                       const std::string &,
+                       int64_t) {
     uv_loop_t *l = nullptr;
     if (loop) {
         l = **loop;
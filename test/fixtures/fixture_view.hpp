@@ -0,0 +1,18 @@
+#ifndef MBGL_TEST_FIXTURE_VIEW
+#define MBGL_TEST_FIXTURE_VIEW
+
+#include <mbgl/map/view.hpp>
+
+namespace mbgl {
+
+// A view without a GL context for tests that create a Map but never render it.
+class FixtureView : public View {
+public:
+    void swap() {}
+    void make_active() {}
+    void notify_map_change(MapChange, timestamp) {}
+};
+
+}
+
+#endif
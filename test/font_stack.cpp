@@ -0,0 +1,114 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/util/std.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+SDFGlyph glyph(uint32_t id, uint32_t advance) {
+    SDFGlyph glyph;
+    glyph.id = id;
+    glyph.metrics.width = 10;
+    glyph.metrics.height = 12;
+    glyph.metrics.advance = advance;
+    return glyph;
+}
+
+std::unique_ptr<const GlyphSet> glyphs(uint32_t start, uint32_t advance) {
+    std::unique_ptr<GlyphSet> set = std::make_unique<GlyphSet>();
+    for (uint32_t id = start; id < start + GlyphSet::Size; id++) {
+        set->insert(glyph(id, advance));
+    }
+    return std::move(set);
+}
+
+}
+
+TEST(FontStack, GetGlyph) {
+    FontStack stack;
+    EXPECT_FALSE(stack.getGlyph('A'));
+
+    std::unique_ptr<GlyphSet> set = std::make_unique<GlyphSet>();
+    set->insert(glyph('A', 12));
+    stack.insert(0, std::move(set));
+
+    const SDFGlyph *a = stack.getGlyph('A');
+    ASSERT_TRUE(a);
+    EXPECT_EQ(uint32_t('A'), a->id);
+    EXPECT_EQ(12u, a->metrics.advance);
+
+    // Glyphs that are missing from a loaded range are not found either.
+    EXPECT_FALSE(stack.getGlyph('B'));
+    EXPECT_FALSE(stack.getGlyph(256));
+    EXPECT_FALSE(stack.getGlyph(0x10FFFF));
+}
+
+TEST(FontStack, RangesArePublishedOnce) {
+    FontStack stack;
+    stack.insert(256, glyphs(256, 10));
+    const SDFGlyph *first = stack.getGlyph(300);
+    ASSERT_TRUE(first);
+
+    // A range that was loaded twice keeps its first glyphs, so that pointers stay valid.
+    stack.insert(256, glyphs(256, 20));
+    EXPECT_EQ(first, stack.getGlyph(300));
+    EXPECT_EQ(10u, stack.getGlyph(300)->metrics.advance);
+}
+
+TEST(FontStack, Shaping) {
+    FontStack stack;
+    stack.insert(0, glyphs(0, 10));
+
+    const Shaping shaping = stack.getShaping(U"abc", 100 * 24, 24, 0, 0, 0, 2, { 0, 0 });
+    ASSERT_EQ(3u, shaping.size());
+    EXPECT_EQ(0, shaping[0].x);
+    EXPECT_EQ(12, shaping[1].x);
+    EXPECT_EQ(24, shaping[2].x);
+
+    // Characters without glyphs don't take any space.
+    const Shaping missing = stack.getShaping(U"\u3042a", 100 * 24, 24, 0, 0, 0, 0, { 0, 0 });
+    ASSERT_EQ(2u, missing.size());
+    EXPECT_EQ(missing[0].x, missing[1].x);
+}
+
+TEST(FontStack, ConcurrentReaders) {
+    FontStack stack;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> found(0);
+
+    // Readers see either no glyph or a complete one while ranges are being published.
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                for (uint32_t id = 0; id < 16 * GlyphSet::Size; id += 97) {
+                    const SDFGlyph *glyph = stack.getGlyph(id);
+                    if (glyph) {
+                        EXPECT_EQ(id, glyph->id);
+                        EXPECT_EQ(id / GlyphSet::Size + 1, glyph->metrics.advance);
+                        found++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (uint32_t range = 0; range < 16; range++) {
+        stack.insert(range * GlyphSet::Size, glyphs(range * GlyphSet::Size, range + 1));
+    }
+    done = true;
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+
+    for (uint32_t id = 0; id < 16 * GlyphSet::Size; id++) {
+        ASSERT_TRUE(stack.getGlyph(id));
+    }
+}
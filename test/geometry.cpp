@@ -0,0 +1,122 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/geometry/geometry.hpp>
+#include <mbgl/util/vec.hpp>
+
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+std::string varint(uint64_t value) {
+    std::string result;
+    while (value >= 0x80) {
+        result += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    result += char(value);
+    return result;
+}
+
+std::string zigzag(int32_t value) {
+    return varint(uint32_t((value << 1) ^ (value >> 31)));
+}
+
+pbf buffer(const std::string &data) {
+    return pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+}
+
+TEST(Geometry, Svarints) {
+    // Mix runs of single-byte varints, which take the vector path, with longer ones.
+    std::mt19937 generator(1);
+    std::vector<int32_t> expected;
+    std::string data;
+    for (int run = 0; run < 50; run++) {
+        const int32_t limit = run % 3 == 0 ? 63 : (run % 3 == 1 ? 8191 : INT32_MAX / 2);
+        std::uniform_int_distribution<int32_t> distribution(-limit, limit);
+        for (int i = 0; i < 1 + run; i++) {
+            expected.push_back(distribution(generator));
+            data += zigzag(expected.back());
+        }
+    }
+
+    pbf batch = buffer(data);
+    std::vector<int32_t> values(expected.size());
+    batch.svarints(values.data(), values.size());
+    EXPECT_EQ(expected, values);
+    EXPECT_FALSE(batch);
+
+    pbf single = buffer(data);
+    for (int32_t value : expected) {
+        EXPECT_EQ(value, single.svarint<int32_t>());
+    }
+}
+
+TEST(Geometry, SvarintsUnterminated) {
+    const std::string data = zigzag(1) + zigzag(2) + "\x80";
+    pbf geometry = buffer(data);
+    int32_t values[3];
+    EXPECT_THROW(geometry.svarints(values, 3), pbf::unterminated_varint_exception);
+}
+
+TEST(Geometry, NextRing) {
+    // A polygon with one ring, a two point line and a multipoint.
+    const std::string data =
+        varint(1 | (1 << 3)) + zigzag(10) + zigzag(10) +
+        varint(2 | (2 << 3)) + zigzag(100) + zigzag(0) + zigzag(0) + zigzag(100) +
+        varint(7 | (1 << 3)) +
+        varint(1 | (1 << 3)) + zigzag(-5) + zigzag(-5) +
+        varint(2 | (1 << 3)) + zigzag(1) + zigzag(2) +
+        varint(1 | (2 << 3)) + zigzag(1) + zigzag(1) + zigzag(1) + zigzag(1);
+
+    pbf geom = buffer(data);
+    Geometry geometry(geom);
+    std::vector<Coordinate> ring;
+
+    ASSERT_TRUE(geometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 10, 10 }, { 110, 10 }, { 110, 110 }, { 10, 10 } }), ring);
+
+    ASSERT_TRUE(geometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 105, 105 }, { 106, 107 } }), ring);
+
+    ASSERT_TRUE(geometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 107, 108 } }), ring);
+    ASSERT_TRUE(geometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 108, 109 } }), ring);
+
+    EXPECT_FALSE(geometry.nextRing(ring));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(Geometry, MalformedCounts) {
+    // Point counts that exceed the data are clamped before anything is allocated.
+    const std::string line =
+        varint(1 | (1 << 3)) + zigzag(10) + zigzag(10) +
+        varint(2 | (uint64_t(0x1FFFFFFF) << 3)) + zigzag(1) + zigzag(2);
+
+    pbf lineData = buffer(line);
+    Geometry lineGeometry(lineData);
+    std::vector<Coordinate> ring;
+
+    ASSERT_TRUE(lineGeometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 10, 10 }, { 11, 12 } }), ring);
+    EXPECT_GT(64u, ring.capacity());
+    EXPECT_FALSE(lineGeometry.nextRing(ring));
+
+    // A close at the end of the data adds a single point.
+    const std::string polygon =
+        varint(1 | (1 << 3)) + zigzag(10) + zigzag(10) +
+        varint(2 | (1 << 3)) + zigzag(1) + zigzag(2) +
+        varint(7 | (uint64_t(0x1FFFFFFF) << 3));
+
+    pbf polygonData = buffer(polygon);
+    Geometry polygonGeometry(polygonData);
+
+    ASSERT_TRUE(polygonGeometry.nextRing(ring));
+    EXPECT_EQ((std::vector<Coordinate> { { 10, 10 }, { 11, 12 }, { 10, 10 } }), ring);
+    EXPECT_FALSE(polygonGeometry.nextRing(ring));
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/geometry/glyph_atlas.hpp>
+
+#include "../common/headless_view.hpp"
+
+using namespace mbgl;
+
+class GlyphAtlasTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        view.make_active();
+    }
+
+    static SDFGlyph glyph(uint32_t id) {
+        SDFGlyph sdf;
+        sdf.id = id;
+        sdf.metrics.width = 10;
+        sdf.metrics.height = 10;
+        sdf.bitmap = std::string(16 * 16, char(id));
+        return sdf;
+    }
+
+    HeadlessView view;
+};
+
+TEST_F(GlyphAtlasTest, SharedGlyphs) {
+    GlyphAtlas atlas(128, 128);
+    const Rect<uint16_t> a = atlas.addGlyph(1, "Open Sans", glyph(65));
+    EXPECT_EQ(20, a.w);
+    EXPECT_EQ(20, a.h);
+
+    // Tiles share glyphs, no matter how often they add them.
+    for (int i = 0; i < 3; i++) {
+        const Rect<uint16_t> b = atlas.addGlyph(2, "Open Sans", glyph(65));
+        EXPECT_EQ(a.x, b.x);
+        EXPECT_EQ(a.y, b.y);
+        atlas.addGlyph(1, "Open Sans", glyph(65));
+    }
+
+    // Faces don't share glyphs.
+    const Rect<uint16_t> c = atlas.addGlyph(1, "Open Sans Bold", glyph(65));
+    EXPECT_FALSE(a.x == c.x && a.y == c.y);
+
+    // The glyph is kept as long as any tile uses it.
+    atlas.removeGlyphs(1);
+    const Rect<uint16_t> d = atlas.addGlyph(3, "Open Sans", glyph(65));
+    EXPECT_EQ(a.x, d.x);
+    EXPECT_EQ(a.y, d.y);
+
+    // Released space is reused.
+    atlas.removeGlyphs(2);
+    atlas.removeGlyphs(3);
+    const Rect<uint16_t> e = atlas.addGlyph(4, "Open Sans", glyph(66));
+    EXPECT_EQ(a.x, e.x);
+    EXPECT_EQ(a.y, e.y);
+}
+
+TEST_F(GlyphAtlasTest, TileIDs) {
+    GlyphAtlas atlas(128, 128);
+
+    // Tile 0 is a valid tile ID, also after another tile released a glyph.
+    const Rect<uint16_t> a = atlas.addGlyph(5, "Open Sans", glyph(65));
+    atlas.addGlyph(0, "Open Sans", glyph(65));
+    atlas.removeGlyphs(0);
+    atlas.addGlyph(0, "Open Sans", glyph(65));
+    atlas.removeGlyphs(5);
+
+    const Rect<uint16_t> b = atlas.addGlyph(6, "Open Sans", glyph(66));
+    EXPECT_FALSE(a.x == b.x && a.y == b.y);
+}
+
+TEST_F(GlyphAtlasTest, PartialUploads) {
+    GlyphAtlas atlas(128, 128);
+    atlas.addGlyph(1, "Open Sans", glyph(65));
+
+    // The first upload creates the texture.
+    EXPECT_EQ(128u * 128u, atlas.upload());
+    EXPECT_EQ(0u, atlas.upload());
+
+    // Later uploads only contain the regions that changed.
+    atlas.addGlyph(1, "Open Sans", glyph(66));
+    EXPECT_EQ(20u * 20u, atlas.upload());
+    atlas.addGlyph(2, "Open Sans", glyph(67));
+    atlas.removeGlyphs(1);
+    EXPECT_EQ(3u * 20u * 20u, atlas.upload());
+
+    // Many changes are uploaded as a band of rows.
+    for (uint32_t id = 100; id < 120; id++) {
+        atlas.addGlyph(3, "Open Sans", glyph(id));
+    }
+    const size_t bytes = atlas.upload();
+    EXPECT_EQ(0u, bytes % 128);
+    EXPECT_LE(bytes, 128u * 128u);
+}
+
+TEST_F(GlyphAtlasTest, Growth) {
+    GlyphAtlas atlas(64, 64);
+    const Rect<uint16_t> first = atlas.addGlyph(1, "Open Sans", glyph(1));
+    EXPECT_EQ(64u * 64u, atlas.upload());
+    EXPECT_EQ(64, atlas.getTextureWidth());
+
+    // The atlas doubles when it is full, and existing glyphs keep their position.
+    for (uint32_t id = 2; id <= 10; id++) {
+        EXPECT_TRUE(atlas.addGlyph(1, "Open Sans", glyph(id)));
+    }
+    const GlyphAtlas::Stats stats = atlas.getStats();
+    EXPECT_EQ(128, stats.width);
+    EXPECT_EQ(128, stats.height);
+    EXPECT_FLOAT_EQ(10 * 20 * 20 / (128.0f * 128.0f), stats.occupancy);
+
+    const Rect<uint16_t> again = atlas.addGlyph(2, "Open Sans", glyph(1));
+    EXPECT_EQ(first.x, again.x);
+    EXPECT_EQ(first.y, again.y);
+
+    // The texture is recreated with the new size.
+    EXPECT_EQ(128u * 128u, atlas.upload());
+    EXPECT_EQ(128, atlas.getTextureWidth());
+    EXPECT_EQ(128, atlas.getTextureHeight());
+}
+
+TEST_F(GlyphAtlasTest, MaximumSize) {
+    GlyphAtlas atlas(1024, 1024);
+    size_t added = 0;
+    for (uint32_t id = 1; id <= 51 * 51 + 1; id++) {
+        if (atlas.addGlyph(1, "Open Sans", glyph(id))) {
+            added++;
+        }
+    }
+
+    // Texture coordinates can't address a larger atlas.
+    EXPECT_EQ(51u * 51u, added);
+    EXPECT_EQ(1024, atlas.getStats().width);
+}
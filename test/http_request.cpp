@@ -0,0 +1,230 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/platform/platform.hpp>
+#include <mbgl/util/filesource.hpp>
+#include <mbgl/util/sqlite_cache.hpp>
+
+#include "./fixtures/fixture_http_server.hpp"
+#include "./fixtures/fixture_log.hpp"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <thread>
+
+using namespace mbgl;
+
+namespace {
+
+const std::string cachePath = "test_http_request.db";
+
+struct Result {
+    int16_t code;
+    std::string body;
+    int64_t expires;
+    std::string error;
+};
+
+// Requests the URL and waits for the response, which arrives on the request thread.
+Result request(const std::string &url, const std::string &etag = "", int64_t modified = 0) {
+    std::promise<Result> promise;
+    platform::request_http(url, [&promise](platform::Response *res) {
+        promise.set_value({ res->code, res->body, res->expires, res->error_message });
+    }, nullptr, etag, modified);
+    return promise.get_future().get();
+}
+
+Result load(FileSource &source, const std::string &url) {
+    std::promise<Result> promise;
+    source.load(ResourceType::Tile, url, [&promise](platform::Response *res) {
+        promise.set_value({ res->code, res->body, res->expires, res->error_message });
+    });
+    return promise.get_future().get();
+}
+
+std::string deflate(const std::string &data) {
+    uLongf length = compressBound(data.size());
+    std::string result(length, '\0');
+    compress((Bytef *)&result[0], &length, (const Bytef *)data.data(), data.size());
+    result.resize(length);
+    return result;
+}
+
+FixtureHTTPServer::Reply tileServer(const FixtureHTTPServer::Request &request) {
+    FixtureHTTPServer::Reply reply;
+    if (request.header("If-None-Match") == "\"v1\"") {
+        reply.code = 304;
+        reply.headers.emplace_back("Cache-Control", "max-age=3600");
+        return reply;
+    }
+
+    reply.headers.emplace_back("ETag", "\"v1\"");
+    reply.headers.emplace_back("Cache-Control", "max-age=0");
+    if (request.header("Accept-Encoding").find("deflate") != std::string::npos) {
+        reply.headers.emplace_back("Content-Encoding", "deflate");
+        reply.body = deflate("tile data");
+    } else {
+        reply.body = "tile data";
+    }
+    return reply;
+}
+
+FixtureHTTPServer::Reply cacheControlServer(const FixtureHTTPServer::Request &request) {
+    FixtureHTTPServer::Reply reply;
+    if (request.path == "/no-store") {
+        reply.headers.emplace_back("Cache-Control", "private, no-store");
+    } else {
+        reply.headers.emplace_back("Cache-Control", "max-age=3600, No-Cache");
+        reply.headers.emplace_back("Expires", "Thu, 01 Jan 2037 00:00:00 GMT");
+    }
+    reply.body = "tile data";
+    return reply;
+}
+
+void removeDatabase(const std::string &path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+}
+
+TEST(HTTPRequest, Compression) {
+    FixtureHTTPServer server(tileServer);
+
+    const Result result = request(server.url("/tile"));
+    EXPECT_EQ(200, result.code);
+    EXPECT_EQ("tile data", result.body);
+}
+
+TEST(HTTPRequest, ConnectionReuse) {
+    FixtureHTTPServer server(tileServer);
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(200, request(server.url("/tile/" + std::to_string(i))).code);
+    }
+
+    const std::vector<FixtureHTTPServer::Request> requests = server.getRequests();
+    ASSERT_EQ(3u, requests.size());
+    for (const FixtureHTTPServer::Request &req : requests) {
+        EXPECT_EQ(1u, req.connection);
+    }
+}
+
+TEST(HTTPRequest, Conditional) {
+    FixtureHTTPServer server(tileServer);
+
+    const Result result = request(server.url("/tile"), "\"v1\"", 1400000000);
+    EXPECT_EQ(304, result.code);
+    EXPECT_EQ("", result.body);
+    EXPECT_GT(result.expires, int64_t(std::time(nullptr)));
+
+    const std::vector<FixtureHTTPServer::Request> requests = server.getRequests();
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ("\"v1\"", requests[0].header("If-None-Match"));
+    EXPECT_EQ("Tue, 13 May 2014 16:53:20 GMT", requests[0].header("If-Modified-Since"));
+}
+
+TEST(HTTPRequest, RevalidateCache) {
+    FixtureHTTPServer server(tileServer);
+    const std::string url = server.url("/tile");
+
+    // Store a stale copy of the tile.
+    removeDatabase(cachePath);
+    {
+        SQLiteCache cache(cachePath, 1024 * 1024);
+        platform::Response stale(nullptr);
+        stale.code = 200;
+        stale.body = "cached tile data";
+        stale.etag = "\"v1\"";
+        stale.expires = std::time(nullptr) - 60;
+        cache.put(ResourceType::Tile, url, stale);
+    }
+
+    {
+        FileSource source;
+        source.setCacheDatabase(cachePath);
+
+        // The server confirms that the cached copy is still valid, so we don't get a new body.
+        const Result result = load(source, url);
+        EXPECT_EQ(200, result.code);
+        EXPECT_EQ("cached tile data", result.body);
+        EXPECT_GT(result.expires, int64_t(std::time(nullptr)));
+
+        const std::vector<FixtureHTTPServer::Request> requests = server.getRequests();
+        ASSERT_EQ(1u, requests.size());
+        EXPECT_EQ("\"v1\"", requests[0].header("If-None-Match"));
+    }
+
+    // The refresh is written asynchronously by the writer thread of the file source's cache, which
+    // the request may still hold on to, so we're waiting until the entry is fresh.
+    SQLiteCache cache(cachePath, 1024 * 1024);
+    platform::Response refreshed(nullptr);
+    bool found = false;
+    for (int i = 0; i < 500; i++) {
+        found = cache.get(ResourceType::Tile, url, refreshed);
+        if (found && refreshed.expires > int64_t(std::time(nullptr))) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(found);
+    EXPECT_EQ("cached tile data", refreshed.body);
+    EXPECT_GT(refreshed.expires, int64_t(std::time(nullptr)));
+
+    removeDatabase(cachePath);
+}
+
+TEST(HTTPRequest, CacheControl) {
+    FixtureHTTPServer server(cacheControlServer);
+    const std::string noStore = server.url("/no-store");
+    const std::string noCache = server.url("/no-cache");
+
+    // no-cache takes precedence over max-age and the Expires header.
+    EXPECT_EQ(0, request(noCache).expires);
+
+    removeDatabase(cachePath);
+    {
+        FileSource source;
+        source.setCacheDatabase(cachePath);
+        EXPECT_EQ(200, load(source, noStore).code);
+        EXPECT_EQ(200, load(source, noCache).code);
+
+        // Writes are applied in order, so the no-store response would have been written before
+        // the no-cache response shows up.
+        SQLiteCache cache(cachePath, 1024 * 1024);
+        platform::Response cached(nullptr);
+        bool found = false;
+        for (int i = 0; i < 500 && !found; i++) {
+            found = cache.get(ResourceType::Tile, noCache, cached);
+            if (!found) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        ASSERT_TRUE(found);
+        EXPECT_EQ(0, cached.expires);
+        EXPECT_FALSE(cache.get(ResourceType::Tile, noStore, cached));
+
+        // The cached no-cache response is revalidated.
+        EXPECT_EQ(200, load(source, noCache).code);
+    }
+    EXPECT_EQ(4u, server.getRequests().size());
+
+    removeDatabase(cachePath);
+}
+
+TEST(HTTPRequest, Timing) {
+    const FixtureLogBackend &log = Log::Set<FixtureLogBackend>();
+    FixtureHTTPServer server(tileServer);
+
+    EXPECT_EQ(200, request(server.url("/tile")).code);
+
+    ASSERT_EQ(1u, log.messages.size());
+    EXPECT_EQ(EventSeverity::Info, log.messages[0].severity.get());
+    EXPECT_EQ(Event::HttpRequest, log.messages[0].event.get());
+    EXPECT_EQ(0u, log.messages[0].msg.get().find(server.url("/tile") + ": 200 (dns "));
+    log.messages[0].checked = true;
+}
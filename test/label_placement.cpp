@@ -0,0 +1,137 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/text/label_placement.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+const LabelPlacement::View view = [] {
+    LabelPlacement::View view;
+    view.width = 512;
+    view.height = 512;
+    view.zoom = 10;
+    return view;
+}();
+
+// A label of 100x20 pixels, centered on the anchor.
+SymbolInstance label(float x, float y, uint32_t key = 0) {
+    SymbolInstance instance;
+    instance.key = key;
+    instance.anchor = CollisionAnchor{x, y};
+    instance.box = CollisionRect{-50, -10, 50, 10};
+    return instance;
+}
+
+// A tile of 4096 units that covers 256 pixels, with its top left corner at the given position.
+LabelPlacement::Bucket bucket(const std::vector<SymbolInstance> &instances, float x, float y) {
+    LabelPlacement::Bucket bucket;
+    bucket.instances = &instances;
+    matrix::identity(bucket.matrix);
+    matrix::translate(bucket.matrix, bucket.matrix, x, y, 0);
+    matrix::scale(bucket.matrix, bucket.matrix, 256.0f / 4096, 256.0f / 4096, 1);
+    return bucket;
+}
+
+}
+
+TEST(LabelPlacement, Overlap) {
+    const std::vector<SymbolInstance> instances = {
+        label(1000, 1000), label(1500, 1000), label(3000, 1000),
+    };
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(instances, 0, 0) };
+    LabelPlacement::place(buckets, view);
+
+    // The second label is 31 pixels to the right of the first one; the third one is clear.
+    EXPECT_EQ(std::vector<bool>({ true, false, true }), buckets[0].visible);
+}
+
+TEST(LabelPlacement, TileBoundaries) {
+    // Labels close to the boundary of two adjacent tiles, which the tile placement can't see.
+    const std::vector<SymbolInstance> left = { label(4000, 2000) };
+    const std::vector<SymbolInstance> right = { label(200, 2000) };
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(left, 0, 0), bucket(right, 256, 0) };
+    LabelPlacement::place(buckets, view);
+
+    // Earlier buckets take precedence.
+    EXPECT_EQ(std::vector<bool>({ true }), buckets[0].visible);
+    EXPECT_EQ(std::vector<bool>({ false }), buckets[1].visible);
+}
+
+TEST(LabelPlacement, Repetitions) {
+    // The same street name in the buffers of two adjacent tiles is shown once.
+    std::vector<SymbolInstance> left = { label(4000, 2000, 42) };
+    std::vector<SymbolInstance> right = { label(0, 3000, 42), label(2000, 2000, 42) };
+    for (SymbolInstance &instance : left) instance.repeatDistance = 100;
+    for (SymbolInstance &instance : right) instance.repeatDistance = 100;
+    for (SymbolInstance &instance : right) instance.allowOverlap = true;
+
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(left, 0, 0), bucket(right, 256, 0) };
+    LabelPlacement::place(buckets, view);
+
+    // 63 pixels apart is a repetition, 131 pixels apart isn't.
+    EXPECT_EQ(std::vector<bool>({ true }), buckets[0].visible);
+    EXPECT_EQ(std::vector<bool>({ false, true }), buckets[1].visible);
+}
+
+TEST(LabelPlacement, AllowOverlapAndIgnorePlacement) {
+    std::vector<SymbolInstance> instances = {
+        label(1000, 1000), label(2400, 1000), label(1500, 1000), label(3600, 1000),
+    };
+    instances[1].allowOverlap = true;
+    instances[1].ignorePlacement = true;
+    instances[2].ignorePlacement = true;
+
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(instances, 0, 0) };
+    LabelPlacement::place(buckets, view);
+
+    // The second label overlaps the first one and is overlapped by the fourth one. The third one
+    // still collides with the first one.
+    EXPECT_EQ(std::vector<bool>({ true, true, false, true }), buckets[0].visible);
+}
+
+TEST(LabelPlacement, OutsideOfView) {
+    // Labels far outside of the view don't block labels that are in it.
+    const std::vector<SymbolInstance> outside = { label(2000, 2000) };
+    const std::vector<SymbolInstance> inside = { label(2000, 2000) };
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(outside, -1024, 0), bucket(inside, 0, 0) };
+    buckets.push_back(bucket(outside, -1024, 0));
+    LabelPlacement::place(buckets, view);
+
+    EXPECT_EQ(std::vector<bool>({ true }), buckets[0].visible);
+    EXPECT_EQ(std::vector<bool>({ true }), buckets[1].visible);
+    EXPECT_EQ(std::vector<bool>({ true }), buckets[2].visible);
+}
+
+TEST(LabelPlacement, MinZoom) {
+    // Labels that the tile placement hides at this zoom level don't take up space.
+    std::vector<SymbolInstance> instances = { label(1000, 1000), label(1000, 1000) };
+    instances[0].minZoom = 11;
+
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(instances, 0, 0) };
+    LabelPlacement::place(buckets, view);
+    EXPECT_EQ(std::vector<bool>({ true, true }), buckets[0].visible);
+
+    LabelPlacement::View zoomedIn = view;
+    zoomedIn.zoom = 11;
+    LabelPlacement::place(buckets, zoomedIn);
+    EXPECT_EQ(std::vector<bool>({ true, false }), buckets[0].visible);
+}
+
+TEST(LabelPlacement, RotateWithMap) {
+    // Two line labels on parallel lines, in a map rotated by 90 degrees.
+    std::vector<SymbolInstance> instances = { label(2000, 2000), label(2000, 2400) };
+    std::vector<LabelPlacement::Bucket> buckets = { bucket(instances, 0, 0) };
+    matrix::rotate_z(buckets[0].matrix, buckets[0].matrix, M_PI / 2);
+    matrix::translate(buckets[0].matrix, buckets[0].matrix, 0, -4096, 0);
+
+    // Boxes that stay horizontal on the screen overlap.
+    LabelPlacement::place(buckets, view);
+    EXPECT_EQ(std::vector<bool>({ true, false }), buckets[0].visible);
+
+    // Boxes that rotate with the map are 20 pixels wide on the screen, and 25 pixels apart.
+    for (SymbolInstance &instance : instances) instance.rotateWithMap = true;
+    LabelPlacement::place(buckets, view);
+    EXPECT_EQ(std::vector<bool>({ true, true }), buckets[0].visible);
+}
@@ -0,0 +1,190 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/request_scheduler.hpp>
+#include <mbgl/platform/platform.hpp>
+#include <mbgl/platform/request.hpp>
+
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// Requests that were handed to the platform, in the order in which they were started.
+std::vector<std::shared_ptr<platform::Request>> started;
+
+void reset() {
+    started.clear();
+}
+
+std::vector<std::string> startedURLs() {
+    std::vector<std::string> urls;
+    for (const std::shared_ptr<platform::Request> &req : started) {
+        urls.push_back(req->url);
+    }
+    return urls;
+}
+
+void complete(size_t index, const std::string &body) {
+    started[index]->res->code = 200;
+    started[index]->res->body = body;
+    started[index]->complete();
+}
+
+}
+
+// Requests are never sent to the network in this test; they complete when the test says so.
+namespace mbgl {
+
+std::shared_ptr<platform::Request>
+platform::request_http(const std::string &url,
+                       std::function<void(Response *)> callback,
+                       std::shared_ptr<uv::loop> loop,
+                       const std::string &,
+                       int64_t) {
+    std::shared_ptr<Request> req = std::make_shared<Request>(url, callback, loop);
+    started.push_back(req);
+    return req;
+}
+
+void platform::cancel_request_http(const std::shared_ptr<Request> &req) {
+    if (req) {
+        req->cancelled = true;
+    }
+}
+
+}
+
+typedef util::RequestScheduler::Ticket Ticket;
+
+TEST(RequestScheduler, Host) {
+    EXPECT_EQ("a.tiles.mapbox.com", util::RequestScheduler::getHost("http://a.tiles.mapbox.com/v3/streets/1/0/0.png"));
+    EXPECT_EQ("localhost:2900", util::RequestScheduler::getHost("http://localhost:2900?access_token=1"));
+    EXPECT_EQ("example.com", util::RequestScheduler::getHost("example.com"));
+}
+
+TEST(RequestScheduler, HostLimit) {
+    reset();
+    auto scheduler = std::make_shared<util::RequestScheduler>(2);
+
+    int completed = 0;
+    for (int i = 0; i < 5; i++) {
+        scheduler->request(std::make_shared<Ticket>(), "http://a.com/" + std::to_string(i), [&completed](platform::Response *) { completed++; });
+    }
+    EXPECT_EQ((std::vector<std::string>{ "http://a.com/0", "http://a.com/1" }), startedURLs());
+
+    // Other hosts have their own limit.
+    scheduler->request(std::make_shared<Ticket>(), "http://b.com/0", [&completed](platform::Response *) { completed++; });
+    EXPECT_EQ(3u, started.size());
+
+    complete(0, "");
+    EXPECT_EQ(1, completed);
+    ASSERT_EQ(4u, started.size());
+    EXPECT_EQ("http://a.com/2", started[3]->url);
+
+    const util::RequestScheduler::Stats stats = scheduler->getStats();
+    EXPECT_EQ(2u, stats.queued);
+    EXPECT_EQ(3u, stats.active);
+    EXPECT_EQ(4u, stats.started);
+    EXPECT_EQ(1u, stats.completed);
+}
+
+TEST(RequestScheduler, Priority) {
+    reset();
+    auto scheduler = std::make_shared<util::RequestScheduler>(1);
+
+    scheduler->request(std::make_shared<Ticket>(), "http://a.com/busy", [](platform::Response *) {});
+
+    auto far = std::make_shared<Ticket>(3);
+    auto near = std::make_shared<Ticket>(2);
+    auto moved = std::make_shared<Ticket>(1);
+    scheduler->request(far, "http://a.com/far", [](platform::Response *) {});
+    scheduler->request(near, "http://a.com/near", [](platform::Response *) {});
+    scheduler->request(moved, "http://a.com/moved", [](platform::Response *) {});
+    scheduler->request(std::make_shared<Ticket>(util::RequestScheduler::ResourcePriority), "http://a.com/glyphs", [](platform::Response *) {});
+
+    // The viewport moved, so the tiles are re-ranked.
+    far->setPriority(0);
+    moved->setPriority(4);
+
+    for (size_t i = 0; i < 4; i++) {
+        complete(i, "");
+    }
+    EXPECT_EQ((std::vector<std::string>{
+        "http://a.com/busy",
+        "http://a.com/glyphs",
+        "http://a.com/far",
+        "http://a.com/near",
+        "http://a.com/moved",
+    }), startedURLs());
+}
+
+TEST(RequestScheduler, Deduplicate) {
+    reset();
+    auto scheduler = std::make_shared<util::RequestScheduler>(1);
+
+    std::vector<std::string> bodies;
+    auto callback = [&bodies](platform::Response *res) {
+        // Callbacks may take the body of the response.
+        bodies.emplace_back();
+        bodies.back().swap(res->body);
+    };
+
+    scheduler->request(std::make_shared<Ticket>(), "http://a.com/0", callback);
+    scheduler->request(std::make_shared<Ticket>(), "http://a.com/1", callback);
+    scheduler->request(std::make_shared<Ticket>(), "http://a.com/1", callback);
+    scheduler->request(std::make_shared<Ticket>(), "http://a.com/0", callback);
+    EXPECT_EQ(1u, started.size());
+
+    complete(0, "zero");
+    ASSERT_EQ(2u, started.size());
+    complete(1, "one");
+
+    EXPECT_EQ((std::vector<std::string>{ "zero", "zero", "one", "one" }), bodies);
+    EXPECT_EQ(2u, scheduler->getStats().deduplicated);
+}
+
+TEST(RequestScheduler, CancelQueued) {
+    reset();
+    auto scheduler = std::make_shared<util::RequestScheduler>(1);
+
+    std::vector<std::string> received;
+    auto callback = [&received](platform::Response *res) { received.push_back(res->body); };
+
+    auto active = std::make_shared<Ticket>();
+    auto queued = std::make_shared<Ticket>();
+    auto shared1 = std::make_shared<Ticket>();
+    auto shared2 = std::make_shared<Ticket>();
+    scheduler->request(active, "http://a.com/active", callback);
+    scheduler->request(queued, "http://a.com/queued", callback);
+    scheduler->request(shared1, "http://a.com/shared", callback);
+    scheduler->request(shared2, "http://a.com/shared", callback);
+
+    // Cancelling a queued request never reaches the network.
+    queued->cancel();
+    EXPECT_EQ(1u, started.size());
+
+    // The request is kept as long as somebody else still wants it.
+    shared1->cancel();
+
+    // Cancelling an active request frees its slot.
+    active->cancel();
+    EXPECT_TRUE(started[0]->cancelled);
+    ASSERT_EQ(2u, started.size());
+    EXPECT_EQ("http://a.com/shared", started[1]->url);
+
+    complete(1, "shared");
+    EXPECT_EQ((std::vector<std::string>{ "shared" }), received);
+
+    // Tickets that were cancelled before they were queued are ignored.
+    auto early = std::make_shared<Ticket>();
+    early->cancel();
+    scheduler->request(early, "http://a.com/early", callback);
+    EXPECT_EQ(2u, started.size());
+
+    const util::RequestScheduler::Stats stats = scheduler->getStats();
+    EXPECT_EQ(0u, stats.queued);
+    EXPECT_EQ(0u, stats.active);
+    EXPECT_EQ(2u, stats.cancelled);
+}
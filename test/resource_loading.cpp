@@ -0,0 +1,295 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/sprite.hpp>
+#include <mbgl/map/vector_tile_data.hpp>
+#include <mbgl/style/style_source.hpp>
+#include <mbgl/util/executor.hpp>
+#include <mbgl/util/filesource.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/std.hpp>
+#include <mbgl/util/uv_detail.hpp>
+
+#include "./fixtures/fixture_http_server.hpp"
+#include "./fixtures/fixture_view.hpp"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace mbgl;
+
+namespace {
+
+// Responses of the fixture server are delayed by this, like slow network requests.
+const std::chrono::milliseconds latency(300);
+
+typedef std::chrono::steady_clock Clock;
+
+std::string varint(uint64_t value) {
+    std::string result;
+    while (value >= 0x80) {
+        result += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    result += char(value);
+    return result;
+}
+
+std::string message(uint32_t tag, const std::string &data) {
+    return varint((tag << 3) | 2) + varint(data.size()) + data;
+}
+
+std::string field(uint32_t tag, uint64_t value) {
+    return varint(tag << 3) + varint(value);
+}
+
+// A glyph PBF with a single glyph of the given advance.
+std::string glyphs(uint32_t id, uint32_t advance) {
+    const std::string glyph = field(1, id) + field(3, 10) + field(4, 12) + field(7, advance);
+    return message(1, message(3, glyph));
+}
+
+FixtureHTTPServer::Reply slowGlyphServer(const FixtureHTTPServer::Request &request) {
+    std::this_thread::sleep_for(latency);
+
+    FixtureHTTPServer::Reply reply;
+    if (request.path == "/Test+Sans/0-255.pbf") {
+        reply.body = glyphs('A', 12);
+    } else if (request.path.find("/Test+Sans/") == 0) {
+        reply.body = glyphs(0, 0);
+    } else {
+        reply.code = 404;
+    }
+    return reply;
+}
+
+FixtureHTTPServer::Reply slowSpriteServer(const FixtureHTTPServer::Request &request) {
+    std::this_thread::sleep_for(latency);
+
+    FixtureHTTPServer::Reply reply;
+    if (request.path == "/sprite.json") {
+        reply.body = "{ \"marker\": { \"x\": 0, \"y\": 0, \"width\": 2, \"height\": 2, \"pixelRatio\": 1 } }";
+    } else if (request.path == "/sprite.png") {
+        uint32_t pixels[4] = { 0xFF0000FF, 0xFF00FF00, 0xFFFF0000, 0xFFFFFFFF };
+        reply.body = util::compress_png(2, 2, pixels);
+    } else {
+        reply.code = 404;
+    }
+    return reply;
+}
+
+// A tile with a single point labelled "A" in the "labels" layer.
+std::string labelTile() {
+    const std::string geometry = varint(1 | (1 << 3)) + varint(2048 << 1) + varint(2048 << 1);
+    const std::string feature = message(2, varint(0) + varint(0)) + field(3, 1) + message(4, geometry);
+    const std::string layer = message(1, "labels") + message(2, feature) + message(3, "name") +
+                              message(4, message(1, "A")) + field(5, 4096);
+    return message(3, layer);
+}
+
+FixtureHTTPServer::Reply slowTileServer(const FixtureHTTPServer::Request &request) {
+    if (request.path != "/tiles/0/0/0.pbf") {
+        return slowGlyphServer(request);
+    }
+
+    std::this_thread::sleep_for(latency);
+    FixtureHTTPServer::Reply reply;
+    reply.body = labelTile();
+    return reply;
+}
+
+// Records the threads that reparse the tile.
+class RecordingTileData : public VectorTileData {
+public:
+    RecordingTileData(Tile::ID id_, Map &map_, const SourceInfo &source_)
+        : VectorTileData(id_, map_, source_) {}
+
+    virtual void beforeParse() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::this_thread::get_id());
+        }
+        VectorTileData::beforeParse();
+    }
+
+    std::vector<std::thread::id> getThreads() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return threads;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+};
+
+// Returns a callback that fulfills the promise.
+std::function<void()> notify(std::promise<void> &promise) {
+    return [&promise]() { promise.set_value(); };
+}
+
+bool arrives(std::promise<void> &promise) {
+    return promise.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+}
+
+}
+
+TEST(ResourceLoading, GlyphRanges) {
+    FixtureHTTPServer server(slowGlyphServer);
+    GlyphStore store(std::make_shared<FileSource>());
+    store.setURL(server.url("/{fontstack}/{range}.pbf"));
+
+    // Requests return right away, and both requesters are notified once the glyphs are parsed.
+    std::promise<void> first, second;
+    const Clock::time_point start = Clock::now();
+    EXPECT_FALSE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255) }, notify(first)));
+    EXPECT_FALSE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255) }, notify(second)));
+    EXPECT_LT(Clock::now() - start, latency / 2);
+
+    ASSERT_TRUE(arrives(first));
+    ASSERT_TRUE(arrives(second));
+    EXPECT_GE(Clock::now() - start, latency);
+
+    EXPECT_TRUE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255) }, nullptr));
+    const SDFGlyph *glyph = store.getFontStack("Test Sans").getGlyph('A');
+    ASSERT_TRUE(glyph);
+    EXPECT_EQ(12u, glyph->metrics.advance);
+    EXPECT_FALSE(store.getFontStack("Test Sans").getGlyph('B'));
+
+    const std::vector<FixtureHTTPServer::Request> requests = server.getRequests();
+    ASSERT_EQ(1u, requests.size());
+    EXPECT_EQ("/Test+Sans/0-255.pbf", requests[0].path);
+}
+
+TEST(ResourceLoading, PartiallyLoadedGlyphRanges) {
+    FixtureHTTPServer server(slowGlyphServer);
+    GlyphStore store(std::make_shared<FileSource>());
+    store.setURL(server.url("/{fontstack}/{range}.pbf"));
+
+    std::promise<void> first;
+    EXPECT_FALSE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255) }, notify(first)));
+    ASSERT_TRUE(arrives(first));
+
+    // Only the missing range is requested, and the callback waits for it.
+    std::promise<void> second;
+    EXPECT_FALSE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255), GlyphRange(256, 511) }, notify(second)));
+    ASSERT_TRUE(arrives(second));
+    EXPECT_TRUE(store.requestGlyphRanges("Test Sans", { GlyphRange(0, 255), GlyphRange(256, 511) }, nullptr));
+    EXPECT_EQ(2u, server.getRequests().size());
+}
+
+TEST(ResourceLoading, GlyphRangeFailure) {
+    FixtureHTTPServer server(slowGlyphServer);
+    GlyphStore store(std::make_shared<FileSource>());
+    store.setURL(server.url("/{fontstack}/{range}.pbf"));
+
+    // Failed ranges don't keep their requesters waiting; labels are rendered without them.
+    std::promise<void> loaded;
+    EXPECT_FALSE(store.requestGlyphRanges("Missing Sans", { GlyphRange(0, 255) }, notify(loaded)));
+    ASSERT_TRUE(arrives(loaded));
+    EXPECT_TRUE(store.requestGlyphRanges("Missing Sans", { GlyphRange(0, 255) }, nullptr));
+    EXPECT_FALSE(store.getFontStack("Missing Sans").getGlyph('A'));
+}
+
+TEST(ResourceLoading, WorkersDontWait) {
+    FixtureHTTPServer server(slowGlyphServer);
+    GlyphStore store(std::make_shared<FileSource>());
+    store.setURL(server.url("/{fontstack}/{range}.pbf"));
+
+    // Tasks that need glyphs finish without waiting for them, even if there are more of them
+    // than there are workers.
+    util::Executor &executor = util::Executor::shared();
+    const size_t count = executor.getThreadCount() * 2;
+    std::vector<std::promise<void>> loaded(count);
+
+    const Clock::time_point start = Clock::now();
+    {
+        util::TaskGroup group(executor);
+        for (size_t i = 0; i < count; i++) {
+            group.add([&, i]() {
+                const GlyphRange range(i * 256, i * 256 + 255);
+                EXPECT_FALSE(store.requestGlyphRanges("Test Sans", { range }, notify(loaded[i])));
+            });
+        }
+        group.wait();
+    }
+    EXPECT_LT(Clock::now() - start, latency / 2);
+
+    for (std::promise<void> &promise : loaded) {
+        ASSERT_TRUE(arrives(promise));
+    }
+}
+
+TEST(ResourceLoading, Sprite) {
+    FixtureHTTPServer server(slowSpriteServer);
+    std::shared_ptr<Sprite> sprite = Sprite::Create(server.url("/sprite"), 1, std::make_shared<FileSource>());
+
+    std::promise<void> loaded;
+    const Clock::time_point start = Clock::now();
+    EXPECT_FALSE(sprite->requestLoaded(notify(loaded)));
+    EXPECT_LT(Clock::now() - start, latency / 2);
+
+    // The callback is invoked once the image has been decoded.
+    ASSERT_TRUE(arrives(loaded));
+    EXPECT_TRUE(sprite->isLoaded());
+    EXPECT_TRUE(sprite->requestLoaded(nullptr));
+    EXPECT_EQ(2u, sprite->getSpritePosition("marker").width);
+    ASSERT_TRUE(sprite->raster.get());
+    EXPECT_EQ(2u, sprite->raster->getWidth());
+}
+
+TEST(ResourceLoading, SpriteFailure) {
+    FixtureHTTPServer server(slowSpriteServer);
+    std::shared_ptr<Sprite> sprite = Sprite::Create(server.url("/missing"), 1, std::make_shared<FileSource>());
+
+    // Symbols are placed without icons instead of waiting forever.
+    std::promise<void> loaded;
+    EXPECT_FALSE(sprite->requestLoaded(notify(loaded)));
+    ASSERT_TRUE(arrives(loaded));
+    EXPECT_FALSE(sprite->isLoaded());
+    EXPECT_TRUE(sprite->requestLoaded(nullptr));
+}
+
+TEST(ResourceLoading, EmptySprite) {
+    std::shared_ptr<Sprite> sprite = Sprite::Create("", 1, std::make_shared<FileSource>());
+    EXPECT_TRUE(sprite->requestLoaded(nullptr));
+}
+
+TEST(ResourceLoading, TileReparsesOnMapThread) {
+    FixtureHTTPServer server(slowTileServer);
+    FixtureView view;
+    Map map(view);
+    map.setStyleJSON("{ \"glyphs\": \"" + server.url("/{fontstack}/{range}.pbf") + "\", "
+                     "\"layers\": [ { \"id\": \"labels\", \"type\": \"symbol\", \"source-layer\": \"labels\", "
+                     "\"render\": { \"text-field\": \"{name}\", \"text-font\": \"Test Sans\" } } ] }");
+
+    const SourceInfo source(SourceType::Vector, server.url("/tiles/{z}/{x}/{y}.pbf"));
+    std::shared_ptr<RecordingTileData> tile = std::make_shared<RecordingTileData>(Tile::ID(0, 0, 0), map, source);
+    tile->request();
+
+    // The tile is parsed before the glyphs arrive, and reparsed once they're loaded. The loop runs
+    // on this thread.
+    const Clock::time_point start = Clock::now();
+    while (tile->state != TileData::State::parsed && Clock::now() - start < std::chrono::seconds(10)) {
+        uv_run(**map.getLoop(), UV_RUN_NOWAIT);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(TileData::State::parsed, tile->state.load());
+
+    // Finishes the work that is still referenced by the loop.
+    uv_run(**map.getLoop(), UV_RUN_DEFAULT);
+
+    const std::vector<std::thread::id> threads = tile->getThreads();
+    EXPECT_EQ(2u, threads.size());
+    for (const std::thread::id &thread : threads) {
+        EXPECT_EQ(std::this_thread::get_id(), thread);
+    }
+
+    const std::vector<FixtureHTTPServer::Request> requests = server.getRequests();
+    ASSERT_EQ(2u, requests.size());
+    EXPECT_EQ("/tiles/0/0/0.pbf", requests[0].path);
+    EXPECT_EQ("/Test+Sans/0-255.pbf", requests[1].path);
+}
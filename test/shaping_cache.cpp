@@ -0,0 +1,166 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/text/shaping_cache.hpp>
+#include <mbgl/util/std.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+std::unique_ptr<const GlyphSet> glyphs(uint32_t start) {
+    std::unique_ptr<GlyphSet> set = std::make_unique<GlyphSet>();
+    for (uint32_t id = start; id < start + GlyphSet::Size; id++) {
+        SDFGlyph glyph;
+        glyph.id = id;
+        glyph.metrics.width = 10;
+        glyph.metrics.height = 12;
+        glyph.metrics.advance = 10 + id % 3;
+        set->insert(glyph);
+    }
+    return std::move(set);
+}
+
+std::shared_ptr<const Shaping> shape(ShapingCache &cache, const FontStack &stack,
+                                     const std::u32string &string, float maxWidth = 10 * 24) {
+    return cache.getShaping("Open Sans Regular", stack, string, maxWidth, 24, 0.5, 0.5, 0.5, 0, { 0, 0 });
+}
+
+void expectEqual(const Shaping &expected, const Shaping &actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].glyph, actual[i].glyph);
+        EXPECT_EQ(expected[i].x, actual[i].x);
+        EXPECT_EQ(expected[i].y, actual[i].y);
+    }
+}
+
+}
+
+TEST(ShapingCache, Hit) {
+    FontStack stack;
+    stack.insert(0, glyphs(0));
+    ShapingCache cache(1024 * 1024);
+
+    const std::shared_ptr<const Shaping> first = shape(cache, stack, U"Main Street");
+    const std::shared_ptr<const Shaping> second = shape(cache, stack, U"Main Street");
+    ASSERT_TRUE(first.get());
+    EXPECT_EQ(first, second);
+    expectEqual(stack.getShaping(U"Main Street", 10 * 24, 24, 0.5, 0.5, 0.5, 0, { 0, 0 }), *first);
+
+    const ShapingCache::Stats stats = cache.getStats();
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(1u, stats.misses);
+    EXPECT_EQ(1u, stats.count);
+    EXPECT_LT(0u, stats.size);
+    EXPECT_DOUBLE_EQ(0.5, stats.hitRate());
+}
+
+TEST(ShapingCache, Keys) {
+    FontStack stack;
+    stack.insert(0, glyphs(0));
+    ShapingCache cache(1024 * 1024);
+
+    const std::shared_ptr<const Shaping> label = shape(cache, stack, U"Main Street");
+    EXPECT_NE(label, shape(cache, stack, U"Main Avenue"));
+    EXPECT_NE(label, shape(cache, stack, U"Main Street", 5 * 24));
+    EXPECT_NE(label, cache.getShaping("Open Sans Bold", stack, U"Main Street", 10 * 24, 24, 0.5, 0.5,
+                                      0.5, 0, { 0, 0 }));
+    EXPECT_NE(label, cache.getShaping("Open Sans Regular", stack, U"Main Street", 10 * 24, 24, 0.5,
+                                      0.5, 0.5, 0, { 0, 1 }));
+    EXPECT_EQ(label, shape(cache, stack, U"Main Street"));
+    EXPECT_EQ(5u, cache.getStats().count);
+}
+
+TEST(ShapingCache, MissingGlyphRanges) {
+    FontStack stack;
+    stack.insert(0, glyphs(0));
+    ShapingCache cache(1024 * 1024);
+
+    // The glyphs of the second word aren't loaded yet, so its shaping is going to change.
+    const std::u32string label = U"Tokyo \u6771\u4eac";
+    const std::shared_ptr<const Shaping> partial = shape(cache, stack, label);
+    EXPECT_NE(partial, shape(cache, stack, label));
+    EXPECT_EQ(0u, cache.getStats().count);
+
+    stack.insert(0x6700, glyphs(0x6700));
+    stack.insert(0x4e00, glyphs(0x4e00));
+    const std::shared_ptr<const Shaping> complete = shape(cache, stack, label);
+    EXPECT_EQ(complete, shape(cache, stack, label));
+    EXPECT_NE(partial->back().x, complete->back().x);
+}
+
+TEST(ShapingCache, Eviction) {
+    FontStack stack;
+    stack.insert(0, glyphs(0));
+    ShapingCache cache(1024 * 1024);
+
+    const std::shared_ptr<const Shaping> first = shape(cache, stack, U"Street 0");
+    const size_t size = cache.getStats().size;
+    cache.setMaximumSize(size * 10);
+
+    for (int i = 1; i < 100; i++) {
+        shape(cache, stack, U"Street " + std::u32string(1, U'0' + i % 10) + std::u32string(1, U'a' + i / 10));
+
+        // Recently used shapings are kept.
+        EXPECT_EQ(first, shape(cache, stack, U"Street 0"));
+    }
+
+    const ShapingCache::Stats stats = cache.getStats();
+    EXPECT_GE(size * 10, stats.size);
+    EXPECT_LT(0u, stats.evictions);
+    EXPECT_GE(10u, stats.count);
+
+    // Evicted shapings stay valid for their users.
+    cache.clear();
+    EXPECT_EQ(0u, cache.getStats().count);
+    EXPECT_EQ(8u, first->size());
+    EXPECT_NE(first, shape(cache, stack, U"Street 0"));
+
+    // Nothing is cached without a size.
+    cache.setMaximumSize(0);
+    EXPECT_EQ(0u, cache.getStats().count);
+    EXPECT_NE(shape(cache, stack, U"Street 0"), shape(cache, stack, U"Street 0"));
+}
+
+TEST(ShapingCache, ConcurrentParsers) {
+    FontStack stack;
+    stack.insert(0, glyphs(0));
+    ShapingCache cache(1024 * 1024);
+
+    std::vector<std::u32string> labels;
+    for (int i = 0; i < 200; i++) {
+        labels.push_back(U"Street " + std::u32string(1, U'a' + i % 26) + std::u32string(1, U'a' + i / 26));
+    }
+
+    // Tiles are parsed on several threads at the same time, and share the labels.
+    std::vector<std::thread> parsers;
+    for (int i = 0; i < 4; i++) {
+        parsers.emplace_back([&]() {
+            for (int round = 0; round < 10; round++) {
+                for (const std::u32string &label : labels) {
+                    const std::shared_ptr<const Shaping> shaping = shape(cache, stack, label);
+                    ASSERT_TRUE(shaping.get());
+                    ASSERT_EQ(label.size(), shaping->size());
+                }
+            }
+        });
+    }
+    for (std::thread &parser : parsers) {
+        parser.join();
+    }
+
+    const ShapingCache::Stats stats = cache.getStats();
+    EXPECT_EQ(labels.size(), stats.count);
+    EXPECT_EQ(4 * 10 * labels.size(), stats.hits + stats.misses);
+    EXPECT_LE(4 * 9 * labels.size(), stats.hits);
+
+    for (const std::u32string &label : labels) {
+        expectEqual(stack.getShaping(label, 10 * 24, 24, 0.5, 0.5, 0.5, 0, { 0, 0 }), *shape(cache, stack, label));
+    }
+}
@@ -0,0 +1,240 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/sqlite_cache.hpp>
+#include <mbgl/util/sqlite3.hpp>
+#include <mbgl/util/mbtiles.hpp>
+#include <mbgl/util/filesource.hpp>
+#include <mbgl/platform/platform.hpp>
+
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <thread>
+
+using namespace mbgl;
+
+namespace {
+
+const std::string cachePath = "test_sqlite_cache.db";
+const std::string archivePath = "test_sqlite_cache.mbtiles";
+
+platform::Response makeResponse(const std::string &body, int64_t expires = 0) {
+    platform::Response response(nullptr);
+    response.code = 200;
+    response.body = body;
+    response.expires = expires;
+    response.etag = "\"" + body + "\"";
+    return response;
+}
+
+void removeDatabase(const std::string &path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+}
+
+TEST(SQLiteCache, PutGet) {
+    removeDatabase(cachePath);
+    {
+        SQLiteCache cache(cachePath, 1024 * 1024);
+
+        platform::Response miss(nullptr);
+        EXPECT_FALSE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", miss));
+
+        cache.put(ResourceType::Tile, "http://example.com/0/0/0.pbf", makeResponse("tile", 1234));
+        cache.flush();
+
+        platform::Response hit(nullptr);
+        ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", hit));
+        EXPECT_EQ(200, hit.code);
+        EXPECT_EQ("tile", hit.body);
+        EXPECT_EQ(1234, hit.expires);
+        EXPECT_EQ("\"tile\"", hit.etag);
+
+        // Entries are keyed by URL and resource type.
+        platform::Response other(nullptr);
+        EXPECT_FALSE(cache.get(ResourceType::JSON, "http://example.com/0/0/0.pbf", other));
+
+        cache.refresh(ResourceType::Tile, "http://example.com/0/0/0.pbf", 5678);
+        cache.flush();
+
+        platform::Response refreshed(nullptr);
+        ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", refreshed));
+        EXPECT_EQ("tile", refreshed.body);
+        EXPECT_EQ(5678, refreshed.expires);
+    }
+
+    // The cache persists across instances.
+    {
+        SQLiteCache cache(cachePath, 1024 * 1024);
+        EXPECT_EQ(4u, cache.getSize());
+
+        platform::Response hit(nullptr);
+        ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", hit));
+        EXPECT_EQ("tile", hit.body);
+    }
+    removeDatabase(cachePath);
+}
+
+TEST(SQLiteCache, QueuedGet) {
+    removeDatabase(cachePath);
+    SQLiteCache cache(cachePath, 1024 * 1024);
+    cache.put(ResourceType::Tile, "http://example.com/0/0/0.pbf", makeResponse("tile"));
+    cache.flush();
+
+    // Queued lookups are answered on the reader thread.
+    platform::Response hit(nullptr);
+    std::promise<std::thread::id> found;
+    cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", hit, [&](bool result) {
+        EXPECT_TRUE(result);
+        found.set_value(std::this_thread::get_id());
+    });
+    EXPECT_NE(std::this_thread::get_id(), found.get_future().get());
+    EXPECT_EQ("tile", hit.body);
+
+    platform::Response miss(nullptr);
+    std::promise<bool> missed;
+    cache.get(ResourceType::Tile, "http://example.com/1/0/0.pbf", miss, [&](bool result) {
+        missed.set_value(result);
+    });
+    EXPECT_FALSE(missed.get_future().get());
+    removeDatabase(cachePath);
+}
+
+TEST(SQLiteCache, AccessTime) {
+    removeDatabase(cachePath);
+    SQLiteCache cache(cachePath, 1024 * 1024);
+    cache.put(ResourceType::Tile, "http://example.com/0/0/0.pbf", makeResponse("tile"));
+    cache.flush();
+
+    sqlite::Database db(cachePath, sqlite::ReadWrite);
+    auto accessed = [&db]() {
+        sqlite::Statement stmt = db.prepare("SELECT `accessed` FROM `http_cache`");
+        return stmt.run() ? stmt.get<int64_t>(0) : -1;
+    };
+
+    // Entries that were accessed recently aren't written again.
+    const int64_t recent = int64_t(std::time(nullptr)) - 60;
+    db.exec("UPDATE `http_cache` SET `accessed` = " + std::to_string(recent));
+    platform::Response hit(nullptr);
+    ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", hit));
+    cache.flush();
+    EXPECT_EQ(recent, accessed());
+
+    db.exec("UPDATE `http_cache` SET `accessed` = 0");
+    ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/0/0/0.pbf", hit));
+    cache.flush();
+    EXPECT_LT(recent, accessed());
+    removeDatabase(cachePath);
+}
+
+TEST(SQLiteCache, Replace) {
+    removeDatabase(cachePath);
+    SQLiteCache cache(cachePath, 1024 * 1024);
+
+    cache.put(ResourceType::Tile, "http://example.com/tile", makeResponse(std::string(100, 'a')));
+    cache.put(ResourceType::Tile, "http://example.com/tile", makeResponse(std::string(50, 'b')));
+    cache.flush();
+
+    EXPECT_EQ(50u, cache.getSize());
+
+    platform::Response hit(nullptr);
+    ASSERT_TRUE(cache.get(ResourceType::Tile, "http://example.com/tile", hit));
+    EXPECT_EQ(std::string(50, 'b'), hit.body);
+    removeDatabase(cachePath);
+}
+
+TEST(SQLiteCache, Prune) {
+    removeDatabase(cachePath);
+    SQLiteCache cache(cachePath, 1000);
+
+    for (int i = 0; i < 20; i++) {
+        cache.put(ResourceType::Tile, "http://example.com/" + std::to_string(i), makeResponse(std::string(100, 'x')));
+    }
+    cache.flush();
+
+    EXPECT_LE(cache.getSize(), 1000u);
+
+    // The most recent entry always survives.
+    platform::Response hit(nullptr);
+    EXPECT_TRUE(cache.get(ResourceType::Tile, "http://example.com/19", hit));
+    removeDatabase(cachePath);
+}
+
+TEST(SQLiteCache, ConcurrentConnections) {
+    removeDatabase(cachePath);
+    SQLiteCache reader(cachePath, 1024 * 1024);
+    reader.put(ResourceType::Tile, "http://example.com/tile", makeResponse("tile"));
+    reader.flush();
+
+    // Another connection, e.g. from a second process, writes while entries are being read.
+    SQLiteCache writer(cachePath, 1024 * 1024);
+    std::thread writes([&writer] {
+        for (int i = 0; i < 500; i++) {
+            writer.put(ResourceType::Tile, "http://example.com/" + std::to_string(i), makeResponse(std::string(100, 'x')));
+        }
+        writer.flush();
+    });
+
+    int misses = 0;
+    for (int i = 0; i < 2000; i++) {
+        platform::Response hit(nullptr);
+        if (!reader.get(ResourceType::Tile, "http://example.com/tile", hit) || hit.body != "tile") {
+            misses++;
+        }
+    }
+    writes.join();
+    EXPECT_EQ(0, misses);
+    removeDatabase(cachePath);
+}
+
+TEST(MBTiles, GetTile) {
+    removeDatabase(archivePath);
+    {
+        sqlite::Database db(archivePath, sqlite::ReadWrite | sqlite::Create);
+        db.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)");
+        // TMS row 0 at z2 is XYZ row 3.
+        db.exec("INSERT INTO tiles VALUES (2, 1, 0, 'tile 2/1/3')");
+    }
+
+    MBTiles archive(archivePath);
+
+    std::string data;
+    ASSERT_TRUE(archive.getTile(2, 1, 3, data));
+    EXPECT_EQ("tile 2/1/3", data);
+    EXPECT_FALSE(archive.getTile(2, 1, 0, data));
+
+    // The FileSource serves archives with mbtiles:// URLs.
+    FileSource source;
+    int16_t code = 0;
+    source.load(ResourceType::Tile, "mbtiles://" + archivePath + "/2/1/3.pbf", [&](platform::Response *res) {
+        code = res->code;
+        data = res->body;
+    });
+    EXPECT_EQ(200, code);
+    EXPECT_EQ("tile 2/1/3", data);
+
+    source.load(ResourceType::Tile, "mbtiles://" + archivePath + "/2/0/0.pbf", [&](platform::Response *res) {
+        code = res->code;
+    });
+    EXPECT_EQ(404, code);
+
+    // Coordinates outside of the tile pyramid are rejected before the lookup.
+    EXPECT_FALSE(archive.getTile(31, 0, 0, data));
+    EXPECT_FALSE(archive.getTile(-1, 0, 0, data));
+    for (const std::string &tile : { "300/0/0", "-1/0/0", "2/4/0", "2/0/-1", "31/0/0" }) {
+        std::string message;
+        code = 0;
+        source.load(ResourceType::Tile, "mbtiles://" + archivePath + "/" + tile + ".pbf", [&](platform::Response *res) {
+            code = res->code;
+            message = res->error_message;
+        });
+        EXPECT_EQ(-1, code) << tile;
+        EXPECT_EQ(0u, message.find("invalid MBTiles URL")) << tile;
+    }
+
+    removeDatabase(archivePath);
+}
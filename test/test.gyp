@@ -157,6 +157,191 @@
             "../mapboxgl.gyp:mapboxgl",
         ]
     },
+    {
+        "target_name": "vector_tile",
+        "product_name": "test_vector_tile",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./vector_tile.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "geometry",
+        "product_name": "test_geometry",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./geometry.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "earcut",
+        "product_name": "test_earcut",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./earcut.cpp",
+            "../benchmark/fixtures/fixture_tile.hpp",
+            "../benchmark/fixtures/fixture_tile.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "compression",
+        "product_name": "test_compression",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+            "-lz",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./compression.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "arena",
+        "product_name": "test_arena",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./arena.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "bufferpool",
+        "product_name": "test_bufferpool",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./bufferpool.cpp",
+            "../common/headless_view.hpp",
+            "../common/headless_view.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+            "link_gl",
+        ]
+    },
+    {
+        "target_name": "binpack",
+        "product_name": "test_binpack",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./binpack.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "glyph_atlas",
+        "product_name": "test_glyph_atlas",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./glyph_atlas.cpp",
+            "../common/headless_view.hpp",
+            "../common/headless_view.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+            "link_gl",
+        ]
+    },
+    {
+        "target_name": "upload_scheduler",
+        "product_name": "test_upload_scheduler",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./upload_scheduler.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "executor",
+        "product_name": "test_executor",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./executor.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "request_scheduler",
+        "product_name": "test_request_scheduler",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./request_scheduler.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
     {
         "target_name": "tile",
         "product_name": "test_tile",
@@ -211,6 +396,171 @@
             "link_gl",
         ]
     },
+    {
+        "target_name": "sqlite_cache",
+        "product_name": "test_sqlite_cache",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./sqlite_cache.cpp",
+            "./fixtures/fixture_request.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "http_request",
+        "product_name": "test_http_request",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+            "-lz",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./http_request.cpp",
+            "../common/curl_request.cpp",
+            "./fixtures/fixture_http_server.hpp",
+            "./fixtures/fixture_http_server.cpp",
+            "./fixtures/fixture_log.hpp",
+            "./fixtures/fixture_log.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+            "link_curl",
+        ]
+    },
+    {
+        "target_name": "resource_loading",
+        "product_name": "test_resource_loading",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./resource_loading.cpp",
+            "../common/curl_request.cpp",
+            "./fixtures/fixture_http_server.hpp",
+            "./fixtures/fixture_http_server.cpp",
+            "./fixtures/fixture_view.hpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+            "link_gl",
+            "link_curl",
+        ]
+    },
+    {
+        "target_name": "font_stack",
+        "product_name": "test_font_stack",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./font_stack.cpp",
+            "./fixtures/fixture_request.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "tile_cache",
+        "product_name": "test_tile_cache",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./tile_cache.cpp",
+            "./fixtures/fixture_request.cpp",
+            "./fixtures/fixture_view.hpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+            "link_gl",
+        ]
+    },
+    {
+        "target_name": "label_placement",
+        "product_name": "test_label_placement",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./label_placement.cpp",
+            "./fixtures/fixture_request.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "collision",
+        "product_name": "test_collision",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./collision.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "shaping_cache",
+        "product_name": "test_shaping_cache",
+        "type": "executable",
+        "libraries": [
+            "-lpthread",
+        ],
+        "sources": [
+            "./main.cpp",
+            "./shaping_cache.cpp",
+            "./fixtures/fixture_request.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "token",
+        "product_name": "test_token",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./token.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
+    {
+        "target_name": "utf",
+        "product_name": "test_utf",
+        "type": "executable",
+        "sources": [
+            "./main.cpp",
+            "./utf.cpp",
+        ],
+        "dependencies": [
+            "../deps/gtest/gtest.gyp:gtest",
+            "../mapboxgl.gyp:mapboxgl",
+        ]
+    },
     {
         "target_name": "test",
         "type": "none",
@@ -224,6 +574,27 @@
           "headless",
           "style_parser",
           "comparisons",
+          "vector_tile",
+          "geometry",
+          "earcut",
+          "compression",
+          "executor",
+          "arena",
+          "bufferpool",
+          "binpack",
+          "glyph_atlas",
+          "upload_scheduler",
+          "request_scheduler",
+          "sqlite_cache",
+          "http_request",
+          "resource_loading",
+          "tile_cache",
+          "font_stack",
+          "label_placement",
+          "collision",
+          "shaping_cache",
+          "token",
+          "utf",
         ],
     }
   ]
@@ -0,0 +1,56 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/tile_cache.hpp>
+#include <mbgl/map/vector_tile_data.hpp>
+#include <mbgl/style/style_source.hpp>
+
+#include "./fixtures/fixture_view.hpp"
+
+#include <memory>
+
+using namespace mbgl;
+
+TEST(TileCache, AddAndGet) {
+    FixtureView view;
+    Map map(view);
+    map.setTileCacheSize(1024 * 1024);
+
+    const SourceInfo source(SourceType::Vector);
+    std::shared_ptr<TileData> tile = std::make_shared<VectorTileData>(Tile::ID(1, 0, 0), map, source);
+
+    TileCache cache(map.getTileCacheSize());
+    cache.add(tile->id, tile);
+    EXPECT_TRUE(cache.has(tile->id));
+    EXPECT_EQ(1u, cache.getTileCount());
+
+    EXPECT_EQ(tile, cache.get(tile->id));
+    EXPECT_FALSE(cache.has(tile->id));
+    EXPECT_EQ(nullptr, cache.get(tile->id));
+}
+
+TEST(TileCache, IgnoresTilesCreatedWithoutCache) {
+    FixtureView view;
+    Map map(view);
+    map.setTileCacheSize(0);
+
+    // The tile doesn't keep the CPU copies of its buffers, so it would be empty after the cache
+    // released its GL objects.
+    const SourceInfo source(SourceType::Vector);
+    std::shared_ptr<TileData> tile = std::make_shared<VectorTileData>(Tile::ID(1, 0, 0), map, source);
+    EXPECT_FALSE(tile->retainAfterUpload);
+
+    // The cache is enabled before the tile is evicted.
+    map.setTileCacheSize(1024 * 1024);
+    TileCache cache(map.getTileCacheSize());
+    cache.add(tile->id, tile);
+    EXPECT_FALSE(cache.has(tile->id));
+    EXPECT_EQ(0u, cache.getTileCount());
+
+    // Tiles created after the change are cached.
+    std::shared_ptr<TileData> retained = std::make_shared<VectorTileData>(Tile::ID(1, 1, 0), map, source);
+    EXPECT_TRUE(retained->retainAfterUpload);
+    cache.add(retained->id, retained);
+    EXPECT_TRUE(cache.has(retained->id));
+}
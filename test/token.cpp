@@ -0,0 +1,59 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/token.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+std::string replace(const std::string &source) {
+    return util::replaceTokens(source, [](const std::string &token) -> std::string {
+        if (token == "name") return "Main Street";
+        if (token == "name_en") return "Main St.";
+        if (token == "maki") return "cafe";
+        if (token == "x-y_1") return "7";
+        return "";
+    });
+}
+
+}
+
+TEST(Token, ReplaceTokens) {
+    EXPECT_EQ("", replace(""));
+    EXPECT_EQ("literal", replace("literal"));
+    EXPECT_EQ("Main Street", replace("{name}"));
+    EXPECT_EQ("cafe-12", replace("{maki}-12"));
+    EXPECT_EQ("Main Street (Main St.)", replace("{name} ({name_en})"));
+    EXPECT_EQ("Main StreetMain Street", replace("{name}{name}"));
+    EXPECT_EQ("7", replace("{x-y_1}"));
+    EXPECT_EQ("", replace("{unknown}"));
+}
+
+TEST(Token, LiteralBraces) {
+    // Braces that don't enclose a token name are kept.
+    EXPECT_EQ("{}", replace("{}"));
+    EXPECT_EQ("{", replace("{"));
+    EXPECT_EQ("}", replace("}"));
+    EXPECT_EQ("{name", replace("{name"));
+    EXPECT_EQ("{na me}", replace("{na me}"));
+    EXPECT_EQ("{Main Street}", replace("{{name}}"));
+    EXPECT_EQ("{aMain Street", replace("{a{name}"));
+    EXPECT_EQ("{\xc3\xa9}", replace("{\xc3\xa9}"));
+}
+
+TEST(Token, Template) {
+    const util::TokenTemplate tokens("{name} ({ele} m) {name}");
+    EXPECT_EQ("{name} ({ele} m) {name}", tokens.getSource());
+    EXPECT_EQ(std::vector<std::string>({ "name", "ele" }), tokens.getTokens());
+
+    // Lookups refer to tokens by index, and append to the same string.
+    std::string result = "> ";
+    tokens.expand(result, [](size_t token, std::string &out) {
+        out += token == 0 ? "Mont Blanc" : "4808";
+    });
+    EXPECT_EQ("> Mont Blanc (4808 m) Mont Blanc", result);
+
+    EXPECT_TRUE(util::TokenTemplate().empty());
+    EXPECT_TRUE(util::TokenTemplate("literal").getTokens().empty());
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/renderer/upload_scheduler.hpp>
+
+using namespace mbgl;
+
+TEST(UploadScheduler, Budget) {
+    UploadScheduler scheduler;
+    scheduler.beginFrame(1000);
+    EXPECT_TRUE(scheduler.acquire(400));
+    EXPECT_TRUE(scheduler.acquire(600));
+    EXPECT_FALSE(scheduler.acquire(1));
+    EXPECT_FALSE(scheduler.acquire(300));
+    EXPECT_TRUE(scheduler.hasDeferred());
+
+    const UploadScheduler::Stats &stats = scheduler.getStats();
+    EXPECT_EQ(1000u, stats.uploaded);
+    EXPECT_EQ(2u, stats.deferred);
+    EXPECT_EQ(301u, stats.deferredBytes);
+
+    // Deferred uploads get another chance in the next frame.
+    scheduler.beginFrame(1000);
+    EXPECT_FALSE(scheduler.hasDeferred());
+    EXPECT_TRUE(scheduler.acquire(300));
+    EXPECT_EQ(300u, scheduler.getStats().uploaded);
+}
+
+TEST(UploadScheduler, LargeUploads) {
+    UploadScheduler scheduler;
+
+    // The first upload of a frame always fits, even if it exceeds the budget.
+    scheduler.beginFrame(1000);
+    EXPECT_TRUE(scheduler.acquire(5000));
+    EXPECT_FALSE(scheduler.acquire(10));
+}
+
+TEST(UploadScheduler, Record) {
+    UploadScheduler scheduler;
+    scheduler.beginFrame(1000);
+
+    // Recorded uploads count against the budget, but are never deferred.
+    scheduler.record(800);
+    scheduler.record(800);
+    EXPECT_FALSE(scheduler.hasDeferred());
+    EXPECT_FALSE(scheduler.acquire(100));
+    EXPECT_EQ(1600u, scheduler.getStats().uploaded);
+}
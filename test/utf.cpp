@@ -0,0 +1,132 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/util/utf.hpp>
+
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+std::string encode(char32_t c) {
+    std::string result;
+    if (c < 0x80) {
+        result += char(c);
+    } else if (c < 0x800) {
+        result += char(0xC0 | (c >> 6));
+        result += char(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        result += char(0xE0 | (c >> 12));
+        result += char(0x80 | ((c >> 6) & 0x3F));
+        result += char(0x80 | (c & 0x3F));
+    } else {
+        result += char(0xF0 | (c >> 18));
+        result += char(0x80 | ((c >> 12) & 0x3F));
+        result += char(0x80 | ((c >> 6) & 0x3F));
+        result += char(0x80 | (c & 0x3F));
+    }
+    return result;
+}
+
+std::u32string decode(const std::string &utf8, bool expectValid = true) {
+    std::u32string result;
+    EXPECT_EQ(expectValid, util::utf8ToUtf32(utf8, result)) << utf8;
+    return result;
+}
+
+}
+
+TEST(UTF, Decode) {
+    EXPECT_EQ(U"", decode(""));
+    EXPECT_EQ(U"Main Street", decode("Main Street"));
+    EXPECT_EQ(U"Straße", decode("Stra\xc3\x9f" "e"));
+    EXPECT_EQ(U"東京都", decode("\xe6\x9d\xb1\xe4\xba\xac\xe9\x83\xbd"));
+    EXPECT_EQ(U"\U0001F600", decode("\xf0\x9f\x98\x80"));
+    EXPECT_EQ(U"߿ࠀ￿\U00010000\U0010FFFF",
+              decode("\xdf\xbf\xe0\xa0\x80\xef\xbf\xbf\xf0\x90\x80\x80\xf4\x8f\xbf\xbf"));
+
+    // Labels that are longer than a block of ASCII characters, with other characters in between.
+    EXPECT_EQ(U"Avenue des Champs-Élysées, Paris 75008",
+              decode("Avenue des Champs-\xc3\x89lys\xc3\xa9" "es, Paris 75008"));
+
+    // Decoded characters are appended.
+    std::u32string result = U"> ";
+    EXPECT_TRUE(util::utf8ToUtf32("abc", 3, result));
+    EXPECT_EQ(U"> abc", result);
+}
+
+TEST(UTF, RoundTrip) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> length(0, 40);
+    std::uniform_int_distribution<uint32_t> plane(0, 3);
+
+    for (int i = 0; i < 1000; i++) {
+        std::u32string expected;
+        std::string utf8;
+        for (uint32_t j = length(generator); j > 0; j--) {
+            const uint32_t limits[] = { 0x80, 0x800, 0x10000, 0x110000 };
+            char32_t c = std::uniform_int_distribution<uint32_t>(0, limits[plane(generator)] - 1)(generator);
+            if (c >= 0xD800 && c < 0xE000) {
+                c = 'x';
+            }
+            expected += c;
+            utf8 += encode(c);
+        }
+        ASSERT_EQ(expected, decode(utf8));
+    }
+}
+
+TEST(UTF, Invalid) {
+    // Continuation bytes without a lead byte, and bytes that never appear in UTF-8.
+    EXPECT_EQ(U"ab", decode("a\x80" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xbf\xbf" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xfe\xff" "b", false));
+
+    // Overlong encodings.
+    EXPECT_EQ(U"ab", decode("a\xc0\xaf" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xc1\xbf" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xe0\x80\xaf" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xf0\x80\x80\xaf" "b", false));
+
+    // Surrogates and code points above U+10FFFF.
+    EXPECT_EQ(U"ab", decode("a\xed\xa0\x80" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xed\xbf\xbf" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xf4\x90\x80\x80" "b", false));
+    EXPECT_EQ(U"ab", decode("a\xf5\x80\x80\x80" "b", false));
+
+    // Truncated sequences don't swallow the characters that follow them.
+    EXPECT_EQ(U"ab", decode("a\xe6\x9d" "b", false));
+    EXPECT_EQ(U"a東", decode("a\xf0\x9f\xe6\x9d\xb1", false));
+    EXPECT_EQ(U"a", decode("a\xe6\x9d", false));
+    EXPECT_EQ(U"a", decode("a\xf0\x9f\x98", false));
+}
+
+TEST(UTF, CaseMapping) {
+    std::u32string label = U"Rue de l'Église 12";
+    util::toUpper(label);
+    EXPECT_EQ(U"RUE DE L'ÉGLISE 12", label);
+    util::toLower(label);
+    EXPECT_EQ(U"rue de l'église 12", label);
+
+    // Latin, Greek, Cyrillic and Armenian.
+    EXPECT_EQ(U'Ÿ', util::toUpper(U'ÿ'));
+    EXPECT_EQ(U'Ł', util::toUpper(U'ł'));
+    EXPECT_EQ(U'Ǆ', util::toUpper(U'ǆ'));
+    EXPECT_EQ(U'Ệ', util::toUpper(U'ệ'));
+    EXPECT_EQ(U'Σ', util::toUpper(U'σ'));
+    EXPECT_EQ(U'Σ', util::toUpper(U'ς'));
+    EXPECT_EQ(U'σ', util::toLower(U'Σ'));
+    EXPECT_EQ(U'Ж', util::toUpper(U'ж'));
+    EXPECT_EQ(U'ё', util::toLower(U'Ё'));
+    EXPECT_EQ(U'Ա', util::toUpper(U'ա'));
+    EXPECT_EQ(U'Ａ', util::toUpper(U'ａ'));
+    EXPECT_EQ(U'i', util::toLower(U'İ'));
+
+    // Characters whose other case has several characters, without case, or outside of the
+    // Basic Multilingual Plane keep their case.
+    EXPECT_EQ(U'ß', util::toUpper(U'ß'));
+    EXPECT_EQ(U'東', util::toUpper(U'東'));
+    EXPECT_EQ(U'×', util::toLower(U'×'));
+    EXPECT_EQ(U'\U00010428', util::toUpper(U'\U00010428'));
+}
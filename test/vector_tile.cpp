@@ -0,0 +1,144 @@
+#include <iostream>
+#include "gtest/gtest.h"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+#include <mbgl/style/filter_comparison_private.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+// Minimal protobuf writer for assembling test tiles.
+std::string varint(uint64_t value) {
+    std::string result;
+    while (value >= 0x80) {
+        result += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    result += char(value);
+    return result;
+}
+
+std::string field(uint32_t tag, uint64_t value) {
+    return varint(tag << 3) + varint(value);
+}
+
+std::string field(uint32_t tag, const std::string &message) {
+    return varint((tag << 3) | 2) + varint(message.size()) + message;
+}
+
+std::string feature(uint64_t id, FeatureType type, const std::string &tags) {
+    return field(2, field(1, id) + field(2, tags) + field(3, uint64_t(type)) + field(4, varint(9) + varint(0) + varint(0)));
+}
+
+// A layer whose features come before its keys and values, like tiles written by most encoders.
+std::string layer() {
+    return field(1, std::string("water")) +
+           feature(1, FeatureType::Polygon, varint(0) + varint(0) + varint(1) + varint(2)) +
+           feature(2, FeatureType::LineString, varint(0) + varint(1)) +
+           feature(3, FeatureType::Polygon, varint(0) + varint(5)) +
+           field(3, std::string("class")) +
+           field(3, std::string("name")) +
+           field(4, field(1, std::string("lake"))) +
+           field(4, field(1, std::string("river"))) +
+           field(4, field(1, std::string("Nile"))) +
+           field(5, uint64_t(2048));
+}
+
+}
+
+TEST(VectorTile, FeatureIndex) {
+    const std::string data = field(3, layer());
+    const VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto it = tile.layers.find("water");
+    ASSERT_NE(tile.layers.end(), it);
+    const VectorTileLayer &water = it->second;
+
+    EXPECT_EQ(2048u, water.extent);
+    ASSERT_EQ(2u, water.keys.size());
+    EXPECT_EQ("class", water.keys[0].to_string());
+    EXPECT_EQ(1, water.getKeyIndex("name"));
+    EXPECT_EQ(-1, water.getKeyIndex("type"));
+
+    // Keys are not copied out of the tile buffer.
+    EXPECT_GE(water.keys[0].data(), data.data());
+    EXPECT_LT(water.keys[0].data(), data.data() + data.size());
+
+    ASSERT_EQ(3u, water.features.size());
+    const VectorTileFeature &lake = water.features[0];
+    EXPECT_EQ(1u, lake.id);
+    EXPECT_EQ(FeatureType::Polygon, lake.type);
+    EXPECT_TRUE(lake.geometry);
+
+    const Value *name = water.getValue(lake, "name");
+    ASSERT_TRUE(name != nullptr);
+    EXPECT_EQ("Nile", toString(*name));
+    EXPECT_TRUE(water.getValue(water.features[1], "name") == nullptr);
+
+    // Out of range tags are dropped when the layer is decoded.
+    EXPECT_FALSE(water.features[2].tags);
+    EXPECT_TRUE(water.getValue(water.features[2], "class") == nullptr);
+}
+
+TEST(VectorTile, FilteredLayer) {
+    const std::string data = field(3, layer());
+    const VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+    const VectorTileLayer &water = tile.layers.find("water")->second;
+
+    FilterExpression all;
+    size_t count = 0;
+    for (const VectorTileFeature &feature : FilteredVectorTileLayer(water, all)) {
+        (void)feature;
+        count++;
+    }
+    EXPECT_EQ(3u, count);
+
+    FilterComparison comparison("class");
+    comparison.add(FilterComparison::Operator::Equal, std::vector<Value> { std::string("river") });
+    FilterExpression rivers;
+    rivers.add(comparison);
+
+    std::vector<uint64_t> ids;
+    for (const VectorTileFeature &feature : FilteredVectorTileLayer(water, rivers)) {
+        ids.push_back(feature.id);
+    }
+    EXPECT_EQ(std::vector<uint64_t>{ 2 }, ids);
+}
+
+TEST(VectorTile, CompiledFilter) {
+    const std::string data = field(3, layer());
+    const VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+    const VectorTileLayer &water = tile.layers.find("water")->second;
+
+    FilterComparison named("name");
+    named.add(FilterComparison::Operator::NotEqual, std::vector<Value> { std::string("Nile") });
+    FilterComparison unknown("depth");
+    unknown.add(FilterComparison::Operator::In, std::vector<Value> { int64_t(1) });
+    FilterComparison lakes("class");
+    lakes.add(FilterComparison::Operator::Equal, std::vector<Value> { std::string("lake") });
+
+    FilterExpression polygons(FilterExpression::Operator::Or);
+    polygons.setGeometryType(FilterExpression::GeometryType::Polygon);
+    polygons.add(lakes);
+    polygons.add(unknown);
+
+    FilterExpression expression(FilterExpression::Operator::Nor);
+    expression.add(named);
+    expression.add(polygons);
+
+    // The compiled filter agrees with evaluating the expression tree.
+    const VectorTileFilter filter(expression, water);
+    VectorTileTagExtractor extractor(water);
+    for (const VectorTileFeature &feature : water.features) {
+        extractor.setFeature(feature);
+        EXPECT_EQ(expression.compare(extractor), filter.matches(feature)) << "feature " << feature.id;
+        // Results are memoized; evaluating again yields the same result.
+        EXPECT_EQ(expression.compare(extractor), filter.matches(feature)) << "feature " << feature.id;
+    }
+
+    // Only the lake has a name, and it is excluded by the polygon clause.
+    EXPECT_FALSE(filter.matches(water.features[0]));
+    EXPECT_FALSE(filter.matches(water.features[1]));
+}